@@ -63,7 +63,8 @@ ovrHmdDesc HMDRenderState::GetDesc() const
     d.DistortionCaps    = ovrDistortionCap_Chromatic | ovrDistortionCap_TimeWarp |
                           ovrDistortionCap_Vignette | ovrDistortionCap_SRGB |
                           ovrDistortionCap_FlipInput | ovrDistortionCap_ProfileNoTimewarpSpinWaits |
-                          ovrDistortionCap_HqDistortion | ovrDistortionCap_LinuxDevFullscreen;
+                          ovrDistortionCap_HqDistortion | ovrDistortionCap_LinuxDevFullscreen |
+                          ovrDistortionCap_AdaptiveMesh;
 
 #if defined(OVR_OS_WIN32) || defined(OVR_OS_WIN64)
     // TODO: this gets enabled for everything, but is only applicable for DX11+
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "CAPI_HMDState.h"
 #include "../OVR_Profile.h"
+#include "../Util/Util_DistortionMeshCache.h"
 #include "../Service/Service_NetClient.h"
 #ifdef OVR_OS_WIN32
 #include "../Displays/OVR_Win32_ShimFunctions.h"
@@ -286,6 +287,9 @@ HMDState* HMDState::CreateHMDState(NetClient* client, const HMDNetworkInfo& netI
     hmds->TheSensorStateReader.SetUpdater(hmds->SharedStateReader.Get());
     hmds->TheLatencyTestStateReader.SetUpdater(hmds->SharedStateReader.Get());
 
+    // Pay the service round trips now rather than on the first frames
+    client->PrefetchNumberValues(netInfo.NetId);
+
     return hmds;
 }
 
@@ -483,7 +487,8 @@ float HMDState::getFloatValue(const char* propertyName, float defaultVal)
     }
     else if (NetSessionCommon::IsServiceProperty(NetSessionCommon::EGetNumberValue, propertyName))
     {
-       return (float)NetClient::GetInstance()->GetNumberValue(GetNetId(), propertyName, defaultVal);
+       // Cached: this is typically read every frame from the render thread
+       return (float)NetClient::GetInstance()->GetCachedNumberValue(GetNetId(), propertyName, defaultVal);
     }
     else if (pProfile)
     {
@@ -752,6 +757,10 @@ void  HMDState::SubmitEyeTextures(const ovrPosef renderPose[2],
 }
 
 
+// Largest interpolation error of ovrDistortionCap_AdaptiveMesh meshes, in pixels at the lens
+// centre. Half a pixel is below the error of the default uniform grid on DK2.
+static const float AdaptiveMeshTolerancePixels = 0.5f;
+
 // I appreciate this is not an idea place for this function, but it didn't seem to be
 // being linked properly when in OVR_CAPI.cpp. 
 // Please relocate if you know of a better place
@@ -765,8 +774,7 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
         return 0;
     HMDState* hmds = (HMDState*)hmd;
 
-    // Not used now, but Chromatic flag or others could possibly be checked for in the future.
-    OVR_UNUSED1(distortionCaps); 
+    // Only AdaptiveMesh is checked for now, but Chromatic flag or others could possibly be checked for in the future.
    
 #if defined (OVR_CC_MSVC)
     static_assert(sizeof(DistortionMeshVertexData) == sizeof(ovrDistortionVertex), "DistortionMeshVertexData size mismatch");
@@ -794,11 +802,44 @@ ovrBool ovrHmd_CreateDistortionMeshInternal( ovrHmdStruct *  hmd,
     int triangleCount = 0;
     int vertexCount = 0;
 
-    DistortionMeshCreate((DistortionMeshVertexData**)&meshData->pVertexData,
-                         (uint16_t**)&meshData->pIndexData,
-                          &vertexCount, &triangleCount,
-                          (stereoEye == StereoEye_Right),
-                          hmdri, distortion, eyeToSourceNDC);
+    // The same HMD, lens and FOV always give the same mesh, so it is kept on disk
+    bool     adaptive  = (distortionCaps & ovrDistortionCap_AdaptiveMesh) != 0;
+    String   cachePath = ProfileManager::GetInstance()->GetDistortionMeshCachePath();
+    uint32_t cacheKey  = DistortionMeshCacheKey((stereoEye == StereoEye_Right), hmdri, distortion, fov,
+                                                adaptive, AdaptiveMeshTolerancePixels);
+
+    bool cached = !cachePath.IsEmpty() &&
+                  DistortionMeshCacheLoad(cachePath.ToCStr(), cacheKey,
+                                          (DistortionMeshVertexData**)&meshData->pVertexData,
+                                          (uint16_t**)&meshData->pIndexData,
+                                          &vertexCount, &triangleCount);
+    if (!cached)
+    {
+        if (adaptive)
+        {
+            DistortionMeshCreateAdaptive((DistortionMeshVertexData**)&meshData->pVertexData,
+                                         (uint16_t**)&meshData->pIndexData,
+                                         &vertexCount, &triangleCount,
+                                         (stereoEye == StereoEye_Right),
+                                         hmdri, distortion, eyeToSourceNDC,
+                                         AdaptiveMeshTolerancePixels);
+        }
+        else
+        {
+            DistortionMeshCreate((DistortionMeshVertexData**)&meshData->pVertexData,
+                                 (uint16_t**)&meshData->pIndexData,
+                                  &vertexCount, &triangleCount,
+                                  (stereoEye == StereoEye_Right),
+                                  hmdri, distortion, eyeToSourceNDC);
+        }
+
+        if (meshData->pVertexData && !cachePath.IsEmpty())
+        {
+            DistortionMeshCacheStore(cachePath.ToCStr(), cacheKey,
+                                     (const DistortionMeshVertexData*)meshData->pVertexData,
+                                     meshData->pIndexData, vertexCount, triangleCount);
+        }
+    }
 
     if (meshData->pVertexData)
     {
@@ -32,9 +32,72 @@ limitations under the License.
 
 namespace OVR { namespace CAPI {
 
+//-----------------------------------------------------------------------------
+// ***** LatencyHistogram
+
+void LatencyHistogram::Reset()
+{
+    memset(Buckets, 0, sizeof(Buckets));
+    Count = 0;
+    Sum = 0.;
+    Max = 0.;
+}
+
+void LatencyHistogram::AddSample(double seconds)
+{
+    if (seconds < 0.)
+        seconds = 0.;
+
+    int bucket = (int)(seconds * 1000.);
+    if (bucket >= OVR_LAG_STATS_HISTOGRAM_BUCKETS)
+        bucket = OVR_LAG_STATS_HISTOGRAM_BUCKETS - 1;
+
+    ++Buckets[bucket];
+    ++Count;
+    Sum += seconds;
+    if (seconds > Max)
+        Max = seconds;
+}
+
+double LatencyHistogram::GetPercentile(double fraction) const
+{
+    if (Count == 0)
+        return 0.;
+
+    // Rank of the sample, starting at 1
+    uint32_t rank = (uint32_t)(fraction * Count + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    uint32_t sum = 0;
+    for (int i = 0; i < OVR_LAG_STATS_HISTOGRAM_BUCKETS - 1; ++i)
+    {
+        sum += Buckets[i];
+        if (sum >= rank)
+            return (i + 1) * 0.001;
+    }
+    return Max;
+}
+
+void LatencyHistogramSummary::Set(const LatencyHistogram& histogram)
+{
+    Mean   = histogram.GetMean();
+    Median = histogram.GetPercentile(0.5);
+    P99    = histogram.GetPercentile(0.99);
+    Max    = histogram.GetMax();
+}
+
 //-----------------------------------------------------------------------------
 // ***** LatencyStatisticsObserver
 
+// Header written when creating the file
+static const char* LatencyStatisticsHeaderV2 = "GUID,OS,OSVersion,Process,DisplayDriver,CameraDriver,GPU,Time,Interval,FPS,EndFrameExecutionTime,LatencyRender,LatencyTimewarp,LatencyPostPresent,LatencyVisionProc,LatencyVisionFrame,"
+                                               "VideoFrames,VideoFramesDropped,VideoFramesRepeated,"
+                                               "VideoCaptureIntervalMean,VideoCaptureIntervalMedian,VideoCaptureIntervalP99,VideoCaptureIntervalMax,"
+                                               "VideoCaptureToUploadMean,VideoCaptureToUploadMedian,VideoCaptureToUploadP99,VideoCaptureToUploadMax,"
+                                               "VideoUploadToPresentMean,VideoUploadToPresentMedian,VideoUploadToPresentP99,VideoUploadToPresentMax,"
+                                               "VideoCaptureToPresentMean,VideoCaptureToPresentMedian,VideoCaptureToPresentP99,VideoCaptureToPresentMax,UserData1\n";
+
 LatencyStatisticsCSV::LatencyStatisticsCSV()
 {
 }
@@ -83,10 +146,30 @@ bool LatencyStatisticsCSV::Start(String fileName, String userData1)
 #endif
     Guid = OVR::Util::GetGuidString();
 
+    // Files written before the video columns were added have a shorter header: appending V2 rows to them
+    // would misalign every column, so V2 rows go to "<name>_v2<ext>" instead.
+    if (_File.Open(path, OVR::File::Open_Read, OVR::File::Mode_Read))
+    {
+        bool isV2 = HasHeaderV2();
+        _File.Close();
+        if (!isV2)
+        {
+            OVR::String v2Name = fileName;
+            OVR::String extension = v2Name.GetExtension();
+            v2Name.StripExtension();
+            v2Name.AppendString("_v2");
+            v2Name.AppendString(extension);
+            LogText("[LatencyStatisticsCSV] %s does not have a V2 header, writing to %s\n", fileName.ToCStr(), v2Name.ToCStr());
+            path = basePath;
+            path.AppendString("\\");
+            path.AppendString(v2Name);
+        }
+    }
+
     if (!_File.Open(path, OVR::File::Open_Write, OVR::File::Mode_Write))
     {
         _File.Create(path, OVR::File::Mode_Write);
-        WriteHeaderV1();
+        WriteHeaderV2();
     }
     else
     {
@@ -118,23 +201,42 @@ bool LatencyStatisticsCSV::Stop()
     }
     return false;
 }
-void LatencyStatisticsCSV::WriteHeaderV1()
+void LatencyStatisticsCSV::WriteHeaderV2()
 {
     if (_File.IsValid())
     {
-        // Write header if creating the file
-        const char *str = "GUID,OS,OSVersion,Process,DisplayDriver,CameraDriver,GPU,Time,Interval,FPS,EndFrameExecutionTime,LatencyRender,LatencyTimewarp,LatencyPostPresent,LatencyVisionProc,LatencyVisionFrame,UserData1\n";
-        _File.Write((const uint8_t *) str, (int)OVR_strlen(str));
+        _File.Write((const uint8_t *) LatencyStatisticsHeaderV2, (int)OVR_strlen(LatencyStatisticsHeaderV2));
     }
 }
 
-void LatencyStatisticsCSV::WriteResultsV1(LatencyStatisticsResults *results)
+bool LatencyStatisticsCSV::HasHeaderV2()
+{
+    const int headerLength = (int)OVR_strlen(LatencyStatisticsHeaderV2);
+    OVR::Array<uint8_t> header;
+    header.Resize(headerLength);
+    return _File.Read(&header[0], headerLength) == headerLength &&
+           memcmp(&header[0], LatencyStatisticsHeaderV2, headerLength) == 0;
+}
+
+void LatencyStatisticsCSV::WriteResultsV2(LatencyStatisticsResults *results)
 {
     if (_File.IsValid())
     {
-        char str[512];
+        const LatencyHistogramSummary* video[4] = { &results->VideoCaptureInterval, &results->VideoCaptureToUpload,
+                                                    &results->VideoUploadToPresent, &results->VideoCaptureToPresent };
+        char videoStr[512];
+        size_t videoLen = OVR_sprintf(videoStr, sizeof(videoStr), "%d,%d,%d",
+            results->VideoFrames, results->VideoFramesDropped, results->VideoFramesRepeated);
+        for (int i = 0; i < 4 && videoLen < sizeof(videoStr); ++i)
+        {
+            videoLen += OVR_sprintf(videoStr + videoLen, sizeof(videoStr) - videoLen, ",%f,%f,%f,%f",
+                video[i]->Mean, video[i]->Median, video[i]->P99, video[i]->Max);
+        }
+        videoStr[sizeof(videoStr)-1] = 0;
+
+        char str[1024];
         OVR_sprintf(str, sizeof(str),
-            "%s,%s,%s,%s,%s,%s,%s,%f,%f,%f,%f,%f,%f,%f,%f,%f,%s\n",
+            "%s,%s,%s,%s,%s,%s,%s,%f,%f,%f,%f,%f,%f,%f,%f,%f,%s,%s\n",
             Guid.ToCStr(),
             OS.ToCStr(),
             OSVersion.ToCStr(),
@@ -151,6 +253,7 @@ void LatencyStatisticsCSV::WriteResultsV1(LatencyStatisticsResults *results)
             results->LatencyPostPresent,
             results->LatencyVisionProc,
             results->LatencyVisionFrame,
+            videoStr,
             UserData1.ToCStr());
         str[sizeof(str)-1] = 0;
         _File.Write((const uint8_t *)str, (int)OVR_strlen(str));
@@ -158,13 +261,16 @@ void LatencyStatisticsCSV::WriteResultsV1(LatencyStatisticsResults *results)
 }
 void LatencyStatisticsCSV::OnResults(LatencyStatisticsResults *results)
 {
-    WriteResultsV1(results);
+    WriteResultsV2(results);
 }
 //-------------------------------------------------------------------------------------
 // ***** LatencyStatisticsCalculator
     
 LagStatsCalculator::LagStatsCalculator()
 {
+    VideoFramePending = false;
+    LastVideoFrameValid = false;
+
     resetPerfStats();
 }
 
@@ -184,6 +290,14 @@ void LagStatsCalculator::resetPerfStats(double resetTime)
     //VisionLagSum = 0.;
     VisionFrames = 0;
 
+    VideoFrames = 0;
+    VideoFramesDropped = 0;
+    VideoFramesRepeated = 0;
+    VideoCaptureInterval.Reset();
+    VideoCaptureToUpload.Reset();
+    VideoUploadToPresent.Reset();
+    VideoCaptureToPresent.Reset();
+
     //for (int i = 0; i < 3; ++i)
     //{
     //    LatencyData[i] = 0.f;
@@ -230,9 +344,52 @@ void LagStatsCalculator::InstrumentEndFrameEnd(double timestamp)
 {
     EndFrameEndTime = timestamp;
 
+    instrumentVideoPresent(timestamp);
+
     calculateResults();
 }
 
+void LagStatsCalculator::InstrumentVideoFrame(const ovrVideoFrameTiming& timing)
+{
+    PendingVideoFrame = timing;
+    VideoFramePending = true;
+}
+
+void LagStatsCalculator::instrumentVideoPresent(double presentTime)
+{
+    if (!VideoFramePending)
+        return;
+    VideoFramePending = false;
+
+    const ovrVideoFrameTiming& frame = PendingVideoFrame;
+
+    if (LastVideoFrameValid)
+    {
+        // If the same frame is shown again,
+        if (frame.SequenceNumber == LastVideoFrame.SequenceNumber)
+        {
+            ++VideoFramesRepeated;
+            return;
+        }
+
+        // If the sequence went forward, frames in between were never presented.
+        // Otherwise the video source was restarted.
+        if (frame.SequenceNumber > LastVideoFrame.SequenceNumber)
+        {
+            VideoFramesDropped += (int)(frame.SequenceNumber - LastVideoFrame.SequenceNumber - 1);
+            VideoCaptureInterval.AddSample(frame.CaptureSeconds - LastVideoFrame.CaptureSeconds);
+        }
+    }
+
+    VideoCaptureToUpload.AddSample(frame.UploadSeconds - frame.CaptureSeconds);
+    VideoUploadToPresent.AddSample(presentTime - frame.UploadSeconds);
+    VideoCaptureToPresent.AddSample(presentTime - frame.CaptureSeconds);
+    ++VideoFrames;
+
+    LastVideoFrame = frame;
+    LastVideoFrameValid = true;
+}
+
 void LagStatsCalculator::InstrumentEyePose(const ovrTrackingState& state)
 {
     // If the camera frame counter has rolled,
@@ -300,6 +457,15 @@ void LagStatsCalculator::calculateResults()
         results.LatencyVisionProc = latencyStatisticsData.LatencyVisionProc * invVisionFrameCount;
         results.LatencyVisionFrame = latencyStatisticsData.LatencyVisionFrame * invVisionFrameCount;
 
+        // Video frame instrumentation
+        results.VideoFrames = VideoFrames;
+        results.VideoFramesDropped = VideoFramesDropped;
+        results.VideoFramesRepeated = VideoFramesRepeated;
+        results.VideoCaptureInterval.Set(VideoCaptureInterval);
+        results.VideoCaptureToUpload.Set(VideoCaptureToUpload);
+        results.VideoUploadToPresent.Set(VideoUploadToPresent);
+        results.VideoCaptureToPresent.Set(VideoCaptureToPresent);
+
         Results.SetState(results);
 
         {
@@ -40,6 +40,46 @@ namespace OVR { namespace CAPI {
 #define OVR_LAG_STATS_EPOCH 1.0 /* seconds */
 // Define seconds without frames before resetting stats
 #define OVR_LAG_STATS_RESET_LIMIT 2.0 /* seconds */
+// Define number of 1 ms buckets in the video frame latency histograms
+#define OVR_LAG_STATS_HISTOGRAM_BUCKETS 128
+
+
+//-------------------------------------------------------------------------------------
+// ***** LatencyHistogram
+
+// Distribution of one latency over the epoch, with 1 ms resolution.
+// Longer samples go to the last bucket, but are still included in the mean and maximum.
+class LatencyHistogram
+{
+public:
+    LatencyHistogram() { Reset(); }
+
+    void Reset();
+    void AddSample(double seconds);
+
+    int    GetCount() const { return Count; }
+    double GetMean() const  { return Count ? Sum / Count : 0.; }
+    double GetMax() const   { return Max; }
+    // Upper edge of the bucket holding the sample at this fraction (0..1) of the distribution
+    double GetPercentile(double fraction) const;
+
+protected:
+    uint32_t Buckets[OVR_LAG_STATS_HISTOGRAM_BUCKETS];
+    int      Count;
+    double   Sum;
+    double   Max;
+};
+
+// Summary of a LatencyHistogram, as written in the CSV log
+struct LatencyHistogramSummary
+{
+    double Mean;
+    double Median;
+    double P99;
+    double Max;
+
+    void Set(const LatencyHistogram& histogram);
+};
 
 
 //-------------------------------------------------------------------------------------
@@ -71,6 +111,23 @@ struct LatencyStatisticsResults
 
     // Measures the time from exposure until the pose is available for the frame, including processing time.
     double LatencyVisionFrame;
+
+    // Video frames reported with ovrHmd_SetVideoFrameTiming(), e.g. from a passthrough camera.
+    // Number of new video frames presented during the epoch.
+    int VideoFrames;
+    // Video frames that were captured but never presented (gaps in the sequence numbers).
+    int VideoFramesDropped;
+    // Presents showing a video frame that was already presented.
+    int VideoFramesRepeated;
+
+    // Time between the captures of consecutive presented video frames.
+    LatencyHistogramSummary VideoCaptureInterval;
+    // Time from the capture of a video frame until its upload to a texture.
+    LatencyHistogramSummary VideoCaptureToUpload;
+    // Time from the upload of a video frame until the end of the EndFrame() call that first presents it.
+    LatencyHistogramSummary VideoUploadToPresent;
+    // Time from the capture of a video frame until the end of the EndFrame() call that first presents it.
+    LatencyHistogramSummary VideoCaptureToPresent;
 };
 
 //-----------------------------------------------------------------------------
@@ -87,11 +144,14 @@ public:
     void OnResults(LatencyStatisticsResults *results);
 
     // Internal
-    void WriteHeaderV1();
-    void WriteResultsV1(LatencyStatisticsResults *results);
+    void WriteHeaderV2();
+    void WriteResultsV2(LatencyStatisticsResults *results);
     ObserverScope<LatencyStatisticsSlot>* GetObserver() { return &_Observer; }
 
 protected:
+    // Reads the start of the open file: true if it begins with the header written by WriteHeaderV2
+    bool HasHeaderV2();
+
     ObserverScope<LatencyStatisticsSlot> _Observer;
     String Guid, UserData1;
     String FileName;
@@ -142,6 +202,21 @@ class LagStatsCalculator
     // Count of vision frames
     int                 VisionFrames;
 
+    // Video frame reported for the frame being rendered
+    ovrVideoFrameTiming PendingVideoFrame;
+    bool                VideoFramePending;
+    // Last video frame presented, kept across epochs
+    ovrVideoFrameTiming LastVideoFrame;
+    bool                LastVideoFrameValid;
+    // Video frame counts and latency distributions for this stats epoch
+    int                 VideoFrames, VideoFramesDropped, VideoFramesRepeated;
+    LatencyHistogram    VideoCaptureInterval;
+    LatencyHistogram    VideoCaptureToUpload;
+    LatencyHistogram    VideoUploadToPresent;
+    LatencyHistogram    VideoCaptureToPresent;
+
+    void instrumentVideoPresent(double presentTime);
+
     // Statistics results:
 
     LocklessUpdater<LatencyStatisticsResults, LatencyStatisticsResults> Results;
@@ -170,6 +245,10 @@ public:
 
     // Eye pose instrumentation
     void InstrumentEyePose(const ovrTrackingState& state);
+
+    // Video frame instrumentation
+    // Note: The frame is accounted as presented by the next InstrumentEndFrameEnd()
+    void InstrumentVideoFrame(const ovrVideoFrameTiming& timing);
 };
 
 
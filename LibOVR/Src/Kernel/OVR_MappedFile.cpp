@@ -0,0 +1,159 @@
+/************************************************************************************
+
+Filename    :   OVR_MappedFile.cpp
+Content     :   Read-only memory mapping of whole files
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#include "OVR_MappedFile.h"
+#include "OVR_UTF8Util.h"
+
+#if defined(OVR_OS_WIN32)
+#include <windows.h>
+#elif defined(OVR_OS_LINUX) || defined(OVR_OS_MAC)
+#include <sys/mman.h> // mmap()
+#include <sys/stat.h> // fstat()
+#include <fcntl.h>    // open()
+#include <unistd.h>   // close()
+#define OVR_MAPPEDFILE_MMAP 1
+#else
+#include "OVR_SysFile.h"
+#endif
+
+namespace OVR {
+
+
+MappedFile::MappedFile()
+  : pData(NULL), Size(0), Allocated(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+#if defined(OVR_OS_WIN32)
+
+    wchar_t* pwpath = (wchar_t*)OVR_ALLOC((UTF8Util::GetLength(path) + 1) * sizeof(wchar_t));
+    if (!pwpath)
+    {
+        return false;
+    }
+    UTF8Util::DecodeString(pwpath, path);
+    HANDLE hFile = ::CreateFileW(pwpath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL,
+                                 OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    OVR_FREE(pwpath);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (::GetFileSizeEx(hFile, &fileSize) && fileSize.QuadPart > 0 && (uint64_t)fileSize.QuadPart <= (size_t)-1)
+    {
+        // The view keeps the file mapped once the handles are closed
+        HANDLE hMapping = ::CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (hMapping)
+        {
+            pData = (const uint8_t*)::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+            Size  = pData ? (size_t)fileSize.QuadPart : 0;
+            ::CloseHandle(hMapping);
+        }
+    }
+    ::CloseHandle(hFile);
+
+#elif defined(OVR_MAPPEDFILE_MMAP)
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (::fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        void* view = ::mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view != MAP_FAILED)
+        {
+            pData = (const uint8_t*)view;
+            Size  = (size_t)fileStat.st_size;
+        }
+    }
+    ::close(fd);
+
+#else
+
+    SysFile file(path, File::Open_Read | File::Open_Buffered);
+    int length = file.IsValid() ? file.GetLength() : 0;
+    if (length > 0)
+    {
+        uint8_t* buffer = (uint8_t*)OVR_ALLOC_ALIGNED(length, 16);
+        if (buffer && file.Read(buffer, length) == length)
+        {
+            pData     = buffer;
+            Size      = (size_t)length;
+            Allocated = true;
+        }
+        else if (buffer)
+        {
+            OVR_FREE_ALIGNED(buffer);
+        }
+    }
+
+#endif
+
+    return pData != NULL;
+}
+
+void MappedFile::Close()
+{
+    if (!pData)
+    {
+        return;
+    }
+
+    if (Allocated)
+    {
+        OVR_FREE_ALIGNED((void*)pData);
+    }
+    else
+    {
+#if defined(OVR_OS_WIN32)
+        ::UnmapViewOfFile(pData);
+#elif defined(OVR_MAPPEDFILE_MMAP)
+        ::munmap((void*)pData, Size);
+#endif
+    }
+
+    pData     = NULL;
+    Size      = 0;
+    Allocated = false;
+}
+
+
+} // OVR
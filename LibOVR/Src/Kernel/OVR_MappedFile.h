@@ -0,0 +1,72 @@
+/************************************************************************************
+
+PublicHeader:   Kernel
+Filename    :   OVR_MappedFile.h
+Content     :   Read-only memory mapping of whole files
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#ifndef OVR_MappedFile_h
+#define OVR_MappedFile_h
+
+#include "OVR_Types.h"
+#include "OVR_Allocator.h"
+
+namespace OVR {
+
+
+//-----------------------------------------------------------------------------------
+// ***** MappedFile
+
+// Maps a whole file read-only into memory, with MapViewOfFile on Windows and mmap on
+// Linux and OS X. Elsewhere the file is read into an allocated buffer instead, so the
+// data is always available the same way. The view is page aligned.
+class MappedFile : public NewOverrideBase
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    // Maps the file at path (UTF-8), closing any file mapped before. Returns false if it
+    // cannot be opened or is empty.
+    bool Open(const char* path);
+    void Close();
+
+    bool           IsOpen() const  { return pData != NULL; }
+    const uint8_t* GetData() const { return pData; }
+    size_t         GetSize() const { return Size; }
+
+protected:
+    const uint8_t* pData;
+    size_t         Size;
+    bool           Allocated;   // pData came from OVR_ALLOC rather than a mapping
+
+private:
+    // Not copyable
+    MappedFile(const MappedFile&);
+    void operator=(const MappedFile&);
+};
+
+
+} // OVR
+
+#endif // OVR_MappedFile_h
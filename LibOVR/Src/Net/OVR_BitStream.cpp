@@ -25,6 +25,8 @@ limitations under the License.
 ************************************************************************************/
 
 #include "OVR_BitStream.h"
+#include "../Kernel/OVR_System.h"
+#include "../Kernel/OVR_Threads.h"
 
 #ifdef OVR_OS_WIN32
 #include <WinSock2.h>
@@ -35,8 +37,124 @@ limitations under the License.
 namespace OVR { namespace Net {
 
 
+//-----------------------------------------------------------------------------
+// BitStreamBufferPool
+
+// Keeps the heap buffers of bitstreams that outgrew their inline storage, so the streams
+// built for each RPC reuse them. Sizes are powers of two from 2^MinShift to 2^MaxShift
+// bytes; larger buffers are allocated and freed directly.
+class BitStreamBufferPool : public NewOverrideBase, public SystemSingletonBase<BitStreamBufferPool>
+{
+    OVR_DECLARE_SINGLETON(BitStreamBufferPool);
+
+public:
+    enum
+    {
+        MinShift   = 9,     // Above BITSTREAM_STACK_ALLOCATION_SIZE
+        MaxShift   = 16,
+        ClassCount = MaxShift - MinShift + 1,
+        Depth      = 8      // Buffers kept per size
+    };
+
+    // Returns the size class holding bytes and rounds bytes up to it, or -1 if too large
+    static int GetSizeClass(BitSize_t& bytes)
+    {
+        if (bytes > ((BitSize_t)1 << MaxShift))
+        {
+            return -1;
+        }
+
+        int shift = MinShift;
+        while (((BitSize_t)1 << shift) < bytes)
+        {
+            ++shift;
+        }
+        bytes = (BitSize_t)1 << shift;
+        return shift - MinShift;
+    }
+
+    unsigned char* Acquire(int sizeClass)
+    {
+        {
+            Lock::Locker locker(&PoolLock);
+            if (Counts[sizeClass] > 0)
+            {
+                return Buffers[sizeClass][--Counts[sizeClass]];
+            }
+        }
+        return (unsigned char*) OVR_ALLOC((size_t) 1 << (sizeClass + MinShift));
+    }
+
+    void Release(unsigned char* buffer, int sizeClass)
+    {
+        {
+            Lock::Locker locker(&PoolLock);
+            if (Counts[sizeClass] < Depth)
+            {
+                Buffers[sizeClass][Counts[sizeClass]++] = buffer;
+                return;
+            }
+        }
+        OVR_FREE(buffer);
+    }
+
+private:
+    Lock           PoolLock;
+    unsigned char* Buffers[ClassCount][Depth];
+    int            Counts[ClassCount];
+};
+
+BitStreamBufferPool::BitStreamBufferPool()
+{
+    memset(Counts, 0, sizeof(Counts));
+    PushDestroyCallbacks();
+}
+
+BitStreamBufferPool::~BitStreamBufferPool()
+{
+    for (int i = 0; i < ClassCount; ++i)
+    {
+        for (int j = 0; j < Counts[i]; ++j)
+        {
+            OVR_FREE(Buffers[i][j]);
+        }
+    }
+}
+
+void BitStreamBufferPool::OnSystemDestroy()
+{
+    delete this;
+}
+
+
+}} // OVR::Net
+
+OVR_DEFINE_SINGLETON(OVR::Net::BitStreamBufferPool);
+
+namespace OVR { namespace Net {
+
+
 //-----------------------------------------------------------------------------
 // BitStream
+
+unsigned char* BitStream::AllocBuffer( BitSize_t &bytes )
+{
+	int sizeClass = BitStreamBufferPool::GetSizeClass(bytes);
+	if (sizeClass < 0)
+		return ( unsigned char* ) OVR_ALLOC( (size_t) bytes );
+
+	return BitStreamBufferPool::GetInstance()->Acquire(sizeClass);
+}
+
+void BitStream::FreeBuffer( unsigned char* buffer, BitSize_t bytes )
+{
+	BitSize_t poolBytes = bytes;
+	int sizeClass = BitStreamBufferPool::GetSizeClass(poolBytes);
+	if (sizeClass < 0 || poolBytes != bytes)
+		OVR_FREE( buffer );
+	else
+		BitStreamBufferPool::GetInstance()->Release(buffer, sizeClass);
+}
 	
 BitStream::BitStream()
 {
@@ -65,8 +183,9 @@ BitStream::BitStream( const unsigned int initialBytesToAllocate )
 	}
 	else
 	{
-		data = ( unsigned char* ) OVR_ALLOC( (size_t) initialBytesToAllocate);
-		numberOfBitsAllocated = initialBytesToAllocate << 3;
+		BitSize_t bytes = initialBytesToAllocate;
+		data = AllocBuffer( bytes );
+		numberOfBitsAllocated = bytes << 3;
 	}
 #ifdef _DEBUG
 	OVR_ASSERT( data );
@@ -86,14 +205,16 @@ BitStream::BitStream( char* _data, const unsigned int lengthInBytes, bool _copyD
 	{
 		if ( lengthInBytes > 0 )
 		{
-			if (lengthInBytes < BITSTREAM_STACK_ALLOCATION_SIZE)
+			if (lengthInBytes <= BITSTREAM_STACK_ALLOCATION_SIZE)
 			{
 				data = ( unsigned char* ) stackData;
 				numberOfBitsAllocated = BITSTREAM_STACK_ALLOCATION_SIZE << 3;
 			}
 			else
 			{
-				data = ( unsigned char* ) OVR_ALLOC( (size_t) lengthInBytes);
+				BitSize_t bytes = lengthInBytes;
+				data = AllocBuffer( bytes );
+				numberOfBitsAllocated = bytes << 3;
 			}
 #ifdef _DEBUG
 			OVR_ASSERT( data );
@@ -118,8 +239,8 @@ void BitStream::SetNumberOfBitsAllocated( const BitSize_t lengthInBits )
 
 BitStream::~BitStream()
 {
-	if ( copyData && numberOfBitsAllocated > (BITSTREAM_STACK_ALLOCATION_SIZE << 3))
-		OVR_FREE( data );  // Use realloc and free so we are more efficient than delete and new for resizing
+	if ( IsHeapData() )
+		FreeBuffer( data, BITS_TO_BYTES( numberOfBitsAllocated ) );
 }
 
 void BitStream::Reset( void )
@@ -687,30 +808,27 @@ void BitStream::AddBitsAndReallocate( const BitSize_t numberOfBitsToWrite )
 		if (newNumberOfBitsAllocated - ( numberOfBitsToWrite + numberOfBitsUsed ) > 1048576 )
 			newNumberOfBitsAllocated = numberOfBitsToWrite + numberOfBitsUsed + 1048576;
 
-		//		BitSize_t newByteOffset = BITS_TO_BYTES( numberOfBitsAllocated );
-		// Use realloc and free so we are more efficient than delete and new for resizing
+		// Pooled buffers instead of realloc: the size is rounded up to the pool's
 		BitSize_t amountToAllocate = BITS_TO_BYTES( newNumberOfBitsAllocated );
-		if (data==(unsigned char*)stackData)
+		if (data!=(unsigned char*)stackData || amountToAllocate > BITSTREAM_STACK_ALLOCATION_SIZE)
 		{
-			if (amountToAllocate > BITSTREAM_STACK_ALLOCATION_SIZE)
+			unsigned char* newData = AllocBuffer( amountToAllocate );
+			OVR_ASSERT(newData);
+			if (newData)
 			{
-				data = ( unsigned char* ) OVR_ALLOC( (size_t) amountToAllocate);
-				OVR_ASSERT(data);
-                if (data)
+				if (data)
+				{
+					memcpy ((void *)newData, (void *)data, (size_t) BITS_TO_BYTES( numberOfBitsAllocated ));
+				}
+				if (IsHeapData())
 				{
-                    // need to copy the stack data over to our new memory area too
-                    memcpy ((void *)data, (void *)stackData, (size_t) BITS_TO_BYTES( numberOfBitsAllocated ));
-                }
+					FreeBuffer( data, BITS_TO_BYTES( numberOfBitsAllocated ) );
+				}
+				data = newData;
+				copyData = true;
+				numberOfBitsAllocated = BYTES_TO_BITS( amountToAllocate );
 			}
 		}
-		else
-		{
-			data = ( unsigned char* ) OVR_REALLOC( data, (size_t) amountToAllocate);
-		}
-
-#ifdef _DEBUG
-		OVR_ASSERT( data ); // Make sure realloc succeeded
-#endif
 		//  memset(data+newByteOffset, 0,  ((newNumberOfBitsAllocated-1)>>3) - ((numberOfBitsAllocated-1)>>3)); // Set the new data block to 0
 	}
 
@@ -958,14 +1076,26 @@ void BitStream::AssertCopyData( void )
 
 		if ( numberOfBitsAllocated > 0 )
 		{
-			unsigned char * newdata = ( unsigned char* ) OVR_ALLOC( (size_t) BITS_TO_BYTES( numberOfBitsAllocated ));
+			const BitSize_t bytes = BITS_TO_BYTES( numberOfBitsAllocated );
+			BitSize_t newBytes = bytes;
+			unsigned char * newdata;
+			if (bytes <= BITSTREAM_STACK_ALLOCATION_SIZE)
+			{
+				newdata = ( unsigned char* ) stackData;
+				newBytes = BITSTREAM_STACK_ALLOCATION_SIZE;
+			}
+			else
+			{
+				newdata = AllocBuffer( newBytes );
+			}
 #ifdef _DEBUG
 
 			OVR_ASSERT( data );
 #endif
 
-			memcpy( newdata, data, (size_t) BITS_TO_BYTES( numberOfBitsAllocated ) );
+			memcpy( newdata, data, (size_t) bytes );
 			data = newdata;
+			numberOfBitsAllocated = newBytes << 3;
 		}
 
 		else
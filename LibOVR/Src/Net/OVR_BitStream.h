@@ -577,6 +577,13 @@ public:
 	bool ReadAlignedBytesSafeAlloc( char **outByteArray, int &inputLength, const unsigned int maxBytesToRead );
 	bool ReadAlignedBytesSafeAlloc( char **outByteArray, unsigned int &inputLength, const unsigned int maxBytesToRead );
 
+	/// \brief Reads a string written by Write(const OVR::String&) or Write(const char*) without copying it.
+	/// \details \a outString points into the data of this bitstream, and is not null terminated.
+	/// \param[out] outString The first character of the string
+	/// \param[out] outLength The length of the string in bytes
+	/// \return true on success, false if the bitstream does not hold the whole string.
+	bool ReadInPlace( const char *&outString, uint16_t &outLength );
+
 	/// \brief Align the next write and/or read to a byte boundary.  
 	/// \details This can be used to 'waste' bits to byte align for efficiency reasons It
 	/// can also be used to force coalesced bitstreams to start on byte
@@ -812,6 +819,14 @@ private:
 	/// \brief Assume the input source points to a compressed native type. Decompress and read it.
 	bool ReadCompressed( unsigned char* inOutByteArray,	const unsigned int size, const bool unsignedData );
 
+	/// \brief Heap buffers are recycled by size, see BitStreamBufferPool.
+	/// \param[in,out] bytes The minimum size, set to the size of the returned buffer
+	static unsigned char* AllocBuffer( BitSize_t &bytes );
+	static void FreeBuffer( unsigned char* buffer, BitSize_t bytes );
+
+	/// \return true if data was allocated by this bitstream, and is numberOfBitsAllocated bits long
+	bool IsHeapData( void ) const { return copyData && data != 0 && data != stackData; }
+
 
 	BitSize_t numberOfBitsUsed;
 
@@ -1285,6 +1300,19 @@ inline bool BitStream::Read(OVR::String &outTemplateVar)
 	}
 	return b;
 }
+inline bool BitStream::ReadInPlace( const char *&outString, uint16_t &outLength )
+{
+	uint16_t l;
+	if (!Read(l))
+		return false;
+	AlignReadToByteBoundary();
+	if (readOffset > numberOfBitsUsed || GetNumberOfUnreadBits() < BYTES_TO_BITS((BitSize_t) l))
+		return false;
+	outString = (const char*) (data + ( readOffset >> 3 ));
+	outLength = l;
+	IgnoreBytes(l);
+	return true;
+}
 template <>
 inline bool BitStream::Read(char *&varString)
 {
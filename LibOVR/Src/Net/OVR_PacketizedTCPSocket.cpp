@@ -25,6 +25,7 @@ limitations under the License.
 ************************************************************************************/
 
 #include "OVR_PacketizedTCPSocket.h"
+#include "../Kernel/OVR_Alg.h"
 
 namespace OVR { namespace Net {
 
@@ -42,6 +43,7 @@ PacketizedTCPSocket::PacketizedTCPSocket()
 {
 	pRecvBuff = 0;
 	pRecvBuffSize = 0;
+	pRecvBuffCapacity = 0;
 	Transport = TransportType_PacketizedTCP;
 }
 
@@ -49,6 +51,7 @@ PacketizedTCPSocket::PacketizedTCPSocket(SocketHandle _sock, bool isListenSocket
 {
 	pRecvBuff = 0;
 	pRecvBuffSize = 0;
+	pRecvBuffCapacity = 0;
 	Transport = TransportType_PacketizedTCP;
 }
 
@@ -59,31 +62,12 @@ PacketizedTCPSocket::~PacketizedTCPSocket()
 
 int PacketizedTCPSocket::Send(const void* pData, int bytes)
 {
-    Lock::Locker locker(&sendLock);
-
 	if (bytes <= 0)
 	{
 		return -1;
 	}
 
-	// Convert length to 4 endian-neutral bytes
-	uint32_t lengthWord = bytes;
-	uint8_t lengthBytes[LENGTH_FIELD_BYTES] = {
-		(uint8_t)lengthWord,
-		(uint8_t)(lengthWord >> 8),
-		(uint8_t)(lengthWord >> 16),
-		(uint8_t)(lengthWord >> 24)
-	};
-
-	int s = PacketizedTCPSocketBase::Send(lengthBytes, LENGTH_FIELD_BYTES);
-	if (s > 0)
-	{
-		return PacketizedTCPSocketBase::Send(pData,bytes);
-	}
-	else
-	{
-		return s;
-	}
+	return SendAndConcatenate(&pData, &bytes, 1);
 }
 
 int PacketizedTCPSocket::SendAndConcatenate(const void** pDataArray, int* dataLengthArray, int arrayCount)
@@ -106,16 +90,31 @@ int PacketizedTCPSocket::SendAndConcatenate(const void** pDataArray, int* dataLe
 		(uint8_t)(lengthWord >> 24)
 	};
 
-	int s = PacketizedTCPSocketBase::Send(lengthBytes, LENGTH_FIELD_BYTES);
-	if (s > 0)
+	// The length field and the data go out in the same system calls, so the receiver
+	// gets whole packets rather than a lone length field followed by the data
+	const void* buffers[MaxSendBuffers];
+	int         lengths[MaxSendBuffers];
+	buffers[0] = lengthBytes;
+	lengths[0] = LENGTH_FIELD_BYTES;
+	int count = 1;
+	int sent = 0;
+	for (int i = 0; i < arrayCount; i++)
 	{
-		for (int i = 0; i < arrayCount; i++)
+		buffers[count] = pDataArray[i];
+		lengths[count] = dataLengthArray[i];
+		if (++count == MaxSendBuffers || i == arrayCount - 1)
 		{
-			PacketizedTCPSocketBase::Send(pDataArray[i], dataLengthArray[i]);
+			int s = PacketizedTCPSocketBase::SendBuffers(buffers, lengths, count);
+			if (s <= 0)
+			{
+				return sent > 0 ? sent : s;
+			}
+			sent += s;
+			count = 0;
 		}
 	}
 
-	return s;
+	return (sent > LENGTH_FIELD_BYTES) ? sent - LENGTH_FIELD_BYTES : -1;
 }
 
 void PacketizedTCPSocket::OnRecv(SocketEvent_TCP* eventHandler, uint8_t* pData, int bytesRead)
@@ -125,31 +124,35 @@ void PacketizedTCPSocket::OnRecv(SocketEvent_TCP* eventHandler, uint8_t* pData,
 
 	recvBuffLock.DoLock();
 
-	if (pRecvBuff == NULL)
+	if (pRecvBuffSize == 0)
 	{
 		dataSource = pData;
 		dataSourceSize = bytesRead;
 	}
 	else
 	{
-		uint8_t* pRecvBuffNew = (uint8_t*)OVR_REALLOC(pRecvBuff, bytesRead + pRecvBuffSize);
-		if (!pRecvBuffNew)
-		{
-			OVR_FREE(pRecvBuff);
-			pRecvBuff = NULL;
-			pRecvBuffSize = 0;
-			recvBuffLock.Unlock();
-			return;
-		}
-		else
+		// Grows by doubling: a packet split across many reads is copied a few times only
+		if (pRecvBuffSize + bytesRead > pRecvBuffCapacity)
 		{
+			int capacity = Alg::Max(pRecvBuffCapacity * 2, pRecvBuffSize + bytesRead);
+			uint8_t* pRecvBuffNew = (uint8_t*)OVR_REALLOC(pRecvBuff, capacity);
+			if (!pRecvBuffNew)
+			{
+				OVR_FREE(pRecvBuff);
+				pRecvBuff = NULL;
+				pRecvBuffSize = 0;
+				pRecvBuffCapacity = 0;
+				recvBuffLock.Unlock();
+				return;
+			}
 			pRecvBuff = pRecvBuffNew;
+			pRecvBuffCapacity = capacity;
+		}
 
-			memcpy(pRecvBuff + pRecvBuffSize, pData, bytesRead);
+		memcpy(pRecvBuff + pRecvBuffSize, pData, bytesRead);
 
-			dataSourceSize = pRecvBuffSize + bytesRead;
-			dataSource = pRecvBuff;
-		}
+		dataSourceSize = pRecvBuffSize + bytesRead;
+		dataSource = pRecvBuff;
 	}
 
 	int bytesReadFromStream;
@@ -169,32 +172,29 @@ void PacketizedTCPSocket::OnRecv(SocketEvent_TCP* eventHandler, uint8_t* pData,
 	{
         if (dataSource != NULL)
         {
-            if (pRecvBuff == NULL)
+            if (dataSourceSize > pRecvBuffCapacity)
             {
-                pRecvBuff = (uint8_t*)OVR_ALLOC(dataSourceSize);
+                // dataSource is the caller's buffer here, not pRecvBuff
+                OVR_FREE(pRecvBuff);
+                pRecvBuffCapacity = Alg::Max(dataSourceSize, (int)RecvBuffMinBytes);
+                pRecvBuff = (uint8_t*)OVR_ALLOC(pRecvBuffCapacity);
                 if (!pRecvBuff)
                 {
                     pRecvBuffSize = 0;
+                    pRecvBuffCapacity = 0;
                     recvBuffLock.Unlock();
                     return;
                 }
-                else
-                {
-                    memcpy(pRecvBuff, dataSource, dataSourceSize);
-                }
-            }
-            else
-            {
-                memmove(pRecvBuff, dataSource, dataSourceSize);
             }
+            memmove(pRecvBuff, dataSource, dataSourceSize);
         }
 	}
-	else
+	else if (pRecvBuffCapacity > RecvBuffKeptBytes)
 	{
-		if (pRecvBuff != NULL)
-			OVR_FREE(pRecvBuff);
-
+		// Kept for the next partial packet, unless a large packet grew it
+		OVR_FREE(pRecvBuff);
 		pRecvBuff = NULL;
+		pRecvBuffCapacity = 0;
 	}
 	pRecvBuffSize = dataSourceSize;
 
@@ -77,8 +77,12 @@ protected:
     Lock   sendLock;
     Lock   recvBuffLock;
 
-	uint8_t* pRecvBuff;     // Queued receive buffered data
-	int    pRecvBuffSize; // Size of receive queue in bytes
+	static const int RecvBuffMinBytes  = 512;   // Smallest receive buffer allocated
+	static const int RecvBuffKeptBytes = 65536; // Larger receive buffers are freed once drained
+
+	uint8_t* pRecvBuff;         // Queued receive buffered data
+	int    pRecvBuffSize;     // Size of receive queue in bytes
+	int    pRecvBuffCapacity; // Allocated size of pRecvBuff in bytes
 };
 
 
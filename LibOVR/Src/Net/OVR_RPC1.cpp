@@ -40,9 +40,108 @@ enum {
 	CALL_BLOCKING,
 	RPC_ERROR_FUNCTION_NOT_REGISTERED,
 	ID_RPC4_RETURN,
+
+	// RPCCapability_Pipelining: calls carrying a request id, so that several can be in flight.
+	// Replies are: request id, uint8 succeeded, then byte-aligned return data.
+	CALL_ASYNC,
+	CALL_BATCH,
+	ID_RPC_ASYNC_RETURN,
+	ID_RPC_BATCH_RETURN,
 };
 
 
+//-----------------------------------------------------------------------------
+// RPCCall
+
+RPCCall::RPCCall(RPC1* owner, uint32_t requestId, Connection* connection) :
+	pOwner(owner),
+	RequestId(requestId),
+	pConnection(connection),
+	Complete(false),
+	Succeeded(false)
+{
+}
+
+bool RPCCall::Wait(OVR::Net::BitStream* returnData)
+{
+	return pOwner->waitForCall(this, returnData);
+}
+
+
+//-----------------------------------------------------------------------------
+// RPCBatch
+
+void RPCBatch::Add(const char* uniqueID, OVR::Net::BitStream* bitStream)
+{
+	Requests.Write(uniqueID);
+	BitSize_t bits = 0;
+	if (bitStream)
+	{
+		bitStream->ResetReadPointer();
+		bits = bitStream->GetNumberOfBitsUsed();
+	}
+	Requests.Write(bits);
+	if (bitStream)
+	{
+		Requests.Write(bitStream);
+	}
+	++Count;
+}
+
+void RPCBatch::Clear()
+{
+	Count = 0;
+	Requests.Reset();
+	Results.Reset();
+	ResultIndex.Clear();
+}
+
+bool RPCBatch::GetResult(int i, OVR::Net::BitStream* returnData)
+{
+	if (i < 0 || i >= ResultIndex.GetSizeI() || !ResultIndex[i].Succeeded)
+	{
+		return false;
+	}
+
+	if (returnData)
+	{
+		returnData->Reset();
+		Results.SetReadOffset(ResultIndex[i].Offset);
+		returnData->Write(Results, ResultIndex[i].Bits);
+		returnData->ResetReadPointer();
+	}
+	return true;
+}
+
+bool RPCBatch::parseResults()
+{
+	ResultIndex.Clear();
+	Results.ResetReadPointer();
+
+	int32_t count = 0;
+	if (!Results.Read(count) || count != Count)
+	{
+		return false;
+	}
+
+	for (int i = 0; i < count; ++i)
+	{
+		uint8_t succeeded = 0;
+		Result r;
+		if (!Results.Read(succeeded) || !Results.Read(r.Bits) || Results.GetNumberOfUnreadBits() < r.Bits)
+		{
+			ResultIndex.Clear();
+			return false;
+		}
+		r.Succeeded = (succeeded != 0);
+		r.Offset = Results.GetReadOffset();
+		Results.IgnoreBits(r.Bits);
+		ResultIndex.PushBack(r);
+	}
+	return true;
+}
+
+
 //-----------------------------------------------------------------------------
 // RPC1
 
@@ -50,6 +149,8 @@ RPC1::RPC1()
 {
 	blockingOnThisConnection = 0;
 	blockingReturnValue = new BitStream();
+	nextRequestId = 0;
+	callPoolNext = 0;
 }
 
 RPC1::~RPC1()
@@ -77,7 +178,7 @@ void RPC1::UnregisterBlockingFunction(OVR::String uniqueID)
 	registeredBlockingFunctions.Remove(uniqueID);
 }
 
-bool RPC1::CallBlocking( OVR::String uniqueID, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection, OVR::Net::BitStream* returnData )
+bool RPC1::CallBlocking( const char* uniqueID, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection, OVR::Net::BitStream* returnData )
 {
     // If invalid parameters,
     if (!pConnection)
@@ -137,7 +238,192 @@ bool RPC1::CallBlocking( OVR::String uniqueID, OVR::Net::BitStream* bitStream, P
 	return true;
 }
 
-bool RPC1::Signal(OVR::String sharedIdentifier, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection)
+bool RPC1::IsPipeliningSupported( Connection* pConnection )
+{
+	return pConnection && (pConnection->RemoteCapabilities & RPCCapability_Pipelining) != 0;
+}
+
+Ptr<RPCCall> RPC1::acquireCall(Connection* pConnection)
+{
+	// Called with callBlockingMutex locked
+	const int count = callPool.GetSizeI();
+	for (int i = 0; i < count; ++i)
+	{
+		RPCCall* call = callPool[callPoolNext];
+		callPoolNext = (callPoolNext + 1) % count;
+
+		// Only the pool references it: the caller dropped it after its Wait()
+		if (call->GetRefCount() == 1)
+		{
+			call->RequestId   = nextRequestId++;
+			call->pConnection = pConnection;
+			call->Complete    = false;
+			call->Succeeded   = false;
+			call->ReturnValue.Reset();
+			return call;
+		}
+	}
+
+	Ptr<RPCCall> call = *new RPCCall(this, nextRequestId++, pConnection);
+	if (count < CallPoolSize)
+	{
+		callPool.PushBack(call);
+	}
+	return call;
+}
+
+Ptr<RPCCall> RPC1::sendCall(unsigned char callType, const char* uniqueID, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection)
+{
+	if (!pConnection)
+	{
+		return NULL;
+	}
+
+	// Registered before sending: the reply may arrive before Send() returns
+	Ptr<RPCCall> call;
+	{
+		Mutex::Locker locker(&callBlockingMutex);
+		call = acquireCall(pConnection);
+		pendingCalls.PushBack(call);
+	}
+
+	OVR::Net::BitStream out;
+	out.Write((MessageID) OVRID_RPC1);
+	out.Write((MessageID) callType);
+	out.Write(call->RequestId);
+	out.Write(uniqueID);
+	if (bitStream)
+	{
+		bitStream->ResetReadPointer();
+		out.AlignWriteToByteBoundary();
+		out.Write(bitStream);
+	}
+
+	SendParameters sp(pConnection, out.GetData(), out.GetNumberOfBytesUsed());
+	if (pSession->Send(&sp) != sp.Bytes)
+	{
+		completeCall(call->RequestId, false, NULL);
+		return NULL;
+	}
+
+	return call;
+}
+
+bool RPC1::waitForCall(RPCCall* call, OVR::Net::BitStream* returnData)
+{
+	Mutex::Locker locker(&callBlockingMutex);
+
+	while (!call->Complete)
+	{
+		callBlockingWait.Wait(&callBlockingMutex);
+	}
+
+	if (returnData)
+	{
+		returnData->Reset();
+		call->ReturnValue.ResetReadPointer();
+		returnData->Write(call->ReturnValue);
+		returnData->ResetReadPointer();
+	}
+
+	return call->Succeeded;
+}
+
+void RPC1::completeCall(uint32_t requestId, bool succeeded, OVR::Net::BitStream* returnData)
+{
+	Mutex::Locker locker(&callBlockingMutex);
+
+	for (int i = 0; i < pendingCalls.GetSizeI(); ++i)
+	{
+		if (pendingCalls[i]->RequestId == requestId)
+		{
+			RPCCall* call = pendingCalls[i];
+			call->ReturnValue.Reset();
+			if (returnData)
+			{
+				call->ReturnValue.Write(returnData);
+			}
+			call->Succeeded = succeeded;
+			call->Complete = true;
+			call->pConnection.Clear();
+			pendingCalls.RemoveAt(i);
+			callBlockingWait.NotifyAll();
+			return;
+		}
+	}
+}
+
+bool RPC1::runBlockingFunction(const RPCFunctionName& uniqueID, OVR::Net::BitStream* parameters, OVR::Net::BitStream* returnData, ReceivePayload* pPayload)
+{
+	RPCDelegate *bf = registeredBlockingFunctions.GetAlt(uniqueID);
+	if (bf == 0)
+	{
+		return false;
+	}
+
+	(*bf)(parameters, returnData, pPayload);
+	return true;
+}
+
+Ptr<RPCCall> RPC1::CallAsync( const char* uniqueID, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection )
+{
+	if (IsPipeliningSupported(pConnection))
+	{
+		return sendCall(CALL_ASYNC, uniqueID, bitStream, pConnection);
+	}
+
+	// Older remote: one call at a time
+	if (!pConnection)
+	{
+		return NULL;
+	}
+	Ptr<RPCCall> call = *new RPCCall(this, 0, pConnection);
+	call->Succeeded = CallBlocking(uniqueID, bitStream, pConnection, &call->ReturnValue);
+	call->Complete = true;
+	return call;
+}
+
+bool RPC1::CallBatch( RPCBatch* batch, Ptr<Connection> pConnection )
+{
+	batch->Results.Reset();
+	batch->ResultIndex.Clear();
+
+	if (IsPipeliningSupported(pConnection))
+	{
+		OVR::Net::BitStream parameters;
+		parameters.Write((int32_t) batch->Count);
+		batch->Requests.ResetReadPointer();
+		parameters.Write(batch->Requests);
+
+		Ptr<RPCCall> call = sendCall(CALL_BATCH, "", &parameters, pConnection);
+		if (!call || !call->Wait(&batch->Results))
+		{
+			return false;
+		}
+		return batch->parseResults();
+	}
+
+	// Older remote: same results, one round trip per call
+	batch->Results.Write((int32_t) batch->Count);
+	batch->Requests.ResetReadPointer();
+	for (int i = 0; i < batch->Count; ++i)
+	{
+		OVR::String uniqueID;
+		BitSize_t bits = 0;
+		OVR::Net::BitStream parameters, returnData;
+		batch->Requests.Read(uniqueID);
+		batch->Requests.Read(bits);
+		batch->Requests.Read(&parameters, bits);
+
+		bool succeeded = CallBlocking(uniqueID, &parameters, pConnection, &returnData);
+		batch->Results.Write((uint8_t) (succeeded ? 1 : 0));
+		batch->Results.Write((BitSize_t) returnData.GetNumberOfBitsUsed());
+		batch->Results.Write(returnData);
+	}
+	return batch->parseResults();
+}
+
+bool RPC1::Signal(const char* sharedIdentifier, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection)
 {
 	OVR::Net::BitStream out;
 	out.Write((MessageID) OVRID_RPC1);
@@ -154,7 +440,7 @@ bool RPC1::Signal(OVR::String sharedIdentifier, OVR::Net::BitStream* bitStream,
 	int32_t bytesSent = pSession->Send(&sp);
 	return bytesSent == sp.Bytes;
 }
-void RPC1::BroadcastSignal(OVR::String sharedIdentifier, OVR::Net::BitStream* bitStream)
+void RPC1::BroadcastSignal(const char* sharedIdentifier, OVR::Net::BitStream* bitStream)
 {
     OVR::Net::BitStream out;
     out.Write((MessageID) OVRID_RPC1);
@@ -200,10 +486,10 @@ void RPC1::OnReceive(ReceivePayload *pPayload, ListenerReceiveResult *lrrOut)
 		}
         else if (pPayload->pData[1] == CALL_BLOCKING)
         {
-			OVR::String uniqueId;
-			bsIn.Read(uniqueId);
+			RPCFunctionName uniqueId = { "", 0 };
+			bsIn.ReadInPlace(uniqueId.pName, uniqueId.Length);
 
-			RPCDelegate *bf = registeredBlockingFunctions.Get(uniqueId);
+			RPCDelegate *bf = registeredBlockingFunctions.GetAlt(uniqueId);
 			if (bf==0)
 			{
 				OVR::Net::BitStream bsOut;
@@ -230,6 +516,62 @@ void RPC1::OnReceive(ReceivePayload *pPayload, ListenerReceiveResult *lrrOut)
 			SendParameters sp(pPayload->pConnection, out.GetData(), out.GetNumberOfBytesUsed());
 			pSession->Send(&sp);
 		}
+        else if (pPayload->pData[1] == ID_RPC_ASYNC_RETURN || pPayload->pData[1] == ID_RPC_BATCH_RETURN)
+        {
+            uint32_t requestId = 0;
+            uint8_t succeeded = 0;
+            bsIn.Read(requestId);
+            bsIn.Read(succeeded);
+            bsIn.AlignReadToByteBoundary();
+
+            completeCall(requestId, succeeded != 0, &bsIn);
+        }
+        else if (pPayload->pData[1] == CALL_ASYNC || pPayload->pData[1] == CALL_BATCH)
+        {
+            uint32_t requestId = 0;
+            RPCFunctionName uniqueId = { "", 0 };
+            bsIn.Read(requestId);
+            bsIn.ReadInPlace(uniqueId.pName, uniqueId.Length);
+            bsIn.AlignReadToByteBoundary();
+
+            OVR::Net::BitStream returnData;
+            bool succeeded = true;
+            if (pPayload->pData[1] == CALL_ASYNC)
+            {
+                succeeded = runBlockingFunction(uniqueId, &bsIn, &returnData, pPayload);
+            }
+            else
+            {
+                int32_t count = 0;
+                bsIn.Read(count);
+                returnData.Write(count);
+                for (int i = 0; i < count; ++i)
+                {
+                    BitSize_t bits = 0;
+                    OVR::Net::BitStream parameters, callReturnData;
+                    bsIn.ReadInPlace(uniqueId.pName, uniqueId.Length);
+                    bsIn.Read(bits);
+                    bsIn.Read(&parameters, bits);
+
+                    bool callSucceeded = runBlockingFunction(uniqueId, &parameters, &callReturnData, pPayload);
+                    returnData.Write((uint8_t) (callSucceeded ? 1 : 0));
+                    returnData.Write((BitSize_t) callReturnData.GetNumberOfBitsUsed());
+                    returnData.Write(callReturnData);
+                }
+            }
+
+            OVR::Net::BitStream out;
+            out.Write((MessageID) OVRID_RPC1);
+            out.Write((MessageID) (pPayload->pData[1] == CALL_ASYNC ? ID_RPC_ASYNC_RETURN : ID_RPC_BATCH_RETURN));
+            out.Write(requestId);
+            out.Write((uint8_t) (succeeded ? 1 : 0));
+            returnData.ResetReadPointer();
+            out.AlignWriteToByteBoundary();
+            out.Write(returnData);
+
+            SendParameters sp(pPayload->pConnection, out.GetData(), out.GetNumberOfBytesUsed());
+            pSession->Send(&sp);
+        }
 		else if (pPayload->pData[1]==ID_RPC4_SIGNAL)
 		{
 			OVR::String sharedIdentifier;
@@ -259,6 +601,20 @@ void RPC1::OnDisconnected(Connection* conn)
         blockingOnThisConnection = 0;
         callBlockingWait.NotifyAll();
     }
+
+    // Fail the async calls that will never get their reply
+    Mutex::Locker locker(&callBlockingMutex);
+    for (int i = pendingCalls.GetSizeI() - 1; i >= 0; --i)
+    {
+        if (pendingCalls[i]->pConnection == conn)
+        {
+            pendingCalls[i]->Succeeded = false;
+            pendingCalls[i]->Complete = true;
+            pendingCalls[i]->pConnection.Clear();
+            pendingCalls.RemoveAt(i);
+        }
+    }
+    callBlockingWait.NotifyAll();
 }
 
 void RPC1::OnConnected(Connection* conn)
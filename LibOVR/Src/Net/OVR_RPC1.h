@@ -43,6 +43,85 @@ typedef Delegate3<void, BitStream*, BitStream*, ReceivePayload*> RPCDelegate;
 typedef Delegate2<void, BitStream*, ReceivePayload*> RPCSlot;
 // typedef void ( *Slot ) ( OVR::Net::BitStream *userData, OVR::Net::ReceivePayload *pPayload );
 
+class RPC1;
+
+/// Name of a blocking function read in place from a received call, to look it up without copying it to a String
+struct RPCFunctionName
+{
+	const char* pName;
+	uint16_t    Length;
+
+	struct HashFunctor
+	{
+		size_t operator()(const String& name) const          { return String::BernsteinHashFunction(name.ToCStr(), name.GetSize()); }
+		size_t operator()(const RPCFunctionName& name) const { return String::BernsteinHashFunction(name.pName, name.Length); }
+	};
+};
+
+inline bool operator==(const String& a, const RPCFunctionName& b)
+{
+	return a.GetSize() == b.Length && memcmp(a.ToCStr(), b.pName, b.Length) == 0;
+}
+
+/// Handle to a call started with RPC1::CallAsync(). The request id travels with the call and its reply,
+/// so any number of calls can be in flight on one connection.
+class RPCCall : public RefCountBase<RPCCall>
+{
+public:
+	RPCCall(RPC1* owner, uint32_t requestId, Connection* connection);
+
+	uint32_t GetRequestId() const { return RequestId; }
+
+	/// True once the reply arrived, or the connection was lost
+	bool IsComplete() const { return Complete; }
+
+	/// Blocks until IsComplete().
+	/// \param[out] returnData Written to by the function registered with RegisterBlockingFunction.
+	/// \return false on disconnect or if the function is not registered on the remote system
+	bool Wait(OVR::Net::BitStream* returnData = NULL);
+
+protected:
+	friend class RPC1;
+
+	RPC1*           pOwner;
+	uint32_t        RequestId;
+	Ptr<Connection> pConnection;
+	volatile bool   Complete;    // Written under RPC1::callBlockingMutex
+	bool            Succeeded;
+	BitStream       ReturnValue;
+};
+
+/// Several calls to blocking functions, sent in one packet and answered in one packet
+class RPCBatch
+{
+public:
+	RPCBatch() : Count(0) { }
+
+	void Add(const char* uniqueID, OVR::Net::BitStream* bitStream = NULL);
+	int  GetCount() const { return Count; }
+	void Clear();
+
+	/// Once RPC1::CallBatch() returned: the return data of the i-th call added.
+	/// \return false if that call did not run (not registered remotely, or the batch failed)
+	bool GetResult(int i, OVR::Net::BitStream* returnData);
+
+protected:
+	friend class RPC1;
+
+	struct Result
+	{
+		bool      Succeeded;
+		BitSize_t Offset, Bits;  // Location of the return data in Results
+	};
+
+	int           Count;
+	BitStream     Requests;      // For each call: uniqueID, bit count, parameters
+	BitStream     Results;       // Reply as received
+	Array< Result, ArrayConstPolicy<0, 16, true> > ResultIndex;  // Kept across Clear() for reuse
+
+	bool parseResults();
+};
+
 /// NetworkPlugin that maps strings to function pointers. Can invoke the functions using blocking calls with return values, or signal/slots. Networked parameters serialized with BitStream
 class RPC1 : public NetworkPlugin, public NewOverrideBase
 {
@@ -71,14 +150,27 @@ public:
 	/// \param[in] pConnection connection to send on
 	/// \param[out] returnData Written to by the function registered with RegisterBlockingFunction.
 	/// \return true if successfully called. False on disconnect, function not registered, or not connected to begin with
-	bool CallBlocking( OVR::String uniqueID, OVR::Net::BitStream * bitStream, Ptr<Connection> pConnection, OVR::Net::BitStream *returnData = NULL );
+	bool CallBlocking( const char* uniqueID, OVR::Net::BitStream * bitStream, Ptr<Connection> pConnection, OVR::Net::BitStream *returnData = NULL );
+
+	/// Same as CallBlocking(), but returns as soon as the call is sent. Calls from any thread can be in flight
+	/// together; wait for the reply with RPCCall::Wait().
+	/// \note If the remote system predates pipelining (see IsPipeliningSupported) this is CallBlocking() and the returned call is already complete
+	/// \return NULL if the call could not be sent
+	Ptr<RPCCall> CallAsync( const char* uniqueID, OVR::Net::BitStream * bitStream, Ptr<Connection> pConnection );
+
+	/// Runs every call of the batch on the remote system for a single round trip. Blocking.
+	/// \return false if the batch could not be sent or the connection was lost. Per-call results are in the batch.
+	bool CallBatch( RPCBatch * batch, Ptr<Connection> pConnection );
+
+	/// True if the remote RPC1 understands async and batched calls (advertised with RPCCapability_Pipelining in the handshake)
+	static bool IsPipeliningSupported( Connection* pConnection );
 
 	/// Calls zero or more functions identified by sharedIdentifier registered with RegisterSlot()
 	/// \param[in] sharedIdentifier parameter of the same name passed to RegisterSlot() on the remote system
 	/// \param[in] bitStream bitStream encoded data to send to the function callback
 	/// \param[in] pConnection connection to send on
-	bool Signal(OVR::String sharedIdentifier, OVR::Net::BitStream * bitStream, Ptr<Connection> pConnection);
-    void BroadcastSignal(OVR::String sharedIdentifier, OVR::Net::BitStream * bitStream);
+	bool Signal(const char* sharedIdentifier, OVR::Net::BitStream * bitStream, Ptr<Connection> pConnection);
+    void BroadcastSignal(const char* sharedIdentifier, OVR::Net::BitStream * bitStream);
 
 
 protected:
@@ -87,7 +179,7 @@ protected:
     virtual void OnDisconnected(Connection* conn);
     virtual void OnConnected(Connection* conn);
 
-	Hash< String, RPCDelegate, String::HashFunctor > registeredBlockingFunctions;
+	Hash< String, RPCDelegate, RPCFunctionName::HashFunctor > registeredBlockingFunctions;
 	ObserverHash< RPCSlot > slotHash;
 
     // Synchronization for RPC caller
@@ -97,6 +189,22 @@ protected:
 
     Net::BitStream* blockingReturnValue;
 	Ptr<Connection> blockingOnThisConnection;
+
+    // Async and batched calls waiting for their reply, guarded by callBlockingMutex
+    uint32_t              nextRequestId;
+    Array< Ptr<RPCCall>, ArrayConstPolicy<0, 16, true> > pendingCalls;
+
+    // Calls handed out by sendCall(), reused once nothing else references them. Guarded by callBlockingMutex
+    static const int CallPoolSize = 64;
+    Array< Ptr<RPCCall>, ArrayConstPolicy<0, 16, true> > callPool;
+    int                   callPoolNext;
+
+    friend class RPCCall;
+    Ptr<RPCCall> sendCall(unsigned char callType, const char* uniqueID, OVR::Net::BitStream* bitStream, Ptr<Connection> pConnection);
+    Ptr<RPCCall> acquireCall(Connection* pConnection);
+    bool         waitForCall(RPCCall* call, OVR::Net::BitStream* returnData);
+    void         completeCall(uint32_t requestId, bool succeeded, OVR::Net::BitStream* returnData);
+    bool         runBlockingFunction(const RPCFunctionName& uniqueID, OVR::Net::BitStream* parameters, OVR::Net::BitStream* returnData, ReceivePayload* pPayload);
 };
 
 
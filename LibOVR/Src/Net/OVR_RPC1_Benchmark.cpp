@@ -0,0 +1,340 @@
+/************************************************************************************
+
+Filename    :   OVR_RPC1_Benchmark.cpp
+Content     :   Loopback benchmark of the RPC1 call modes
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#include "OVR_RPC1_Benchmark.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_Alg.h"
+#include "../Kernel/OVR_Log.h"
+
+namespace OVR { namespace Net { namespace Plugins {
+
+
+//-----------------------------------------------------------------------------
+// AllocationCounter
+
+// Installed in place of the global allocator, forwards to it and counts the allocations
+// made by every thread. Memory allocated before Install() may be freed while installed.
+class AllocationCounter : public Allocator
+{
+public:
+    AllocationCounter() : pPrevious(NULL) { }
+
+    void Install()
+    {
+        Count = 0;
+        pPrevious = GetInstance();
+        setInstance(NULL);
+        setInstance(this);
+    }
+    void Uninstall()
+    {
+        setInstance(NULL);
+        setInstance(pPrevious);
+    }
+
+    int GetCount() const { return Count.Load_Acquire(); }
+
+    virtual void* Alloc(size_t size)                                  { Count.Increment_NoSync(); return pPrevious->Alloc(size); }
+    virtual void* AllocDebug(size_t size, const char* file, unsigned line) { Count.Increment_NoSync(); return pPrevious->AllocDebug(size, file, line); }
+    virtual void* Realloc(void* p, size_t newSize)                    { Count.Increment_NoSync(); return pPrevious->Realloc(p, newSize); }
+    virtual void  Free(void* p)                                       { pPrevious->Free(p); }
+    virtual void* AllocAligned(size_t size, size_t align)             { Count.Increment_NoSync(); return pPrevious->AllocAligned(size, align); }
+    virtual void  FreeAligned(void* p)                                { pPrevious->FreeAligned(p); }
+
+protected:
+    Allocator*     pPrevious;
+    AtomicInt<int> Count;
+};
+
+
+//-----------------------------------------------------------------------------
+// Benchmark
+
+// True if returnData holds what Echo_1 sends back for payload
+static bool isEcho(BitStream* returnData, double payload)
+{
+    double echoed = 0.;
+    return returnData->Read(echoed) && echoed == payload;
+}
+
+void ComputeRPC1BenchmarkResult(Array<double>& latencies, double totalSeconds, RPC1BenchmarkResult& result)
+{
+    result.Calls              = latencies.GetSizeI();
+    result.CallsPerSecond     = (totalSeconds > 0.) ? result.Calls / totalSeconds : 0.;
+    result.MeanLatencySeconds = 0.;
+    result.P99LatencySeconds  = 0.;
+    if (result.Calls == 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < result.Calls; ++i)
+    {
+        result.MeanLatencySeconds += latencies[i];
+    }
+    result.MeanLatencySeconds /= result.Calls;
+
+    Alg::QuickSort(latencies);
+    result.P99LatencySeconds = latencies[Alg::Min(result.Calls - 1, (result.Calls * 99) / 100)];
+}
+
+Ptr<Connection> ConnectLoopbackEndpoints(LoopbackEndpoint& server, LoopbackEndpoint& client, uint16_t port,
+                                         int connectionCount)
+{
+    BerkleyBindParameters bbp;
+    bbp.Address = "::1";
+    bbp.Port = port;
+    if (server.TheSession.ListenPTCP(&bbp) != SessionResult_OK)
+    {
+        LogError("[RPC1 Benchmark] Cannot listen on port %d", (int)port);
+        return NULL;
+    }
+    server.StartPolling();
+
+    // Polling first: a blocking connect waits for the handshake, which the poll thread does
+    client.StartPolling();
+
+    BerkleyBindParameters clientBbp;
+    clientBbp.Address = "::1";
+    clientBbp.blockingTimeout = 5000;
+    SockAddr serverAddress;
+    serverAddress.Set("::1", port, SOCK_STREAM);
+    for (int i = 0; i < connectionCount; ++i)
+    {
+        client.TheSession.ConnectPTCP(&clientBbp, &serverAddress, false);
+    }
+
+    // Wait for the version handshakes
+    double timeout = Timer::GetSeconds() + 5.;
+    while (client.TheSession.GetConnectionCount() < connectionCount && Timer::GetSeconds() < timeout)
+    {
+        Thread::MSleep(1);
+    }
+    Ptr<Connection> connection = client.TheSession.GetConnectionAtIndex(0);
+    if (!connection || client.TheSession.GetConnectionCount() < connectionCount)
+    {
+        LogError("[RPC1 Benchmark] Cannot connect %d times to the loopback server", connectionCount);
+        return NULL;
+    }
+
+    return connection;
+}
+
+bool RunRPC1LoopbackBenchmark(int callCount, int window, uint16_t port,
+                              RPC1BenchmarkResult results[RPC1Benchmark_Count])
+{
+    memset(results, 0, sizeof(RPC1BenchmarkResult) * RPC1Benchmark_Count);
+    window = Alg::Max(window, 1);
+
+    LoopbackEndpoint server(true), client(false);
+    server.Rpc.RegisterBlockingFunction("Echo_1", RPCDelegate::FromMember<LoopbackEndpoint, &LoopbackEndpoint::Echo_1>(&server));
+
+    Ptr<Connection> connection = ConnectLoopbackEndpoints(server, client, port);
+    if (!connection)
+    {
+        return false;
+    }
+
+    Array<double> latencies;
+    latencies.Reserve(callCount);
+    double payload = 1.;
+    int failures = 0;  // Calls that did not return the echoed payload, in any mode
+
+    // Counts the allocations of the RPC path only: the arrays of this function do not grow
+    AllocationCounter allocations;
+
+    // Sequential: each call waits for the previous reply
+    allocations.Install();
+    double start = Timer::GetSeconds();
+    for (int i = 0; i < callCount; ++i)
+    {
+        BitStream parameters, returnData;
+        parameters.Write(payload);
+        double callStart = Timer::GetSeconds();
+        bool succeeded = client.Rpc.CallBlocking("Echo_1", &parameters, connection, &returnData);
+        latencies.PushBack(Timer::GetSeconds() - callStart);
+        if (!succeeded || !isEcho(&returnData, payload))
+        {
+            ++failures;
+        }
+    }
+    ComputeRPC1BenchmarkResult(latencies, Timer::GetSeconds() - start, results[RPC1Benchmark_Sequential]);
+    allocations.Uninstall();
+    results[RPC1Benchmark_Sequential].AllocationsPerCall = (double)allocations.GetCount() / callCount;
+
+    // Pipelined: window calls sent before waiting for the first reply
+    latencies.Clear();
+    Array< Ptr<RPCCall>, ArrayConstPolicy<0, 4, true> > calls;
+    Array< double, ArrayConstPolicy<0, 4, true> > callStarts;
+    calls.Reserve(window);
+    callStarts.Reserve(window);
+    allocations.Install();
+    start = Timer::GetSeconds();
+    for (int i = 0; i < callCount; i += window)
+    {
+        int n = Alg::Min(window, callCount - i);
+        calls.Clear();
+        callStarts.Clear();
+        for (int j = 0; j < n; ++j)
+        {
+            BitStream parameters;
+            parameters.Write(payload);
+            callStarts.PushBack(Timer::GetSeconds());
+            calls.PushBack(client.Rpc.CallAsync("Echo_1", &parameters, connection));
+        }
+        for (int j = 0; j < n; ++j)
+        {
+            BitStream returnData;
+            if (!calls[j] || !calls[j]->Wait(&returnData) || !isEcho(&returnData, payload))
+            {
+                ++failures;
+            }
+            latencies.PushBack(Timer::GetSeconds() - callStarts[j]);
+        }
+    }
+    ComputeRPC1BenchmarkResult(latencies, Timer::GetSeconds() - start, results[RPC1Benchmark_Pipelined]);
+    allocations.Uninstall();
+    results[RPC1Benchmark_Pipelined].AllocationsPerCall = (double)allocations.GetCount() / callCount;
+
+    // Batched: window calls in one packet each way
+    latencies.Clear();
+    RPCBatch batch;
+    allocations.Install();
+    start = Timer::GetSeconds();
+    for (int i = 0; i < callCount; i += window)
+    {
+        int n = Alg::Min(window, callCount - i);
+        batch.Clear();
+        for (int j = 0; j < n; ++j)
+        {
+            BitStream parameters;
+            parameters.Write(payload);
+            batch.Add("Echo_1", &parameters);
+        }
+        double batchStart = Timer::GetSeconds();
+        bool succeeded = client.Rpc.CallBatch(&batch, connection);
+        double batchLatency = Timer::GetSeconds() - batchStart;
+        for (int j = 0; j < n; ++j)
+        {
+            BitStream returnData;
+            if (!succeeded || !batch.GetResult(j, &returnData) || !isEcho(&returnData, payload))
+            {
+                ++failures;
+            }
+            latencies.PushBack(batchLatency);
+        }
+    }
+    ComputeRPC1BenchmarkResult(latencies, Timer::GetSeconds() - start, results[RPC1Benchmark_Batched]);
+    allocations.Uninstall();
+    results[RPC1Benchmark_Batched].AllocationsPerCall = (double)allocations.GetCount() / callCount;
+
+    static const char* modeNames[RPC1Benchmark_Count] = { "Sequential", "Pipelined", "Batched" };
+    for (int m = 0; m < RPC1Benchmark_Count; ++m)
+    {
+        LogText("[RPC1 Benchmark] %-10s %8.0f calls/s, mean %.3f ms, p99 %.3f ms, %.2f allocations/call (%d calls, window %d)\n",
+                modeNames[m], results[m].CallsPerSecond, results[m].MeanLatencySeconds * 1000.,
+                results[m].P99LatencySeconds * 1000., results[m].AllocationsPerCall, results[m].Calls, window);
+    }
+
+    if (failures)
+    {
+        LogError("[RPC1 Benchmark] %d of %d calls did not return their parameters", failures, callCount * RPC1Benchmark_Count);
+        return false;
+    }
+    return true;
+}
+
+bool RunSessionLoopbackBenchmark(int callsPerConnection, uint16_t port,
+                                 RPC1BenchmarkResult results[SessionBenchmark_Count])
+{
+    memset(results, 0, sizeof(RPC1BenchmarkResult) * SessionBenchmark_Count);
+
+    static const int connectionCounts[SessionBenchmark_Count] = { 1, 16, 256 };
+    for (int c = 0; c < SessionBenchmark_Count; ++c)
+    {
+        const int connectionCount = connectionCounts[c];
+
+        LoopbackEndpoint server(true), client(false);
+        server.Rpc.RegisterBlockingFunction("Echo_1", RPCDelegate::FromMember<LoopbackEndpoint, &LoopbackEndpoint::Echo_1>(&server));
+
+        if (!ConnectLoopbackEndpoints(server, client, (uint16_t)(port + c), connectionCount))
+        {
+            return false;
+        }
+
+        Array< Ptr<Connection> > connections;
+        for (int i = 0; i < connectionCount; ++i)
+        {
+            connections.PushBack(client.TheSession.GetConnectionAtIndex(i));
+        }
+
+        Array<double> latencies;
+        latencies.Reserve(callsPerConnection * connectionCount);
+        Array< Ptr<RPCCall> > calls;
+        Array<double> callStarts;
+        double payload = 1.;
+        int failures = 0;
+
+        double start = Timer::GetSeconds();
+        for (int round = 0; round < callsPerConnection; ++round)
+        {
+            calls.Clear();
+            callStarts.Clear();
+            for (int i = 0; i < connectionCount; ++i)
+            {
+                BitStream parameters;
+                parameters.Write(payload);
+                callStarts.PushBack(Timer::GetSeconds());
+                calls.PushBack(client.Rpc.CallAsync("Echo_1", &parameters, connections[i]));
+            }
+            for (int i = 0; i < connectionCount; ++i)
+            {
+                BitStream returnData;
+                if (!calls[i] || !calls[i]->Wait(&returnData) || !isEcho(&returnData, payload))
+                {
+                    ++failures;
+                }
+                latencies.PushBack(Timer::GetSeconds() - callStarts[i]);
+            }
+        }
+        ComputeRPC1BenchmarkResult(latencies, Timer::GetSeconds() - start, results[c]);
+
+        LogText("[Session Benchmark] %3d connections %8.0f calls/s, mean %.3f ms, p99 %.3f ms (%d calls)\n",
+                connectionCount, results[c].CallsPerSecond, results[c].MeanLatencySeconds * 1000.,
+                results[c].P99LatencySeconds * 1000., results[c].Calls);
+
+        if (failures)
+        {
+            LogError("[Session Benchmark] %d of %d calls did not return their parameters", failures, results[c].Calls);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+}}} // OVR::Net::Plugins
@@ -0,0 +1,131 @@
+/************************************************************************************
+
+PublicHeader:   n/a
+Filename    :   OVR_RPC1_Benchmark.h
+Content     :   Loopback benchmark of the RPC1 call modes
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#ifndef OVR_Net_RPC1_Benchmark_h
+#define OVR_Net_RPC1_Benchmark_h
+
+#include "OVR_RPC1.h"
+#include "OVR_Session.h"
+#include "../Kernel/OVR_Threads.h"
+
+namespace OVR { namespace Net { namespace Plugins {
+
+
+enum RPC1BenchmarkMode
+{
+    RPC1Benchmark_Sequential,   // CallBlocking(), one call per round trip
+    RPC1Benchmark_Pipelined,    // CallAsync(), up to Window calls in flight
+    RPC1Benchmark_Batched,      // CallBatch(), Window calls per packet
+    RPC1Benchmark_Count
+};
+
+struct RPC1BenchmarkResult
+{
+    int    Calls;
+    double CallsPerSecond;
+    double MeanLatencySeconds;  // From the call to its reply
+    double P99LatencySeconds;
+    double AllocationsPerCall;  // Heap allocations of both endpoints, 0 when not measured
+};
+
+//-----------------------------------------------------------------------------
+// LoopbackEndpoint
+
+// A session with its RPC1 plugin, polled by the session's own I/O thread
+class LoopbackEndpoint
+{
+    OVR_NON_COPYABLE(LoopbackEndpoint);
+
+public:
+    LoopbackEndpoint(bool listening) :
+        Listening(listening)
+    {
+        TheSession.AddSessionListener(&Rpc);
+    }
+    ~LoopbackEndpoint()
+    {
+        TheSession.Shutdown();
+        TheSession.StopPollThread();
+        TheSession.RemoveSessionListener(&Rpc);
+    }
+
+    void StartPolling()
+    {
+        TheSession.StartPollThread(Listening);
+    }
+
+    void Echo_1(BitStream* userData, BitStream* returnData, ReceivePayload* pPayload)
+    {
+        OVR_UNUSED(pPayload);
+        returnData->Write(userData);
+    }
+
+    Session       TheSession;
+    RPC1          Rpc;
+
+protected:
+    bool          Listening;
+};
+
+
+// Starts server listening on localhost at port and connects client to it connectionCount times,
+// both polling. Returns the client's first connection once every version handshake is done, or NULL.
+Ptr<Connection> ConnectLoopbackEndpoints(LoopbackEndpoint& server, LoopbackEndpoint& client, uint16_t port,
+                                         int connectionCount = 1);
+
+
+//-----------------------------------------------------------------------------
+// Benchmark
+
+// Runs callCount small calls in each mode between two sessions of this process, over localhost
+// packetized TCP on the given port, and logs the results. Returns false if the sessions could not connect
+// or if any call did not echo its parameters back.
+bool RunRPC1LoopbackBenchmark(int callCount, int window, uint16_t port,
+                              RPC1BenchmarkResult results[RPC1Benchmark_Count]);
+
+enum SessionBenchmarkConnections
+{
+    SessionBenchmark_1,         // 1 connection
+    SessionBenchmark_16,        // 16 connections
+    SessionBenchmark_256,       // 256 connections
+    SessionBenchmark_Count
+};
+
+// One server and one client session with 1, 16 then 256 connections between them, on ports
+// port to port + 2. Each round sends one call on every connection before waiting for the
+// replies, for callsPerConnection rounds, so both sessions poll every connection at once.
+// Logs the results. Returns false if the sessions could not connect or if any call failed.
+bool RunSessionLoopbackBenchmark(int callsPerConnection, uint16_t port,
+                                 RPC1BenchmarkResult results[SessionBenchmark_Count]);
+
+// Fills result from the latency of each call; sorts latencies
+void ComputeRPC1BenchmarkResult(Array<double>& latencies, double totalSeconds, RPC1BenchmarkResult& result);
+
+
+}}} // OVR::Net::Plugins
+
+#endif // OVR_Net_RPC1_Benchmark_h
@@ -38,13 +38,14 @@ namespace OVR { namespace Net {
 static const char* OfficialHelloString = "OculusVR_Hello";
 static const char* OfficialAuthorizedString = "OculusVR_Authorized";
 
-void RPC_C2S_Hello::Generate(Net::BitStream* bs)
+void RPC_C2S_Hello::Generate(Net::BitStream* bs, uint32_t capabilities)
 {
     RPC_C2S_Hello hello;
     hello.HelloString = OfficialHelloString;
     hello.MajorVersion = RPCVersion_Major;
     hello.MinorVersion = RPCVersion_Minor;
     hello.PatchVersion = RPCVersion_Patch;
+    hello.Capabilities = capabilities;
     hello.Serialize(bs);
 }
 
@@ -55,7 +56,7 @@ bool RPC_C2S_Hello::Validate()
            HelloString.CompareNoCase(OfficialHelloString) == 0;
 }
 
-void RPC_S2C_Authorization::Generate(Net::BitStream* bs, String errorString)
+void RPC_S2C_Authorization::Generate(Net::BitStream* bs, String errorString, uint32_t capabilities)
 {
     RPC_S2C_Authorization auth;
     if (errorString.IsEmpty())
@@ -69,6 +70,7 @@ void RPC_S2C_Authorization::Generate(Net::BitStream* bs, String errorString)
     auth.MajorVersion = RPCVersion_Major;
     auth.MinorVersion = RPCVersion_Minor;
     auth.PatchVersion = RPCVersion_Patch;
+    auth.Capabilities = capabilities;
     auth.Serialize(bs);
 }
 
@@ -107,6 +109,63 @@ void Session::Shutdown()
             ptcp->pSocket->Close();
         }
     }
+
+#ifdef OVR_NET_EPOLL
+    // The closed handles left the epoll set on their own, so the reactor has to look for them
+    Reactor.Wake();
+#endif
+}
+
+bool Session::StartPollThread(bool listeners)
+{
+    if (PollThread)
+    {
+        return true;
+    }
+
+    PollThreadStop = false;
+    PollThreadListeners = listeners;
+    PollThread = *new Thread(&pollThreadFn, this);
+    if (!PollThread->Start())
+    {
+        PollThread.Clear();
+        return false;
+    }
+
+    return true;
+}
+
+void Session::StopPollThread()
+{
+    if (!PollThread)
+    {
+        return;
+    }
+
+    PollThreadStop = true;
+#ifdef OVR_NET_EPOLL
+    Reactor.Wake();
+#endif
+    PollThread->Join();
+    PollThread.Clear();
+}
+
+int Session::pollThreadFn(Thread* pthread, void* h)
+{
+    pthread->SetThreadName("Session");
+    Session* session = (Session*)h;
+
+    while (!session->PollThreadStop)
+    {
+        session->Poll(session->PollThreadListeners);
+
+        if (session->GetActiveSocketsCount() == 0)
+        {
+            Thread::MSleep(1);
+        }
+    }
+
+    return 0;
 }
 
 SessionResult Session::Listen(ListenerDescription* pListenerDescription)
@@ -123,6 +182,9 @@ SessionResult Session::Listen(ListenerDescription* pListenerDescription)
 
 		Lock::Locker locker(&SocketListenersLock);
         SocketListeners.PushBack(tcpSocket);
+#ifdef OVR_NET_EPOLL
+        Reactor.Add(tcpSocket);
+#endif
 	}
     else if (pListenerDescription->Transport == TransportType_Loopback)
 	{
@@ -174,6 +236,9 @@ SessionResult Session::Connect(ConnectParameters *cp)
             c->SetState(Client_Connecting);
 
             AllConnections.PushBack(c);
+#ifdef OVR_NET_EPOLL
+            Reactor.Add(c->pSocket);
+#endif
 
         }
 
@@ -341,6 +406,10 @@ void Session::Broadcast(BroadcastParameters *payload)
 // DO NOT CALL Poll() FROM MULTIPLE THREADS due to allBlockingTcpSockets being a member
 void Session::Poll(bool listeners)
 {
+#ifdef OVR_NET_EPOLL
+    OVR_UNUSED(listeners);
+    Reactor.Poll(this);
+#else
     allBlockingTcpSockets.Clear();
 
 	if (listeners)
@@ -408,6 +477,7 @@ void Session::Poll(bool listeners)
             }
         }
 	}
+#endif
 }
 
 void Session::AddSessionListener(SessionListener* se)
@@ -551,6 +621,7 @@ void Session::TCP_OnRecv(Socket* pSocket, uint8_t* pData, int bytesRead)
                 conn->RemoteMajorVersion = auth.MajorVersion;
                 conn->RemoteMinorVersion = auth.MinorVersion;
                 conn->RemotePatchVersion = auth.PatchVersion;
+                conn->RemoteCapabilities = auth.Capabilities;
 
                 // Mark as connected
                 conn->SetState(State_Connected);
@@ -590,10 +661,11 @@ void Session::TCP_OnRecv(Socket* pSocket, uint8_t* pData, int bytesRead)
                 conn->RemoteMajorVersion = hello.MajorVersion;
                 conn->RemoteMinorVersion = hello.MinorVersion;
                 conn->RemotePatchVersion = hello.PatchVersion;
+                conn->RemoteCapabilities = hello.Capabilities;
 
                 // Send auth response
                 BitStream bsOut;
-                RPC_S2C_Authorization::Generate(&bsOut);
+                RPC_S2C_Authorization::Generate(&bsOut, "", LocalCapabilities);
                 conn->pSocket->Send(bsOut.GetData(), bsOut.GetNumberOfBytesUsed());
 
                 // Mark as connected
@@ -618,6 +690,10 @@ void Session::TCP_OnRecv(Socket* pSocket, uint8_t* pData, int bytesRead)
 
 void Session::TCP_OnClosed(TCPSocket* s)
 {
+#ifdef OVR_NET_EPOLL
+    Reactor.Remove(s);
+#endif
+
 	Lock::Locker locker(&ConnectionsLock);
 
     // If found in the full connection list,
@@ -682,6 +758,9 @@ void Session::TCP_OnAccept(TCPSocket* pListener, SockAddr* pSockAddr, SocketHand
             Lock::Locker locker(&ConnectionsLock);
             AllConnections.PushBack(c);
         }
+#ifdef OVR_NET_EPOLL
+        Reactor.Add(newSocket);
+#endif
 
         // Server does not send the first packet.  It waits for the client to send its version
 	}
@@ -699,7 +778,7 @@ void Session::TCP_OnConnected(TCPSocket *s)
 
         // Send hello message
         BitStream bsOut;
-        RPC_C2S_Hello::Generate(&bsOut);
+        RPC_C2S_Hello::Generate(&bsOut, LocalCapabilities);
         conn->pSocket->Send(bsOut.GetData(), bsOut.GetNumberOfBytesUsed());
 
         // Just update state but do not generate any notifications yet
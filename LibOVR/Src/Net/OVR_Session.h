@@ -47,19 +47,34 @@ class Session;
 // 1.0.0 - [SDK 0.4.0] Initial version (July 21, 2014)
 // 1.1.0 - Add Get/SetDriverMode_1, HMDCountUpdate_1
 //         Version mismatch results (July 28, 2014)
+//
+// Optional features are advertised in the Capabilities field appended to the
+// hello and authorization messages instead of bumping the minor version, which
+// shipped services check against their own (MinorVersion <= RPCVersion_Minor).
+// Older peers ignore the trailing field and read as having no capabilities.
 //-----------------------------------------------------------------------------
 
 static const uint16_t RPCVersion_Major = 1; // MAJOR version when you make incompatible API changes,
 static const uint16_t RPCVersion_Minor = 2; // MINOR version when you add functionality in a backwards-compatible manner, and
 static const uint16_t RPCVersion_Patch = 0; // PATCH version when you make backwards-compatible bug fixes.
 
+enum RPCCapabilityFlags
+{
+    RPCCapability_Pipelining      = 0x00000001, // RPC1 async (request id tagged) and batched calls
+    RPCCapability_PropertyChanged = 0x00000002, // Service pushes PropertyChanged_1 whenever a persistent value changes
+};
+
+// Advertised by every session; a session can add more with Session::SetLocalCapabilities()
+static const uint32_t RPCCapabilities_Local = RPCCapability_Pipelining;
+
 // Client starts communication by sending its version number.
 struct RPC_C2S_Hello
 {
     RPC_C2S_Hello() :
         MajorVersion(0),
         MinorVersion(0),
-        PatchVersion(0)
+        PatchVersion(0),
+        Capabilities(0)
     {
     }
 
@@ -68,12 +83,16 @@ struct RPC_C2S_Hello
     // Client version info
     uint16_t MajorVersion, MinorVersion, PatchVersion;
 
+    // RPCCapabilityFlags, 0 when sent by a peer that predates the field
+    uint32_t Capabilities;
+
     void Serialize(Net::BitStream* bs)
     {
         bs->Write(HelloString);
         bs->Write(MajorVersion);
         bs->Write(MinorVersion);
         bs->Write(PatchVersion);
+        bs->Write(Capabilities);
     }
 
     bool Deserialize(Net::BitStream* bs)
@@ -81,10 +100,16 @@ struct RPC_C2S_Hello
         bs->Read(HelloString);
         bs->Read(MajorVersion);
         bs->Read(MinorVersion);
-        return bs->Read(PatchVersion);
+        if (!bs->Read(PatchVersion))
+            return false;
+
+        // Optional trailing field
+        if (!bs->Read(Capabilities))
+            Capabilities = 0;
+        return true;
     }
 
-    static void Generate(Net::BitStream* bs);
+    static void Generate(Net::BitStream* bs, uint32_t capabilities = RPCCapabilities_Local);
 
     bool Validate();
 };
@@ -95,7 +120,8 @@ struct RPC_S2C_Authorization
     RPC_S2C_Authorization() :
         MajorVersion(0),
         MinorVersion(0),
-        PatchVersion(0)
+        PatchVersion(0),
+        Capabilities(0)
     {
     }
 
@@ -104,12 +130,16 @@ struct RPC_S2C_Authorization
     // Server version info
     uint16_t MajorVersion, MinorVersion, PatchVersion;
 
+    // RPCCapabilityFlags, 0 when sent by a peer that predates the field
+    uint32_t Capabilities;
+
     void Serialize(Net::BitStream* bs)
     {
         bs->Write(AuthString);
         bs->Write(MajorVersion);
         bs->Write(MinorVersion);
         bs->Write(PatchVersion);
+        bs->Write(Capabilities);
     }
 
     bool Deserialize(Net::BitStream* bs)
@@ -117,10 +147,16 @@ struct RPC_S2C_Authorization
         bs->Read(AuthString);
         bs->Read(MajorVersion);
         bs->Read(MinorVersion);
-        return bs->Read(PatchVersion);
+        if (!bs->Read(PatchVersion))
+            return false;
+
+        // Optional trailing field
+        if (!bs->Read(Capabilities))
+            Capabilities = 0;
+        return true;
     }
 
-    static void Generate(Net::BitStream* bs, String errorString = "");
+    static void Generate(Net::BitStream* bs, String errorString = "", uint32_t capabilities = RPCCapabilities_Local);
 
     bool Validate();
 };
@@ -166,7 +202,8 @@ public:
         State(State_Zombie),
         RemoteMajorVersion(0),
         RemoteMinorVersion(0),
-        RemotePatchVersion(0)
+        RemotePatchVersion(0),
+        RemoteCapabilities(0)
     {
     }
 	virtual ~Connection() // Allow delete from base
@@ -183,6 +220,7 @@ public:
     int              RemoteMajorVersion;
     int              RemoteMinorVersion;
     int              RemotePatchVersion;
+    uint32_t         RemoteCapabilities; // RPCCapabilityFlags
 };
 
 
@@ -450,11 +488,16 @@ class Session : public SocketEvent_TCP, public NewOverrideBase
 
 public:
     Session() :
-        HasLoopbackListener(false)
+        LocalCapabilities(RPCCapabilities_Local),
+        HasLoopbackListener(false),
+        PollThreadStop(false),
+        PollThreadListeners(true)
     {
     }
     virtual ~Session()
     {
+        StopPollThread();
+
         // Ensure memory backing the sockets array is released
 		allBlockingTcpSockets.ClearAndRelease();
     }
@@ -464,6 +507,8 @@ public:
 	virtual int           Send(SendParameters* payload);
     virtual void          Broadcast(BroadcastParameters* payload);
     // DO NOT CALL Poll() FROM MULTIPLE THREADS due to allBlockingTcpSockets being a member
+    // With OVR_NET_EPOLL the sockets stay registered in Reactor instead, and listening
+    // sockets are polled whatever the listeners argument (only servers have any).
     virtual void          Poll(bool listeners = true);
 	virtual void          AddSessionListener(SessionListener* se);
 	virtual void          RemoveSessionListener(SessionListener* se);
@@ -476,6 +521,15 @@ public:
     // Closes all the sockets; useful for interrupting the socket polling during shutdown
     void            Shutdown();
 
+    // Calls Poll() on a dedicated network I/O thread until StopPollThread() or destruction.
+    // The session must then not be polled by any other thread.
+    bool            StartPollThread(bool listeners = true);
+    void            StopPollThread();
+
+    // RPCCapabilityFlags advertised to the peers in the handshake. Set before listening or connecting.
+    void            SetLocalCapabilities(uint32_t capabilities) { LocalCapabilities = capabilities; }
+    uint32_t        GetLocalCapabilities() const                { return LocalCapabilities; }
+
     // Get count of successful connections (past handshake point)
     int             GetConnectionCount() const
     {
@@ -487,12 +541,22 @@ protected:
 	virtual Ptr<Connection> AllocConnection(TransportType transportType);
 
     Lock SocketListenersLock, ConnectionsLock, SessionListenersLock;
+    uint32_t                  LocalCapabilities;   // RPCCapabilityFlags sent in the handshake
     bool                      HasLoopbackListener; // Has loopback listener installed?
 	Array< Ptr<TCPSocket> >   SocketListeners;     // List of active sockets
     Array< Ptr<Connection> >  AllConnections;      // List of active connections stuck at the versioning handshake
     Array< Ptr<Connection> >  FullConnections;     // List of active connections past the versioning handshake
     Array< SessionListener* > SessionListeners;    // List of session listeners
     Array< Ptr< Net::TCPSocket >, ArrayNoShrinkPolicy > allBlockingTcpSockets; // Preallocated blocking sockets array
+#ifdef OVR_NET_EPOLL
+    TCPSocketReactor          Reactor;             // Every listening and connection socket, registered once
+#endif
+
+    // Network I/O thread
+    Ptr<Thread>               PollThread;
+    volatile bool             PollThreadStop;
+    bool                      PollThreadListeners;
+    static int                pollThreadFn(Thread* pthread, void* h);
 
     // Tools
     Ptr<PacketizedTCPConnection> findConnectionBySocket(Array< Ptr<Connection> >& connectionArray, Socket* s, int *connectionIndex = NULL); // Call with ConnectionsLock held
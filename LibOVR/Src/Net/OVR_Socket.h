@@ -227,6 +227,14 @@ public:
 	virtual int          Connect(SockAddr* pSockAddr) = 0;
 	virtual int          Send(const void* pData,
                               int bytes) = 0;
+
+	// Sends the buffers in order as one stream, with as few system calls as possible.
+	// Returns the total number of bytes sent, or -1 on error.
+	virtual int          SendBuffers(const void** pDataArray,
+                                     const int* dataLengthArray,
+                                     int arrayCount) = 0;
+
+	static const int MaxSendBuffers = 16; // Buffers per system call
 protected:
 	virtual void         OnRecv(SocketEvent_TCP* eventHandler,
                                 uint8_t* pData,
@@ -0,0 +1,956 @@
+/************************************************************************************
+
+Filename    :   OVR_Unix_Socket.cpp
+Content     :   Berkley sockets networking implementation for Unix platforms
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#include "OVR_Unix_Socket.h"
+#include "../Kernel/OVR_Std.h"
+#include "../Kernel/OVR_Allocator.h"
+#include "../Kernel/OVR_Threads.h" // Thread::MSleep
+#include "../Kernel/OVR_Log.h"
+#include "../Kernel/OVR_Alg.h"
+
+#ifdef OVR_NET_EPOLL
+#include <sys/eventfd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SO_NOSIGPIPE is set instead
+#endif
+
+namespace OVR { namespace Net {
+
+
+//-----------------------------------------------------------------------------
+// BerkleySocket
+
+void BerkleySocket::Close()
+{
+	if (TheSocket != INVALID_SOCKET)
+	{
+		close(TheSocket);
+		TheSocket = INVALID_SOCKET;
+	}
+}
+
+int32_t BerkleySocket::GetSockname(SockAddr *pSockAddrOut)
+{
+	struct sockaddr_in6 sa;
+	memset(&sa,0,sizeof(sa));
+	socklen_t size = sizeof(sa);
+	int32_t i = getsockname(TheSocket, (sockaddr*) &sa, &size);
+	if (i>=0)
+	{
+		pSockAddrOut->Set(&sa);
+	}
+	return i;
+}
+
+
+//-----------------------------------------------------------------------------
+// BitStream overloads for SockAddr
+
+BitStream& operator<<(BitStream& out, SockAddr& in)
+{
+	out.WriteBits((const unsigned char*) &in.Addr6, sizeof(in.Addr6)*8, true);
+	return out;
+}
+
+BitStream& operator>>(BitStream& in, SockAddr& out)
+{
+	bool success = in.ReadBits((unsigned char*) &out.Addr6, sizeof(out.Addr6)*8, true);
+	OVR_ASSERT(success);
+	OVR_UNUSED(success);
+	return in;
+}
+
+
+//-----------------------------------------------------------------------------
+// SockAddr
+
+SockAddr::SockAddr()
+{
+    // Zero out the address to squelch static analysis tools
+    memset(&Addr6, 0, sizeof(Addr6));
+}
+
+SockAddr::SockAddr(SockAddr* address)
+{
+	Set(&address->Addr6);
+}
+
+SockAddr::SockAddr(sockaddr_storage* storage)
+{
+	Set(storage);
+}
+
+SockAddr::SockAddr(sockaddr_in6* address)
+{
+	Set(address);
+}
+
+SockAddr::SockAddr(const char* hostAddress, uint16_t port, int sockType)
+{
+	Set(hostAddress, port, sockType);
+}
+
+void SockAddr::Set(const sockaddr_storage* storage)
+{
+	memcpy(&Addr6, storage, sizeof(Addr6));
+}
+
+void SockAddr::Set(const sockaddr_in6* address)
+{
+	memcpy(&Addr6, address, sizeof(Addr6));
+}
+
+void SockAddr::Set(const char* hostAddress, uint16_t port, int sockType)
+{
+	memset(&Addr6, 0, sizeof(Addr6));
+
+	struct addrinfo hints;
+
+	// make sure the struct is empty
+	memset(&hints, 0, sizeof (addrinfo));
+
+	hints.ai_socktype = sockType; // SOCK_DGRAM or SOCK_STREAM
+	hints.ai_flags = AI_PASSIVE;     // fill in my IP for me
+	hints.ai_family = AF_UNSPEC ;
+	hints.ai_protocol = (sockType == SOCK_DGRAM) ? IPPROTO_UDP : IPPROTO_TCP;
+
+    struct addrinfo* servinfo = NULL;  // will point to the results
+
+	char portStr[32];
+	OVR_itoa(port, portStr, sizeof(portStr), 10);
+	int errcode = getaddrinfo(hostAddress, portStr, &hints, &servinfo);
+
+    if (0 != errcode)
+    {
+        OVR::LogError("{ERR-008u} getaddrinfo error: %s", gai_strerror(errcode));
+    }
+
+    OVR_ASSERT(servinfo);
+
+    if (servinfo)
+    {
+        memcpy(&Addr6, servinfo->ai_addr, Alg::Min(sizeof(Addr6), (size_t)servinfo->ai_addrlen));
+
+        freeaddrinfo(servinfo);
+    }
+}
+
+uint16_t SockAddr::GetPort()
+{
+	return htons(Addr6.sin6_port);
+}
+
+String SockAddr::ToString(bool writePort, char portDelineator) const
+{
+    char dest[INET6_ADDRSTRLEN + 1];
+
+	int ret = getnameinfo((struct sockaddr*)&Addr6,
+						  sizeof(struct sockaddr_in6),
+						  dest,
+						  INET6_ADDRSTRLEN,
+						  NULL,
+						  0,
+						  NI_NUMERICHOST);
+	if (ret != 0)
+	{
+		dest[0] = '\0';
+	}
+
+	if (writePort)
+	{
+		unsigned char ch[2];
+		ch[0]=portDelineator;
+		ch[1]=0;
+		OVR_strcat(dest, 16, (const char*) ch);
+		OVR_itoa(ntohs(Addr6.sin6_port), dest+strlen(dest), 16, 10);
+	}
+
+    return String(dest);
+}
+bool SockAddr::IsLocalhost() const
+{
+    static const unsigned char localhost_bytes[] =
+    { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    return memcmp(Addr6.sin6_addr.s6_addr, localhost_bytes, 16) == 0;
+}
+bool SockAddr::operator==( const SockAddr& right ) const
+{
+	return memcmp(&Addr6, &right.Addr6, sizeof(Addr6)) == 0;
+}
+
+bool SockAddr::operator!=( const SockAddr& right ) const
+{
+	return !(*this == right);
+}
+
+bool SockAddr::operator>( const SockAddr& right ) const
+{
+	return memcmp(&Addr6, &right.Addr6, sizeof(Addr6)) > 0;
+}
+
+bool SockAddr::operator<( const SockAddr& right ) const
+{
+	return memcmp(&Addr6, &right.Addr6, sizeof(Addr6)) < 0;
+}
+
+static bool SetSocketOptions(SocketHandle sock, bool stream)
+{
+    int result = 0;
+	int sock_opt;
+
+	// This doubles the max throughput rate
+    sock_opt = 1024 * 256;
+    result |= setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)& sock_opt, sizeof (sock_opt));
+
+	// Immediate hard close. Don't linger the socket.
+    struct linger linger_opt;
+    linger_opt.l_onoff = 0;
+    linger_opt.l_linger = 0;
+    result |= setsockopt(sock, SOL_SOCKET, SO_LINGER, (char *)& linger_opt, sizeof (linger_opt));
+
+	// This doesn't make much difference: 10% maybe
+    sock_opt = 1024 * 16;
+    result |= setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (char *)& sock_opt, sizeof (sock_opt));
+
+#ifdef SO_NOSIGPIPE
+    // A peer that went away is reported by send(), not by a signal
+    sock_opt = 1;
+    result |= setsockopt(sock, SOL_SOCKET, SO_NOSIGPIPE, (char *)& sock_opt, sizeof (sock_opt));
+#endif
+
+    if (stream)
+    {
+        // Packetized TCP sends the length and the payload separately: without this,
+        // Nagle holds the payload back until the peer's delayed ACK, 40 ms on Linux
+        sock_opt = 1;
+        result |= setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char *)& sock_opt, sizeof (sock_opt));
+    }
+
+    // If all the setsockopt() returned 0 there were no failures, so return true for success, else false
+    return result == 0;
+}
+
+// The default blocking timeout is 0x7fffffff ms, which does not fit in an int once split and summed again
+static int getTimeoutMs(long seconds, long usec)
+{
+    int64_t ms = (int64_t)seconds * 1000 + usec / 1000;
+    return (int)Alg::Min(ms, (int64_t)0x7fffffff);
+}
+
+static void SetNonBlocking(SocketHandle sock)
+{
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+}
+
+static SocketHandle BindShared(int ai_family, int ai_socktype, BerkleyBindParameters* pBindParameters)
+{
+	SocketHandle sock;
+
+	struct addrinfo hints;
+	memset(&hints, 0, sizeof (addrinfo)); // make sure the struct is empty
+	hints.ai_family = ai_family;
+	hints.ai_socktype = ai_socktype;
+	hints.ai_flags = AI_PASSIVE;     // fill in my IP for me
+	struct addrinfo *servinfo=0, *aip;  // will point to the results
+	char portStr[32];
+	OVR_itoa(pBindParameters->Port, portStr, sizeof(portStr), 10);
+
+    int errcode = 0;
+	if (!pBindParameters->Address.IsEmpty())
+		errcode = getaddrinfo(pBindParameters->Address.ToCStr(), portStr, &hints, &servinfo);
+	else
+		errcode = getaddrinfo(0, portStr, &hints, &servinfo);
+
+    if (0 != errcode)
+    {
+        OVR::LogError("{ERR-020u} getaddrinfo error: %s", gai_strerror(errcode));
+    }
+
+	for (aip = servinfo; aip != NULL; aip = aip->ai_next)
+	{
+		// Open socket. The address type depends on what
+		// getaddrinfo() gave us.
+		sock = socket(aip->ai_family, aip->ai_socktype, aip->ai_protocol);
+        if (sock != INVALID_SOCKET)
+		{
+            // Restarting the service must not wait for the TIME_WAIT of the previous listener
+            int reuse = 1;
+            setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, (char *)& reuse, sizeof (reuse));
+
+            if (bind(sock, aip->ai_addr, (socklen_t)aip->ai_addrlen) != SOCKET_ERROR)
+			{
+				// The actual socket is always non-blocking
+				// Blocking is done by the poll on the socket set
+				SetNonBlocking(sock);
+                freeaddrinfo(servinfo);
+				return sock;
+			}
+
+            close(sock);
+        }
+	}
+
+    if (servinfo) { freeaddrinfo(servinfo); }
+	return INVALID_SOCKET;
+}
+
+
+//-----------------------------------------------------------------------------
+// UDPSocket
+
+UDPSocket::UDPSocket()
+{
+	RecvBuf = new uint8_t[RecvBufSize];
+}
+
+UDPSocket::~UDPSocket()
+{
+	delete[] RecvBuf;
+}
+
+SocketHandle UDPSocket::Bind(BerkleyBindParameters *pBindParameters)
+{
+	SocketHandle s = BindShared(AF_INET6, SOCK_DGRAM, pBindParameters);
+	if (s == INVALID_SOCKET)
+		return s;
+
+	Close();
+	TheSocket = s;
+	SetSocketOptions(TheSocket, false);
+
+	return TheSocket;
+}
+
+void UDPSocket::OnRecv(SocketEvent_UDP* eventHandler, uint8_t* pData, int bytesRead, SockAddr* address)
+{
+	eventHandler->UDP_OnRecv(this, pData, bytesRead, address);
+}
+
+int UDPSocket::Send(const void* pData, int bytes, SockAddr* address)
+{
+	return (int)sendto(TheSocket, (const char*)pData, bytes, MSG_NOSIGNAL, (const sockaddr*)&address->Addr6, sizeof(address->Addr6));
+}
+
+void UDPSocket::Poll(SocketEvent_UDP *eventHandler)
+{
+	struct sockaddr_storage addr;
+	socklen_t fromlen;
+	int bytesRead;
+
+    // FIXME: Implement blocking poll wait for UDP
+
+	// While some bytes are read,
+	while (fromlen = sizeof(addr), // Must set fromlen each time
+		   bytesRead = (int)recvfrom(TheSocket, (char*)RecvBuf, RecvBufSize, 0, (sockaddr*)&addr, &fromlen),
+		   bytesRead > 0)
+	{
+		SockAddr address(&addr); // Wrap address
+
+		OnRecv(eventHandler, RecvBuf, bytesRead, &address);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// TCPSocket
+
+TCPSocket::TCPSocket()
+{
+	IsConnecting = false;
+	IsRegistered = false;
+	IsListenSocket = false;
+}
+TCPSocket::TCPSocket(SocketHandle boundHandle, bool isListenSocket)
+{
+	TheSocket = boundHandle;
+	IsListenSocket = isListenSocket;
+	IsConnecting = false;
+	IsRegistered = false;
+	SetSocketOptions(TheSocket, true);
+
+	// The actual socket is always non-blocking
+	SetNonBlocking(TheSocket);
+}
+
+TCPSocket::~TCPSocket()
+{
+}
+
+void TCPSocket::OnRecv(SocketEvent_TCP* eventHandler, uint8_t* pData, int bytesRead)
+{
+	eventHandler->TCP_OnRecv(this, pData, bytesRead);
+}
+
+SocketHandle TCPSocket::Bind(BerkleyBindParameters* pBindParameters)
+{
+	SocketHandle s = BindShared(AF_INET6, SOCK_STREAM, pBindParameters);
+	if (s == INVALID_SOCKET)
+		return s;
+
+	Close();
+
+    SetBlockingTimeout(pBindParameters->blockingTimeout);
+    TheSocket = s;
+
+    SetSocketOptions(TheSocket, true);
+
+	return TheSocket;
+}
+
+int TCPSocket::Listen()
+{
+    if (IsListenSocket)
+    {
+        return 0;
+    }
+
+	int i = listen(TheSocket, SOMAXCONN);
+	if (i >= 0)
+	{
+		IsListenSocket = true;
+	}
+
+	return i;
+}
+
+int TCPSocket::Connect(SockAddr* address)
+{
+	int retval;
+
+	retval = connect(TheSocket, (struct sockaddr *) &address->Addr6, sizeof(address->Addr6));
+	if (retval < 0)
+	{
+		if (errno == EINPROGRESS)
+		{
+            IsConnecting = true;
+            return 0;
+		}
+
+		LogError("{ERR-021u} [Socket] Connect failed: %s", strerror(errno));
+	}
+    else
+    {
+        // Connected at once, which happens on localhost: the socket is writable already,
+        // so the poll reports the connection like for an asynchronous one
+        IsConnecting = true;
+    }
+
+	return retval;
+}
+
+int TCPSocket::Send(const void* pData, int bytes)
+{
+    return SendBuffers(&pData, &bytes, 1);
+}
+
+int TCPSocket::SendBuffers(const void** pDataArray, const int* dataLengthArray, int arrayCount)
+{
+    // The socket is non-blocking, but Packetized TCP framing needs every byte to go out
+    // in order, so wait for room in the send buffer rather than dropping the rest
+    iovec iov[MaxSendBuffers];
+    int sent = 0;
+    for (int first = 0; first < arrayCount; first += MaxSendBuffers)
+    {
+        int count = 0, remaining = 0;
+        for (int i = first; i < arrayCount && count < MaxSendBuffers; ++i)
+        {
+            if (dataLengthArray[i] > 0)
+            {
+                iov[count].iov_base = (void*)pDataArray[i];
+                iov[count].iov_len  = dataLengthArray[i];
+                remaining += dataLengthArray[i];
+                ++count;
+            }
+        }
+
+        iovec* pending = iov;
+        while (remaining > 0)
+        {
+            msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov    = pending;
+            msg.msg_iovlen = count - (int)(pending - iov);
+
+            int result = (int)sendmsg(TheSocket, &msg, MSG_NOSIGNAL);
+            if (result > 0)
+            {
+                sent += result;
+                remaining -= result;
+
+                // Skip the buffers sent, and the start of the one sent partially
+                while (remaining > 0 && (size_t)result >= pending->iov_len)
+                {
+                    result -= (int)pending->iov_len;
+                    ++pending;
+                }
+                if (remaining > 0)
+                {
+                    pending->iov_base = (char*)pending->iov_base + result;
+                    pending->iov_len -= result;
+                }
+            }
+            else if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                pollfd pfd;
+                pfd.fd = TheSocket;
+                pfd.events = POLLOUT;
+                pfd.revents = 0;
+                if (poll(&pfd, 1, getTimeoutMs(GetBlockingTimeoutSec(), GetBlockingTimeoutUsec())) <= 0)
+                {
+                    return sent > 0 ? sent : -1;
+                }
+            }
+            else if (result < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else
+            {
+                return sent > 0 ? sent : -1;
+            }
+        }
+    }
+
+    return sent;
+}
+
+
+//// TCPSocketPollState
+
+TCPSocketPollState::TCPSocketPollState()
+{
+}
+
+bool TCPSocketPollState::IsValid() const
+{
+    return PollFDs.GetSizeI() > 0;
+}
+
+void TCPSocketPollState::Add(TCPSocket* tcpSocket)
+{
+    if (!tcpSocket)
+    {
+        return;
+    }
+
+    pollfd pfd;
+    pfd.fd = tcpSocket->GetSocketHandle();
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+
+    if (tcpSocket->IsConnecting)
+    {
+        pfd.events |= POLLOUT;
+    }
+
+    PollFDs.PushBack(pfd);
+}
+
+bool TCPSocketPollState::Poll(long usec, long seconds)
+{
+    int timeoutMs = getTimeoutMs(seconds, usec);
+
+    return poll(PollFDs.GetDataPtr(), (nfds_t)PollFDs.GetSize(), timeoutMs) > 0;
+}
+
+void TCPSocketPollState::HandleEvent(TCPSocket* tcpSocket, SocketEvent_TCP* eventHandler)
+{
+    if (!tcpSocket || !eventHandler)
+    {
+        return;
+    }
+
+    SocketHandle handle = tcpSocket->GetSocketHandle();
+
+    // Sockets are added in the same order as they are handled, but look them up to be safe
+    const pollfd* pfd = NULL;
+    const int count = PollFDs.GetSizeI();
+    for (int i = 0; i < count; ++i)
+    {
+        if (PollFDs[i].fd == handle)
+        {
+            pfd = &PollFDs[i];
+            break;
+        }
+    }
+    if (!pfd)
+    {
+        return;
+    }
+
+    if (tcpSocket->IsConnecting && (pfd->revents & POLLOUT))
+    {
+        tcpSocket->IsConnecting = false;
+        eventHandler->TCP_OnConnected(tcpSocket);
+    }
+
+    if (pfd->revents & POLLIN)
+    {
+        if (!tcpSocket->IsListenSocket)
+        {
+            static const int BUFF_SIZE = 8096;
+            char data[BUFF_SIZE];
+
+            int bytesRead = (int)recv(handle, data, BUFF_SIZE, 0);
+            if (bytesRead > 0)
+            {
+                tcpSocket->OnRecv(eventHandler, (uint8_t*)data, bytesRead);
+            }
+            else if (bytesRead == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) // Disconnection event:
+            {
+                tcpSocket->IsConnecting = false;
+                eventHandler->TCP_OnClosed(tcpSocket);
+                return;
+            }
+        }
+        else
+        {
+            struct sockaddr_storage sockAddr;
+            socklen_t sockAddrSize = sizeof(sockAddr);
+
+            SocketHandle newSock = accept(handle, (sockaddr*)&sockAddr, &sockAddrSize);
+            if (newSock != INVALID_SOCKET)
+            {
+                SockAddr sa(&sockAddr);
+                eventHandler->TCP_OnAccept(tcpSocket, &sa, newSock);
+            }
+        }
+    }
+
+    if (pfd->revents & (POLLERR | POLLHUP | POLLNVAL))
+    {
+        tcpSocket->IsConnecting = false;
+        eventHandler->TCP_OnClosed(tcpSocket);
+    }
+}
+
+
+#ifdef OVR_NET_EPOLL
+
+//-----------------------------------------------------------------------------
+// TCPSocketReactor
+
+TCPSocketReactor::TCPSocketReactor() :
+    EpollHandle(-1),
+    WakeHandle(-1),
+    CheckClosed(0),
+    RecvBuf(NULL)
+{
+    EpollHandle = epoll_create1(EPOLL_CLOEXEC);
+    WakeHandle = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (EpollHandle < 0 || WakeHandle < 0)
+    {
+        LogError("{ERR-022u} [Socket] Unable to create the epoll set: %s", strerror(errno));
+        return;
+    }
+
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.ptr = NULL;
+    epoll_ctl(EpollHandle, EPOLL_CTL_ADD, WakeHandle, &ev);
+
+    RecvBuf = (uint8_t*)OVR_ALLOC(RecvBufSize);
+}
+
+TCPSocketReactor::~TCPSocketReactor()
+{
+    if (EpollHandle >= 0)
+    {
+        close(EpollHandle);
+    }
+    if (WakeHandle >= 0)
+    {
+        close(WakeHandle);
+    }
+    OVR_FREE(RecvBuf);
+}
+
+bool TCPSocketReactor::Add(TCPSocket* tcpSocket)
+{
+    if (!IsValid() || !tcpSocket || tcpSocket->GetSocketHandle() == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    Lock::Locker locker(&SocketsLock);
+
+    if (tcpSocket->IsRegistered)
+    {
+        return true;
+    }
+
+    // Registered before the epoll_ctl(), as a Poll() on another thread may get its first
+    // event before this returns, and there will be no other one for that edge
+    tcpSocket->IsRegistered = true;
+    Sockets.PushBack(tcpSocket);
+
+    // Edge-triggered: events are reported once per change, and handleEvent() reads until EAGAIN
+    epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    ev.data.ptr = tcpSocket;
+    if (epoll_ctl(EpollHandle, EPOLL_CTL_ADD, tcpSocket->GetSocketHandle(), &ev) != 0)
+    {
+        LogError("{ERR-023u} [Socket] Unable to watch socket %d: %s", tcpSocket->GetSocketHandle(), strerror(errno));
+        tcpSocket->IsRegistered = false;
+        Sockets.PopBack();
+        return false;
+    }
+    return true;
+}
+
+void TCPSocketReactor::Remove(TCPSocket* tcpSocket)
+{
+    if (!tcpSocket)
+    {
+        return;
+    }
+
+    Lock::Locker locker(&SocketsLock);
+
+    if (!tcpSocket->IsRegistered)
+    {
+        return;
+    }
+    tcpSocket->IsRegistered = false;
+
+    // A closed handle has left the epoll set already
+    if (tcpSocket->GetSocketHandle() != INVALID_SOCKET)
+    {
+        epoll_ctl(EpollHandle, EPOLL_CTL_DEL, tcpSocket->GetSocketHandle(), NULL);
+    }
+
+    const int count = Sockets.GetSizeI();
+    for (int i = 0; i < count; ++i)
+    {
+        if (Sockets[i] == tcpSocket)
+        {
+            RemovedSockets.PushBack(Sockets[i]);
+            Sockets.RemoveAtUnordered(i);
+            break;
+        }
+    }
+}
+
+int TCPSocketReactor::GetCount()
+{
+    Lock::Locker locker(&SocketsLock);
+    return Sockets.GetSizeI();
+}
+
+void TCPSocketReactor::Wake()
+{
+    CheckClosed = 1;
+
+    if (WakeHandle >= 0)
+    {
+        uint64_t one = 1;
+        ssize_t written = write(WakeHandle, &one, sizeof(one));
+        OVR_UNUSED(written);
+    }
+}
+
+void TCPSocketReactor::Poll(SocketEvent_TCP* eventHandler)
+{
+    int timeoutMs;
+    {
+        Lock::Locker locker(&SocketsLock);
+
+        // Events of the previous Poll() are all handled
+        RemovedSockets.Clear();
+
+        if (Sockets.GetSizeI() == 0)
+        {
+            return;
+        }
+        timeoutMs = getTimeoutMs(Sockets[0]->GetBlockingTimeoutSec(), Sockets[0]->GetBlockingTimeoutUsec());
+    }
+
+    if (CheckClosed.Load_Acquire())
+    {
+        handleClosedSockets(eventHandler);
+    }
+
+    int eventCount = epoll_wait(EpollHandle, Events, MaxEvents, timeoutMs);
+    for (int i = 0; i < eventCount; ++i)
+    {
+        TCPSocket* tcpSocket = (TCPSocket*)Events[i].data.ptr;
+        if (!tcpSocket)
+        {
+            uint64_t value;
+            while (read(WakeHandle, &value, sizeof(value)) > 0)
+            {
+            }
+            continue;
+        }
+
+        // Removed by an earlier event of this batch, or by another thread
+        if (!tcpSocket->IsRegistered)
+        {
+            continue;
+        }
+
+        handleEvent(tcpSocket, Events[i].events, eventHandler);
+    }
+
+    if (CheckClosed.Load_Acquire())
+    {
+        handleClosedSockets(eventHandler);
+    }
+}
+
+void TCPSocketReactor::handleEvent(TCPSocket* tcpSocket, uint32_t events, SocketEvent_TCP* eventHandler)
+{
+    SocketHandle handle = tcpSocket->GetSocketHandle();
+    if (handle == INVALID_SOCKET)
+    {
+        closeSocket(tcpSocket, eventHandler);
+        return;
+    }
+
+    if (tcpSocket->IsConnecting && (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)))
+    {
+        int error = 0;
+        socklen_t errorSize = sizeof(error);
+        getsockopt(handle, SOL_SOCKET, SO_ERROR, &error, &errorSize);
+        if (error != 0 || (events & (EPOLLERR | EPOLLHUP)))
+        {
+            closeSocket(tcpSocket, eventHandler);
+            return;
+        }
+
+        tcpSocket->IsConnecting = false;
+        eventHandler->TCP_OnConnected(tcpSocket);
+    }
+
+    if (events & (EPOLLIN | EPOLLRDHUP | EPOLLERR | EPOLLHUP))
+    {
+        if (tcpSocket->IsListenSocket)
+        {
+            // Accept the whole backlog, there is no other event for it
+            for (;;)
+            {
+                struct sockaddr_storage sockAddr;
+                socklen_t sockAddrSize = sizeof(sockAddr);
+
+                SocketHandle newSock = accept(handle, (sockaddr*)&sockAddr, &sockAddrSize);
+                if (newSock == INVALID_SOCKET)
+                {
+                    if (errno == EINTR || errno == ECONNABORTED)
+                    {
+                        continue;
+                    }
+                    break;
+                }
+
+                SockAddr sa(&sockAddr);
+                eventHandler->TCP_OnAccept(tcpSocket, &sa, newSock);
+            }
+            return;
+        }
+
+        // Read everything available, there is no other event for it
+        for (;;)
+        {
+            int bytesRead = (int)recv(handle, RecvBuf, RecvBufSize, 0);
+            if (bytesRead > 0)
+            {
+                tcpSocket->OnRecv(eventHandler, RecvBuf, bytesRead);
+
+                // The handler may have closed or removed it
+                if (!tcpSocket->IsRegistered || tcpSocket->GetSocketHandle() != handle)
+                {
+                    return;
+                }
+                continue;
+            }
+
+            if (bytesRead < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+
+            // Disconnection event:
+            closeSocket(tcpSocket, eventHandler);
+            return;
+        }
+    }
+
+    if (events & (EPOLLERR | EPOLLHUP))
+    {
+        closeSocket(tcpSocket, eventHandler);
+    }
+}
+
+void TCPSocketReactor::handleClosedSockets(SocketEvent_TCP* eventHandler)
+{
+    CheckClosed = 0;
+
+    Array< Ptr<TCPSocket> > closed;
+    {
+        Lock::Locker locker(&SocketsLock);
+
+        const int count = Sockets.GetSizeI();
+        for (int i = 0; i < count; ++i)
+        {
+            if (Sockets[i]->GetSocketHandle() == INVALID_SOCKET)
+            {
+                closed.PushBack(Sockets[i]);
+            }
+        }
+    }
+
+    const int closedCount = closed.GetSizeI();
+    for (int i = 0; i < closedCount; ++i)
+    {
+        OVR_DEBUG_LOG(("[Session] Detected an invalid socket handle - Treating it as a disconnection."));
+        closeSocket(closed[i], eventHandler);
+    }
+}
+
+void TCPSocketReactor::closeSocket(TCPSocket* tcpSocket, SocketEvent_TCP* eventHandler)
+{
+    // Keep it alive through the handler, which may release the connection holding it
+    Ptr<TCPSocket> hold = tcpSocket;
+
+    Remove(tcpSocket);
+    tcpSocket->IsConnecting = false;
+    eventHandler->TCP_OnClosed(tcpSocket);
+}
+
+#endif // OVR_NET_EPOLL
+
+
+}} // namespace OVR::Net
@@ -0,0 +1,215 @@
+/************************************************************************************
+
+PublicHeader:   n/a
+Filename    :   OVR_Unix_Socket.h
+Content     :   Berkley sockets networking implementation for Unix platforms
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#ifndef OVR_Unix_Socket_h
+#define OVR_Unix_Socket_h
+
+#include "OVR_Socket.h"
+#include "OVR_BitStream.h"
+#include "../Kernel/OVR_Array.h"
+#include "../Kernel/OVR_Atomic.h"
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+
+// Sessions poll their sockets with a TCPSocketReactor where epoll is available,
+// and with a TCPSocketPollState built on each call elsewhere
+#if defined(OVR_OS_LINUX) || defined(OVR_OS_ANDROID)
+#define OVR_NET_EPOLL 1
+#include <sys/epoll.h>
+#endif
+
+namespace OVR { namespace Net {
+
+
+//-----------------------------------------------------------------------------
+// SockAddr
+
+// Abstraction for IPV6 socket address, with various convenience functions
+class SockAddr
+{
+public:
+	SockAddr();
+	SockAddr(SockAddr* sa);
+	SockAddr(sockaddr_storage* sa);
+	SockAddr(sockaddr_in6* sa);
+	SockAddr(const char* hostAddress, uint16_t port, int sockType);
+
+public:
+	void   Set(const sockaddr_storage* sa);
+	void   Set(const sockaddr_in6* sa);
+	void   Set(const char* hostAddress, uint16_t port, int sockType); // SOCK_DGRAM or SOCK_STREAM
+
+	uint16_t GetPort();
+
+	String ToString(bool writePort, char portDelineator) const;
+    bool IsLocalhost() const;
+
+	void   Serialize(BitStream* bs);
+	bool   Deserialize(BitStream);
+
+	bool   operator==( const SockAddr& right ) const;
+	bool   operator!=( const SockAddr& right ) const;
+	bool   operator >( const SockAddr& right ) const;
+	bool   operator <( const SockAddr& right ) const;
+
+public:
+	sockaddr_in6 Addr6;
+};
+
+
+//-----------------------------------------------------------------------------
+// UDP Socket
+
+// Unix version of UDP socket
+class UDPSocket : public UDPSocketBase
+{
+public:
+	UDPSocket();
+	virtual ~UDPSocket();
+
+public:
+	virtual SocketHandle Bind(BerkleyBindParameters* pBindParameters);
+	virtual int          Send(const void* pData, int bytes, SockAddr* address);
+	virtual void         Poll(SocketEvent_UDP* eventHandler);
+
+protected:
+	static const int RecvBufSize = 1048576;
+	uint8_t* RecvBuf;
+
+	virtual void         OnRecv(SocketEvent_UDP* eventHandler, uint8_t* pData,
+								int bytesRead, SockAddr* address);
+};
+
+
+//-----------------------------------------------------------------------------
+// TCP Socket
+
+// Unix version of TCP socket
+class TCPSocket : public TCPSocketBase
+{
+    friend class TCPSocketPollState;
+    friend class TCPSocketReactor;
+
+public:
+	TCPSocket();
+	TCPSocket(SocketHandle boundHandle, bool isListenSocket);
+	virtual ~TCPSocket();
+
+public:
+	virtual SocketHandle Bind(BerkleyBindParameters* pBindParameters);
+	virtual int          Listen();
+	virtual int          Connect(SockAddr* address);
+	virtual int          Send(const void* pData, int bytes);
+	virtual int          SendBuffers(const void** pDataArray, const int* dataLengthArray, int arrayCount);
+
+protected:
+	virtual void         OnRecv(SocketEvent_TCP* eventHandler, uint8_t* pData,
+								int bytesRead);
+
+public:
+	bool IsConnecting; // Is in the process of connecting?
+	bool IsRegistered; // Is watched by a TCPSocketReactor?
+};
+
+
+//-----------------------------------------------------------------------------
+// TCPSocketPollState
+
+// Polls multiple blocking TCP sockets at once
+class TCPSocketPollState
+{
+    ArrayPOD<pollfd> PollFDs;
+
+public:
+    TCPSocketPollState();
+    bool IsValid() const;
+    void Add(TCPSocket* tcpSocket);
+    bool Poll(long usec = 30000, long seconds = 0);
+    void HandleEvent(TCPSocket* tcpSocket, SocketEvent_TCP* eventHandler);
+};
+
+
+#ifdef OVR_NET_EPOLL
+
+//-----------------------------------------------------------------------------
+// TCPSocketReactor
+
+// Edge-triggered epoll set of TCP sockets. Sockets stay registered from Add() until
+// Remove() or their closing, so a Poll() costs one epoll_wait() and work for the
+// sockets that have events only. Each event is drained until EAGAIN into one receive
+// buffer reused for every socket. Poll() is not reentrant and must be called from a
+// single thread; Add(), Remove() and Wake() may be called from any thread.
+class TCPSocketReactor : public NewOverrideBase
+{
+public:
+    TCPSocketReactor();
+    ~TCPSocketReactor();
+
+    bool IsValid() const { return EpollHandle >= 0; }
+    bool Add(TCPSocket* tcpSocket);
+    void Remove(TCPSocket* tcpSocket);
+    int  GetCount();
+
+    // Makes a blocked Poll() return and check for sockets closed in the meantime
+    void Wake();
+
+    // Waits for events up to the blocking timeout of the first socket, and handles them.
+    // Returns at once when no socket is registered.
+    void Poll(SocketEvent_TCP* eventHandler);
+
+protected:
+    void handleEvent(TCPSocket* tcpSocket, uint32_t events, SocketEvent_TCP* eventHandler);
+    void handleClosedSockets(SocketEvent_TCP* eventHandler);
+    void closeSocket(TCPSocket* tcpSocket, SocketEvent_TCP* eventHandler);
+
+    static const int MaxEvents   = 64;
+    static const int RecvBufSize = 65536;
+
+    int                     EpollHandle;
+    int                     WakeHandle;      // eventfd, registered with a NULL data pointer
+    Lock                    SocketsLock;
+    Array< Ptr<TCPSocket> > Sockets;         // References for the pointers given to epoll
+    Array< Ptr<TCPSocket> > RemovedSockets;  // Released at the next Poll(), which may still have their events
+    AtomicInt<int>          CheckClosed;
+    epoll_event             Events[MaxEvents];
+    uint8_t*                RecvBuf;
+};
+
+#endif // OVR_NET_EPOLL
+
+
+}} // OVR::Net
+
+#endif
@@ -501,6 +501,39 @@ int TCPSocket::Send(const void* pData, int bytes)
 	}
 }
 
+int TCPSocket::SendBuffers(const void** pDataArray, const int* dataLengthArray, int arrayCount)
+{
+	WSABUF buffers[MaxSendBuffers];
+	int sent = 0;
+	for (int first = 0; first < arrayCount; first += MaxSendBuffers)
+	{
+		DWORD count = 0;
+		for (int i = first; i < arrayCount && count < MaxSendBuffers; ++i)
+		{
+			if (dataLengthArray[i] > 0)
+			{
+				buffers[count].buf = (CHAR*)pDataArray[i];
+				buffers[count].len = (ULONG)dataLengthArray[i];
+				++count;
+			}
+		}
+		if (count == 0)
+		{
+			continue;
+		}
+
+		// Blocking socket: returns once every buffer is queued
+		DWORD bytesSent = 0;
+		if (WSASend(TheSocket, buffers, count, &bytesSent, 0, NULL, NULL) != 0)
+		{
+			return sent > 0 ? sent : -1;
+		}
+		sent += (int)bytesSent;
+	}
+
+	return sent;
+}
+
 
 //// TCPSocketPollState
 
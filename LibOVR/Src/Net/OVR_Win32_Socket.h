@@ -118,6 +118,7 @@ public:
 	virtual int          Listen();
 	virtual int          Connect(SockAddr* address);
 	virtual int          Send(const void* pData, int bytes);
+	virtual int          SendBuffers(const void** pDataArray, const int* dataLengthArray, int arrayCount);
 
 protected:
 	virtual void         OnRecv(SocketEvent_TCP* eventHandler, uint8_t* pData,
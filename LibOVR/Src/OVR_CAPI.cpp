@@ -1156,7 +1156,7 @@ OVR_EXPORT float ovrHmd_GetFloat(ovrHmd hmddesc,
         }
     }
 
-    return (float)NetClient::GetInstance()->GetNumberValue(InvalidVirtualHmdId, propertyName, defaultVal);
+    return (float)NetClient::GetInstance()->GetCachedNumberValue(InvalidVirtualHmdId, propertyName, defaultVal);
 }
 
 OVR_EXPORT ovrBool ovrHmd_SetFloat(ovrHmd hmddesc,
@@ -1282,6 +1282,16 @@ OVR_EXPORT ovrBool ovrHmd_StopPerfLog(ovrHmd hmd)
     }
     return false;
 }
+OVR_EXPORT void ovrHmd_SetVideoFrameTiming(ovrHmd hmd, const ovrVideoFrameTiming* timing)
+{
+    OVR_ASSERT(timing);
+
+    if (!hmd || !hmd->Handle || !timing)
+        return;
+
+    OVR::CAPI::HMDState* pHMDState = (OVR::CAPI::HMDState*)hmd->Handle;
+    pHMDState->LagStats.InstrumentVideoFrame(*timing);
+}
 
 
 #ifdef __cplusplus 
@@ -235,6 +235,7 @@ typedef enum
     ovrDistortionCap_HqDistortion       =  0x100,     /// High-quality sampling of distortion buffer for anti-aliasing
     ovrDistortionCap_LinuxDevFullscreen =  0x200,     /// Indicates window is fullscreen on a device when set. The SDK will automatically apply distortion mesh rotation if needed.
     ovrDistortionCap_ComputeShader      =  0x400,     /// Using compute shader (DX11+ only)
+    ovrDistortionCap_AdaptiveMesh       =  0x800,     /// Tessellate the distortion mesh by its error against the lens rather than on a uniform grid
 
     ovrDistortionCap_ProfileNoTimewarpSpinWaits = 0x10000,  /// Use when profiling with timewarp to remove false positives
 } ovrDistortionCaps;
@@ -936,6 +937,20 @@ OVR_EXPORT ovrBool ovrHmd_StartPerfLog(ovrHmd hmd, const char* fileName, const c
 /// Stop performance logging.
 OVR_EXPORT ovrBool ovrHmd_StopPerfLog(ovrHmd hmd);
 
+/// Timing of a video frame captured outside of the SDK, such as a passthrough camera frame,
+/// and shown by the frame being rendered. All times are absolute, see ovr_GetTimeInSeconds().
+typedef struct ovrVideoFrameTiming_
+{
+    unsigned int    SequenceNumber;     ///< Incremented for each captured frame. Gaps are counted as dropped frames.
+    double          CaptureSeconds;     ///< When the frame was captured, from the driver when it provides it.
+    double          UploadSeconds;      ///< When the frame was uploaded to the texture used by this frame.
+} ovrVideoFrameTiming;
+
+/// Reports the video frame shown by the frame being rendered. Must be called before ovrHmd_EndFrame.
+/// The capture interval, capture->upload, upload->present and capture->present latency histograms
+/// are then summarized in the performance log started with ovrHmd_StartPerfLog.
+OVR_EXPORT void ovrHmd_SetVideoFrameTiming(ovrHmd hmd, const ovrVideoFrameTiming* timing);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -198,6 +198,15 @@ String ProfileManager::GetProfilePath()
     return BasePath + "/ProfileDB.json";
 }
 
+String ProfileManager::GetDistortionMeshCachePath()
+{
+    Lock::Locker lockScope(&ProfileLock);
+
+    if (BasePath.IsEmpty())
+        return String();
+    return BasePath + "/DistortionMeshCache.bin";
+}
+
 static JSON* FindTaggedData(JSON* data, const char** tag_names, const char** qtags, int num_qtags)
 {
     if (data == NULL || !(data->Name == "TaggedData") || data->Type != JSON_Array)
@@ -132,6 +132,10 @@ public:
     // Force re-reading the settings
     void                Read();
 
+    // The binary distortion mesh cache next to the profile database, empty when the
+    // base path is not known.
+    String              GetDistortionMeshCachePath();
+
 protected:
     // Force writing the settings
     void                ClearProfileData();
@@ -29,6 +29,10 @@ limitations under the License.
 #include "Kernel/OVR_Log.h"
 #include "Kernel/OVR_Alg.h"
 
+#if defined(OVR_CPU_SSE)
+#include <emmintrin.h>
+#endif
+
 //To allow custom distortion to be introduced to CatMulSpline.
 float (*CustomDistortion)(float) = NULL;
 float (*CustomDistortionInv)(float) = NULL;
@@ -164,6 +168,100 @@ float EvalCatmullRom10Spline ( float const *K, float scaledVal )
     return res;
 }
 
+// The p0, m0, p1, m1 of each segment of EvalCatmullRom10Spline, so the batch version
+// picks them with an index rather than a switch.
+static void MakeCatmullRom10Segments ( float const *K, float pSegments[LensConfig::NumCoefficients][4] )
+{
+    int const NumSegments = LensConfig::NumCoefficients;
+
+    for ( int k = 0; k < NumSegments; k++ )
+    {
+        float *seg = pSegments[k];
+        switch ( k )
+        {
+        case 0:
+            seg[0] = 1.0f;
+            seg[1] =        ( K[1] - K[0] );
+            seg[2] = K[1];
+            seg[3] = 0.5f * ( K[2] - K[0] );
+            break;
+        default:
+            seg[0] = K[k  ];
+            seg[1] = 0.5f * ( K[k+1] - K[k-1] );
+            seg[2] = K[k+1];
+            seg[3] = 0.5f * ( K[k+2] - K[k  ] );
+            break;
+        case NumSegments-2:
+            seg[0] = K[NumSegments-2];
+            seg[1] = 0.5f * ( K[NumSegments-1] - K[NumSegments-2] );
+            seg[2] = K[NumSegments-1];
+            seg[3] = K[NumSegments-1] - K[NumSegments-2];
+            break;
+        case NumSegments-1:
+            seg[0] = K[NumSegments-1];
+            seg[1] = K[NumSegments-1] - K[NumSegments-2];
+            seg[2] = seg[0] + seg[1];
+            seg[3] = seg[1];
+            break;
+        }
+    }
+}
+
+void EvalCatmullRom10SplineBatch ( float const *K, float const *pScaledVals, float *pResults, int count )
+{
+    int const NumSegments = LensConfig::NumCoefficients;
+
+    float segments[NumSegments][4];
+    MakeCatmullRom10Segments ( K, segments );
+
+    int i = 0;
+
+#if defined(OVR_CPU_SSE)
+    // Four values at a time: the segment of each lane is loaded as a row, and
+    // transposing the four rows gives the p0, m0, p1, m1 vectors.
+    const __m128 zero    = _mm_setzero_ps();
+    const __m128 one     = _mm_set1_ps ( 1.0f );
+    const __m128 two     = _mm_set1_ps ( 2.0f );
+    const __m128 lastSeg = _mm_set1_ps ( (float)(NumSegments-1) );
+
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        __m128 scaledVal = _mm_loadu_ps ( pScaledVals + i );
+
+        // Truncating the clamped value is the same as clamping floorf ( scaledVal )
+        float clamped[4];
+        _mm_storeu_ps ( clamped, _mm_max_ps ( zero, _mm_min_ps ( lastSeg, scaledVal ) ) );
+        int k0 = (int)clamped[0], k1 = (int)clamped[1], k2 = (int)clamped[2], k3 = (int)clamped[3];
+
+        __m128 t  = _mm_sub_ps ( scaledVal, _mm_setr_ps ( (float)k0, (float)k1, (float)k2, (float)k3 ) );
+        __m128 p0 = _mm_loadu_ps ( segments[k0] );
+        __m128 m0 = _mm_loadu_ps ( segments[k1] );
+        __m128 p1 = _mm_loadu_ps ( segments[k2] );
+        __m128 m1 = _mm_loadu_ps ( segments[k3] );
+        _MM_TRANSPOSE4_PS ( p0, m0, p1, m1 );
+
+        __m128 omt = _mm_sub_ps ( one, t );
+        __m128 a   = _mm_add_ps ( _mm_mul_ps ( p0, _mm_add_ps ( one, _mm_mul_ps ( two, t ) ) ), _mm_mul_ps ( m0, t ) );
+        __m128 b   = _mm_sub_ps ( _mm_mul_ps ( p1, _mm_add_ps ( one, _mm_mul_ps ( two, omt ) ) ), _mm_mul_ps ( m1, omt ) );
+        __m128 res = _mm_add_ps ( _mm_mul_ps ( _mm_mul_ps ( a, omt ), omt ), _mm_mul_ps ( _mm_mul_ps ( b, t ), t ) );
+        _mm_storeu_ps ( pResults + i, res );
+    }
+#endif
+
+    for ( ; i < count; i++ )
+    {
+        float scaledVal = pScaledVals[i];
+        float scaledValFloor = floorf ( scaledVal );
+        scaledValFloor = Alg::Max ( 0.0f, Alg::Min ( (float)(NumSegments-1), scaledValFloor ) );
+        float t = scaledVal - scaledValFloor;
+        float const *seg = segments[(int)scaledValFloor];
+
+        float omt = 1.0f - t;
+        pResults[i] = ( seg[0] * ( 1.0f + 2.0f *   t ) + seg[1] *   t ) * omt * omt
+                    + ( seg[2] * ( 1.0f + 2.0f * omt ) - seg[3] * omt ) *   t *   t;
+    }
+}
+
 
 
 
@@ -243,6 +341,17 @@ Vector3f LensConfig::DistortionFnScaleRadiusSquaredChroma (float rsq) const
 
 // DistortionFnInverse computes the inverse of the distortion function on an argument.
 float LensConfig::DistortionFnInverse(float r) const
+{
+    float s;
+    if ( DistortionTable && DistortionTable->Matches ( *this ) &&
+         DistortionTable->DistortionFnInverse ( r, LensDistortionTable::Channel_Green, &s ) )
+    {
+        return s;
+    }
+    return DistortionFnInverseExact ( r );
+}
+
+float LensConfig::DistortionFnInverseExact(float r) const
 {    
     OVR_ASSERT((r <= 20.0f));
 
@@ -282,6 +391,209 @@ float LensConfig::DistortionFnInverse(float r) const
 
 
 
+// Values handled at once by the batch functions that need scratch arrays.
+static const int DistortionBatchChunk = 64;
+
+void LensConfig::DistortionFnScaleRadiusSquaredBatch (float const *pRsq, float *pScales, int count) const
+{
+#if defined(OVR_CPU_SSE)
+    if ( Eqn == Distortion_RecipPoly4 )
+    {
+        const __m128 one = _mm_set1_ps ( 1.0f );
+        const __m128 k0  = _mm_set1_ps ( K[0] ), k1 = _mm_set1_ps ( K[1] ), k2 = _mm_set1_ps ( K[2] ), k3 = _mm_set1_ps ( K[3] );
+        int i = 0;
+        for ( ; i + 4 <= count; i += 4 )
+        {
+            __m128 rsq = _mm_loadu_ps ( pRsq + i );
+            __m128 den = _mm_add_ps ( k0, _mm_mul_ps ( rsq, _mm_add_ps ( k1, _mm_mul_ps ( rsq, _mm_add_ps ( k2, _mm_mul_ps ( rsq, k3 ) ) ) ) ) );
+            _mm_storeu_ps ( pScales + i, _mm_div_ps ( one, den ) );
+        }
+        for ( ; i < count; i++ )
+        {
+            pScales[i] = DistortionFnScaleRadiusSquared ( pRsq[i] );
+        }
+        return;
+    }
+#endif
+
+    if ( Eqn != Distortion_CatmullRom10 || CustomDistortion )
+    {
+        for ( int i = 0; i < count; i++ )
+        {
+            pScales[i] = DistortionFnScaleRadiusSquared ( pRsq[i] );
+        }
+        return;
+    }
+
+    const int NumSegments = LensConfig::NumCoefficients;
+    int i = 0;
+#if defined(OVR_CPU_SSE)
+    const __m128 lastSeg = _mm_set1_ps ( (float)(NumSegments-1) );
+    const __m128 maxRsq  = _mm_set1_ps ( MaxR * MaxR );
+    for ( ; i + 4 <= count; i += 4 )
+    {
+        _mm_storeu_ps ( pScales + i, _mm_div_ps ( _mm_mul_ps ( lastSeg, _mm_loadu_ps ( pRsq + i ) ), maxRsq ) );
+    }
+#endif
+    for ( ; i < count; i++ )
+    {
+        pScales[i] = (float)(NumSegments-1) * pRsq[i] / ( MaxR * MaxR );
+    }
+    EvalCatmullRom10SplineBatch ( K, pScales, pScales, count );
+}
+
+void LensConfig::DistortionFnScaleRadiusSquaredChromaBatch (float const *pRsq, Vector3f *pScalesRGB, int count) const
+{
+    float scales[DistortionBatchChunk];
+    for ( int first = 0; first < count; first += DistortionBatchChunk )
+    {
+        int n = Alg::Min ( DistortionBatchChunk, count - first );
+        DistortionFnScaleRadiusSquaredBatch ( pRsq + first, scales, n );
+
+        for ( int i = 0; i < n; i++ )
+        {
+            float rsq   = pRsq[first + i];
+            float scale = scales[i];
+            Vector3f &scaleRGB = pScalesRGB[first + i];
+            scaleRGB.x = scale * ( 1.0f + ChromaticAberration[0] + rsq * ChromaticAberration[1] );     // Red
+            scaleRGB.y = scale;                                                                        // Green
+            scaleRGB.z = scale * ( 1.0f + ChromaticAberration[2] + rsq * ChromaticAberration[3] );     // Blue
+        }
+    }
+}
+
+void LensConfig::DistortionFnInverseBatch(float const *pR, float *pResults, int count) const
+{
+    if ( !DistortionTable || !DistortionTable->Matches ( *this ) )
+    {
+        DistortionFnInverseExactBatch ( pR, pResults, count );
+        return;
+    }
+
+    // Values beyond the table are gathered for the search
+    float missR[DistortionBatchChunk];
+    int   missIndex[DistortionBatchChunk];
+    for ( int first = 0; first < count; first += DistortionBatchChunk )
+    {
+        int n = Alg::Min ( DistortionBatchChunk, count - first );
+        int misses = 0;
+        for ( int i = 0; i < n; i++ )
+        {
+            float r = pR[first + i];
+            if ( !DistortionTable->DistortionFnInverse ( r, LensDistortionTable::Channel_Green, &pResults[first + i] ) )
+            {
+                missR[misses]     = r;
+                missIndex[misses] = first + i;
+                misses++;
+            }
+        }
+        if ( misses > 0 )
+        {
+            DistortionFnInverseExactBatch ( missR, missR, misses );
+            for ( int i = 0; i < misses; i++ )
+            {
+                pResults[missIndex[i]] = missR[i];
+            }
+        }
+    }
+}
+
+// Runs the search of DistortionFnInverseExact on a chunk of values in lock-step, so each
+// step evaluates the distortion of all the trial radii in one batch.
+void LensConfig::DistortionFnInverseExactBatch(float const *pR, float *pResults, int count) const
+{
+    float s[DistortionBatchChunk], d[DistortionBatchChunk], delta[DistortionBatchChunk];
+    float trial[DistortionBatchChunk * 2], trialD[DistortionBatchChunk * 2];
+
+    for ( int first = 0; first < count; first += DistortionBatchChunk )
+    {
+        int n = Alg::Min ( DistortionBatchChunk, count - first );
+        float const *r = pR + first;
+
+        for ( int i = 0; i < n; i++ )
+        {
+            OVR_ASSERT((r[i] <= 20.0f));
+            delta[i] = r[i] * 0.25f;
+            s[i]     = r[i] * 0.25f;
+            trial[i] = s[i] * s[i];
+        }
+        DistortionFnScaleRadiusSquaredBatch ( trial, trialD, n );
+        for ( int i = 0; i < n; i++ )
+        {
+            d[i] = fabs(r[i] - s[i] * trialD[i]);
+        }
+
+        for ( int iter = 0; iter < 20; iter++ )
+        {
+            // sUp in the first n trials, sDown in the next n
+            for ( int i = 0; i < n; i++ )
+            {
+                float sUp   = s[i] + delta[i];
+                float sDown = s[i] - delta[i];
+                trial[i]     = sUp * sUp;
+                trial[n + i] = sDown * sDown;
+            }
+            DistortionFnScaleRadiusSquaredBatch ( trial, trialD, n * 2 );
+
+            int i = 0;
+#if defined(OVR_CPU_SSE)
+            // The same choice as below, made with masks
+            const __m128 absMask = _mm_castsi128_ps ( _mm_set1_epi32 ( 0x7fffffff ) );
+            const __m128 half    = _mm_set1_ps ( 0.5f );
+            for ( ; i + 4 <= n; i += 4 )
+            {
+                __m128 rv     = _mm_loadu_ps ( r + i );
+                __m128 sv     = _mm_loadu_ps ( s + i );
+                __m128 dv     = _mm_loadu_ps ( d + i );
+                __m128 deltav = _mm_loadu_ps ( delta + i );
+                __m128 sUp    = _mm_add_ps ( sv, deltav );
+                __m128 sDown  = _mm_sub_ps ( sv, deltav );
+                __m128 dUp    = _mm_and_ps ( absMask, _mm_sub_ps ( rv, _mm_mul_ps ( sUp,   _mm_loadu_ps ( trialD + i ) ) ) );
+                __m128 dDown  = _mm_and_ps ( absMask, _mm_sub_ps ( rv, _mm_mul_ps ( sDown, _mm_loadu_ps ( trialD + n + i ) ) ) );
+
+                __m128 up    = _mm_cmplt_ps ( dUp, dv );
+                __m128 down  = _mm_andnot_ps ( up, _mm_cmplt_ps ( dDown, dv ) );
+                __m128 moved = _mm_or_ps ( up, down );
+
+                sv     = _mm_or_ps ( _mm_or_ps ( _mm_and_ps ( up, sUp ), _mm_and_ps ( down, sDown ) ), _mm_andnot_ps ( moved, sv ) );
+                dv     = _mm_or_ps ( _mm_or_ps ( _mm_and_ps ( up, dUp ), _mm_and_ps ( down, dDown ) ), _mm_andnot_ps ( moved, dv ) );
+                deltav = _mm_or_ps ( _mm_and_ps ( moved, deltav ), _mm_andnot_ps ( moved, _mm_mul_ps ( deltav, half ) ) );
+
+                _mm_storeu_ps ( s + i, sv );
+                _mm_storeu_ps ( d + i, dv );
+                _mm_storeu_ps ( delta + i, deltav );
+            }
+#endif
+            for ( ; i < n; i++ )
+            {
+                float sUp   = s[i] + delta[i];
+                float sDown = s[i] - delta[i];
+                float dUp   = fabs(r[i] - sUp   * trialD[i]);
+                float dDown = fabs(r[i] - sDown * trialD[n + i]);
+
+                if (dUp < d[i])
+                {
+                    s[i] = sUp;
+                    d[i] = dUp;
+                }
+                else if (dDown < d[i])
+                {
+                    s[i] = sDown;
+                    d[i] = dDown;
+                }
+                else
+                {
+                    delta[i] *= 0.5f;
+                }
+            }
+        }
+
+        memcpy ( pResults + first, s, n * sizeof(float) );
+    }
+}
+
+
+
 float LensConfig::DistortionFnInverseApprox(float r) const
 {
     float rsq = r * r;
@@ -421,6 +733,294 @@ void LensConfig::SetToIdentity()
     MetersPerTanAngleAtCenter = 0.05f;
 }
 
+void LensConfig::SetUpDistortionTable()
+{
+    DistortionTable = LensDistortionTable::GetTable ( *this );
+
+#ifdef OVR_BUILD_DEBUG
+    if ( DistortionTable )
+    {
+        float maxInvR = DistortionTable->GetMaxInvR ( LensDistortionTable::Channel_Green );
+        OVR_ASSERT ( DistortionTable->MeasureInverseError ( *this, 64 ) < 0.0001f * maxInvR );
+        OVR_UNUSED ( maxInvR );
+    }
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** LensDistortionTableCache
+
+// Keeps the last few tables built, most recently used first. Lens configs come from a
+// handful of profiles, so a short list is enough.
+class LensDistortionTableCache : public NewOverrideBase, public SystemSingletonBase<LensDistortionTableCache>
+{
+    OVR_DECLARE_SINGLETON(LensDistortionTableCache);
+
+public:
+    enum { Depth = 8 };
+
+    Ptr<LensDistortionTable> Find ( LensConfig const &config, uint32_t hash )
+    {
+        Lock::Locker locker ( &CacheLock );
+        for ( int i = 0; i < Tables.GetSizeI(); i++ )
+        {
+            if ( Tables[i]->Hash == hash && Tables[i]->Matches ( config ) )
+            {
+                Ptr<LensDistortionTable> table = Tables[i];
+                Tables.RemoveAt ( i );
+                Tables.InsertAt ( 0, table );
+                return table;
+            }
+        }
+        return NULL;
+    }
+
+    // Returns the table cached for the same values in the meantime if there is one.
+    Ptr<LensDistortionTable> Add ( LensDistortionTable *table, LensConfig const &config )
+    {
+        Ptr<LensDistortionTable> cached = Find ( config, table->Hash );
+        if ( cached )
+        {
+            return cached;
+        }
+
+        Lock::Locker locker ( &CacheLock );
+        Tables.InsertAt ( 0, Ptr<LensDistortionTable> ( table ) );
+        if ( Tables.GetSizeI() > Depth )
+        {
+            Tables.RemoveAt ( Depth );
+        }
+        return table;
+    }
+
+private:
+    Lock                                CacheLock;
+    Array< Ptr<LensDistortionTable> >   Tables;
+};
+
+LensDistortionTableCache::LensDistortionTableCache()
+{
+    PushDestroyCallbacks();
+}
+
+LensDistortionTableCache::~LensDistortionTableCache()
+{
+}
+
+void LensDistortionTableCache::OnSystemDestroy()
+{
+    delete this;
+}
+
+
+} //namespace OVR
+
+OVR_DEFINE_SINGLETON(OVR::LensDistortionTableCache);
+
+namespace OVR {
+
+
+//-----------------------------------------------------------------------------------
+// ***** LensDistortionTable
+
+Ptr<LensDistortionTable> LensDistortionTable::GetTable ( LensConfig const &config )
+{
+    if ( CustomDistortion )
+    {
+        return NULL;
+    }
+
+    uint32_t hash = HashConfig ( config );
+    Ptr<LensDistortionTable> table = LensDistortionTableCache::GetInstance()->Find ( config, hash );
+    if ( !table )
+    {
+        // Built outside of the cache lock, another thread may have added the same one meanwhile.
+        table = *new LensDistortionTable ( config, hash );
+        table = LensDistortionTableCache::GetInstance()->Add ( table, config );
+    }
+    return table;
+}
+
+// FNV-1a of the values the table depends on
+uint32_t LensDistortionTable::HashConfig ( LensConfig const &config )
+{
+    uint32_t hash = 2166136261u;
+    uint32_t eqn  = (uint32_t)config.Eqn;
+    const struct { const void *pData; size_t size; } fields[] =
+    {
+        { &eqn,                        sizeof(eqn) },
+        { config.K,                    sizeof(config.K) },
+        { &config.MaxR,                sizeof(config.MaxR) },
+        { config.ChromaticAberration,  sizeof(config.ChromaticAberration) }
+    };
+    for ( size_t f = 0; f < sizeof(fields) / sizeof(fields[0]); f++ )
+    {
+        const uint8_t *bytes = (const uint8_t *)fields[f].pData;
+        for ( size_t i = 0; i < fields[f].size; i++ )
+        {
+            hash = ( hash ^ bytes[i] ) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+bool LensDistortionTable::Matches ( LensConfig const &config ) const
+{
+    if ( config.Eqn != Eqn || config.MaxR != ConfigMaxR )
+    {
+        return false;
+    }
+    for ( int i = 0; i < LensConfig::NumCoefficients; i++ )
+    {
+        if ( config.K[i] != K[i] )
+        {
+            return false;
+        }
+    }
+    for ( int i = 0; i < 4; i++ )
+    {
+        if ( config.ChromaticAberration[i] != ChromaticAberration[i] )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+float LensDistortionTable::DistortionFnChroma ( LensConfig const &config, float r, ChannelType channel )
+{
+    float rsq   = r * r;
+    float scale = config.DistortionFnScaleRadiusSquared ( rsq );
+    switch ( channel )
+    {
+    case Channel_Red:   scale *= 1.0f + config.ChromaticAberration[0] + rsq * config.ChromaticAberration[1]; break;
+    case Channel_Blue:  scale *= 1.0f + config.ChromaticAberration[2] + rsq * config.ChromaticAberration[3]; break;
+    default: break;
+    }
+    return r * scale;
+}
+
+LensDistortionTable::LensDistortionTable ( LensConfig const &config, uint32_t hash )
+  : Hash(hash), Eqn(config.Eqn), ConfigMaxR(config.MaxR)
+{
+    memcpy ( K, config.K, sizeof(K) );
+    memcpy ( ChromaticAberration, config.ChromaticAberration, sizeof(ChromaticAberration) );
+
+    // Cover up to twice MaxR, but stop where any channel stops increasing or gets steeper
+    // than MaxSlope times its slope at the centre: the curves are extrapolated past MaxR and
+    // may turn back, where they have no inverse, or head for the pole of a RecipPoly4.
+    const int   MaxSlope   = 4;
+    const int   oversample = 4;
+    const int   steps      = ( NumEntries - 1 ) * oversample;
+    const float rangeR     = 2.0f * ( ( ConfigMaxR > 0.0f ) ? ConfigMaxR : 1.0f );
+    float       prev[Channel_Count];
+    float       maxRise[Channel_Count];
+    for ( int c = 0; c < Channel_Count; c++ )
+    {
+        prev[c]    = DistortionFnChroma ( config, rangeR / (float)steps, (ChannelType)c );
+        maxRise[c] = prev[c] * (float)MaxSlope;
+    }
+    int         lastStep = steps;
+    for ( int i = 2; i <= steps && lastStep == steps; i++ )
+    {
+        float r = rangeR * (float)i / (float)steps;
+        for ( int c = 0; c < Channel_Count; c++ )
+        {
+            float f = DistortionFnChroma ( config, r, (ChannelType)c );
+            if ( !( f > prev[c] && f - prev[c] <= maxRise[c] ) )
+            {
+                lastStep = i - 1;
+                break;
+            }
+            prev[c] = f;
+        }
+    }
+    OVR_ASSERT ( lastStep > 0 );
+    MaxR         = rangeR * (float)Alg::Max ( lastStep, 1 ) / (float)steps;
+    ForwardScale = (float)( NumEntries - 1 ) / MaxR;
+
+    const float step = MaxR / (float)( NumEntries - 1 );
+    for ( int c = 0; c < Channel_Count; c++ )
+    {
+        float *forward = Forward[c];
+        float *inverse = Inverse[c];
+        for ( int i = 0; i < NumEntries; i++ )
+        {
+            forward[i] = DistortionFnChroma ( config, (float)i * step, (ChannelType)c );
+        }
+        MaxInvR[c]      = forward[NumEntries - 1];
+        InverseScale[c] = (float)( NumEntries - 1 ) / MaxInvR[c];
+
+        // Each inverse entry lies between two forward entries; bisect the exact curve there.
+        inverse[0]              = 0.0f;
+        inverse[NumEntries - 1] = MaxR;
+        int k = 0;
+        for ( int i = 1; i < NumEntries - 1; i++ )
+        {
+            float t = MaxInvR[c] * (float)i / (float)( NumEntries - 1 );
+            while ( k < NumEntries - 2 && forward[k + 1] < t )
+            {
+                k++;
+            }
+            float lo = (float)k * step;
+            float hi = (float)( k + 1 ) * step;
+            for ( int iter = 0; iter < 16; iter++ )
+            {
+                float mid = 0.5f * ( lo + hi );
+                if ( DistortionFnChroma ( config, mid, (ChannelType)c ) < t )
+                {
+                    lo = mid;
+                }
+                else
+                {
+                    hi = mid;
+                }
+            }
+            inverse[i] = 0.5f * ( lo + hi );
+        }
+    }
+}
+
+float LensDistortionTable::DistortionFn ( float r, ChannelType channel ) const
+{
+    float x = Alg::Clamp ( r * ForwardScale, 0.0f, (float)( NumEntries - 1 ) );
+    int   i = Alg::Min ( (int)x, NumEntries - 2 );
+    float const *forward = Forward[channel];
+    return forward[i] + ( x - (float)i ) * ( forward[i + 1] - forward[i] );
+}
+
+bool LensDistortionTable::DistortionFnInverse ( float r, ChannelType channel, float *pResult ) const
+{
+    if ( !( r >= 0.0f && r <= MaxInvR[channel] ) )
+    {
+        return false;
+    }
+    float x = r * InverseScale[channel];
+    int   i = Alg::Min ( (int)x, NumEntries - 2 );
+    float const *inverse = Inverse[channel];
+    *pResult = inverse[i] + ( x - (float)i ) * ( inverse[i + 1] - inverse[i] );
+    return true;
+}
+
+float LensDistortionTable::MeasureInverseError ( LensConfig const &config, int sampleCount ) const
+{
+    float maxError = 0.0f;
+    for ( int i = 0; i <= sampleCount; i++ )
+    {
+        for ( int c = 0; c < Channel_Count; c++ )
+        {
+            float r = MaxInvR[c] * (float)i / (float)sampleCount;
+            float inv;
+            if ( DistortionFnInverse ( r, (ChannelType)c, &inv ) )
+            {
+                maxError = Alg::Max ( maxError, fabsf ( DistortionFnChroma ( config, inv, (ChannelType)c ) - r ) );
+            }
+        }
+    }
+    return maxError;
+}
+
 
 enum LensConfigStoredVersion
 {
@@ -513,6 +1113,7 @@ bool LoadLensConfig ( LensConfig *presult, uint8_t const *pbuffer, int bufferSiz
             }
             result.MaxInvR = result.DistortionFn ( result.MaxR );
             result.SetUpInverseApprox();
+            result.SetUpDistortionTable();
 
             OVR_ASSERT ( version == lcs.VersionNumber );
 
@@ -1301,6 +1902,9 @@ LensConfig GenerateLensConfigFromEyeRelief ( float eyeReliefInMeters, HmdRenderI
     // Scale.
     result.MetersPerTanAngleAtCenter =  pLower->Config.MetersPerTanAngleAtCenter * invLerpVal +
                                         pUpper->Config.MetersPerTanAngleAtCenter * lerpVal;
+
+    // Inverse tables, once the chromatic aberration is known.
+    result.SetUpDistortionTable();
     /*
     // Commented out - Causes ASSERT with no HMD plugged in
 #ifdef OVR_BUILD_DEBUG
@@ -1774,6 +2378,37 @@ void TransformScreenNDCToTanFovSpaceChroma ( Vector2f *resultR, Vector2f *result
     *resultB = tanEyeAngleDistorted * distortionScales.z;
 }
 
+void TransformScreenNDCToTanFovSpaceChromaBatch ( Vector2f *resultR, Vector2f *resultG, Vector2f *resultB,
+                                                  DistortionRenderDesc const &distortion,
+                                                  const Vector2f *framebufferNDC, int count )
+{
+    Vector2f tanEyeAngleDistorted[DistortionBatchChunk];
+    float    radiusSquared[DistortionBatchChunk];
+    Vector3f distortionScales[DistortionBatchChunk];
+
+    for ( int first = 0; first < count; first += DistortionBatchChunk )
+    {
+        int n = Alg::Min ( DistortionBatchChunk, count - first );
+        for ( int i = 0; i < n; i++ )
+        {
+            // Scale to TanHalfFov space, but still distorted.
+            Vector2f &t = tanEyeAngleDistorted[i];
+            t.x = ( framebufferNDC[first + i].x - distortion.LensCenter.x ) * distortion.TanEyeAngleScale.x;
+            t.y = ( framebufferNDC[first + i].y - distortion.LensCenter.y ) * distortion.TanEyeAngleScale.y;
+            radiusSquared[i] = ( t.x * t.x ) + ( t.y * t.y );
+        }
+
+        // Distort.
+        distortion.Lens.DistortionFnScaleRadiusSquaredChromaBatch ( radiusSquared, distortionScales, n );
+        for ( int i = 0; i < n; i++ )
+        {
+            resultR[first + i] = tanEyeAngleDistorted[i] * distortionScales[i].x;
+            resultG[first + i] = tanEyeAngleDistorted[i] * distortionScales[i].y;
+            resultB[first + i] = tanEyeAngleDistorted[i] * distortionScales[i].z;
+        }
+    }
+}
+
 // This mimics the second half of the distortion shader's function.
 Vector2f TransformTanFovSpaceToRendertargetTexUV( ScaleAndOffset2D const &eyeToSourceUV,
                                                   Vector2f const &tanEyeAngle )
@@ -1854,6 +2489,46 @@ Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion
     return framebufferNDC;
 }
 
+void TransformTanFovSpaceToScreenNDCBatch( Vector2f *framebufferNDC, DistortionRenderDesc const &distortion,
+                                           const Vector2f *tanEyeAngle, int count, bool usePolyApprox /*= false*/ )
+{
+    float tanEyeAngleRadius[DistortionBatchChunk];
+    float tanEyeAngleDistortedRadius[DistortionBatchChunk];
+
+    for ( int first = 0; first < count; first += DistortionBatchChunk )
+    {
+        int n = Alg::Min ( DistortionBatchChunk, count - first );
+        for ( int i = 0; i < n; i++ )
+        {
+            tanEyeAngleRadius[i] = tanEyeAngle[first + i].Length();
+        }
+
+        if ( usePolyApprox )
+        {
+            for ( int i = 0; i < n; i++ )
+            {
+                tanEyeAngleDistortedRadius[i] = distortion.Lens.DistortionFnInverseApprox ( tanEyeAngleRadius[i] );
+            }
+        }
+        else
+        {
+            distortion.Lens.DistortionFnInverseBatch ( tanEyeAngleRadius, tanEyeAngleDistortedRadius, n );
+        }
+
+        for ( int i = 0; i < n; i++ )
+        {
+            Vector2f tanEyeAngleDistorted = tanEyeAngle[first + i];
+            if ( tanEyeAngleRadius[i] > 0.0f )
+            {
+                tanEyeAngleDistorted = tanEyeAngle[first + i] * ( tanEyeAngleDistortedRadius[i] / tanEyeAngleRadius[i] );
+            }
+
+            framebufferNDC[first + i].x = ( tanEyeAngleDistorted.x / distortion.TanEyeAngleScale.x ) + distortion.LensCenter.x;
+            framebufferNDC[first + i].y = ( tanEyeAngleDistorted.y / distortion.TanEyeAngleScale.y ) + distortion.LensCenter.y;
+        }
+    }
+}
+
 Vector2f TransformRendertargetNDCToTanFovSpace( const ScaleAndOffset2D &eyeToSourceNDC,
                                                 const Vector2f &textureNDC )
 {
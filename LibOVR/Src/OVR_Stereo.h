@@ -162,6 +162,13 @@ struct ScaleAndOffset2D
 // have the same pFitX value).
 bool FitCubicPolynomial ( float *pResult, const float *pFitX, const float *pFitY );
 
+// Evaluates the Catmull-Rom spline of LensConfig::Distortion_CatmullRom10 through K[]
+// on count values at once, giving the same results as the per-value evaluation.
+// pResults may be the same array as pScaledVals.
+void EvalCatmullRom10SplineBatch ( float const *K, float const *pScaledVals, float *pResults, int count );
+
+class LensDistortionTable;
+
 //-----------------------------------------------------------------------------------
 // ***** LensConfig
 
@@ -203,12 +210,26 @@ struct LensConfig
     }
 
     // DistortionFnInverse computes the inverse of the distortion function on an argument.
+    // It reads DistortionTable when it was set up for these values, and falls back to
+    // DistortionFnInverseExact beyond the range of the table.
     float DistortionFnInverse(float r) const;
+    // Same, with the iterative search only.
+    float DistortionFnInverseExact(float r) const;
 
     // Also computes the inverse, but using a polynomial approximation. Warning - it's just an approximation!
     float DistortionFnInverseApprox(float r) const;
+
+    // Batch versions of the functions above, on count values at once. They give the same
+    // results as the per-value functions, and the results may be written over the inputs.
+    void DistortionFnScaleRadiusSquaredBatch (float const *pRsq, float *pScales, int count) const;
+    void DistortionFnScaleRadiusSquaredChromaBatch (float const *pRsq, Vector3f *pScalesRGB, int count) const;
+    void DistortionFnInverseBatch(float const *pR, float *pResults, int count) const;
+    void DistortionFnInverseExactBatch(float const *pR, float *pResults, int count) const;
     // Sets up InvK[].
     void SetUpInverseApprox();
+    // Sets up DistortionTable, from the cache when another config had the same values.
+    // Call once every other member is set: the table is ignored if they change afterwards.
+    void SetUpDistortionTable();
 
     // Sets a bunch of sensible defaults.
     void SetToIdentity();
@@ -232,6 +253,81 @@ struct LensConfig
 
     float               InvK[NumCoefficients];
     float               MaxInvR;
+
+    Ptr<LensDistortionTable> DistortionTable;
+};
+
+
+//-----------------------------------------------------------------------------------
+// ***** LensDistortionTable
+
+// Dense tables of the distortion function of a LensConfig and of its inverse, for each
+// colour channel, with the chromatic aberration scales applied. The forward tables sample
+// radii evenly from 0 to GetMaxR(), which is the largest radius up to 2*MaxR where every
+// channel still increases, no steeper than 4 times at the centre; the inverse tables
+// sample the distorted radii of that range, solved on the exact curves.
+// Values in between are interpolated linearly.
+//
+// Tables are shared: GetTable() keeps the last few built in a process-wide cache, looked up
+// by a hash of Eqn, K[], MaxR and ChromaticAberration[], so configuring several HMD states
+// or the same lens again does not rebuild them.
+class LensDistortionTable : public RefCountBase<LensDistortionTable>
+{
+public:
+    enum { NumEntries = 1024 };
+
+    enum ChannelType
+    {
+        Channel_Red,
+        Channel_Green,
+        Channel_Blue,
+        Channel_Count
+    };
+
+    // Returns the table of config, or NULL for a custom distortion callback, which tables cannot follow.
+    static Ptr<LensDistortionTable> GetTable ( LensConfig const &config );
+
+    // True if the table was built from the current values of config.
+    bool     Matches ( LensConfig const &config ) const;
+
+    float    GetMaxR() const                          { return MaxR; }
+    float    GetMaxInvR ( ChannelType channel ) const { return MaxInvR[channel]; }
+
+    // LensConfig::DistortionFn scaled for channel, for r from 0 to GetMaxR().
+    float    DistortionFn ( float r, ChannelType channel ) const;
+    // Its inverse, for r from 0 to GetMaxInvR(channel). Returns false, leaving *pResult
+    // unchanged, outside of that range.
+    bool     DistortionFnInverse ( float r, ChannelType channel, float *pResult ) const;
+
+    // Largest round-trip error | DistortionFn ( DistortionFnInverse ( r ) ) - r | of the
+    // inverse tables against the exact curves of config, over sampleCount radii of each
+    // channel from 0 to GetMaxInvR(). The iterative search of DistortionFnInverseExact
+    // is looser than the tables, so it is not the reference.
+    float    MeasureInverseError ( LensConfig const &config, int sampleCount ) const;
+
+    // LensConfig::DistortionFn scaled for channel, evaluated exactly: the curve the tables sample.
+    static float DistortionFnChroma ( LensConfig const &config, float r, ChannelType channel );
+
+protected:
+    LensDistortionTable ( LensConfig const &config, uint32_t hash );
+
+    static uint32_t HashConfig ( LensConfig const &config );
+
+    // The values the table was built from
+    uint32_t          Hash;
+    DistortionEqnType Eqn;
+    float             K[LensConfig::NumCoefficients];
+    float             ConfigMaxR;
+    float             ChromaticAberration[4];
+
+    float             MaxR;
+    float             MaxInvR[Channel_Count];
+    float             ForwardScale;                   // Entries per unit of radius
+    float             InverseScale[Channel_Count];
+    float             Forward[Channel_Count][NumEntries];
+    float             Inverse[Channel_Count][NumEntries];
+
+    friend class LensDistortionTableCache;
 };
 
 
@@ -640,6 +736,9 @@ Vector2f TransformScreenNDCToTanFovSpace ( DistortionRenderDesc const &distortio
 void TransformScreenNDCToTanFovSpaceChroma ( Vector2f *resultR, Vector2f *resultG, Vector2f *resultB, 
                                              DistortionRenderDesc const &distortion,
                                              const Vector2f &framebufferNDC );
+void TransformScreenNDCToTanFovSpaceChromaBatch ( Vector2f *resultR, Vector2f *resultG, Vector2f *resultB,
+                                                  DistortionRenderDesc const &distortion,
+                                                  const Vector2f *framebufferNDC, int count );
 Vector2f TransformTanFovSpaceToRendertargetTexUV ( ScaleAndOffset2D const &eyeToSourceUV,
                                                    Vector2f const &tanEyeAngle );
 Vector2f TransformTanFovSpaceToRendertargetNDC ( ScaleAndOffset2D const &eyeToSourceNDC,
@@ -661,6 +760,8 @@ Vector2f TransformScreenPixelToRendertargetTexUV( Recti const &distortionViewpor
 // Be aware that many of these are significantly slower than their forward-mapping counterparts.
 Vector2f TransformTanFovSpaceToScreenNDC( DistortionRenderDesc const &distortion,
                                           const Vector2f &tanEyeAngle, bool usePolyApprox = false );
+void TransformTanFovSpaceToScreenNDCBatch( Vector2f *framebufferNDC, DistortionRenderDesc const &distortion,
+                                           const Vector2f *tanEyeAngle, int count, bool usePolyApprox = false );
 Vector2f TransformRendertargetNDCToTanFovSpace( const ScaleAndOffset2D &eyeToSourceNDC,
                                                 const Vector2f &textureNDC );
 
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "Service_NetClient.h"
 #include "../Net/OVR_MessageIDTypes.h"
+#include <limits>
 
 #if defined (OVR_OS_MAC) || defined(OVR_OS_LINUX)
 #define GetCurrentProcessId getpid
@@ -101,6 +102,10 @@ void NetClient::OnDisconnected(Connection* conn)
     OVR_DEBUG_LOG(("[NetClient] Disconnected"));
 
     EdgeTriggeredHMDCount = false;
+
+    // Values may change while we are not listening
+    SharedProperties.SetEnabled(false);
+    InvalidatePropertyCache();
 }
 
 void NetClient::OnConnected(Connection* conn)
@@ -112,6 +117,12 @@ void NetClient::OnConnected(Connection* conn)
         RPCVersion_Major, RPCVersion_Minor, RPCVersion_Patch));
 
     EdgeTriggeredHMDCount = false;
+
+    InvalidatePropertyCache();
+
+    // Services that do not publish the region are read through RPC only
+    SharedProperties.Open();
+    SharedProperties.SetEnabled(true);
 }
 
 bool NetClient::Connect(bool blocking)
@@ -200,6 +211,11 @@ const char* NetClient::GetStringValue(VirtualHmdId hmd, const char* key, const c
 
     ProfileGetValue1_Str = default_val;
 
+    if (SharedProperties.GetString(hmd, key, ProfileGetValue1_Str))
+    {
+        return ProfileGetValue1_Str.ToCStr();
+    }
+
     OVR::Net::BitStream bsOut, returnData;
     bsOut.Write(hmd);
     bsOut.Write(key);
@@ -221,6 +237,12 @@ bool NetClient::GetBoolValue(VirtualHmdId hmd, const char* key, bool default_val
         return default_val;
     }
 
+    double shared = default_val ? 1. : 0.;
+    if (SharedProperties.GetNumber(hmd, key, shared))
+    {
+        return shared != 0.;
+    }
+
     OVR::Net::BitStream bsOut, returnData;
     bsOut.Write(hmd);
     bsOut.Write(key);
@@ -243,6 +265,12 @@ int NetClient::GetIntValue(VirtualHmdId hmd, const char* key, int default_val)
         return default_val;
     }
 
+    double shared = default_val;
+    if (SharedProperties.GetNumber(hmd, key, shared))
+    {
+        return (int)shared;
+    }
+
     OVR::Net::BitStream bsOut, returnData;
     bsOut.Write(hmd);
     bsOut.Write(key);
@@ -265,6 +293,12 @@ double NetClient::GetNumberValue(VirtualHmdId hmd, const char* key, double defau
         return default_val;
     }
 
+    double shared = default_val;
+    if (SharedProperties.GetNumber(hmd, key, shared))
+    {
+        return shared;
+    }
+
     OVR::Net::BitStream bsOut, returnData;
     bsOut.Write(hmd);
     bsOut.Write(key);
@@ -284,6 +318,12 @@ int NetClient::GetNumberValues(VirtualHmdId hmd, const char* key, double* values
         return 0;
     }
 
+    int sharedCount = 0;
+    if (SharedProperties.GetNumbers(hmd, key, values, num_vals, sharedCount))
+    {
+        return sharedCount;
+    }
+
     OVR::Net::BitStream bsOut, returnData;
     bsOut.Write(hmd);
     bsOut.Write(key);
@@ -405,6 +445,16 @@ bool NetClient::SetNumberValue(VirtualHmdId hmd, const char* key, double val)
         return false;
     }
 
+    // The service may clamp or reject the value, so refetch it on the next read
+    {
+        Lock::Locker locker(&PropertyCacheLock);
+        const PropertyId* id = PropertyIds.Get(String(FilterKeyPrefix(key)));
+        if (id)
+        {
+            invalidateNumberValue(getPropertyCacheKey(hmd, *id));
+        }
+    }
+
     return true;
 }
 
@@ -435,6 +485,188 @@ bool NetClient::SetNumberValues(VirtualHmdId hmd, const char* key, const double*
     return true;
 }
 
+NetClient::PropertyId NetClient::InternPropertyKey(const char* key)
+{
+    String keyStr(FilterKeyPrefix(key));
+
+    Lock::Locker locker(&PropertyCacheLock);
+    const PropertyId* id = PropertyIds.Get(keyStr);
+    if (id)
+    {
+        return *id;
+    }
+
+    PropertyId newId = (PropertyId)PropertyIds.GetSize();
+    PropertyIds.Set(keyStr, newId);
+    return newId;
+}
+
+bool NetClient::isPropertyCacheEnabled()
+{
+    Ptr<Connection> conn = GetSession()->GetConnectionAtIndex(0);
+    return conn && (conn->RemoteCapabilities & RPCCapability_PropertyChanged) != 0;
+}
+
+uint32_t NetClient::beginNumberValueFetch(uint64_t cacheKey)
+{
+    CachedNumber* entry = NumberValueCache.Get(cacheKey);
+    if (!entry)
+    {
+        NumberValueCache.Set(cacheKey, CachedNumber());
+        entry = NumberValueCache.Get(cacheKey);
+    }
+    return entry->Generation;
+}
+
+void NetClient::endNumberValueFetch(uint64_t cacheKey, uint32_t generation, double value)
+{
+    // Invalidated while the call was in flight: the reply may predate the change
+    CachedNumber* entry = NumberValueCache.Get(cacheKey);
+    if (entry && entry->Generation == generation)
+    {
+        entry->Value = value;
+        entry->Valid = true;
+    }
+}
+
+void NetClient::invalidateNumberValue(uint64_t cacheKey)
+{
+    CachedNumber* entry = NumberValueCache.Get(cacheKey);
+    if (entry)
+    {
+        entry->Valid = false;
+        ++entry->Generation;
+    }
+}
+
+bool NetClient::fetchNumberValue(VirtualHmdId hmd, const char* key, PropertyId id, double& value)
+{
+    // Reconnecting is left to Hmd_Detect() and the other calls: a read must not block on it
+    if (!IsConnected(false, false))
+    {
+        return false;
+    }
+
+    bool cacheable = isPropertyCacheEnabled();
+    uint64_t cacheKey = getPropertyCacheKey(hmd, id);
+    uint32_t generation = 0;
+    if (cacheable)
+    {
+        Lock::Locker locker(&PropertyCacheLock);
+        generation = beginNumberValueFetch(cacheKey);
+    }
+
+    // NaN as the default tells "no value on the service" apart from any real value
+    const double unset = std::numeric_limits<double>::quiet_NaN();
+
+    OVR::Net::BitStream bsOut, returnData;
+    bsOut.Write(hmd);
+    bsOut.Write(key);
+    bsOut.Write(unset);
+    if (!GetRPC1()->CallBlocking("GetNumberValue_1", &bsOut, GetSession()->GetConnectionAtIndex(0), &returnData) ||
+        !returnData.Read(value))
+    {
+        return false;
+    }
+
+    if (cacheable)
+    {
+        Lock::Locker locker(&PropertyCacheLock);
+        endNumberValueFetch(cacheKey, generation, value);
+    }
+    return true;
+}
+
+double NetClient::GetCachedNumberValue(VirtualHmdId hmd, const char* key, double default_val)
+{
+    // Published values are always current, and cheaper to read than the cache
+    double value = default_val;
+    if (SharedProperties.GetNumber(hmd, key, value))
+    {
+        return value;
+    }
+
+    PropertyId id = InternPropertyKey(key);
+
+    bool cached = false;
+    {
+        Lock::Locker locker(&PropertyCacheLock);
+        const CachedNumber* entry = NumberValueCache.Get(getPropertyCacheKey(hmd, id));
+        if (entry && entry->Valid)
+        {
+            value = entry->Value;
+            cached = true;
+        }
+    }
+
+    if (!cached && !fetchNumberValue(hmd, key, id, value))
+    {
+        return default_val; // Not cached, so the next read tries again
+    }
+
+    return (value != value) ? default_val : value;
+}
+
+void NetClient::PrefetchNumberValues(VirtualHmdId hmd)
+{
+    // Nothing would be kept from a service that does not push changes
+    if (!IsConnected(true, true) || !isPropertyCacheEnabled())
+    {
+        return;
+    }
+
+    // All of them in one round trip
+    const char** keys = GetServicePropertyKeys(EGetNumberValue);
+    const double unset = std::numeric_limits<double>::quiet_NaN();
+    Array<uint64_t> cacheKeys;
+    Array<uint32_t> generations;
+    Net::Plugins::RPCBatch batch;
+    for (int i = 0; keys[i]; ++i)
+    {
+        OVR::Net::BitStream bsOut;
+        bsOut.Write(hmd);
+        bsOut.Write(keys[i]);
+        bsOut.Write(unset);
+        batch.Add("GetNumberValue_1", &bsOut);
+        cacheKeys.PushBack(getPropertyCacheKey(hmd, InternPropertyKey(keys[i])));
+    }
+
+    {
+        Lock::Locker locker(&PropertyCacheLock);
+        for (int i = 0; i < cacheKeys.GetSizeI(); ++i)
+        {
+            generations.PushBack(beginNumberValueFetch(cacheKeys[i]));
+        }
+    }
+
+    if (!GetRPC1()->CallBatch(&batch, GetSession()->GetConnectionAtIndex(0)))
+    {
+        return;
+    }
+
+    Lock::Locker locker(&PropertyCacheLock);
+    for (int i = 0; i < batch.GetCount(); ++i)
+    {
+        OVR::Net::BitStream returnData;
+        double value = 0.;
+        if (batch.GetResult(i, &returnData) && returnData.Read(value))
+        {
+            endNumberValueFetch(cacheKeys[i], generations[i], value);
+        }
+    }
+}
+
+void NetClient::InvalidatePropertyCache()
+{
+    // Entries are kept so that the fetches in flight see their generation change
+    Lock::Locker locker(&PropertyCacheLock);
+    for (Hash<uint64_t, CachedNumber>::Iterator it = NumberValueCache.Begin(); it != NumberValueCache.End(); ++it)
+    {
+        it->Second.Valid = false;
+        ++it->Second.Generation;
+    }
+}
+
 int NetClient::Hmd_Detect()
 {
     if (!IsConnected(true, false))
@@ -653,6 +885,12 @@ unsigned int NetClient::Hmd_GetEnabledCaps(VirtualHmdId hmd)
         return 0;
     }
 
+    double caps = 0.;
+    if (SharedProperties.GetNumber(hmd, SharedPropertyKey_EnabledCaps, caps))
+    {
+        return (unsigned int)caps;
+    }
+
 	OVR::Net::BitStream bsOut, returnData;
 	bsOut.Write(hmd);
 	if (!GetRPC1()->CallBlocking("Hmd_GetEnabledCaps_1", &bsOut, GetSession()->GetConnectionAtIndex(0), &returnData))
@@ -784,6 +1022,11 @@ const char* NetClient::LatencyUtil_GetResultsString()
         return NULL;
     }
 
+    if (SharedProperties.GetString(InvalidVirtualHmdId, SharedPropertyKey_LatencyTestResults, LatencyUtil_GetResultsString_Str))
+    {
+        return LatencyUtil_GetResultsString_Str.ToCStr();
+    }
+
     OVR::Net::BitStream bsOut, returnData;
     if (!GetRPC1()->CallBlocking("LatencyUtil_GetResultsString_1", &bsOut, GetSession()->GetConnectionAtIndex(0), &returnData))
     {
@@ -824,6 +1067,7 @@ void NetClient::registerRPC()
     RPC_REGISTER_SLOT(LatencyTesterAvailableScope, LatencyTesterAvailable_1);
     RPC_REGISTER_SLOT(DefaultLogOutputScope, DefaultLogOutput_1);
     RPC_REGISTER_SLOT(HMDCountUpdateScope, HMDCountUpdate_1);
+    RPC_REGISTER_SLOT(PropertyChangedScope, PropertyChanged_1);
 }
 
 void NetClient::InitialServerState_1(BitStream* userData, ReceivePayload* pPayload)
@@ -878,5 +1122,32 @@ void NetClient::HMDCountUpdate_1(BitStream* userData, ReceivePayload* pPayload)
     EdgeTriggeredHMDCount = true;
 }
 
+void NetClient::PropertyChanged_1(BitStream* userData, ReceivePayload* pPayload)
+{
+    OVR_UNUSED(pPayload);
+
+    VirtualHmdId hmd = InvalidVirtualHmdId;
+    String key;
+    userData->Read(hmd);
+    if (!userData->Read(key))
+    {
+        OVR_ASSERT(false);
+        return;
+    }
+
+    if (key.IsEmpty())
+    {
+        InvalidatePropertyCache();
+        return;
+    }
+
+    Lock::Locker locker(&PropertyCacheLock);
+    const PropertyId* id = PropertyIds.Get(key);
+    if (id)
+    {
+        invalidateNumberValue(getPropertyCacheKey(hmd, *id));
+    }
+}
+
 
 }} // namespace OVR::Service
@@ -29,6 +29,7 @@ limitations under the License.
 
 #include "../Net/OVR_NetworkTypes.h"
 #include "Service_NetSessionCommon.h"
+#include "Service_SharedProperties.h"
 #include "../Kernel/OVR_System.h"
 #include "../OVR_CAPI.h"
 #include "../Util/Util_Render_Stereo.h"
@@ -84,6 +85,18 @@ public:
     bool         SetNumberValue(VirtualHmdId hmd, const char* key, double val);
     bool         SetNumberValues(VirtualHmdId hmd, const char* key, const double* vals, int num_vals);
 
+    // Cached number values, for properties read every frame: a hit is a hash lookup with no
+    // round trip to the service. Keys are interned to small ids once. Values are only kept when
+    // the service advertises RPCCapability_PropertyChanged, i.e. pushes PropertyChanged_1 when
+    // one changes; otherwise every read not served by the shared properties is a GetNumberValue_1.
+    // Entries are filled on first use or by PrefetchNumberValues() at HMD creation, and dropped by
+    // SetNumberValue(), PropertyChanged_1 and connection changes. A miss never reconnects.
+    typedef int32_t PropertyId;
+    PropertyId   InternPropertyKey(const char* key);
+    double       GetCachedNumberValue(VirtualHmdId hmd, const char* key, double default_val);
+    void         PrefetchNumberValues(VirtualHmdId hmd);
+    void         InvalidatePropertyCache();
+
     bool         GetDriverMode(bool& driverInstalled, bool& compatMode, bool& hideDK1Mode);
     bool         SetDriverMode(bool compatMode, bool hideDK1Mode);
 
@@ -125,6 +138,35 @@ protected:
     String       LatencyUtil_GetResultsString_Str;
     String       ProfileGetValue1_Str, ProfileGetValue3_Str;
 
+    // Property cache, shared by the API threads and the NetClient thread (push notifications)
+    Lock         PropertyCacheLock;
+    Hash<String, PropertyId, String::HashFunctor> PropertyIds;
+
+    // Generation changes with every invalidation of the entry, so that a fetch which raced with
+    // one (the reply was sent before the change) does not store its stale value.
+    struct CachedNumber
+    {
+        CachedNumber() : Value(0.), Valid(false), Generation(0) { }
+        double   Value;                             // NaN when the service has none
+        bool     Valid;
+        uint32_t Generation;
+    };
+    Hash<uint64_t, CachedNumber> NumberValueCache;  // (hmd << 32 | PropertyId) -> value
+
+    // Values published by the service in shared memory, read before any RPC.
+    // Opened on the first connection and enabled while connected.
+    SharedPropertyReader SharedProperties;
+
+    static uint64_t getPropertyCacheKey(VirtualHmdId hmd, PropertyId id)
+    {
+        return ((uint64_t)(uint32_t)hmd << 32) | (uint32_t)id;
+    }
+    bool         isPropertyCacheEnabled();
+    uint32_t     beginNumberValueFetch(uint64_t cacheKey);                        // Call with PropertyCacheLock held
+    void         endNumberValueFetch(uint64_t cacheKey, uint32_t generation, double value); // Call with PropertyCacheLock held
+    void         invalidateNumberValue(uint64_t cacheKey);                        // Call with PropertyCacheLock held
+    bool         fetchNumberValue(VirtualHmdId hmd, const char* key, PropertyId id, double& value);
+
 protected:
     //// Push Notifications:
 
@@ -141,6 +183,11 @@ protected:
 
     ObserverScope<Net::Plugins::RPCSlot> HMDCountUpdateScope;
     void HMDCountUpdate_1(BitStream* userData, ReceivePayload* pPayload);
+
+    // Sent by the service when a persistent value changes (hmd, key), so cached copies are dropped.
+    // An empty key invalidates every cached value.
+    ObserverScope<Net::Plugins::RPCSlot> PropertyChangedScope;
+    void PropertyChanged_1(BitStream* userData, ReceivePayload* pPayload);
 };
 
 
@@ -323,6 +323,12 @@ const char *NetSessionCommon::FilterKeyPrefix(const char* key)
     return key;
 }
 
+const char** NetSessionCommon::GetServicePropertyKeys(EGetterSetters e)
+{
+    static const char* noKeys[] = { 0 };
+    return (e >= 0 && e < ENumTypes) ? KeyNames[e] : noKeys;
+}
+
 bool NetSessionCommon::IsServiceProperty(EGetterSetters e, const char* key)
 {
     if ((e >= 0 && e < ENumTypes) && IsInStringArray(KeyNames[e], key))
@@ -129,6 +129,8 @@ public:
 
     static const char* FilterKeyPrefix(const char* key);
     static bool IsServiceProperty(EGetterSetters e, const char* key);
+    // Null-terminated list of the keys handled by the service for e (without the bypass prefix)
+    static const char** GetServicePropertyKeys(EGetterSetters e);
 
 protected:
     bool                Terminated; // Thread termination flag
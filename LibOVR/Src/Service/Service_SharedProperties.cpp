@@ -0,0 +1,449 @@
+/************************************************************************************
+
+Filename    :   Service_SharedProperties.cpp
+Content     :   Shared memory key/value region published by the service
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#include "Service_SharedProperties.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_Log.h"
+#include <limits>
+
+namespace OVR { namespace Service {
+
+using namespace OVR::Net;
+
+
+//-------------------------------------------------------------------------------------
+// SharedPropertyRegion
+
+SharedPropertyRegion::SharedPropertyRegion() :
+    FormatVersion(CurrentFormatVersion),
+    MaxEntries(SharedProperty_MaxEntries),
+    EntryCount(0)
+{
+    for (int i = 0; i < SharedProperty_MaxEntries; ++i)
+    {
+        Entries[i].Version = 0;
+        Entries[i].Hmd = InvalidVirtualHmdId;
+        Entries[i].KeyHash = 0;
+        Entries[i].Key[0] = '\0';
+        Entries[i].Value.Type = SharedPropertyType_None;
+        Entries[i].Value.Count = 0;
+    }
+}
+
+uint32_t SharedPropertyRegion::GetKeyHash(const char* key)
+{
+    // The low 32 bits are the same for 32-bit and 64-bit processes
+    return (uint32_t)String::BernsteinHashFunction(key, OVR_strlen(key));
+}
+
+
+//-------------------------------------------------------------------------------------
+// SharedPropertyWriter
+
+bool SharedPropertyWriter::Open(const char* name)
+{
+    return Region.Open(name);
+}
+
+SharedPropertyEntry* SharedPropertyWriter::findOrAddEntry(VirtualHmdId hmd, const char* key)
+{
+    SharedPropertyRegion* region = Region.Get();
+    if (!region || OVR_strlen(key) >= SharedProperty_MaxKeySize)
+    {
+        return NULL;
+    }
+
+    uint32_t hash = SharedPropertyRegion::GetKeyHash(key);
+    int count = region->EntryCount.Load_Acquire();
+    for (int i = 0; i < count; ++i)
+    {
+        SharedPropertyEntry& entry = region->Entries[i];
+        if (entry.KeyHash == hash && entry.Hmd == hmd && strcmp(entry.Key, key) == 0)
+        {
+            return &entry;
+        }
+    }
+
+    if (count >= SharedProperty_MaxEntries)
+    {
+        return NULL;
+    }
+
+    // Readers do not look at the new entry before EntryCount includes it
+    SharedPropertyEntry& entry = region->Entries[count];
+    entry.Hmd = hmd;
+    entry.KeyHash = hash;
+    OVR_strcpy(entry.Key, sizeof(entry.Key), key);
+    entry.Value.Type = SharedPropertyType_None;
+    entry.Value.Count = 0;
+    region->EntryCount.ExchangeAdd_Sync(1);
+    return &entry;
+}
+
+bool SharedPropertyWriter::setValue(VirtualHmdId hmd, const char* key, const SharedPropertyValue& value)
+{
+    Lock::Locker locker(&WriteLock);
+
+    SharedPropertyEntry* entry = findOrAddEntry(hmd, NetSessionCommon::FilterKeyPrefix(key));
+    if (!entry)
+    {
+        return false;
+    }
+
+    entry->Version.ExchangeAdd_Sync(1);
+    entry->Value = value;
+    entry->Version.ExchangeAdd_Sync(1);
+    return true;
+}
+
+bool SharedPropertyWriter::SetNumbers(VirtualHmdId hmd, const char* key, const double* values, int count)
+{
+    SharedPropertyValue value;
+    if (count < 0 || count > SharedProperty_MaxNumbers)
+    {
+        // Stale values must not stay visible, so the readers go to the service instead
+        SetNone(hmd, key);
+        return false;
+    }
+
+    value.Type = SharedPropertyType_Numbers;
+    value.Count = count;
+    for (int i = 0; i < count; ++i)
+    {
+        value.Numbers[i] = values[i];
+    }
+    return setValue(hmd, key, value);
+}
+
+bool SharedPropertyWriter::SetString(VirtualHmdId hmd, const char* key, const char* str)
+{
+    SharedPropertyValue value;
+    size_t length = str ? OVR_strlen(str) : 0;
+    if (length >= SharedProperty_MaxStringSize)
+    {
+        SetNone(hmd, key);
+        return false;
+    }
+
+    value.Type = SharedPropertyType_String;
+    value.Count = (int32_t)length;
+    memcpy(value.String, str ? str : "", length + 1);
+    return setValue(hmd, key, value);
+}
+
+bool SharedPropertyWriter::SetNone(VirtualHmdId hmd, const char* key)
+{
+    SharedPropertyValue value;
+    value.Type = SharedPropertyType_None;
+    value.Count = 0;
+    return setValue(hmd, key, value);
+}
+
+
+//-------------------------------------------------------------------------------------
+// SharedPropertyReader
+
+SharedPropertyReader::SharedPropertyReader() :
+    Enabled(0),
+    Valid(false)
+{
+}
+
+bool SharedPropertyReader::Open(const char* name)
+{
+    if (Valid)
+    {
+        return true;
+    }
+
+    if (!Region.Open(name))
+    {
+        return false;
+    }
+
+    const SharedPropertyRegion* region = Region.Get();
+    if (region->FormatVersion != SharedPropertyRegion::CurrentFormatVersion ||
+        region->MaxEntries != SharedProperty_MaxEntries)
+    {
+        LogError("[SharedProperties] Unexpected region format %d, reading through RPC", region->FormatVersion);
+        return false;
+    }
+
+    Valid = true;
+    return true;
+}
+
+void SharedPropertyReader::SetEnabled(bool enabled)
+{
+    Enabled = (enabled && IsOpen()) ? 1 : 0;
+}
+
+const SharedPropertyEntry* SharedPropertyReader::findEntry(VirtualHmdId hmd, const char* key) const
+{
+    const SharedPropertyRegion* region = Region.Get();
+    uint32_t hash = SharedPropertyRegion::GetKeyHash(key);
+
+    // Entries are never removed nor moved, so the scan needs no versioning
+    int count = Alg::Min(region->EntryCount.Load_Acquire(), (int)SharedProperty_MaxEntries);
+    for (int i = 0; i < count; ++i)
+    {
+        const SharedPropertyEntry& entry = region->Entries[i];
+        if (entry.KeyHash == hash && entry.Hmd == hmd && strcmp(entry.Key, key) == 0)
+        {
+            return &entry;
+        }
+    }
+
+    return NULL;
+}
+
+// Load_Acquire only keeps the loads that follow it from moving up, so it does not stop the
+// plain copy of an entry from being reordered after the second version check.
+static inline void loadFence()
+{
+#if defined(OVR_CC_MSVC)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+bool SharedPropertyReader::readValue(VirtualHmdId hmd, const char* key, SharedPropertyValue& value) const
+{
+    if (!Enabled.Load_Acquire())
+    {
+        return false;
+    }
+
+    const SharedPropertyEntry* entry = findEntry(hmd, NetSessionCommon::FilterKeyPrefix(key));
+    if (!entry)
+    {
+        return false;
+    }
+
+    // Copy the value out, and again if the writer was in the middle of it. A writer that keeps
+    // the entry busy (or died halfway through an update) must not hang the reader: after a few
+    // attempts the caller falls back to the RPC path.
+    const AtomicInt<int>& version = entry->Version;
+    int attempt = 0;
+    for (;;)
+    {
+        if (++attempt > SharedProperty_MaxReadAttempts)
+        {
+            return false;
+        }
+
+        int begin = version.Load_Acquire();
+        if ((begin & 1) == 0)
+        {
+            value = entry->Value;
+            loadFence(); // The copy above must complete before the version is read again
+            if (version.Load_Acquire() == begin)
+            {
+                break;
+            }
+        }
+    }
+
+    // Clamp anything a misbehaving writer may have left
+    if (value.Type == SharedPropertyType_Numbers)
+    {
+        value.Count = Alg::Clamp(value.Count, 0, (int32_t)SharedProperty_MaxNumbers);
+    }
+    else if (value.Type == SharedPropertyType_String)
+    {
+        value.Count = Alg::Clamp(value.Count, 0, (int32_t)SharedProperty_MaxStringSize - 1);
+        value.String[value.Count] = '\0';
+    }
+    return true;
+}
+
+bool SharedPropertyReader::GetNumbers(VirtualHmdId hmd, const char* key, double* values, int maxCount, int& count) const
+{
+    SharedPropertyValue value;
+    if (!readValue(hmd, key, value))
+    {
+        return false;
+    }
+
+    count = 0;
+    if (value.Type == SharedPropertyType_Numbers)
+    {
+        count = Alg::Min((int)value.Count, maxCount);
+        for (int i = 0; i < count; ++i)
+        {
+            values[i] = value.Numbers[i];
+        }
+    }
+    return value.Type != SharedPropertyType_String;
+}
+
+bool SharedPropertyReader::GetNumber(VirtualHmdId hmd, const char* key, double& number) const
+{
+    SharedPropertyValue value;
+    if (!readValue(hmd, key, value) || value.Type == SharedPropertyType_String)
+    {
+        return false;
+    }
+
+    if (value.Type == SharedPropertyType_Numbers && value.Count > 0)
+    {
+        number = value.Numbers[0];
+    }
+    return true;
+}
+
+bool SharedPropertyReader::GetString(VirtualHmdId hmd, const char* key, String& str) const
+{
+    SharedPropertyValue value;
+    if (!readValue(hmd, key, value) || value.Type == SharedPropertyType_Numbers)
+    {
+        return false;
+    }
+
+    if (value.Type == SharedPropertyType_String)
+    {
+        str = value.String;
+    }
+    return true;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Benchmark
+
+// Stands in for the service: publishes its values in a region and answers GetNumberValue_1 from the same values
+class SharedPropertiesStandIn : public Net::Plugins::LoopbackEndpoint
+{
+public:
+    SharedPropertiesStandIn() :
+        LoopbackEndpoint(true)
+    {
+    }
+
+    bool Publish(const char* name, VirtualHmdId hmd, const char* key, double value)
+    {
+        Values.Set(String(key), value);
+        return (Writer.Open(name) && Writer.SetNumber(hmd, key, value));
+    }
+
+    void GetNumberValue_1(BitStream* userData, BitStream* returnData, ReceivePayload* pPayload)
+    {
+        OVR_UNUSED(pPayload);
+
+        VirtualHmdId hmd = InvalidVirtualHmdId;
+        String key;
+        double defaultValue = 0.;
+        userData->Read(hmd);
+        userData->Read(key);
+        userData->Read(defaultValue);
+
+        double value = defaultValue;
+        Values.Get(key, &value);
+        returnData->Write(value);
+    }
+
+protected:
+    SharedPropertyWriter                     Writer;
+    Hash<String, double, String::HashFunctor> Values;
+};
+
+bool RunSharedPropertiesBenchmark(int readCount, uint16_t port,
+                                  Net::Plugins::RPC1BenchmarkResult& sharedResult,
+                                  Net::Plugins::RPC1BenchmarkResult& rpcResult)
+{
+    memset(&sharedResult, 0, sizeof(sharedResult));
+    memset(&rpcResult, 0, sizeof(rpcResult));
+
+    static const char* regionName = "OVRServicePropertiesBenchmark";
+    const VirtualHmdId hmd = 0;
+    const char* key = "IPD";
+    const double unset = std::numeric_limits<double>::quiet_NaN();
+
+    SharedPropertiesStandIn server;
+    Net::Plugins::LoopbackEndpoint client(false);
+    if (!server.Publish(regionName, hmd, key, 0.064))
+    {
+        LogError("[SharedProperties Benchmark] Cannot create the region %s", regionName);
+        return false;
+    }
+    server.Rpc.RegisterBlockingFunction("GetNumberValue_1",
+        Net::Plugins::RPCDelegate::FromMember<SharedPropertiesStandIn, &SharedPropertiesStandIn::GetNumberValue_1>(&server));
+
+    Ptr<Connection> connection = Net::Plugins::ConnectLoopbackEndpoints(server, client, port);
+    SharedPropertyReader reader;
+    if (!connection || !reader.Open(regionName))
+    {
+        return false;
+    }
+    reader.SetEnabled(true);
+
+    Array<double> latencies;
+    latencies.Reserve(readCount);
+
+    // Shared memory
+    double sum = 0.;
+    double start = Timer::GetSeconds();
+    for (int i = 0; i < readCount; ++i)
+    {
+        double value = unset;
+        double readStart = Timer::GetSeconds();
+        reader.GetNumber(hmd, key, value);
+        latencies.PushBack(Timer::GetSeconds() - readStart);
+        sum += value;
+    }
+    Net::Plugins::ComputeRPC1BenchmarkResult(latencies, Timer::GetSeconds() - start, sharedResult);
+
+    // The same reads as NetClient::GetNumberValue() makes them over TCP
+    latencies.Clear();
+    start = Timer::GetSeconds();
+    for (int i = 0; i < readCount; ++i)
+    {
+        BitStream bsOut, returnData;
+        bsOut.Write(hmd);
+        bsOut.Write(key);
+        bsOut.Write(unset);
+        double value = unset;
+        double readStart = Timer::GetSeconds();
+        if (client.Rpc.CallBlocking("GetNumberValue_1", &bsOut, connection, &returnData))
+        {
+            returnData.Read(value);
+        }
+        latencies.PushBack(Timer::GetSeconds() - readStart);
+        sum += value;
+    }
+    Net::Plugins::ComputeRPC1BenchmarkResult(latencies, Timer::GetSeconds() - start, rpcResult);
+
+    LogText("[SharedProperties Benchmark] Shared memory %10.0f reads/s, mean %.6f ms, p99 %.6f ms\n",
+            sharedResult.CallsPerSecond, sharedResult.MeanLatencySeconds * 1000., sharedResult.P99LatencySeconds * 1000.);
+    LogText("[SharedProperties Benchmark] RPC over TCP  %10.0f reads/s, mean %.6f ms, p99 %.6f ms (checksum %f)\n",
+            rpcResult.CallsPerSecond, rpcResult.MeanLatencySeconds * 1000., rpcResult.P99LatencySeconds * 1000., sum);
+
+    return true;
+}
+
+
+}} // namespace OVR::Service
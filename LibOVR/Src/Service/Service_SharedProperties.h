@@ -0,0 +1,172 @@
+/************************************************************************************
+
+PublicHeader:   n/a
+Filename    :   Service_SharedProperties.h
+Content     :   Shared memory key/value region published by the service
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#ifndef OVR_Service_SharedProperties_h
+#define OVR_Service_SharedProperties_h
+
+#include "Service_NetSessionCommon.h"
+#include "../Net/OVR_RPC1_Benchmark.h"
+#include "../Kernel/OVR_SharedMemory.h"
+#include "../Kernel/OVR_Atomic.h"
+#include "../Kernel/OVR_Threads.h"
+#include "../Kernel/OVR_String.h"
+
+namespace OVR { namespace Service {
+
+
+// The service publishes the values clients read most (persistent properties, enabled caps,
+// latency tester results) in a shared memory region, so a read is a few loads instead of an
+// RPC round trip. Keys are added once and never move; each entry has its own version
+// counter, odd while the service rewrites it, used like the LocklessUpdater counters.
+// A key that is not in the region is not published, and the client falls back to RPC.
+
+static const char* const SharedPropertiesName = "OVRServiceProperties";
+
+// Keys published alongside the persistent properties
+static const char* const SharedPropertyKey_EnabledCaps        = "EnabledCaps";         // Per HMD, number
+static const char* const SharedPropertyKey_LatencyTestResults = "LatencyTestResults";  // InvalidVirtualHmdId, string
+
+enum SharedPropertyLimits
+{
+    SharedProperty_MaxEntries      = 128,
+    SharedProperty_MaxKeySize      = 48,   // Including the terminator
+    SharedProperty_MaxNumbers      = 8,
+    SharedProperty_MaxStringSize   = 256,  // Including the terminator, longer strings are not published
+    SharedProperty_MaxReadAttempts = 64    // Copies of an entry tried before a reader gives up and uses RPC
+};
+
+enum SharedPropertyType
+{
+    SharedPropertyType_None,            // Published as having no value: the reader returns its default
+    SharedPropertyType_Numbers,         // Bool, int and number values are all stored as doubles
+    SharedPropertyType_String
+};
+
+// Layout shared by 32-bit and 64-bit processes: fixed size fields only
+struct SharedPropertyValue
+{
+    int32_t        Type;                // SharedPropertyType
+    int32_t        Count;               // Numbers: values used, String: length without the terminator
+    union
+    {
+        double     Numbers[SharedProperty_MaxNumbers];
+        char       String[SharedProperty_MaxStringSize];
+    };
+};
+
+struct SharedPropertyEntry
+{
+    AtomicInt<int> Version;             // Odd while Value is being written
+    int32_t        Hmd;                 // Hmd and Key are set once, before the entry is counted in EntryCount
+    uint32_t       KeyHash;
+    char           Key[SharedProperty_MaxKeySize];
+    SharedPropertyValue Value;
+};
+
+struct SharedPropertyRegion
+{
+    enum { CurrentFormatVersion = 1 };
+
+    SharedPropertyRegion();
+
+    int32_t        FormatVersion;
+    int32_t        MaxEntries;
+    AtomicInt<int> EntryCount;          // Entries [0, EntryCount) have their Hmd and Key set
+    SharedPropertyEntry Entries[SharedProperty_MaxEntries];
+
+    static uint32_t GetKeyHash(const char* key);
+};
+
+
+//-------------------------------------------------------------------------------------
+// SharedPropertyWriter
+
+// Used by the service, a single writer. Values that do not fit are not published.
+class SharedPropertyWriter : public NewOverrideBase
+{
+public:
+    bool Open(const char* name = SharedPropertiesName);
+
+    bool SetNumbers(VirtualHmdId hmd, const char* key, const double* values, int count);
+    bool SetNumber(VirtualHmdId hmd, const char* key, double value) { return SetNumbers(hmd, key, &value, 1); }
+    bool SetString(VirtualHmdId hmd, const char* key, const char* value);
+    bool SetNone(VirtualHmdId hmd, const char* key);
+
+protected:
+    SharedPropertyEntry* findOrAddEntry(VirtualHmdId hmd, const char* key);
+    bool setValue(VirtualHmdId hmd, const char* key, const SharedPropertyValue& value);
+
+    Lock                                       WriteLock;
+    SharedObjectWriter<SharedPropertyRegion>   Region;
+};
+
+
+//-------------------------------------------------------------------------------------
+// SharedPropertyReader
+
+// Used by NetClient. Getters are lock free and return false when the key is not published,
+// or when the region is disabled because the service is not connected. A key published with
+// no value returns true and leaves the output unchanged, so it should hold the default.
+class SharedPropertyReader : public NewOverrideBase
+{
+public:
+    SharedPropertyReader();
+
+    // The mapping is kept until destruction, so getters never race with an unmap
+    bool Open(const char* name = SharedPropertiesName);
+    bool IsOpen() const { return Valid; }
+
+    void SetEnabled(bool enabled);
+
+    bool GetNumbers(VirtualHmdId hmd, const char* key, double* values, int maxCount, int& count) const;
+    bool GetNumber(VirtualHmdId hmd, const char* key, double& value) const;
+    bool GetString(VirtualHmdId hmd, const char* key, String& value) const;
+
+protected:
+    const SharedPropertyEntry* findEntry(VirtualHmdId hmd, const char* key) const;
+    bool readValue(VirtualHmdId hmd, const char* key, SharedPropertyValue& value) const;
+
+    AtomicInt<int>                             Enabled;
+    bool                                       Valid;      // Open, and in the format of this build
+    SharedObjectReader<SharedPropertyRegion>   Region;
+};
+
+
+//-------------------------------------------------------------------------------------
+// Benchmark
+
+// Reads a number readCount times through a region and through GetNumberValue_1 calls, both
+// published by an in-process stand-in of the service listening on localhost at the given
+// port, and logs the results. Returns false if the region or the session could not be set up.
+bool RunSharedPropertiesBenchmark(int readCount, uint16_t port,
+                                  Net::Plugins::RPC1BenchmarkResult& sharedResult,
+                                  Net::Plugins::RPC1BenchmarkResult& rpcResult);
+
+
+}} // namespace OVR::Service
+
+#endif // OVR_Service_SharedProperties_h
@@ -0,0 +1,392 @@
+/************************************************************************************
+
+Filename    :   Util_DistortionMeshCache.cpp
+Content     :   On-disk cache of the generated distortion meshes
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_DistortionMeshCache.h"
+#include "../Kernel/OVR_CRC32.h"
+#include "../Kernel/OVR_MappedFile.h"
+#include "../Kernel/OVR_SysFile.h"
+#include "../Kernel/OVR_UTF8Util.h"
+
+#if defined(OVR_OS_WIN32)
+#include <windows.h>
+#else
+#include <stdio.h> // rename(), remove()
+#endif
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// ***** File layout
+
+// CacheFileHeader, then EntryCount CacheFileEntry, then the vertices and indices of each
+// entry, every array starting on a 16 byte boundary. Everything is in the byte order of
+// the machine that wrote it; the magic number does not match on any other.
+
+static const uint32_t CacheFileMagic = 0x4D44564F;   // "OVDM"
+
+// Bump whenever the file layout or the generated meshes change: files of any other
+// version are ignored and replaced on the next store.
+static const uint32_t CacheFileVersion = 1;
+
+struct CacheFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t VertexSize;
+    uint32_t EntryCount;
+};
+
+struct CacheFileEntry
+{
+    uint32_t Key;
+    uint32_t NumVertices;
+    uint32_t NumTriangles;
+    uint32_t DataChecksum;  // CacheDataChecksum of the vertices followed by the indices
+    uint32_t VertexOffset;
+    uint32_t IndexOffset;
+    uint32_t Reserved[2];
+};
+
+static inline uint32_t CacheFileAlign(uint32_t offset)
+{
+    return (offset + 15) & ~15u;
+}
+
+static inline uint32_t CacheEntryVertexBytes(const CacheFileEntry& entry)
+{
+    return entry.NumVertices * (uint32_t)sizeof(DistortionMeshVertexData);
+}
+
+static inline uint32_t CacheEntryIndexBytes(const CacheFileEntry& entry)
+{
+    return entry.NumTriangles * 3 * (uint32_t)sizeof(uint16_t);
+}
+
+// Fletcher style sums over 32 bit words, continuing from prevChecksum. The data is only
+// checked for damage, and CRC32_Calculate goes a byte at a time: it took longer over a
+// DK2 mesh than generating the mesh does.
+static uint32_t CacheDataChecksum(const void* data, uint32_t bytes, uint32_t prevChecksum = 0)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t       a = prevChecksum, b = 0;
+    uint32_t       i = 0;
+    for (; i + 4 <= bytes; i += 4)
+    {
+        uint32_t word;
+        memcpy(&word, p + i, sizeof(word));
+        a += word;
+        b += a;
+    }
+    for (; i < bytes; i++)
+    {
+        a += p[i];
+        b += a;
+    }
+    return (uint32_t)(a ^ (a >> 32)) ^ (uint32_t)((b ^ (b >> 32)) * 0x9E3779B1u);
+}
+
+// Returns the entry table of a mapped cache file, or NULL if it is not one this version
+// can read.
+static const CacheFileEntry* GetCacheFileEntries(const MappedFile& file, uint32_t* pEntryCount)
+{
+    const size_t size = file.GetSize();
+    if (size < sizeof(CacheFileHeader) || size > 0x7FFFFFFF)
+    {
+        return NULL;
+    }
+
+    const CacheFileHeader* header = (const CacheFileHeader*)file.GetData();
+    if (header->Magic != CacheFileMagic ||
+        header->Version != CacheFileVersion ||
+        header->VertexSize != sizeof(DistortionMeshVertexData) ||
+        header->EntryCount > DistortionMeshCache_MaxEntries ||
+        size < sizeof(CacheFileHeader) + header->EntryCount * sizeof(CacheFileEntry))
+    {
+        return NULL;
+    }
+
+    *pEntryCount = header->EntryCount;
+    return (const CacheFileEntry*)(header + 1);
+}
+
+// Checks the entry lies within the file; with checkData also that its data is intact.
+static bool ValidateCacheFileEntry(const MappedFile& file, const CacheFileEntry& entry, bool checkData)
+{
+    const uint64_t size = file.GetSize();
+    // A mesh indexed with uint16_t
+    if (entry.NumVertices == 0 || entry.NumVertices > 0x10000 ||
+        entry.NumTriangles == 0 || entry.NumTriangles > 0x100000 ||
+        (uint64_t)entry.VertexOffset + CacheEntryVertexBytes(entry) > size ||
+        (uint64_t)entry.IndexOffset + CacheEntryIndexBytes(entry) > size)
+    {
+        return false;
+    }
+
+    if (checkData)
+    {
+        uint32_t checksum = CacheDataChecksum(file.GetData() + entry.VertexOffset, CacheEntryVertexBytes(entry));
+        checksum = CacheDataChecksum(file.GetData() + entry.IndexOffset, CacheEntryIndexBytes(entry), checksum);
+        return checksum == entry.DataChecksum;
+    }
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** Key
+
+// Chains the CRC over each value in turn, so no padding bytes are ever included
+class CacheKeyBuilder
+{
+public:
+    CacheKeyBuilder() : CRC(0) { }
+
+    void AddBytes(const void* data, int bytes) { CRC = CRC32_Calculate(data, bytes, CRC); }
+    void Add(float value)                      { AddBytes(&value, sizeof(value)); }
+    void Add(int32_t value)                    { AddBytes(&value, sizeof(value)); }
+    void Add(const Vector2f& value)            { Add(value.x); Add(value.y); }
+    void AddArray(const float* values, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            Add(values[i]);
+        }
+    }
+
+    uint32_t CRC;
+};
+
+uint32_t DistortionMeshCacheKey ( bool rightEye, const HmdRenderInfo &hmdRenderInfo,
+                                  const DistortionRenderDesc &distortion, const FovPort &fov,
+                                  bool adaptive, float tolerancePixels )
+{
+    CacheKeyBuilder key;
+    key.Add((int32_t)CacheFileVersion);
+
+    const LensConfig& lens = distortion.Lens;
+    key.Add((int32_t)lens.Eqn);
+    key.AddArray(lens.K, LensConfig::NumCoefficients);
+    key.Add(lens.MaxR);
+    key.Add(lens.MetersPerTanAngleAtCenter);
+    key.AddArray(lens.ChromaticAberration, 4);
+    key.AddArray(lens.InvK, LensConfig::NumCoefficients);
+    key.Add(lens.MaxInvR);
+
+    key.Add(distortion.LensCenter);
+    key.Add(distortion.TanEyeAngleScale);
+    key.Add(distortion.PixelsPerTanAngleAtCenter);
+
+    key.Add((int32_t)hmdRenderInfo.HmdType);
+    key.Add((int32_t)hmdRenderInfo.ResolutionInPixels.w);
+    key.Add((int32_t)hmdRenderInfo.ResolutionInPixels.h);
+    key.Add(hmdRenderInfo.ScreenSizeInMeters.w);
+    key.Add(hmdRenderInfo.ScreenSizeInMeters.h);
+    key.Add(hmdRenderInfo.ScreenGapSizeInMeters);
+    key.Add((int32_t)hmdRenderInfo.Shutter.Type);
+
+    key.Add((int32_t)rightEye);
+    key.Add(fov.UpTan);
+    key.Add(fov.DownTan);
+    key.Add(fov.LeftTan);
+    key.Add(fov.RightTan);
+
+    key.Add((int32_t)adaptive);
+    key.Add(adaptive ? tolerancePixels : 0.0f);
+    return key.CRC;
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** Load and store
+
+bool DistortionMeshCacheLoad ( const char *path, uint32_t key,
+                               DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                               int *pNumVertices, int *pNumTriangles )
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        return false;
+    }
+
+    uint32_t              entryCount = 0;
+    const CacheFileEntry* entries    = GetCacheFileEntries(file, &entryCount);
+    if (!entries)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < entryCount; i++)
+    {
+        const CacheFileEntry& entry = entries[i];
+        if (entry.Key != key)
+        {
+            continue;
+        }
+        if (!ValidateCacheFileEntry(file, entry, true))
+        {
+            return false;
+        }
+
+        const uint32_t vertexBytes = CacheEntryVertexBytes(entry);
+        const uint32_t indexBytes  = CacheEntryIndexBytes(entry);
+        DistortionMeshVertexData* pVertices = (DistortionMeshVertexData*) OVR_ALLOC( vertexBytes );
+        uint16_t*                 pIndices  = (uint16_t*) OVR_ALLOC( indexBytes );
+        if (!pVertices || !pIndices)
+        {
+            DistortionMeshDestroy(pVertices, pIndices);
+            return false;
+        }
+        memcpy(pVertices, file.GetData() + entry.VertexOffset, vertexBytes);
+        memcpy(pIndices,  file.GetData() + entry.IndexOffset,  indexBytes);
+
+        *ppVertices            = pVertices;
+        *ppTriangleListIndices = pIndices;
+        *pNumVertices          = (int)entry.NumVertices;
+        *pNumTriangles         = (int)entry.NumTriangles;
+        return true;
+    }
+
+    return false;
+}
+
+// Moves the file at from over the file at to
+static bool ReplaceCacheFile(const String& from, const String& to)
+{
+#if defined(OVR_OS_WIN32)
+    wchar_t* pwfrom = (wchar_t*)OVR_ALLOC((UTF8Util::GetLength(from.ToCStr()) + 1) * sizeof(wchar_t));
+    wchar_t* pwto   = (wchar_t*)OVR_ALLOC((UTF8Util::GetLength(to.ToCStr()) + 1) * sizeof(wchar_t));
+    bool     result = false;
+    if (pwfrom && pwto)
+    {
+        UTF8Util::DecodeString(pwfrom, from.ToCStr());
+        UTF8Util::DecodeString(pwto, to.ToCStr());
+        result = ::MoveFileExW(pwfrom, pwto, MOVEFILE_REPLACE_EXISTING) != FALSE;
+        if (!result)
+        {
+            ::DeleteFileW(pwfrom);
+        }
+    }
+    OVR_FREE(pwfrom);
+    OVR_FREE(pwto);
+    return result;
+#else
+    if (::rename(from.ToCStr(), to.ToCStr()) != 0)
+    {
+        ::remove(from.ToCStr());
+        return false;
+    }
+    return true;
+#endif
+}
+
+bool DistortionMeshCacheStore ( const char *path, uint32_t key,
+                                const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                int numVertices, int numTriangles )
+{
+    if (!pVertices || !pTriangleListIndices || numVertices <= 0 || numVertices > 0x10000 ||
+        numTriangles <= 0 || numTriangles > 0x100000)
+    {
+        return false;
+    }
+
+    // The new entry first, then whatever is still usable in the current file
+    CacheFileEntry entries[DistortionMeshCache_MaxEntries];
+    memset(entries, 0, sizeof(entries));
+    entries[0].Key          = key;
+    entries[0].NumVertices  = (uint32_t)numVertices;
+    entries[0].NumTriangles = (uint32_t)numTriangles;
+    entries[0].DataChecksum = CacheDataChecksum(pTriangleListIndices, CacheEntryIndexBytes(entries[0]),
+                                  CacheDataChecksum(pVertices, CacheEntryVertexBytes(entries[0])));
+    uint32_t entryCount = 1;
+
+    MappedFile oldFile;
+    uint32_t   oldEntryCount = 0;
+    const CacheFileEntry* oldEntries = oldFile.Open(path) ? GetCacheFileEntries(oldFile, &oldEntryCount) : NULL;
+    for (uint32_t i = 0; oldEntries && i < oldEntryCount && entryCount < DistortionMeshCache_MaxEntries; i++)
+    {
+        if (oldEntries[i].Key != key && ValidateCacheFileEntry(oldFile, oldEntries[i], false))
+        {
+            entries[entryCount++] = oldEntries[i];
+        }
+    }
+
+    // Lay the new file out, remembering where each entry's data comes from
+    const uint8_t* vertexSources[DistortionMeshCache_MaxEntries];
+    const uint8_t* indexSources[DistortionMeshCache_MaxEntries];
+    uint32_t       fileSize = CacheFileAlign(sizeof(CacheFileHeader) + entryCount * sizeof(CacheFileEntry));
+    for (uint32_t i = 0; i < entryCount; i++)
+    {
+        CacheFileEntry& entry = entries[i];
+        vertexSources[i] = i ? oldFile.GetData() + entry.VertexOffset : (const uint8_t*)pVertices;
+        indexSources[i]  = i ? oldFile.GetData() + entry.IndexOffset  : (const uint8_t*)pTriangleListIndices;
+
+        entry.VertexOffset = fileSize;
+        fileSize           = CacheFileAlign(fileSize + CacheEntryVertexBytes(entry));
+        entry.IndexOffset  = fileSize;
+        fileSize           = CacheFileAlign(fileSize + CacheEntryIndexBytes(entry));
+    }
+
+    uint8_t* buffer = (uint8_t*) OVR_ALLOC( fileSize );
+    if (!buffer)
+    {
+        return false;
+    }
+    memset(buffer, 0, fileSize);
+
+    CacheFileHeader* header = (CacheFileHeader*)buffer;
+    header->Magic      = CacheFileMagic;
+    header->Version    = CacheFileVersion;
+    header->VertexSize = sizeof(DistortionMeshVertexData);
+    header->EntryCount = entryCount;
+    memcpy(header + 1, entries, entryCount * sizeof(CacheFileEntry));
+    for (uint32_t i = 0; i < entryCount; i++)
+    {
+        memcpy(buffer + entries[i].VertexOffset, vertexSources[i], CacheEntryVertexBytes(entries[i]));
+        memcpy(buffer + entries[i].IndexOffset,  indexSources[i],  CacheEntryIndexBytes(entries[i]));
+    }
+
+    // Windows cannot replace a file that is still mapped
+    oldFile.Close();
+
+    String tempPath = String(path) + ".tmp";
+    bool   written  = false;
+    {
+        SysFile file(tempPath, File::Open_Write | File::Open_Truncate | File::Open_Create);
+        if (file.IsValid())
+        {
+            written = (file.Write(buffer, (int)fileSize) == (int)fileSize);
+            written = file.Close() && written;
+        }
+    }
+    OVR_FREE(buffer);
+
+    return written && ReplaceCacheFile(tempPath, path);
+}
+
+
+}}} // OVR::Util::Render
@@ -0,0 +1,73 @@
+/************************************************************************************
+
+Filename    :   Util_DistortionMeshCache.h
+Content     :   On-disk cache of the generated distortion meshes
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_DistortionMeshCache_h
+#define OVR_Util_DistortionMeshCache_h
+
+#include "Util_Render_Stereo.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Distortion mesh cache
+
+// A mesh only depends on the eye, the lens, the panel and the FOV it was made for, so
+// the meshes are kept in one binary file and mapped back in on the next start instead
+// of being generated again. The file holds up to DistortionMeshCache_MaxEntries meshes,
+// most recently stored first, each under the key of the parameters it was made from.
+//
+// The file starts with a magic number and a format version, and each mesh carries a
+// checksum of its data; a file of another version, a truncated or corrupt file or a
+// missing key is only a miss, after which the mesh is generated and stored as usual.
+
+enum { DistortionMeshCache_MaxEntries = 16 };
+
+// CRC32 of everything DistortionMeshCreate and DistortionMeshCreateAdaptive read:
+// the lens and eye placement, the panel, the shutter, the FOV and the tessellation.
+// tolerancePixels is only used with adaptive set.
+uint32_t DistortionMeshCacheKey ( bool rightEye, const HmdRenderInfo &hmdRenderInfo,
+                                  const DistortionRenderDesc &distortion, const FovPort &fov,
+                                  bool adaptive, float tolerancePixels );
+
+// Looks key up in the cache file at path. On a hit the mesh is copied into buffers
+// that are released with DistortionMeshDestroy, like those of DistortionMeshCreate.
+bool DistortionMeshCacheLoad ( const char *path, uint32_t key,
+                               DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                               int *pNumVertices, int *pNumTriangles );
+
+// Adds the mesh under key in front of the entries already in the file, dropping any
+// older entry with the same key and the oldest past DistortionMeshCache_MaxEntries.
+// The file is written aside and renamed over the old one, so readers never see a
+// partial file.
+bool DistortionMeshCacheStore ( const char *path, uint32_t key,
+                                const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                int numVertices, int numTriangles );
+
+
+}}} // OVR::Util::Render
+
+#endif // OVR_Util_DistortionMeshCache_h
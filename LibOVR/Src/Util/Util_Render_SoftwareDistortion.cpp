@@ -0,0 +1,610 @@
+/************************************************************************************
+
+Filename    :   Util_Render_SoftwareDistortion.cpp
+Content     :   CPU implementation of the distortion rendering pass
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Render_SoftwareDistortion.h"
+#include "../Kernel/OVR_Threads.h"
+
+#if defined(OVR_CPU_SSE)
+#include <emmintrin.h>
+#endif
+
+namespace OVR { namespace Util { namespace Render {
+
+
+// Tiles of 64x64 pixels are taken one at a time by the threads.
+static const int SDR_TileSizeLog2  = 6;
+static const int SDR_TileSize      = 1<<SDR_TileSizeLog2;
+static const int SDR_MaxThreads    = 7;
+// Vertex positions are snapped to 1/256 of a pixel, as GPUs do.
+static const int SDR_SubpixelBits  = 8;
+static const int SDR_SubpixelScale = 1<<SDR_SubpixelBits;
+
+// Interpolated per pixel: the source UV of each channel, then the vignette.
+enum { SDR_AttribU = 0, SDR_AttribV = 1, SDR_AttribShade = 6, SDR_Attribs = 7 };
+
+
+// A mesh vertex after the vertex shader.
+struct SoftwareDistortionVertex
+{
+    int32_t X, Y;                   // Frame buffer pixels, fixed point
+    float   Attribs[SDR_Attribs];
+};
+
+// A triangle ready to rasterize. Its vertices are ordered so that the edge functions are
+// positive inside.
+struct SoftwareDistortionTriangle
+{
+    int32_t X[3], Y[3];
+    int32_t EdgeBias[3];            // -1 where a pixel on the edge is left to the neighbour
+    int     MinX, MinY, MaxX, MaxY; // Pixels, inclusive and within the frame buffer
+    int     Eye;
+
+    // Attribute planes: A0 at vertex 0, then the gradients per pixel.
+    float   X0, Y0;
+    float   A0[SDR_Attribs], DaDx[SDR_Attribs], DaDy[SDR_Attribs];
+};
+
+// Everything the tile threads share.
+struct SoftwareDistortionFrame
+{
+    SoftwareDistortionImage           FrameBuffer;
+    const SoftwareDistortionEye*      pEyes;
+    Color                             ClearColor;
+
+    const SoftwareDistortionTriangle* pTriangles;
+    const int*                        pBinStarts;   // Per tile, into pBins; one more at the end
+    const int*                        pBins;        // Triangle indices, in drawing order
+    int                               TilesX, TilesY;
+    AtomicInt<int>                    NextTile;
+};
+
+
+//-----------------------------------------------------------------------------------
+// ***** Vertex stage
+
+// The distortion vertex shaders, with the vertex colour quantized to 8 bits like the
+// vertex buffers of the GPU renderers do.
+static void SoftwareDistortionTransformVertices ( SoftwareDistortionVertex *pOut, const SoftwareDistortionEye &eye,
+                                                  unsigned flags, int width, int height )
+{
+    const Vector2f*                 tanEyeAngles[3];
+    const DistortionMeshVertexData* pIn = eye.pVertices;
+
+    for ( int i = 0; i < eye.NumVertices; i++, pIn++, pOut++ )
+    {
+        // Far off vertices are clamped to keep the fixed point in range
+        float x = ( pIn->ScreenPosNDC.x + 1.0f ) * 0.5f * (float)width;
+        float y = ( 1.0f - pIn->ScreenPosNDC.y ) * 0.5f * (float)height;
+        x = Alg::Max ( -(float)width,  Alg::Min ( x, 2.0f * (float)width ) );
+        y = Alg::Max ( -(float)height, Alg::Min ( y, 2.0f * (float)height ) );
+        pOut->X = (int32_t)floorf ( x * (float)SDR_SubpixelScale + 0.5f );
+        pOut->Y = (int32_t)floorf ( y * (float)SDR_SubpixelScale + 0.5f );
+
+        tanEyeAngles[0] = &pIn->TanEyeAnglesR;
+        tanEyeAngles[1] = &pIn->TanEyeAnglesG;
+        tanEyeAngles[2] = &pIn->TanEyeAnglesB;
+        if ( !( flags & SoftwareDistortion_Chromatic ) )
+        {
+            tanEyeAngles[0] = tanEyeAngles[2] = &pIn->TanEyeAnglesG;
+        }
+
+        float lerp = (float)(int)( Alg::Max ( 0.0f, Alg::Min ( pIn->TimewarpLerp, 1.0f ) ) * 255.99f ) / 255.0f;
+        for ( int c = 0; c < 3; c++ )
+        {
+            Vector2f coord = *tanEyeAngles[c];
+            if ( flags & SoftwareDistortion_TimeWarp )
+            {
+                // Both rotations of (x,y,1), blended, then projected back onto z = 1
+                const Matrix4f& ms = eye.TimewarpStart;
+                const Matrix4f& me = eye.TimewarpEnd;
+                Vector3f start ( ms.M[0][0] * coord.x + ms.M[0][1] * coord.y + ms.M[0][2],
+                                 ms.M[1][0] * coord.x + ms.M[1][1] * coord.y + ms.M[1][2],
+                                 ms.M[2][0] * coord.x + ms.M[2][1] * coord.y + ms.M[2][2] );
+                Vector3f end   ( me.M[0][0] * coord.x + me.M[0][1] * coord.y + me.M[0][2],
+                                 me.M[1][0] * coord.x + me.M[1][1] * coord.y + me.M[1][2],
+                                 me.M[2][0] * coord.x + me.M[2][1] * coord.y + me.M[2][2] );
+                Vector3f transformed = start + ( end - start ) * lerp;
+                float    recipZ      = 1.0f / transformed.z;
+                coord = Vector2f ( transformed.x * recipZ, transformed.y * recipZ );
+            }
+            pOut->Attribs[SDR_AttribU + c*2] = coord.x * eye.UVScale.x + eye.UVOffset.x;
+            pOut->Attribs[SDR_AttribV + c*2] = coord.y * eye.UVScale.y + eye.UVOffset.y;
+        }
+
+        float shade = 1.0f;
+        if ( flags & SoftwareDistortion_Vignette )
+        {
+            shade = (float)(int)( Alg::Max ( pIn->Shade, 0.0f ) * 255.99f ) / 255.0f;
+        }
+        pOut->Attribs[SDR_AttribShade] = shade;
+    }
+}
+
+// Returns false for triangles that cover no pixel centre of the frame buffer.
+static bool SoftwareDistortionSetupTriangle ( SoftwareDistortionTriangle &tri,
+                                              const SoftwareDistortionVertex *v0,
+                                              const SoftwareDistortionVertex *v1,
+                                              const SoftwareDistortionVertex *v2,
+                                              int eye, int width, int height )
+{
+    // Culling is off in the GPU renderers, so either winding is drawn
+    int64_t area = (int64_t)( v2->X - v0->X ) * ( v1->Y - v0->Y ) - (int64_t)( v2->Y - v0->Y ) * ( v1->X - v0->X );
+    if ( area == 0 )
+    {
+        return false;
+    }
+    if ( area < 0 )
+    {
+        Alg::Swap ( v1, v2 );
+    }
+
+    const SoftwareDistortionVertex* v[3] = { v0, v1, v2 };
+    int32_t minX = v0->X, maxX = v0->X, minY = v0->Y, maxY = v0->Y;
+    for ( int i = 0; i < 3; i++ )
+    {
+        tri.X[i] = v[i]->X;
+        tri.Y[i] = v[i]->Y;
+        minX = Alg::Min ( minX, tri.X[i] ); maxX = Alg::Max ( maxX, tri.X[i] );
+        minY = Alg::Min ( minY, tri.Y[i] ); maxY = Alg::Max ( maxY, tri.Y[i] );
+    }
+
+    // Pixel centres within the bounds
+    const int half = SDR_SubpixelScale / 2;
+    tri.MinX = Alg::Max ( 0,          ( minX - half + SDR_SubpixelScale - 1 ) >> SDR_SubpixelBits );
+    tri.MinY = Alg::Max ( 0,          ( minY - half + SDR_SubpixelScale - 1 ) >> SDR_SubpixelBits );
+    tri.MaxX = Alg::Min ( width - 1,  ( maxX - half ) >> SDR_SubpixelBits );
+    tri.MaxY = Alg::Min ( height - 1, ( maxY - half ) >> SDR_SubpixelBits );
+    if ( tri.MinX > tri.MaxX || tri.MinY > tri.MaxY )
+    {
+        return false;
+    }
+    tri.Eye = eye;
+
+    // Top-left rule: pixels exactly on an edge belong to the triangle on its right or below it
+    for ( int i = 0; i < 3; i++ )
+    {
+        int32_t dx = tri.X[(i+1)%3] - tri.X[i];
+        int32_t dy = tri.Y[(i+1)%3] - tri.Y[i];
+        tri.EdgeBias[i] = ( dy > 0 || ( dy == 0 && dx < 0 ) ) ? 0 : -1;
+    }
+
+    const float scale = 1.0f / (float)SDR_SubpixelScale;
+    float x0  = (float)tri.X[0] * scale, y0 = (float)tri.Y[0] * scale;
+    float dx1 = (float)tri.X[1] * scale - x0, dy1 = (float)tri.Y[1] * scale - y0;
+    float dx2 = (float)tri.X[2] * scale - x0, dy2 = (float)tri.Y[2] * scale - y0;
+    float recipDet = 1.0f / ( dx1 * dy2 - dx2 * dy1 );
+
+    tri.X0 = x0;
+    tri.Y0 = y0;
+    for ( int a = 0; a < SDR_Attribs; a++ )
+    {
+        float a0  = v[0]->Attribs[a];
+        float da1 = v[1]->Attribs[a] - a0;
+        float da2 = v[2]->Attribs[a] - a0;
+        tri.A0[a]   = a0;
+        tri.DaDx[a] = ( da1 * dy2 - da2 * dy1 ) * recipDet;
+        tri.DaDy[a] = ( da2 * dx1 - da1 * dx2 ) * recipDet;
+    }
+    return true;
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** Pixel stage
+
+// The attributes of a run of pixels in a row, filled in by the rasterizer.
+struct SoftwareDistortionSpan
+{
+    float RowBase[SDR_Attribs];     // At x = X0
+    float DaDx[SDR_Attribs];
+    float X0;
+};
+
+// One channel of the texture sampled bilinearly with clamp to edge, from 0 to 255.
+static inline float SoftwareDistortionSample ( const SoftwareDistortionImage &tex, int channel, float u, float v )
+{
+    float tx = u * (float)tex.Width  - 0.5f;
+    float ty = v * (float)tex.Height - 0.5f;
+    // As _mm_max_ps and _mm_min_ps, which also turn NaN into 0
+    tx = ( tx > 0.0f ) ? tx : 0.0f;
+    ty = ( ty > 0.0f ) ? ty : 0.0f;
+    tx = ( tx < (float)( tex.Width - 1 ) )  ? tx : (float)( tex.Width - 1 );
+    ty = ( ty < (float)( tex.Height - 1 ) ) ? ty : (float)( tex.Height - 1 );
+
+    int   ix = (int)tx, iy = (int)ty;
+    float fx = tx - (float)ix, fy = ty - (float)iy;
+    int   ix1 = ix + ( ix < tex.Width - 1 ? 1 : 0 );
+    int   iy1 = iy + ( iy < tex.Height - 1 ? 1 : 0 );
+
+    const uint8_t* row0 = tex.pData + iy  * tex.Pitch + channel;
+    const uint8_t* row1 = tex.pData + iy1 * tex.Pitch + channel;
+    float t00 = (float)row0[ix*4], t10 = (float)row0[ix1*4];
+    float t01 = (float)row1[ix*4], t11 = (float)row1[ix1*4];
+    float top = t00 + ( t10 - t00 ) * fx;
+    float bot = t01 + ( t11 - t01 ) * fx;
+    return top + ( bot - top ) * fy;
+}
+
+// Shades pixels [x0,x1) of a span. Every pixel gets exactly the same float operations
+// whether it is done four at a time or alone, so the tiling does not show in the output.
+static void SoftwareDistortionShadeSpan ( uint8_t *pDest, int x0, int x1, const SoftwareDistortionSpan &span,
+                                          const SoftwareDistortionImage &tex )
+{
+    int x = x0;
+
+#if defined(OVR_CPU_SSE)
+    const __m128  half     = _mm_set1_ps ( 0.5f );
+    const __m128  zero     = _mm_setzero_ps();
+    const __m128  width    = _mm_set1_ps ( (float)tex.Width );
+    const __m128  height   = _mm_set1_ps ( (float)tex.Height );
+    const __m128  maxX     = _mm_set1_ps ( (float)( tex.Width - 1 ) );
+    const __m128  maxY     = _mm_set1_ps ( (float)( tex.Height - 1 ) );
+    const __m128i maxXi    = _mm_set1_epi32 ( tex.Width - 1 );
+    const __m128i maxYi    = _mm_set1_epi32 ( tex.Height - 1 );
+    const __m128  spanX0   = _mm_set1_ps ( span.X0 );
+
+    for ( ; x + 4 <= x1; x += 4 )
+    {
+        __m128 px = _mm_sub_ps ( _mm_add_ps ( _mm_cvtepi32_ps ( _mm_setr_epi32 ( x, x+1, x+2, x+3 ) ), half ), spanX0 );
+
+        __m128 result[3];
+        for ( int c = 0; c < 3; c++ )
+        {
+            __m128 u  = _mm_add_ps ( _mm_set1_ps ( span.RowBase[SDR_AttribU + c*2] ),
+                                     _mm_mul_ps ( _mm_set1_ps ( span.DaDx[SDR_AttribU + c*2] ), px ) );
+            __m128 v  = _mm_add_ps ( _mm_set1_ps ( span.RowBase[SDR_AttribV + c*2] ),
+                                     _mm_mul_ps ( _mm_set1_ps ( span.DaDx[SDR_AttribV + c*2] ), px ) );
+            __m128 tx = _mm_sub_ps ( _mm_mul_ps ( u, width ), half );
+            __m128 ty = _mm_sub_ps ( _mm_mul_ps ( v, height ), half );
+            tx = _mm_min_ps ( _mm_max_ps ( tx, zero ), maxX );
+            ty = _mm_min_ps ( _mm_max_ps ( ty, zero ), maxY );
+
+            __m128i ix  = _mm_cvttps_epi32 ( tx );
+            __m128i iy  = _mm_cvttps_epi32 ( ty );
+            __m128  fx  = _mm_sub_ps ( tx, _mm_cvtepi32_ps ( ix ) );
+            __m128  fy  = _mm_sub_ps ( ty, _mm_cvtepi32_ps ( iy ) );
+            // The compare gives -1 where there is a next texel
+            __m128i ix1 = _mm_sub_epi32 ( ix, _mm_cmplt_epi32 ( ix, maxXi ) );
+            __m128i iy1 = _mm_sub_epi32 ( iy, _mm_cmplt_epi32 ( iy, maxYi ) );
+
+            OVR_ALIGNAS(16) int32_t ixs[4], iys[4], ix1s[4], iy1s[4];
+            _mm_store_si128 ( (__m128i*)ixs,  ix );
+            _mm_store_si128 ( (__m128i*)iys,  iy );
+            _mm_store_si128 ( (__m128i*)ix1s, ix1 );
+            _mm_store_si128 ( (__m128i*)iy1s, iy1 );
+
+            OVR_ALIGNAS(16) float t00[4], t10[4], t01[4], t11[4];
+            for ( int i = 0; i < 4; i++ )
+            {
+                const uint8_t* row0 = tex.pData + iys[i]  * tex.Pitch + c;
+                const uint8_t* row1 = tex.pData + iy1s[i] * tex.Pitch + c;
+                t00[i] = (float)row0[ixs[i]*4];
+                t10[i] = (float)row0[ix1s[i]*4];
+                t01[i] = (float)row1[ixs[i]*4];
+                t11[i] = (float)row1[ix1s[i]*4];
+            }
+            __m128 a   = _mm_load_ps ( t00 ), b = _mm_load_ps ( t10 );
+            __m128 top = _mm_add_ps ( a, _mm_mul_ps ( _mm_sub_ps ( b, a ), fx ) );
+            a = _mm_load_ps ( t01 ); b = _mm_load_ps ( t11 );
+            __m128 bot = _mm_add_ps ( a, _mm_mul_ps ( _mm_sub_ps ( b, a ), fx ) );
+            result[c]  = _mm_add_ps ( top, _mm_mul_ps ( _mm_sub_ps ( bot, top ), fy ) );
+        }
+
+        __m128 shade = _mm_add_ps ( _mm_set1_ps ( span.RowBase[SDR_AttribShade] ),
+                                    _mm_mul_ps ( _mm_set1_ps ( span.DaDx[SDR_AttribShade] ), px ) );
+        shade = _mm_max_ps ( shade, zero );
+
+        // Rounded, and saturated to bytes by the packs
+        __m128i r = _mm_cvttps_epi32 ( _mm_add_ps ( _mm_mul_ps ( result[0], shade ), half ) );
+        __m128i g = _mm_cvttps_epi32 ( _mm_add_ps ( _mm_mul_ps ( result[1], shade ), half ) );
+        __m128i b = _mm_cvttps_epi32 ( _mm_add_ps ( _mm_mul_ps ( result[2], shade ), half ) );
+        __m128i a = _mm_set1_epi32 ( 255 );
+        // r0 g0 b0 a0 r1 g1 ... from the planar channels
+        __m128i rg   = _mm_packs_epi32 ( _mm_unpacklo_epi32 ( r, g ), _mm_unpackhi_epi32 ( r, g ) );
+        __m128i ba   = _mm_packs_epi32 ( _mm_unpacklo_epi32 ( b, a ), _mm_unpackhi_epi32 ( b, a ) );
+        __m128i rgba = _mm_packus_epi16 ( _mm_unpacklo_epi32 ( rg, ba ), _mm_unpackhi_epi32 ( rg, ba ) );
+        _mm_storeu_si128 ( (__m128i*)( pDest + x*4 ), rgba );
+    }
+#endif
+
+    for ( ; x < x1; x++ )
+    {
+        float px = ( (float)x + 0.5f ) - span.X0;
+        float result[3];
+        for ( int c = 0; c < 3; c++ )
+        {
+            float u = span.RowBase[SDR_AttribU + c*2] + span.DaDx[SDR_AttribU + c*2] * px;
+            float v = span.RowBase[SDR_AttribV + c*2] + span.DaDx[SDR_AttribV + c*2] * px;
+            result[c] = SoftwareDistortionSample ( tex, c, u, v );
+        }
+        float shade = span.RowBase[SDR_AttribShade] + span.DaDx[SDR_AttribShade] * px;
+        shade = ( shade > 0.0f ) ? shade : 0.0f;
+
+        uint8_t* pixel = pDest + x*4;
+        for ( int c = 0; c < 3; c++ )
+        {
+            int value = (int)( result[c] * shade + 0.5f );
+            pixel[c] = (uint8_t)Alg::Max ( 0, Alg::Min ( value, 255 ) );
+        }
+        pixel[3] = 255;
+    }
+}
+
+// Draws the part of tri within the tile.
+static void SoftwareDistortionRasterize ( const SoftwareDistortionFrame &frame, const SoftwareDistortionTriangle &tri,
+                                          int tileMinX, int tileMinY, int tileMaxX, int tileMaxY )
+{
+    const int minX = Alg::Max ( tri.MinX, tileMinX ), maxX = Alg::Min ( tri.MaxX, tileMaxX );
+    const int minY = Alg::Max ( tri.MinY, tileMinY ), maxY = Alg::Min ( tri.MaxY, tileMaxY );
+    if ( minX > maxX || minY > maxY )
+    {
+        return;
+    }
+
+    const SoftwareDistortionImage& tex = frame.pEyes[tri.Eye].Texture;
+
+    // Edge i runs from vertex i to the next; its function grows by StepX per pixel to the right
+    int64_t stepX[3];
+    for ( int i = 0; i < 3; i++ )
+    {
+        stepX[i] = (int64_t)( tri.Y[(i+1)%3] - tri.Y[i] ) * SDR_SubpixelScale;
+    }
+
+    SoftwareDistortionSpan span;
+    span.X0 = tri.X0;
+    for ( int a = 0; a < SDR_Attribs; a++ )
+    {
+        span.DaDx[a] = tri.DaDx[a];
+    }
+
+    for ( int y = minY; y <= maxY; y++ )
+    {
+        // Exact edge functions at the centre of the first pixel, never stepped across rows
+        const int64_t cx = ( (int64_t)minX << SDR_SubpixelBits ) + SDR_SubpixelScale / 2;
+        const int64_t cy = ( (int64_t)y    << SDR_SubpixelBits ) + SDR_SubpixelScale / 2;
+        int64_t e[3];
+        for ( int i = 0; i < 3; i++ )
+        {
+            const int n = (i+1)%3;
+            e[i] = ( cx - tri.X[i] ) * ( tri.Y[n] - tri.Y[i] ) - ( cy - tri.Y[i] ) * ( tri.X[n] - tri.X[i] ) + tri.EdgeBias[i];
+        }
+
+        // The pixels inside are one run, as the triangle is convex
+        int x = minX;
+        while ( x <= maxX && ( e[0] | e[1] | e[2] ) < 0 )
+        {
+            e[0] += stepX[0]; e[1] += stepX[1]; e[2] += stepX[2];
+            x++;
+        }
+        const int spanStart = x;
+        while ( x <= maxX && ( e[0] | e[1] | e[2] ) >= 0 )
+        {
+            e[0] += stepX[0]; e[1] += stepX[1]; e[2] += stepX[2];
+            x++;
+        }
+        if ( x == spanStart )
+        {
+            continue;
+        }
+
+        float py = ( (float)y + 0.5f ) - tri.Y0;
+        for ( int a = 0; a < SDR_Attribs; a++ )
+        {
+            span.RowBase[a] = tri.A0[a] + tri.DaDy[a] * py;
+        }
+        SoftwareDistortionShadeSpan ( frame.FrameBuffer.pData + y * frame.FrameBuffer.Pitch,
+                                      spanStart, x, span, tex );
+    }
+}
+
+static void SoftwareDistortionDrawTile ( const SoftwareDistortionFrame &frame, int tile )
+{
+    const SoftwareDistortionImage& fb = frame.FrameBuffer;
+    const int minX = ( tile % frame.TilesX ) * SDR_TileSize;
+    const int minY = ( tile / frame.TilesX ) * SDR_TileSize;
+    const int maxX = Alg::Min ( minX + SDR_TileSize, fb.Width ) - 1;
+    const int maxY = Alg::Min ( minY + SDR_TileSize, fb.Height ) - 1;
+
+    for ( int y = minY; y <= maxY; y++ )
+    {
+        uint8_t* pixel = fb.pData + y * fb.Pitch + minX * 4;
+        for ( int x = minX; x <= maxX; x++, pixel += 4 )
+        {
+            pixel[0] = frame.ClearColor.R;
+            pixel[1] = frame.ClearColor.G;
+            pixel[2] = frame.ClearColor.B;
+            pixel[3] = frame.ClearColor.A;
+        }
+    }
+
+    for ( int i = frame.pBinStarts[tile]; i < frame.pBinStarts[tile+1]; i++ )
+    {
+        SoftwareDistortionRasterize ( frame, frame.pTriangles[frame.pBins[i]], minX, minY, maxX, maxY );
+    }
+}
+
+static int SoftwareDistortionTilesThreadFn ( Thread *pthread, void* h )
+{
+    OVR_UNUSED ( pthread );
+    SoftwareDistortionFrame &frame = *(SoftwareDistortionFrame*)h;
+
+    const int tileCount = frame.TilesX * frame.TilesY;
+    int tile;
+    while ( ( tile = frame.NextTile.ExchangeAdd_NoSync ( 1 ) ) < tileCount )
+    {
+        SoftwareDistortionDrawTile ( frame, tile );
+    }
+    return 0;
+}
+
+
+//-----------------------------------------------------------------------------------
+// ***** SoftwareDistortionRender
+
+void SoftwareDistortionRender ( const SoftwareDistortionImage &frameBuffer,
+                                const SoftwareDistortionEye eyes[2], unsigned flags,
+                                Color clearColor, int threadCount )
+{
+    if ( !frameBuffer.pData || frameBuffer.Width <= 0 || frameBuffer.Height <= 0 )
+    {
+        return;
+    }
+
+    int maxVertices = 0, totalTriangles = 0;
+    for ( int eye = 0; eye < 2; eye++ )
+    {
+        maxVertices     = Alg::Max ( maxVertices, eyes[eye].NumVertices );
+        totalTriangles += eyes[eye].NumTriangles;
+    }
+
+    SoftwareDistortionFrame frame;
+    frame.FrameBuffer = frameBuffer;
+    frame.pEyes       = eyes;
+    frame.ClearColor  = clearColor;
+    frame.TilesX      = ( frameBuffer.Width  + SDR_TileSize - 1 ) >> SDR_TileSizeLog2;
+    frame.TilesY      = ( frameBuffer.Height + SDR_TileSize - 1 ) >> SDR_TileSizeLog2;
+    frame.NextTile    = 0;
+    const int tileCount = frame.TilesX * frame.TilesY;
+
+    // One allocation for the transformed vertices of an eye, the triangles and the bins
+    const size_t verticesBytes  = sizeof(SoftwareDistortionVertex) * maxVertices;
+    const size_t trianglesBytes = sizeof(SoftwareDistortionTriangle) * totalTriangles;
+    const size_t binStartsBytes = sizeof(int) * ( tileCount + 1 );
+    uint8_t* pScratch = (uint8_t*) OVR_ALLOC( verticesBytes + trianglesBytes + binStartsBytes );
+    if ( !pScratch )
+    {
+        return;
+    }
+    SoftwareDistortionVertex*   pVertices  = (SoftwareDistortionVertex*)pScratch;
+    SoftwareDistortionTriangle* pTriangles = (SoftwareDistortionTriangle*)( pScratch + verticesBytes );
+    int*                        pBinStarts = (int*)( pScratch + verticesBytes + trianglesBytes );
+
+    // Vertex stage and triangle setup, left eye then right as the GPU renderers draw them
+    int triangleCount = 0;
+    for ( int eye = 0; eye < 2; eye++ )
+    {
+        const SoftwareDistortionEye& e = eyes[eye];
+        if ( !e.pVertices || !e.pIndices || !e.Texture.pData || e.Texture.Width <= 0 || e.Texture.Height <= 0 )
+        {
+            continue;
+        }
+        SoftwareDistortionTransformVertices ( pVertices, e, flags, frameBuffer.Width, frameBuffer.Height );
+
+        const uint16_t* pIndex = e.pIndices;
+        for ( int t = 0; t < e.NumTriangles; t++, pIndex += 3 )
+        {
+            if ( pIndex[0] >= e.NumVertices || pIndex[1] >= e.NumVertices || pIndex[2] >= e.NumVertices )
+            {
+                OVR_ASSERT ( false );
+                continue;
+            }
+            if ( SoftwareDistortionSetupTriangle ( pTriangles[triangleCount], &pVertices[pIndex[0]],
+                                                   &pVertices[pIndex[1]], &pVertices[pIndex[2]],
+                                                   eye, frameBuffer.Width, frameBuffer.Height ) )
+            {
+                triangleCount++;
+            }
+        }
+    }
+
+    // Bin the triangles by the tiles their bounds touch, keeping the drawing order
+    memset ( pBinStarts, 0, binStartsBytes );
+    int binEntries = 0;
+    for ( int t = 0; t < triangleCount; t++ )
+    {
+        const SoftwareDistortionTriangle& tri = pTriangles[t];
+        for ( int ty = tri.MinY >> SDR_TileSizeLog2; ty <= tri.MaxY >> SDR_TileSizeLog2; ty++ )
+        {
+            for ( int tx = tri.MinX >> SDR_TileSizeLog2; tx <= tri.MaxX >> SDR_TileSizeLog2; tx++ )
+            {
+                pBinStarts[ty * frame.TilesX + tx + 1]++;
+                binEntries++;
+            }
+        }
+    }
+    for ( int i = 0; i < tileCount; i++ )
+    {
+        pBinStarts[i+1] += pBinStarts[i];
+    }
+
+    int* pBins    = (int*) OVR_ALLOC( sizeof(int) * Alg::Max ( binEntries, 1 ) );
+    int* pBinNext = (int*) OVR_ALLOC( sizeof(int) * tileCount );
+    if ( !pBins || !pBinNext )
+    {
+        OVR_FREE ( pBins );
+        OVR_FREE ( pBinNext );
+        OVR_FREE ( pScratch );
+        return;
+    }
+    memcpy ( pBinNext, pBinStarts, sizeof(int) * tileCount );
+    for ( int t = 0; t < triangleCount; t++ )
+    {
+        const SoftwareDistortionTriangle& tri = pTriangles[t];
+        for ( int ty = tri.MinY >> SDR_TileSizeLog2; ty <= tri.MaxY >> SDR_TileSizeLog2; ty++ )
+        {
+            for ( int tx = tri.MinX >> SDR_TileSizeLog2; tx <= tri.MaxX >> SDR_TileSizeLog2; tx++ )
+            {
+                pBins[pBinNext[ty * frame.TilesX + tx]++] = t;
+            }
+        }
+    }
+    OVR_FREE ( pBinNext );
+
+    frame.pTriangles = pTriangles;
+    frame.pBinStarts = pBinStarts;
+    frame.pBins      = pBins;
+
+    if ( threadCount <= 0 )
+    {
+        threadCount = Thread::GetCPUCount();
+    }
+    threadCount = Alg::Max ( 1, Alg::Min ( threadCount, Alg::Min ( tileCount, SDR_MaxThreads + 1 ) ) );
+
+    // The calling thread draws tiles too
+    Ptr<Thread> threads[SDR_MaxThreads];
+    for ( int i = 0; i < threadCount - 1; i++ )
+    {
+        threads[i] = *new Thread ( SoftwareDistortionTilesThreadFn, &frame );
+        if ( !threads[i]->Start() )
+        {
+            threads[i].Clear();
+        }
+    }
+    SoftwareDistortionTilesThreadFn ( NULL, &frame );
+    for ( int i = 0; i < threadCount - 1; i++ )
+    {
+        if ( threads[i] )
+        {
+            threads[i]->Join();
+        }
+    }
+
+    OVR_FREE ( pBins );
+    OVR_FREE ( pScratch );
+}
+
+
+}}} // OVR::Util::Render
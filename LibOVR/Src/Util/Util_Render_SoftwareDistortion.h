@@ -0,0 +1,94 @@
+/************************************************************************************
+
+Filename    :   Util_Render_SoftwareDistortion.h
+Content     :   CPU implementation of the distortion rendering pass
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_SoftwareDistortion_h
+#define OVR_Util_Render_SoftwareDistortion_h
+
+#include "Util_Render_Stereo.h"
+#include "../Kernel/OVR_Color.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+//-----------------------------------------------------------------------------------
+// ***** Software distortion rendering
+
+// Draws the distortion meshes of both eyes into a frame buffer in memory the way the
+// distortion shaders of the GL and D3D renderers do: timewarp and the eye to source UV
+// mapping per vertex, then a bilinear sample per colour channel at its own coordinates,
+// times the vignette. Pixels the meshes do not cover get the clear colour.
+//
+// The output only depends on the inputs: not on the thread count, the tiling or the order
+// the tiles are done in, so it can be compared bit for bit against a stored image. Frame
+// buffer pixels are sampled at their centres, with the top-left fill rule.
+
+// An 8 bit RGBA image, rows top to bottom and Pitch bytes apart.
+struct SoftwareDistortionImage
+{
+    uint8_t* pData;
+    int      Width;
+    int      Height;
+    int      Pitch;
+
+    SoftwareDistortionImage() : pData(NULL), Width(0), Height(0), Pitch(0) { }
+    SoftwareDistortionImage(uint8_t* pdata, int width, int height, int pitch)
+      : pData(pdata), Width(width), Height(height), Pitch(pitch) { }
+};
+
+enum SoftwareDistortionFlags
+{
+    SoftwareDistortion_Chromatic = 0x01,    // Otherwise every channel uses the green coordinates
+    SoftwareDistortion_Vignette  = 0x02,
+    SoftwareDistortion_TimeWarp  = 0x04
+};
+
+// What the distortion shaders get for one eye.
+struct SoftwareDistortionEye
+{
+    const DistortionMeshVertexData* pVertices;      // From DistortionMeshCreate
+    const uint16_t*                 pIndices;
+    int                             NumVertices;
+    int                             NumTriangles;
+
+    SoftwareDistortionImage         Texture;        // The eye's rendered image
+    Vector2f                        UVScale;        // EyeToSourceUVScale, as from ovrHmd_GetRenderScaleAndOffset
+    Vector2f                        UVOffset;       // EyeToSourceUVOffset
+    Matrix4f                        TimewarpStart;  // From ovrHmd_GetEyeTimewarpMatrices, with SoftwareDistortion_TimeWarp
+    Matrix4f                        TimewarpEnd;
+
+    SoftwareDistortionEye() : pVertices(NULL), pIndices(NULL), NumVertices(0), NumTriangles(0) { }
+};
+
+// Renders both eyes into frameBuffer, tiled over threadCount threads, or as many as there
+// are CPUs with 0. flags are SoftwareDistortionFlags.
+void SoftwareDistortionRender ( const SoftwareDistortionImage &frameBuffer,
+                                const SoftwareDistortionEye eyes[2], unsigned flags,
+                                Color clearColor, int threadCount = 0 );
+
+
+}}} // OVR::Util::Render
+
+#endif // OVR_Util_Render_SoftwareDistortion_h
@@ -25,6 +25,8 @@ limitations under the License.
 *************************************************************************************/
 
 #include "Util_Render_Stereo.h"
+#include "../Kernel/OVR_Threads.h"
+#include "../Kernel/OVR_Atomic.h"
 
 namespace OVR { namespace Util { namespace Render {
 
@@ -787,32 +789,30 @@ Matrix4f StereoConfig::GetProjectionWithZoom ( StereoEye eye, float fovZoom ) co
 // 6 is indistinguishable on a monitor on even/odd frames.
 static const int DMA_GridSizeLog2   = 6;
 static const int DMA_GridSize       = 1<<DMA_GridSizeLog2;
-static const int DMA_NumVertsPerEye = (DMA_GridSize+1)*(DMA_GridSize+1);
-static const int DMA_NumTrisPerEye  = (DMA_GridSize)*(DMA_GridSize)*2;
-
-
-
-DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
-                                                    bool rightEye,
-                                                    const HmdRenderInfo &hmdRenderInfo,
-                                                    const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
+// 16-bit indices limit the grid to 128x128 quads.
+static const int DMA_MaxGridSizeLog2 = 7;
+static const int DMA_MaxGridSize     = 1<<DMA_MaxGridSizeLog2;
+// Rows below which another thread does not pay for its start, and threads started at most.
+static const int DMA_MinRowsPerThread = 32;
+static const int DMA_MaxThreads       = 7;
+// Adaptive meshes refine quads of an 8x8 grid down to the cells of the largest grid.
+static const int DMA_AdaptiveMinGridSizeLog2 = 3;
+
+
+
+// Fills in everything but the tan(angle) vectors, which must already be in result.
+static void DistortionMeshFinishVertex ( DistortionMeshVertexData &result,
+                                         Vector2f screenNDC,
+                                         bool rightEye,
+                                         const HmdRenderInfo &hmdRenderInfo,
+                                         const ScaleAndOffset2D &eyeToSourceNDC )
 {
-    DistortionMeshVertexData result;
-
     float xOffset = 0.0f;
     if (rightEye)
     {
         xOffset = 1.0f;
     }
 
-    Vector2f tanEyeAnglesR, tanEyeAnglesG, tanEyeAnglesB;
-    TransformScreenNDCToTanFovSpaceChroma ( &tanEyeAnglesR, &tanEyeAnglesG, &tanEyeAnglesB,
-                                            distortion, screenNDC );
-
-	result.TanEyeAnglesR = tanEyeAnglesR;
-	result.TanEyeAnglesG = tanEyeAnglesG;
-	result.TanEyeAnglesB = tanEyeAnglesB;
-
     HmdShutterTypeEnum shutterType = hmdRenderInfo.Shutter.Type;
     switch ( shutterType )
     {
@@ -858,7 +858,7 @@ DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
 
     // Fade out at texture edges.
     // The furthest out will be the blue channel, because of chromatic aberration (true of any standard lens)
-    Vector2f sourceTexCoordBlueNDC = TransformTanFovSpaceToRendertargetNDC ( eyeToSourceNDC, tanEyeAnglesB );
+    Vector2f sourceTexCoordBlueNDC = TransformTanFovSpaceToRendertargetNDC ( eyeToSourceNDC, result.TanEyeAnglesB );
 	if (rightEye)
 	{
 		// The inner edge of the eye texture is usually much more magnified, because it's right against the middle of the screen, not the FOV edge.
@@ -880,7 +880,24 @@ DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
     result.Shade = Alg::Min ( edgeFadeIn, 1.0f );
     result.ScreenPosNDC.x = 0.5f * screenNDC.x - 0.5f + xOffset;
     result.ScreenPosNDC.y = -screenNDC.y;
+}
+
+DistortionMeshVertexData DistortionMeshMakeVertex ( Vector2f screenNDC,
+                                                    bool rightEye,
+                                                    const HmdRenderInfo &hmdRenderInfo,
+                                                    const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
+{
+    DistortionMeshVertexData result;
+
+    Vector2f tanEyeAnglesR, tanEyeAnglesG, tanEyeAnglesB;
+    TransformScreenNDCToTanFovSpaceChroma ( &tanEyeAnglesR, &tanEyeAnglesG, &tanEyeAnglesB,
+                                            distortion, screenNDC );
 
+	result.TanEyeAnglesR = tanEyeAnglesR;
+	result.TanEyeAnglesG = tanEyeAnglesG;
+	result.TanEyeAnglesB = tanEyeAnglesB;
+
+    DistortionMeshFinishVertex ( result, screenNDC, rightEye, hmdRenderInfo, eyeToSourceNDC );
     return result;
 }
 
@@ -915,8 +932,91 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
                            const HmdRenderInfo &hmdRenderInfo,
                            const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
 {
-    *pNumVertices  = DMA_NumVertsPerEye;
-    *pNumTriangles = DMA_NumTrisPerEye;
+    DistortionMeshCreate(ppVertices, ppTriangleListIndices, pNumVertices, pNumTriangles,
+                         rightEye, hmdRenderInfo, distortion, eyeToSourceNDC,
+                         DMA_GridSizeLog2, 0);
+}
+
+
+// The vertex rows of a distortion mesh, taken one at a time by the threads building it.
+struct DistortionMeshRows
+{
+    DistortionMeshVertexData*   pVertices;
+    int                         GridSize;
+    bool                        RightEye;
+    const HmdRenderInfo*        pHmdRenderInfo;
+    const DistortionRenderDesc* pDistortion;
+    const ScaleAndOffset2D*     pEyeToSourceNDC;
+    AtomicInt<int>              NextRow;
+};
+
+// Builds row y of the mesh, with each step done on the whole row at once.
+static void DistortionMeshMakeRow ( const DistortionMeshRows &rows, int y )
+{
+    const int rowVerts = rows.GridSize + 1;
+    Vector2f  tanEyeAngle[DMA_MaxGridSize+1];
+    Vector2f  screenNDC[DMA_MaxGridSize+1];
+    Vector2f  tanEyeAnglesR[DMA_MaxGridSize+1], tanEyeAnglesG[DMA_MaxGridSize+1], tanEyeAnglesB[DMA_MaxGridSize+1];
+
+    for ( int x = 0; x < rowVerts; x++ )
+    {
+        Vector2f sourceCoordNDC;
+        // NDC texture coords [-1,+1]
+        sourceCoordNDC.x = 2.0f * ( (float)x / (float)rows.GridSize ) - 1.0f;
+        sourceCoordNDC.y = 2.0f * ( (float)y / (float)rows.GridSize ) - 1.0f;
+        tanEyeAngle[x] = TransformRendertargetNDCToTanFovSpace ( *rows.pEyeToSourceNDC, sourceCoordNDC );
+    }
+
+    // Find a corresponding screen position.
+    // Note - this function does not have to be precise - we're just trying to match the mesh tessellation
+    // with the shape of the distortion to minimise the number of trianlges needed.
+    TransformTanFovSpaceToScreenNDCBatch ( screenNDC, *rows.pDistortion, tanEyeAngle, rowVerts, false );
+    for ( int x = 0; x < rowVerts; x++ )
+    {
+        // ...but don't let verts overlap to the other eye.
+        screenNDC[x].x = Alg::Max ( -1.0f, Alg::Min ( screenNDC[x].x, 1.0f ) );
+        screenNDC[x].y = Alg::Max ( -1.0f, Alg::Min ( screenNDC[x].y, 1.0f ) );
+    }
+
+    // From those screen positions, generate the vertices.
+    TransformScreenNDCToTanFovSpaceChromaBatch ( tanEyeAnglesR, tanEyeAnglesG, tanEyeAnglesB,
+                                                 *rows.pDistortion, screenNDC, rowVerts );
+    DistortionMeshVertexData* pcurVert = rows.pVertices + y * rowVerts;
+    for ( int x = 0; x < rowVerts; x++, pcurVert++ )
+    {
+        pcurVert->TanEyeAnglesR = tanEyeAnglesR[x];
+        pcurVert->TanEyeAnglesG = tanEyeAnglesG[x];
+        pcurVert->TanEyeAnglesB = tanEyeAnglesB[x];
+        DistortionMeshFinishVertex ( *pcurVert, screenNDC[x], rows.RightEye, *rows.pHmdRenderInfo, *rows.pEyeToSourceNDC );
+    }
+}
+
+static int DistortionMeshRowsThreadFn ( Thread *pthread, void* h )
+{
+    OVR_UNUSED ( pthread );
+    DistortionMeshRows &rows = *(DistortionMeshRows*)h;
+
+    int y;
+    while ( ( y = rows.NextRow.ExchangeAdd_NoSync ( 1 ) ) <= rows.GridSize )
+    {
+        DistortionMeshMakeRow ( rows, y );
+    }
+    return 0;
+}
+
+void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                           int *pNumVertices, int *pNumTriangles,
+                           bool rightEye,
+                           const HmdRenderInfo &hmdRenderInfo,
+                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                           int gridSizeLog2, int threadCount )
+{
+    OVR_ASSERT ( gridSizeLog2 >= 1 && gridSizeLog2 <= DMA_MaxGridSizeLog2 );
+    gridSizeLog2 = Alg::Max ( 1, Alg::Min ( gridSizeLog2, DMA_MaxGridSizeLog2 ) );
+    const int gridSize = 1 << gridSizeLog2;
+
+    *pNumVertices  = (gridSize+1)*(gridSize+1);
+    *pNumTriangles = gridSize*gridSize*2;
 
     *ppVertices = (DistortionMeshVertexData*)
                       OVR_ALLOC( sizeof(DistortionMeshVertexData) * (*pNumVertices) );
@@ -943,31 +1043,40 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
 
     // Populate vertex buffer info
 
-    // First pass - build up raw vertex data.
-    DistortionMeshVertexData* pcurVert = *ppVertices;
+    // First pass - build up raw vertex data, a row at a time.
+    DistortionMeshRows rows;
+    rows.pVertices       = *ppVertices;
+    rows.GridSize        = gridSize;
+    rows.RightEye        = rightEye;
+    rows.pHmdRenderInfo  = &hmdRenderInfo;
+    rows.pDistortion     = &distortion;
+    rows.pEyeToSourceNDC = &eyeToSourceNDC;
+    rows.NextRow         = 0;
+
+    if ( threadCount <= 0 )
+    {
+        // Starting a thread costs about as much as building DMA_MinRowsPerThread rows
+        threadCount = Alg::Min ( Thread::GetCPUCount(), (gridSize+1) / DMA_MinRowsPerThread );
+    }
+    threadCount = Alg::Max ( 1, Alg::Min ( threadCount, gridSize+1 ) );
 
-    for ( int y = 0; y <= DMA_GridSize; y++ )
+    // The calling thread builds rows too
+    Ptr<Thread> threads[DMA_MaxThreads];
+    threadCount = Alg::Min ( threadCount, DMA_MaxThreads + 1 );
+    for ( int i = 0; i < threadCount - 1; i++ )
     {
-        for ( int x = 0; x <= DMA_GridSize; x++ )
+        threads[i] = *new Thread ( DistortionMeshRowsThreadFn, &rows );
+        if ( !threads[i]->Start() )
         {
-
-            Vector2f sourceCoordNDC;
-            // NDC texture coords [-1,+1]
-            sourceCoordNDC.x = 2.0f * ( (float)x / (float)DMA_GridSize ) - 1.0f;
-            sourceCoordNDC.y = 2.0f * ( (float)y / (float)DMA_GridSize ) - 1.0f;
-            Vector2f tanEyeAngle = TransformRendertargetNDCToTanFovSpace ( eyeToSourceNDC, sourceCoordNDC );
-
-            // Find a corresponding screen position.
-            // Note - this function does not have to be precise - we're just trying to match the mesh tessellation
-            // with the shape of the distortion to minimise the number of trianlges needed.
-            Vector2f screenNDC = TransformTanFovSpaceToScreenNDC ( distortion, tanEyeAngle, false );
-            // ...but don't let verts overlap to the other eye.
-            screenNDC.x = Alg::Max ( -1.0f, Alg::Min ( screenNDC.x, 1.0f ) );
-            screenNDC.y = Alg::Max ( -1.0f, Alg::Min ( screenNDC.y, 1.0f ) );
-
-            // From those screen positions, generate the vertex.
-            *pcurVert = DistortionMeshMakeVertex ( screenNDC, rightEye, hmdRenderInfo, distortion, eyeToSourceNDC );
-            pcurVert++;
+            threads[i].Clear();
+        }
+    }
+    DistortionMeshRowsThreadFn ( NULL, &rows );
+    for ( int i = 0; i < threadCount - 1; i++ )
+    {
+        if ( threads[i] )
+        {
+            threads[i]->Join();
         }
     }
 
@@ -975,11 +1084,11 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
     // Populate index buffer info
     uint16_t *pcurIndex = *ppTriangleListIndices;
 
-    for ( int triNum = 0; triNum < DMA_GridSize * DMA_GridSize; triNum++ )
+    for ( int triNum = 0; triNum < gridSize * gridSize; triNum++ )
     {
         // Use a Morton order to help locality of FB, texture and vertex cache.
         // (0.325ms raster order -> 0.257ms Morton order)
-        OVR_ASSERT ( DMA_GridSize <= 256 );
+        OVR_ASSERT ( gridSize <= 256 );
         int x = ( ( triNum & 0x0001 ) >> 0 ) |
                 ( ( triNum & 0x0004 ) >> 1 ) |
                 ( ( triNum & 0x0010 ) >> 2 ) |
@@ -996,7 +1105,7 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
                 ( ( triNum & 0x0800 ) >> 6 ) |
                 ( ( triNum & 0x2000 ) >> 7 ) |
                 ( ( triNum & 0x8000 ) >> 8 );
-        int FirstVertex = x * (DMA_GridSize+1) + y;
+        int FirstVertex = x * (gridSize+1) + y;
         // Another twist - we want the top-left and bottom-right quadrants to
         // have the triangles split one way, the other two split the other.
         // +---+---+---+---+
@@ -1018,27 +1127,435 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
         // +---+---+---+---+
         // This way triangle edges don't span long distances over the distortion function,
         // so linear interpolation works better & we can use fewer tris.
-        if ( ( x < DMA_GridSize/2 ) != ( y < DMA_GridSize/2 ) )       // != is logical XOR
+        if ( ( x < gridSize/2 ) != ( y < gridSize/2 ) )       // != is logical XOR
         {
             *pcurIndex++ = (uint16_t)FirstVertex;
             *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1)+1;
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1)+1;
 
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1)+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1);
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1)+1;
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1);
             *pcurIndex++ = (uint16_t)FirstVertex;
         }
         else
         {
             *pcurIndex++ = (uint16_t)FirstVertex;
             *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1);
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1);
 
             *pcurIndex++ = (uint16_t)FirstVertex+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1)+1;
-            *pcurIndex++ = (uint16_t)FirstVertex+(DMA_GridSize+1);
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1)+1;
+            *pcurIndex++ = (uint16_t)FirstVertex+(gridSize+1);
+        }
+    }
+}
+
+float DistortionMeshPixelsPerTanAngle ( const HmdRenderInfo &hmdRenderInfo, const DistortionRenderDesc &distortion )
+{
+    float pixelsPerMeter = (float)hmdRenderInfo.ResolutionInPixels.w / hmdRenderInfo.ScreenSizeInMeters.w;
+    return pixelsPerMeter * distortion.Lens.MetersPerTanAngleAtCenter;
+}
+
+// Largest difference, over the three colour channels, between the tan(angle) vectors at p
+// interpolated linearly over the triangle of screen positions pos[] that holds it, and the
+// exact ones in tanR/G/B. Points on no triangle, like those squashed against the screen
+// edges, count as no error.
+static float DistortionMeshTriangleError ( const Vector2f *pos[3], const Vector2f *tan[3][3],
+                                           Vector2f p, const Vector2f &tanR, const Vector2f &tanG, const Vector2f &tanB,
+                                           bool *pInside )
+{
+    Vector2f e1 = *pos[1] - *pos[0];
+    Vector2f e2 = *pos[2] - *pos[0];
+    float    area = e1.x * e2.y - e1.y * e2.x;
+    *pInside = false;
+    if ( Alg::Abs ( area ) < 1e-12f )
+    {
+        return 0.0f;
+    }
+
+    Vector2f d  = p - *pos[0];
+    float    w1 = ( d.x * e2.y - d.y * e2.x ) / area;
+    float    w2 = ( e1.x * d.y - e1.y * d.x ) / area;
+    float    w0 = 1.0f - w1 - w2;
+    const float edge = -1e-4f;
+    if ( w0 < edge || w1 < edge || w2 < edge )
+    {
+        return 0.0f;
+    }
+    *pInside = true;
+
+    const Vector2f *exact[3] = { &tanR, &tanG, &tanB };
+    float maxError = 0.0f;
+    for ( int c = 0; c < 3; c++ )
+    {
+        Vector2f interp = *tan[0][c] * w0 + *tan[1][c] * w1 + *tan[2][c] * w2;
+        maxError = Alg::Max ( maxError, ( interp - *exact[c] ).Length() );
+    }
+    return maxError;
+}
+
+float DistortionMeshMeasureError ( const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                   int numTriangles, bool rightEye,
+                                   const HmdRenderInfo &hmdRenderInfo, const DistortionRenderDesc &distortion,
+                                   int samplesPerEdge )
+{
+    float xOffset = rightEye ? 1.0f : 0.0f;
+    float maxError = 0.0f;
+    for ( int t = 0; t < numTriangles; t++ )
+    {
+        const DistortionMeshVertexData *v[3];
+        Vector2f screenNDC[3];
+        for ( int i = 0; i < 3; i++ )
+        {
+            v[i] = &pVertices[pTriangleListIndices[t * 3 + i]];
+            // Undo the placement of DistortionMeshFinishVertex
+            screenNDC[i].x = ( v[i]->ScreenPosNDC.x + 0.5f - xOffset ) * 2.0f;
+            screenNDC[i].y = -v[i]->ScreenPosNDC.y;
+        }
+
+        for ( int a = 0; a <= samplesPerEdge; a++ )
+        {
+            for ( int b = 0; a + b <= samplesPerEdge; b++ )
+            {
+                float w1 = (float)a / (float)samplesPerEdge;
+                float w2 = (float)b / (float)samplesPerEdge;
+                float w0 = 1.0f - w1 - w2;
+                Vector2f p = screenNDC[0] * w0 + screenNDC[1] * w1 + screenNDC[2] * w2;
+
+                Vector2f tanR, tanG, tanB;
+                TransformScreenNDCToTanFovSpaceChroma ( &tanR, &tanG, &tanB, distortion, p );
+                float error = ( v[0]->TanEyeAnglesR * w0 + v[1]->TanEyeAnglesR * w1 + v[2]->TanEyeAnglesR * w2 - tanR ).Length();
+                error = Alg::Max ( error, ( v[0]->TanEyeAnglesG * w0 + v[1]->TanEyeAnglesG * w1 + v[2]->TanEyeAnglesG * w2 - tanG ).Length() );
+                error = Alg::Max ( error, ( v[0]->TanEyeAnglesB * w0 + v[1]->TanEyeAnglesB * w1 + v[2]->TanEyeAnglesB * w2 - tanB ).Length() );
+                maxError = Alg::Max ( maxError, error );
+            }
+        }
+    }
+    return maxError * DistortionMeshPixelsPerTanAngle ( hmdRenderInfo, distortion );
+}
+
+
+// The quadtree of an adaptive mesh. Cells live on the lattice of the largest grid; the
+// vertices of its points are made on first use and numbered in order of use.
+struct DistortionMeshQuadtree
+{
+    struct Cell
+    {
+        uint8_t X, Y, SizeLog2;
+    };
+
+    enum
+    {
+        LatticeSize = DMA_MaxGridSize + 1
+    };
+
+    bool                            RightEye;
+    const HmdRenderInfo*            pHmdRenderInfo;
+    const DistortionRenderDesc*     pDistortion;
+    const ScaleAndOffset2D*         pEyeToSourceNDC;
+    float                           ToleranceTanAngle;
+
+    DistortionMeshVertexData*       pLatticeVerts;      // LatticeSize^2
+    Vector2f*                       pLatticeScreenNDC;  // LatticeSize^2
+    int*                            pLatticeIndex;      // LatticeSize^2, -2 not made yet, -1 made but not used
+    uint8_t*                        pLeafSizeLog2;      // DMA_MaxGridSize^2, the size of the leaf on each cell
+
+    Array<Cell>                     Leaves;
+    Array<DistortionMeshVertexData> Vertices;
+    Array<uint16_t>                 Indices;
+
+    int LatticePoint ( int x, int y )
+    {
+        int i = y * LatticeSize + x;
+        if ( pLatticeIndex[i] == -2 )
+        {
+            Vector2f sourceCoordNDC;
+            sourceCoordNDC.x = 2.0f * ( (float)x / (float)DMA_MaxGridSize ) - 1.0f;
+            sourceCoordNDC.y = 2.0f * ( (float)y / (float)DMA_MaxGridSize ) - 1.0f;
+            Vector2f tanEyeAngle = TransformRendertargetNDCToTanFovSpace ( *pEyeToSourceNDC, sourceCoordNDC );
+
+            // As in DistortionMeshMakeRow
+            Vector2f screenNDC = TransformTanFovSpaceToScreenNDC ( *pDistortion, tanEyeAngle, false );
+            screenNDC.x = Alg::Max ( -1.0f, Alg::Min ( screenNDC.x, 1.0f ) );
+            screenNDC.y = Alg::Max ( -1.0f, Alg::Min ( screenNDC.y, 1.0f ) );
+
+            pLatticeScreenNDC[i] = screenNDC;
+            pLatticeVerts[i]     = DistortionMeshMakeVertex ( screenNDC, RightEye, *pHmdRenderInfo, *pDistortion, *pEyeToSourceNDC );
+            pLatticeIndex[i]     = -1;
+        }
+        return i;
+    }
+
+    uint16_t VertexIndex ( int x, int y )
+    {
+        int i = LatticePoint ( x, y );
+        if ( pLatticeIndex[i] < 0 )
+        {
+            pLatticeIndex[i] = Vertices.GetSizeI();
+            Vertices.PushBack ( pLatticeVerts[i] );
+        }
+        return (uint16_t)pLatticeIndex[i];
+    }
+
+    // The quadrant rule of the uniform mesh: which diagonal splits the cell.
+    static bool SplitsOnMainDiagonal ( int x, int y, int size )
+    {
+        return ( ( y + size/2 < DMA_MaxGridSize/2 ) != ( x + size/2 < DMA_MaxGridSize/2 ) );
+    }
+
+    // Largest error of the two triangles of the cell at some lattice points inside it.
+    float CellError ( int x, int y, int size )
+    {
+        int corners[4] = { LatticePoint ( x, y ),        LatticePoint ( x + size, y ),
+                           LatticePoint ( x, y + size ), LatticePoint ( x + size, y + size ) };
+        // Triangles as DistortionMeshCreate winds them: 0,1,3 + 3,2,0 or 0,1,2 + 1,3,2
+        static const int mainTris[2][3]  = { { 0, 1, 3 }, { 3, 2, 0 } };
+        static const int otherTris[2][3] = { { 0, 1, 2 }, { 1, 3, 2 } };
+        const int (*tris)[3] = SplitsOnMainDiagonal ( x, y, size ) ? mainTris : otherTris;
+
+        // The vertices a split would add, and the centres of the quads it would make when
+        // they are on the lattice: the curvature across a quad shows best there.
+        const int half = size / 2, quarter = size / 4;
+        const int tests[9][2] = { { half, half }, { half, 0 }, { 0, half }, { size, half }, { half, size },
+                                  { quarter, quarter }, { half + quarter, quarter },
+                                  { quarter, half + quarter }, { half + quarter, half + quarter } };
+        const int testCount = ( quarter > 0 ) ? 9 : 5;
+
+        float maxError = 0.0f;
+        for ( int t = 0; t < testCount; t++ )
+        {
+            const DistortionMeshVertexData &exact = pLatticeVerts[LatticePoint ( x + tests[t][0], y + tests[t][1] )];
+            Vector2f p = pLatticeScreenNDC[( y + tests[t][1] ) * LatticeSize + x + tests[t][0]];
+
+            for ( int tri = 0; tri < 2; tri++ )
+            {
+                const Vector2f *pos[3];
+                const Vector2f *tan[3][3];
+                for ( int k = 0; k < 3; k++ )
+                {
+                    const int corner = corners[tris[tri][k]];
+                    pos[k]    = &pLatticeScreenNDC[corner];
+                    tan[k][0] = &pLatticeVerts[corner].TanEyeAnglesR;
+                    tan[k][1] = &pLatticeVerts[corner].TanEyeAnglesG;
+                    tan[k][2] = &pLatticeVerts[corner].TanEyeAnglesB;
+                }
+                bool  inside;
+                float error = DistortionMeshTriangleError ( pos, tan, p, exact.TanEyeAnglesR, exact.TanEyeAnglesG,
+                                                            exact.TanEyeAnglesB, &inside );
+                if ( inside )
+                {
+                    maxError = Alg::Max ( maxError, error );
+                    break;
+                }
+            }
+        }
+        return maxError;
+    }
+
+    void SetLeaf ( int x, int y, int sizeLog2 )
+    {
+        const int size = 1 << sizeLog2;
+        for ( int cy = y; cy < y + size; cy++ )
+        {
+            memset ( pLeafSizeLog2 + cy * DMA_MaxGridSize + x, sizeLog2, size );
+        }
+        Cell cell = { (uint8_t)x, (uint8_t)y, (uint8_t)sizeLog2 };
+        Leaves.PushBack ( cell );
+    }
+
+    // Splits down to the largest cells within tolerance, in Morton order.
+    void Refine ( int x, int y, int sizeLog2 )
+    {
+        const int size = 1 << sizeLog2;
+        if ( sizeLog2 == 0 ||
+             ( sizeLog2 <= DMA_MaxGridSizeLog2 - DMA_AdaptiveMinGridSizeLog2 && CellError ( x, y, size ) <= ToleranceTanAngle ) )
+        {
+            SetLeaf ( x, y, sizeLog2 );
+            return;
+        }
+        const int half = size / 2;
+        Refine ( x,        y,        sizeLog2 - 1 );
+        Refine ( x + half, y,        sizeLog2 - 1 );
+        Refine ( x,        y + half, sizeLog2 - 1 );
+        Refine ( x + half, y + half, sizeLog2 - 1 );
+    }
+
+    // Size of the leaf on the cell at x,y, or 255 off the lattice.
+    int LeafSizeLog2 ( int x, int y ) const
+    {
+        if ( x < 0 || y < 0 || x >= DMA_MaxGridSize || y >= DMA_MaxGridSize )
+        {
+            return 255;
+        }
+        return pLeafSizeLog2[y * DMA_MaxGridSize + x];
+    }
+
+    // Smallest leaf along one side of a cell, walking from x,y by dx,dy.
+    int MinNeighbourSizeLog2 ( int x, int y, int dx, int dy, int size ) const
+    {
+        int minSizeLog2 = 255;
+        for ( int i = 0; i < size; i++ )
+        {
+            minSizeLog2 = Alg::Min ( minSizeLog2, LeafSizeLog2 ( x + i * dx, y + i * dy ) );
+        }
+        return minSizeLog2;
+    }
+
+    // Splits leaves until neighbours differ by one level at most, so each side of a leaf
+    // has one vertex in its middle at most.
+    void Balance()
+    {
+        Array<Cell> leaves;
+        bool        changed = true;
+        while ( changed )
+        {
+            changed = false;
+            leaves = Leaves;
+            Leaves.Clear();
+            for ( int i = 0; i < leaves.GetSizeI(); i++ )
+            {
+                const Cell cell = leaves[i];
+                const int  x    = cell.X, y = cell.Y, sizeLog2 = cell.SizeLog2, size = 1 << sizeLog2;
+                int minSizeLog2 = Alg::Min ( Alg::Min ( MinNeighbourSizeLog2 ( x, y - 1,    1, 0, size ),
+                                                        MinNeighbourSizeLog2 ( x, y + size, 1, 0, size ) ),
+                                             Alg::Min ( MinNeighbourSizeLog2 ( x - 1,    y, 0, 1, size ),
+                                                        MinNeighbourSizeLog2 ( x + size, y, 0, 1, size ) ) );
+                if ( minSizeLog2 + 1 < sizeLog2 )
+                {
+                    const int half = size / 2;
+                    SetLeaf ( x,        y,        sizeLog2 - 1 );
+                    SetLeaf ( x + half, y,        sizeLog2 - 1 );
+                    SetLeaf ( x,        y + half, sizeLog2 - 1 );
+                    SetLeaf ( x + half, y + half, sizeLog2 - 1 );
+                    changed = true;
+                }
+                else
+                {
+                    Leaves.PushBack ( cell );
+                }
+            }
+        }
+    }
+
+    // Two triangles per leaf as in the uniform mesh, or a fan around its centre when
+    // smaller neighbours put vertices in the middle of its sides.
+    void Triangulate()
+    {
+        for ( int i = 0; i < Leaves.GetSizeI(); i++ )
+        {
+            const Cell cell = Leaves[i];
+            const int  x    = cell.X, y = cell.Y, sizeLog2 = cell.SizeLog2, size = 1 << sizeLog2, half = size / 2;
+
+            bool bottom = sizeLog2 > 0 && LeafSizeLog2 ( x, y - 1 )    < sizeLog2;
+            bool right  = sizeLog2 > 0 && LeafSizeLog2 ( x + size, y ) < sizeLog2;
+            bool top    = sizeLog2 > 0 && LeafSizeLog2 ( x, y + size ) < sizeLog2;
+            bool left   = sizeLog2 > 0 && LeafSizeLog2 ( x - 1, y )    < sizeLog2;
+
+            if ( !bottom && !right && !top && !left )
+            {
+                uint16_t v00 = VertexIndex ( x, y ),        v10 = VertexIndex ( x + size, y );
+                uint16_t v01 = VertexIndex ( x, y + size ), v11 = VertexIndex ( x + size, y + size );
+                if ( SplitsOnMainDiagonal ( x, y, size ) )
+                {
+                    Indices.PushBack ( v00 ); Indices.PushBack ( v10 ); Indices.PushBack ( v11 );
+                    Indices.PushBack ( v11 ); Indices.PushBack ( v01 ); Indices.PushBack ( v00 );
+                }
+                else
+                {
+                    Indices.PushBack ( v00 ); Indices.PushBack ( v10 ); Indices.PushBack ( v01 );
+                    Indices.PushBack ( v10 ); Indices.PushBack ( v11 ); Indices.PushBack ( v01 );
+                }
+                continue;
+            }
+
+            // The sides in the winding order of the two-triangle case
+            uint16_t ring[8];
+            int      ringSize = 0;
+            ring[ringSize++] = VertexIndex ( x, y );
+            if ( bottom ) ring[ringSize++] = VertexIndex ( x + half, y );
+            ring[ringSize++] = VertexIndex ( x + size, y );
+            if ( right )  ring[ringSize++] = VertexIndex ( x + size, y + half );
+            ring[ringSize++] = VertexIndex ( x + size, y + size );
+            if ( top )    ring[ringSize++] = VertexIndex ( x + half, y + size );
+            ring[ringSize++] = VertexIndex ( x, y + size );
+            if ( left )   ring[ringSize++] = VertexIndex ( x, y + half );
+
+            uint16_t centre = VertexIndex ( x + half, y + half );
+            for ( int k = 0; k < ringSize; k++ )
+            {
+                Indices.PushBack ( centre );
+                Indices.PushBack ( ring[k] );
+                Indices.PushBack ( ring[( k + 1 ) % ringSize] );
+            }
+        }
+    }
+};
+
+void DistortionMeshCreateAdaptive( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                                   int *pNumVertices, int *pNumTriangles,
+                                   bool rightEye,
+                                   const HmdRenderInfo &hmdRenderInfo,
+                                   const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                   float tolerancePixels )
+{
+    *ppVertices             = NULL;
+    *ppTriangleListIndices  = NULL;
+    *pNumTriangles          = 0;
+    *pNumVertices           = 0;
+
+    const int latticePoints = DistortionMeshQuadtree::LatticeSize * DistortionMeshQuadtree::LatticeSize;
+    const int cells         = DMA_MaxGridSize * DMA_MaxGridSize;
+    uint8_t* pScratch = (uint8_t*) OVR_ALLOC( latticePoints * ( sizeof(DistortionMeshVertexData) + sizeof(Vector2f) + sizeof(int) ) + cells );
+    if (!pScratch)
+    {
+        return;
+    }
+
+    DistortionMeshQuadtree tree;
+    tree.RightEye          = rightEye;
+    tree.pHmdRenderInfo    = &hmdRenderInfo;
+    tree.pDistortion       = &distortion;
+    tree.pEyeToSourceNDC   = &eyeToSourceNDC;
+    tree.ToleranceTanAngle = tolerancePixels / DistortionMeshPixelsPerTanAngle ( hmdRenderInfo, distortion );
+    tree.pLatticeVerts     = (DistortionMeshVertexData*)pScratch;
+    tree.pLatticeScreenNDC = (Vector2f*)( tree.pLatticeVerts + latticePoints );
+    tree.pLatticeIndex     = (int*)( tree.pLatticeScreenNDC + latticePoints );
+    tree.pLeafSizeLog2     = (uint8_t*)( tree.pLatticeIndex + latticePoints );
+    for ( int i = 0; i < latticePoints; i++ )
+    {
+        tree.pLatticeIndex[i] = -2;
+    }
+
+    tree.Refine ( 0, 0, DMA_MaxGridSizeLog2 );
+    tree.Balance();
+    tree.Triangulate();
+    OVR_FREE ( pScratch );
+
+    *pNumVertices  = tree.Vertices.GetSizeI();
+    *pNumTriangles = tree.Indices.GetSizeI() / 3;
+    *ppVertices = (DistortionMeshVertexData*)
+                      OVR_ALLOC( sizeof(DistortionMeshVertexData) * (*pNumVertices) );
+    *ppTriangleListIndices  = (uint16_t*) OVR_ALLOC( sizeof(uint16_t) * (*pNumTriangles) * 3 );
+
+    if (!*ppVertices || !*ppTriangleListIndices)
+    {
+        if (*ppVertices)
+        {
+            OVR_FREE(*ppVertices);
+        }
+        if (*ppTriangleListIndices)
+        {
+            OVR_FREE(*ppTriangleListIndices);
         }
+        *ppVertices             = NULL;
+        *ppTriangleListIndices  = NULL;
+        *pNumTriangles          = 0;
+        *pNumVertices           = 0;
+        return;
     }
+
+    memcpy ( *ppVertices, &tree.Vertices[0], sizeof(DistortionMeshVertexData) * (*pNumVertices) );
+    memcpy ( *ppTriangleListIndices, &tree.Indices[0], sizeof(uint16_t) * (*pNumTriangles) * 3 );
 }
 
 //-----------------------------------------------------------------------------------
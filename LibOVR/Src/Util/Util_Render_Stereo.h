@@ -346,8 +346,41 @@ void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppT
                            const HmdRenderInfo &hmdRenderInfo, 
                            const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC );
 
+// Same, on a grid of (1<<gridSizeLog2) quads a side, gridSizeLog2 from 1 to 7.
+// The rows are built by threadCount threads, the calling one included; 0 picks a count
+// from the grid size and the CPU count.
+void DistortionMeshCreate( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                           int *pNumVertices, int *pNumTriangles,
+                           bool rightEye,
+                           const HmdRenderInfo &hmdRenderInfo,
+                           const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                           int gridSizeLog2, int threadCount );
+
+// Same, with the quads of an 8x8 grid split down to the cells of the 128x128 grid until the
+// tan(angle) vectors interpolated over their triangles are within tolerancePixels of
+// TransformScreenNDCToTanFovSpaceChroma, so the mesh is dense only where the lens bends most.
+// Quads next to smaller ones are fanned around their centre to take the extra side vertices.
+void DistortionMeshCreateAdaptive( DistortionMeshVertexData **ppVertices, uint16_t **ppTriangleListIndices,
+                                   int *pNumVertices, int *pNumTriangles,
+                                   bool rightEye,
+                                   const HmdRenderInfo &hmdRenderInfo,
+                                   const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC,
+                                   float tolerancePixels );
+
 void DistortionMeshDestroy ( DistortionMeshVertexData *pVertices, uint16_t *pTriangleMeshIndices );
 
+// Pixels of a render target at the density of the lens centre per unit of tan(angle):
+// the unit of the tolerance of DistortionMeshCreateAdaptive.
+float DistortionMeshPixelsPerTanAngle ( const HmdRenderInfo &hmdRenderInfo, const DistortionRenderDesc &distortion );
+
+// Largest difference, in pixels as above, between the tan(angle) vectors interpolated over
+// the triangles of a mesh and TransformScreenNDCToTanFovSpaceChroma, sampled on a grid of
+// samplesPerEdge steps along the sides of each triangle.
+float DistortionMeshMeasureError ( const DistortionMeshVertexData *pVertices, const uint16_t *pTriangleListIndices,
+                                   int numTriangles, bool rightEye,
+                                   const HmdRenderInfo &hmdRenderInfo, const DistortionRenderDesc &distortion,
+                                   int samplesPerEdge );
+
 
 //-----------------------------------------------------------------------------------
 // *****  Heightmap Mesh Rendering
@@ -0,0 +1,507 @@
+/************************************************************************************
+
+Filename    :   Util_Render_Stereo_Benchmark.cpp
+Content     :   Benchmarks and accuracy checks of the distortion code
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#include "Util_Render_Stereo_Benchmark.h"
+#include "Util_Render_SoftwareDistortion.h"
+#include "../OVR_Profile.h"
+#include "../Kernel/OVR_CRC32.h"
+#include "../Kernel/OVR_Timer.h"
+#include "../Kernel/OVR_Log.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+// The vertices of DistortionMeshCreate, computed one at a time with the scalar functions
+static void DistortionMeshMakeVerticesScalar ( DistortionMeshVertexData *pVertices, int gridSize,
+                                               bool rightEye, const HmdRenderInfo &hmdRenderInfo,
+                                               const DistortionRenderDesc &distortion, const ScaleAndOffset2D &eyeToSourceNDC )
+{
+    DistortionMeshVertexData* pcurVert = pVertices;
+    for ( int y = 0; y <= gridSize; y++ )
+    {
+        for ( int x = 0; x <= gridSize; x++ )
+        {
+            Vector2f sourceCoordNDC;
+            sourceCoordNDC.x = 2.0f * ( (float)x / (float)gridSize ) - 1.0f;
+            sourceCoordNDC.y = 2.0f * ( (float)y / (float)gridSize ) - 1.0f;
+            Vector2f tanEyeAngle = TransformRendertargetNDCToTanFovSpace ( eyeToSourceNDC, sourceCoordNDC );
+
+            Vector2f screenNDC = TransformTanFovSpaceToScreenNDC ( distortion, tanEyeAngle, false );
+            screenNDC.x = Alg::Max ( -1.0f, Alg::Min ( screenNDC.x, 1.0f ) );
+            screenNDC.y = Alg::Max ( -1.0f, Alg::Min ( screenNDC.y, 1.0f ) );
+
+            *pcurVert++ = DistortionMeshMakeVertex ( screenNDC, rightEye, hmdRenderInfo, distortion, eyeToSourceNDC );
+        }
+    }
+}
+
+static float DistortionMeshMaxError ( const DistortionMeshVertexData *a, const DistortionMeshVertexData *b, int count )
+{
+    const int floatCount = count * (int)( sizeof(DistortionMeshVertexData) / sizeof(float) );
+    const float *fa = (const float*)a;
+    const float *fb = (const float*)b;
+
+    float maxError = 0.0f;
+    for ( int i = 0; i < floatCount; i++ )
+    {
+        maxError = Alg::Max ( maxError, Alg::Abs ( fa[i] - fb[i] ) );
+    }
+    return maxError;
+}
+
+void RunDistortionMeshBenchmark(const HmdRenderInfo& hmdRenderInfo, int iterations, int threadCount,
+                                DistortionMeshBenchmarkResult results[DistortionMeshBenchmark_GridSizes])
+{
+    memset(results, 0, sizeof(DistortionMeshBenchmarkResult) * DistortionMeshBenchmark_GridSizes);
+    iterations = Alg::Max(iterations, 1);
+
+    DistortionRenderDesc distortion     = CalculateDistortionRenderDesc ( StereoEye_Left, hmdRenderInfo );
+    FovPort              fov            = CalculateFovFromHmdInfo ( StereoEye_Left, distortion, hmdRenderInfo );
+    ScaleAndOffset2D     eyeToSourceNDC = CreateNDCScaleAndOffsetFromFov ( fov );
+
+    for ( int g = 0; g < DistortionMeshBenchmark_GridSizes; g++ )
+    {
+        DistortionMeshBenchmarkResult& result = results[g];
+        result.GridSizeLog2 = DistortionMeshBenchmark_MinGridSizeLog2 + g;
+        const int gridSize  = 1 << result.GridSizeLog2;
+        result.Vertices     = (gridSize+1)*(gridSize+1);
+
+        DistortionMeshVertexData* pScalarVertices = (DistortionMeshVertexData*)
+            OVR_ALLOC( sizeof(DistortionMeshVertexData) * result.Vertices );
+        if (!pScalarVertices)
+        {
+            return;
+        }
+
+        double start = Timer::GetSeconds();
+        for ( int i = 0; i < iterations; i++ )
+        {
+            DistortionMeshMakeVerticesScalar ( pScalarVertices, gridSize, false, hmdRenderInfo, distortion, eyeToSourceNDC );
+        }
+        result.ScalarSeconds = ( Timer::GetSeconds() - start ) / iterations;
+
+        // Index generation is included: it is part of every rebuild
+        for ( int threaded = 0; threaded < 2; threaded++ )
+        {
+            start = Timer::GetSeconds();
+            for ( int i = 0; i < iterations; i++ )
+            {
+                DistortionMeshVertexData* pVertices = NULL;
+                uint16_t*                 pIndices  = NULL;
+                int                       vertexCount = 0, triangleCount = 0;
+                DistortionMeshCreate ( &pVertices, &pIndices, &vertexCount, &triangleCount,
+                                       false, hmdRenderInfo, distortion, eyeToSourceNDC,
+                                       result.GridSizeLog2, threaded ? threadCount : 1 );
+
+                if ( i == 0 && pVertices )
+                {
+                    result.MaxError = Alg::Max ( result.MaxError,
+                                                 DistortionMeshMaxError ( pScalarVertices, pVertices, vertexCount ) );
+                }
+                DistortionMeshDestroy ( pVertices, pIndices );
+            }
+            double seconds = ( Timer::GetSeconds() - start ) / iterations;
+            if ( threaded )
+            {
+                result.ThreadedSeconds = seconds;
+            }
+            else
+            {
+                result.BatchSeconds = seconds;
+            }
+        }
+
+        OVR_FREE ( pScalarVertices );
+
+        LogText("[Distortion Mesh Benchmark] %3dx%-3d %6d vertices: scalar %.3f ms, batch %.3f ms, threaded %.3f ms (%.1fx), max error %g\n",
+                gridSize, gridSize, result.Vertices, result.ScalarSeconds * 1000., result.BatchSeconds * 1000.,
+                result.ThreadedSeconds * 1000., result.ThreadedSeconds > 0. ? result.ScalarSeconds / result.ThreadedSeconds : 0.,
+                result.MaxError);
+    }
+}
+
+void RunAdaptiveDistortionMeshBenchmark(const HmdRenderInfo& hmdRenderInfo, int iterations, float tolerancePixels,
+                                        DistortionMeshTessellationResult results[DistortionMeshTessellation_Count])
+{
+    memset(results, 0, sizeof(DistortionMeshTessellationResult) * DistortionMeshTessellation_Count);
+    iterations = Alg::Max(iterations, 1);
+
+    DistortionRenderDesc distortion     = CalculateDistortionRenderDesc ( StereoEye_Left, hmdRenderInfo );
+    FovPort              fov            = CalculateFovFromHmdInfo ( StereoEye_Left, distortion, hmdRenderInfo );
+    ScaleAndOffset2D     eyeToSourceNDC = CreateNDCScaleAndOffsetFromFov ( fov );
+
+    for ( int m = 0; m < DistortionMeshTessellation_Count; m++ )
+    {
+        DistortionMeshTessellationResult& result = results[m];
+
+        // One build to measure, then the timed ones
+        double start = 0.;
+        for ( int i = 0; i <= iterations; i++ )
+        {
+            if ( i == 1 )
+            {
+                start = Timer::GetSeconds();
+            }
+
+            DistortionMeshVertexData* pVertices = NULL;
+            uint16_t*                 pIndices  = NULL;
+            if ( m == DistortionMeshTessellation_Adaptive )
+            {
+                DistortionMeshCreateAdaptive ( &pVertices, &pIndices, &result.Vertices, &result.Triangles,
+                                               false, hmdRenderInfo, distortion, eyeToSourceNDC, tolerancePixels );
+            }
+            else
+            {
+                DistortionMeshCreate ( &pVertices, &pIndices, &result.Vertices, &result.Triangles,
+                                       false, hmdRenderInfo, distortion, eyeToSourceNDC );
+            }
+
+            if ( i == 0 && pVertices )
+            {
+                result.MaxErrorPixels = DistortionMeshMeasureError ( pVertices, pIndices, result.Triangles,
+                                                                     false, hmdRenderInfo, distortion, 8 );
+            }
+            DistortionMeshDestroy ( pVertices, pIndices );
+        }
+        result.Seconds = ( Timer::GetSeconds() - start ) / iterations;
+    }
+
+    static const char* modeNames[DistortionMeshTessellation_Count] = { "uniform", "adaptive" };
+    for ( int m = 0; m < DistortionMeshTessellation_Count; m++ )
+    {
+        LogText("[Distortion Mesh Benchmark] %-8s %6d vertices %6d triangles: %.3f ms, max error %.3f pixels (tolerance %.3f)\n",
+                modeNames[m], results[m].Vertices, results[m].Triangles, results[m].Seconds * 1000.,
+                results[m].MaxErrorPixels, tolerancePixels);
+    }
+}
+
+// A checkerboard of 16 pixel squares over colour ramps
+static void SoftwareDistortionFillTestTexture ( uint8_t* pTexture, Sizei textureSize )
+{
+    for ( int y = 0; y < textureSize.h; y++ )
+    {
+        uint8_t* pixel = pTexture + y * textureSize.w * 4;
+        for ( int x = 0; x < textureSize.w; x++, pixel += 4 )
+        {
+            bool light = ( ( x >> 4 ) ^ ( y >> 4 ) ) & 1;
+            pixel[0] = (uint8_t)( light ? 255 : x * 255 / textureSize.w );
+            pixel[1] = (uint8_t)( light ? 255 : y * 255 / textureSize.h );
+            pixel[2] = (uint8_t)( light ? 255 : 128 );
+            pixel[3] = 255;
+        }
+    }
+}
+
+
+// The golden frames: fixed meshes, texture and timewarp, built from values that are exact in
+// binary with no library maths, so the frame only depends on the renderer. When the renderer
+// is meant to change its output, update the CRCs from the log of a run.
+enum { SoftwareDistortionGolden_GridSize = 16, SoftwareDistortionGolden_Cases = 2 };
+
+static const unsigned SoftwareDistortionGoldenFlags[SoftwareDistortionGolden_Cases] =
+{
+    0,
+    SoftwareDistortion_Chromatic | SoftwareDistortion_Vignette | SoftwareDistortion_TimeWarp
+};
+static const uint32_t SoftwareDistortionGoldenCRCs[SoftwareDistortionGolden_Cases] =
+{
+    0x96374eee,
+    0xb1dc41e5
+};
+
+// A grid over each half of the frame, with a barrel curve, red and blue scaled apart,
+// the timewarp lerp across and the vignette darkening the corners, black on the border
+static void SoftwareDistortionMakeGoldenMesh ( DistortionMeshVertexData* pVertices, uint16_t* pIndices, int eyeNum )
+{
+    const int   gridSize = SoftwareDistortionGolden_GridSize;
+    const float step     = 1.0f / (float)gridSize;
+
+    DistortionMeshVertexData* pcurVert = pVertices;
+    for ( int y = 0; y <= gridSize; y++ )
+    {
+        for ( int x = 0; x <= gridSize; x++, pcurVert++ )
+        {
+            float u  = (float)x * step;
+            float v  = (float)y * step;
+            float tx = 2.0f * u - 1.0f;
+            float ty = 2.0f * v - 1.0f;
+            float scale = 1.0f + 0.25f * ( tx * tx + ty * ty );
+
+            pcurVert->ScreenPosNDC  = Vector2f ( u - 1.0f + (float)eyeNum, 2.0f * v - 1.0f );
+            pcurVert->TimewarpLerp  = u;
+            pcurVert->Shade         = ( x == 0 || y == 0 || x == gridSize || y == gridSize ) ? 0.0f : 1.0f - 0.5f * tx * tx * ty * ty;
+            pcurVert->TanEyeAnglesG = Vector2f ( tx * scale, ty * scale );
+            pcurVert->TanEyeAnglesR = pcurVert->TanEyeAnglesG * 0.984375f;
+            pcurVert->TanEyeAnglesB = pcurVert->TanEyeAnglesG * 1.015625f;
+        }
+    }
+
+    uint16_t* pcurIndex = pIndices;
+    for ( int y = 0; y < gridSize; y++ )
+    {
+        for ( int x = 0; x < gridSize; x++ )
+        {
+            uint16_t first = (uint16_t)( y * ( gridSize + 1 ) + x );
+            uint16_t below = (uint16_t)( first + gridSize + 1 );
+            *pcurIndex++ = first;
+            *pcurIndex++ = (uint16_t)( first + 1 );
+            *pcurIndex++ = below;
+            *pcurIndex++ = (uint16_t)( first + 1 );
+            *pcurIndex++ = (uint16_t)( below + 1 );
+            *pcurIndex++ = below;
+        }
+    }
+}
+
+// Renders each golden case at every benchmark thread count and compares the frame CRCs with
+// the stored ones. Returns false on any mismatch.
+static bool SoftwareDistortionCheckGolden()
+{
+    const Sizei frameSize    ( 320, 180 );
+    const Sizei textureSize  ( 128, 128 );
+    const int   gridSize     = SoftwareDistortionGolden_GridSize;
+    const int   numVertices  = ( gridSize + 1 ) * ( gridSize + 1 );
+    const int   numTriangles = gridSize * gridSize * 2;
+
+    uint8_t*                  pFrame    = (uint8_t*) OVR_ALLOC( frameSize.w * frameSize.h * 4 );
+    uint8_t*                  pTexture  = (uint8_t*) OVR_ALLOC( textureSize.w * textureSize.h * 4 );
+    DistortionMeshVertexData* pVertices = (DistortionMeshVertexData*) OVR_ALLOC( sizeof(DistortionMeshVertexData) * numVertices * 2 );
+    uint16_t*                 pIndices  = (uint16_t*) OVR_ALLOC( sizeof(uint16_t) * numTriangles * 3 * 2 );
+    bool passed = ( pFrame && pTexture && pVertices && pIndices );
+
+    if ( passed )
+    {
+        SoftwareDistortionFillTestTexture ( pTexture, textureSize );
+
+        SoftwareDistortionEye eyes[2];
+        for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+        {
+            SoftwareDistortionEye& eye = eyes[eyeNum];
+            eye.pVertices    = pVertices + numVertices * eyeNum;
+            eye.pIndices     = pIndices + numTriangles * 3 * eyeNum;
+            eye.NumVertices  = numVertices;
+            eye.NumTriangles = numTriangles;
+            SoftwareDistortionMakeGoldenMesh ( (DistortionMeshVertexData*)eye.pVertices, (uint16_t*)eye.pIndices, eyeNum );
+
+            eye.Texture  = SoftwareDistortionImage ( pTexture, textureSize.w, textureSize.h, textureSize.w * 4 );
+            eye.UVScale  = Vector2f ( 0.375f, 0.375f );
+            eye.UVOffset = Vector2f ( 0.5f, 0.5f );
+            // A small turn to the side over the frame, as a shear of the view direction
+            eye.TimewarpStart = Matrix4f::Identity();
+            eye.TimewarpEnd   = Matrix4f::Identity();
+            eye.TimewarpEnd.M[0][2] = eyeNum ? -0.0625f : 0.0625f;
+        }
+
+        const SoftwareDistortionImage frame ( pFrame, frameSize.w, frameSize.h, frameSize.w * 4 );
+        for ( int g = 0; g < SoftwareDistortionGolden_Cases; g++ )
+        {
+            for ( int t = 0; t < SoftwareDistortionBenchmark_ThreadCounts; t++ )
+            {
+                SoftwareDistortionRender ( frame, eyes, SoftwareDistortionGoldenFlags[g], Color ( 0, 0, 64 ), 1 << t );
+                uint32_t crc = CRC32_Calculate ( pFrame, frameSize.w * frameSize.h * 4 );
+                if ( crc != SoftwareDistortionGoldenCRCs[g] )
+                {
+                    LogError("[Software Distortion Benchmark] Golden frame %d (flags %x), %d threads: CRC %08x, expected %08x",
+                             g, SoftwareDistortionGoldenFlags[g], 1 << t, crc, SoftwareDistortionGoldenCRCs[g]);
+                    passed = false;
+                }
+            }
+        }
+    }
+
+    OVR_FREE ( pIndices );
+    OVR_FREE ( pVertices );
+    OVR_FREE ( pTexture );
+    OVR_FREE ( pFrame );
+    return passed;
+}
+
+bool RunSoftwareDistortionBenchmark(const HmdRenderInfo& hmdRenderInfo, int iterations,
+                                    SoftwareDistortionBenchmarkResult results[SoftwareDistortionBenchmark_ThreadCounts])
+{
+    memset(results, 0, sizeof(SoftwareDistortionBenchmarkResult) * SoftwareDistortionBenchmark_ThreadCounts);
+    iterations = Alg::Max(iterations, 1);
+
+    bool passed = SoftwareDistortionCheckGolden();
+    LogText("[Software Distortion Benchmark] Golden frames %s\n", passed ? "match" : "DO NOT MATCH");
+
+    const Sizei textureSize = CalculateRecommendedTextureSize ( hmdRenderInfo, false );
+    const Sizei frameSize   = hmdRenderInfo.ResolutionInPixels;
+    if ( textureSize.w <= 0 || textureSize.h <= 0 || frameSize.w <= 0 || frameSize.h <= 0 )
+    {
+        return false;
+    }
+
+    uint8_t* pFrame   = (uint8_t*) OVR_ALLOC( frameSize.w * frameSize.h * 4 );
+    uint8_t* pTexture = (uint8_t*) OVR_ALLOC( textureSize.w * textureSize.h * 4 );
+    SoftwareDistortionEye eyes[2];
+    bool ok = ( pFrame && pTexture );
+
+    // Shared by both eyes
+    if ( ok )
+    {
+        SoftwareDistortionFillTestTexture ( pTexture, textureSize );
+    }
+
+    for ( int eyeNum = 0; ok && eyeNum < 2; eyeNum++ )
+    {
+        StereoEye            stereoEye      = eyeNum ? StereoEye_Right : StereoEye_Left;
+        DistortionRenderDesc distortion     = CalculateDistortionRenderDesc ( stereoEye, hmdRenderInfo );
+        FovPort              fov            = CalculateFovFromHmdInfo ( stereoEye, distortion, hmdRenderInfo );
+        ScaleAndOffset2D     eyeToSourceNDC = CreateNDCScaleAndOffsetFromFov ( fov );
+        ScaleAndOffset2D     eyeToSourceUV  = CreateUVScaleAndOffsetfromNDCScaleandOffset (
+                                                  eyeToSourceNDC, Recti ( Vector2i ( 0, 0 ), textureSize ), textureSize );
+
+        SoftwareDistortionEye& eye = eyes[eyeNum];
+        DistortionMeshCreate ( (DistortionMeshVertexData**)&eye.pVertices, (uint16_t**)&eye.pIndices,
+                               &eye.NumVertices, &eye.NumTriangles,
+                               eyeNum == 1, hmdRenderInfo, distortion, eyeToSourceNDC );
+        eye.Texture       = SoftwareDistortionImage ( pTexture, textureSize.w, textureSize.h, textureSize.w * 4 );
+        eye.UVScale       = eyeToSourceUV.Scale;
+        eye.UVOffset      = eyeToSourceUV.Offset;
+        // A small head turn over the frame
+        eye.TimewarpStart = Matrix4f::RotationY ( 0.01f );
+        eye.TimewarpEnd   = Matrix4f::RotationY ( 0.02f );
+        ok = ( eye.pVertices != NULL );
+    }
+
+    const SoftwareDistortionImage frame ( pFrame, frameSize.w, frameSize.h, frameSize.w * 4 );
+    const unsigned                flags = SoftwareDistortion_Chromatic | SoftwareDistortion_Vignette | SoftwareDistortion_TimeWarp;
+
+    for ( int t = 0; ok && t < SoftwareDistortionBenchmark_ThreadCounts; t++ )
+    {
+        SoftwareDistortionBenchmarkResult& result = results[t];
+        result.Threads = 1 << t;
+
+        double start = Timer::GetSeconds();
+        for ( int i = 0; i < iterations; i++ )
+        {
+            SoftwareDistortionRender ( frame, eyes, flags, Color ( 0, 0, 0 ), result.Threads );
+        }
+        result.Seconds  = ( Timer::GetSeconds() - start ) / iterations;
+        result.FrameCRC = CRC32_Calculate ( pFrame, frameSize.w * frameSize.h * 4 );
+
+        // The frame must not depend on the thread count
+        bool matches = ( result.FrameCRC == results[0].FrameCRC );
+        passed = passed && matches;
+
+        LogText("[Software Distortion Benchmark] %dx%d from %dx%d eyes, %d threads: %.3f ms, frame CRC %08x%s\n",
+                frameSize.w, frameSize.h, textureSize.w, textureSize.h, result.Threads,
+                result.Seconds * 1000., result.FrameCRC, matches ? "" : ", DIFFERS FROM 1 THREAD");
+    }
+
+    for ( int eyeNum = 0; eyeNum < 2; eyeNum++ )
+    {
+        if ( eyes[eyeNum].pVertices )
+        {
+            DistortionMeshDestroy ( (DistortionMeshVertexData*)eyes[eyeNum].pVertices, (uint16_t*)eyes[eyeNum].pIndices );
+        }
+    }
+    OVR_FREE ( pTexture );
+    OVR_FREE ( pFrame );
+    return passed && ok;
+}
+
+
+// The radius whose distortion is r on channel, by bisection on the exact curve of config
+// between 0 and maxR, where the curve increases
+static float LensDistortionInverseBisect ( LensConfig const &config, float r, LensDistortionTable::ChannelType channel, float maxR )
+{
+    double lo = 0.0, hi = maxR;
+    for ( int i = 0; i < 64 && lo < hi; i++ )
+    {
+        double mid = 0.5 * ( lo + hi );
+        if ( LensDistortionTable::DistortionFnChroma ( config, (float)mid, channel ) < r )
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return (float)( 0.5 * ( lo + hi ) );
+}
+
+bool RunLensDistortionTableAccuracyCheck(int sampleCount, float tolerance,
+                                         LensDistortionAccuracyResult results[LensDistortionAccuracy_Count])
+{
+    memset(results, 0, sizeof(LensDistortionAccuracyResult) * LensDistortionAccuracy_Count);
+    sampleCount = Alg::Max(sampleCount, 1);
+
+    static const HmdTypeEnum       hmdTypes[LensDistortionAccuracy_Count] = { HmdType_DK1, HmdType_DK1, HmdType_DK2, HmdType_DK2 };
+    static const DistortionEqnType eqns[LensDistortionAccuracy_Count]     = { Distortion_RecipPoly4, Distortion_CatmullRom10,
+                                                                              Distortion_RecipPoly4, Distortion_CatmullRom10 };
+    bool passed = true;
+    for ( int p = 0; p < LensDistortionAccuracy_Count; p++ )
+    {
+        LensDistortionAccuracyResult& result = results[p];
+        result.HmdType = hmdTypes[p];
+        result.Eqn     = eqns[p];
+
+        Ptr<Profile>  profile       = *ProfileManager::GetInstance()->GetDefaultProfile ( result.HmdType );
+        HmdRenderInfo hmdRenderInfo = GenerateHmdRenderInfoFromHmdInfo ( CreateDebugHMDInfo ( result.HmdType ), profile, result.Eqn );
+        LensConfig    config        = GenerateLensConfigFromEyeRelief ( hmdRenderInfo.EyeLeft.ReliefInMeters, hmdRenderInfo, result.Eqn );
+
+        Ptr<LensDistortionTable> table = LensDistortionTable::GetTable ( config );
+        result.Passed = ( table != NULL );
+        if ( table )
+        {
+            result.MaxInvR        = table->GetMaxInvR ( LensDistortionTable::Channel_Green );
+            result.RoundTripError = table->MeasureInverseError ( config, sampleCount );
+
+            for ( int c = 0; c < LensDistortionTable::Channel_Count; c++ )
+            {
+                LensDistortionTable::ChannelType channel = (LensDistortionTable::ChannelType)c;
+                const float maxInvR = table->GetMaxInvR ( channel );
+                for ( int i = 0; i <= sampleCount; i++ )
+                {
+                    float r     = maxInvR * (float)i / (float)sampleCount;
+                    float exact = LensDistortionInverseBisect ( config, r, channel, table->GetMaxR() );
+                    float inv   = exact;
+                    table->DistortionFnInverse ( r, channel, &inv );
+                    result.MaxTableError = Alg::Max ( result.MaxTableError, Alg::Abs ( inv - exact ) );
+
+                    if ( channel == LensDistortionTable::Channel_Green )
+                    {
+                        result.MaxSearchError = Alg::Max ( result.MaxSearchError, Alg::Abs ( config.DistortionFnInverseExact ( r ) - exact ) );
+                    }
+                }
+            }
+            result.Passed = ( result.MaxTableError <= tolerance );
+        }
+        passed = passed && result.Passed;
+
+        LogText("[Lens Distortion Accuracy] %s %-12s radii to %.3f: table error %g, search error %g, round trip %g (tolerance %g) %s\n",
+                result.HmdType == HmdType_DK1 ? "DK1" : "DK2", result.Eqn == Distortion_RecipPoly4 ? "RecipPoly4" : "CatmullRom10",
+                result.MaxInvR, result.MaxTableError, result.MaxSearchError, result.RoundTripError, tolerance,
+                result.Passed ? "passed" : ( table ? "FAILED" : "FAILED, no table" ));
+    }
+    return passed;
+}
+
+
+}}} // OVR::Util::Render
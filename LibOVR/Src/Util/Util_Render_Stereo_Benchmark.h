@@ -0,0 +1,126 @@
+/************************************************************************************
+
+Filename    :   Util_Render_Stereo_Benchmark.h
+Content     :   Benchmarks and accuracy checks of the distortion code
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC All Rights reserved.
+
+Licensed under the Oculus VR Rift SDK License Version 3.2 (the "License");
+you may not use the Oculus VR Rift SDK except in compliance with the License,
+which is provided at the time of installation or download, or which
+otherwise accompanies this software in either electronic or hard copy form.
+
+You may obtain a copy of the License at
+
+http://www.oculusvr.com/licenses/LICENSE-3.2
+
+Unless required by applicable law or agreed to in writing, the Oculus VR SDK
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*************************************************************************************/
+
+#ifndef OVR_Util_Render_Stereo_Benchmark_h
+#define OVR_Util_Render_Stereo_Benchmark_h
+
+#include "Util_Render_Stereo.h"
+
+namespace OVR { namespace Util { namespace Render {
+
+
+// Grids of 8, 16, 32, 64 and 128 quads a side
+enum { DistortionMeshBenchmark_MinGridSizeLog2 = 3, DistortionMeshBenchmark_GridSizes = 5 };
+
+struct DistortionMeshBenchmarkResult
+{
+    int    GridSizeLog2;
+    int    Vertices;
+    double ScalarSeconds;       // Per mesh, one DistortionMeshMakeVertex per vertex
+    double BatchSeconds;        // Per mesh, DistortionMeshCreate on the calling thread only
+    double ThreadedSeconds;     // Per mesh, DistortionMeshCreate with the given thread count
+    float  MaxError;            // Largest difference of a vertex component, batched against scalar
+};
+
+// Builds the left eye mesh of hmdRenderInfo iterations times for each grid size, with the
+// scalar per-vertex functions, the batched ones, then the batched ones on threadCount
+// threads (0 for the automatic count), and logs the results.
+void RunDistortionMeshBenchmark(const HmdRenderInfo& hmdRenderInfo, int iterations, int threadCount,
+                                DistortionMeshBenchmarkResult results[DistortionMeshBenchmark_GridSizes]);
+
+
+enum
+{
+    DistortionMeshTessellation_Uniform,     // DistortionMeshCreate on its default grid
+    DistortionMeshTessellation_Adaptive,    // DistortionMeshCreateAdaptive
+    DistortionMeshTessellation_Count
+};
+
+struct DistortionMeshTessellationResult
+{
+    int    Vertices;
+    int    Triangles;
+    double Seconds;             // Per mesh
+    float  MaxErrorPixels;      // DistortionMeshMeasureError
+};
+
+// Builds the left eye mesh of hmdRenderInfo iterations times on the default uniform grid,
+// then adaptively within tolerancePixels, and logs their sizes, build times and errors.
+void RunAdaptiveDistortionMeshBenchmark(const HmdRenderInfo& hmdRenderInfo, int iterations, float tolerancePixels,
+                                        DistortionMeshTessellationResult results[DistortionMeshTessellation_Count]);
+
+
+// 1, 2, 4 and 8 threads
+enum { SoftwareDistortionBenchmark_ThreadCounts = 4 };
+
+struct SoftwareDistortionBenchmarkResult
+{
+    int      Threads;
+    double   Seconds;           // Per frame
+    uint32_t FrameCRC;          // Of the frame buffer, the same for every thread count
+};
+
+// First renders the golden frames, fixed meshes and images that do not depend on the HMD,
+// at each thread count and compares their CRCs with the stored ones. Then renders a frame of
+// hmdRenderInfo's resolution with SoftwareDistortionRender iterations times for each thread
+// count, from synthetic eye images at the recommended size with chromatic aberration,
+// vignette and timewarp on, and logs the times. Returns false if a golden frame does not
+// match, or a thread count renders a different frame.
+bool RunSoftwareDistortionBenchmark(const HmdRenderInfo& hmdRenderInfo, int iterations,
+                                    SoftwareDistortionBenchmarkResult results[SoftwareDistortionBenchmark_ThreadCounts]);
+
+
+enum
+{
+    LensDistortionAccuracy_DK1_RecipPoly4,
+    LensDistortionAccuracy_DK1_CatmullRom10,
+    LensDistortionAccuracy_DK2_RecipPoly4,
+    LensDistortionAccuracy_DK2_CatmullRom10,
+    LensDistortionAccuracy_Count
+};
+
+struct LensDistortionAccuracyResult
+{
+    HmdTypeEnum       HmdType;
+    DistortionEqnType Eqn;
+    float             MaxInvR;          // Largest distorted radius checked, GetMaxInvR() of the green channel
+    float             MaxTableError;    // Largest | table inverse - exact inverse | of the three channels
+    float             MaxSearchError;   // Same for DistortionFnInverseExact, the search the tables replace (green)
+    float             RoundTripError;   // LensDistortionTable::MeasureInverseError
+    bool              Passed;           // The table exists and MaxTableError is within the tolerance
+};
+
+// Checks the inverse tables of the default DK1 and DK2 lens configs, fitted as RecipPoly4
+// and CatmullRom10, against the exact inverse solved by bisection on the exact curves, at
+// sampleCount radii of each channel, and logs the errors. Returns false if a table is
+// missing or any of its inverses is off by more than tolerance.
+bool RunLensDistortionTableAccuracyCheck(int sampleCount, float tolerance,
+                                         LensDistortionAccuracyResult results[LensDistortionAccuracy_Count]);
+
+
+}}} // OVR::Util::Render
+
+#endif // OVR_Util_Render_Stereo_Benchmark_h
@@ -0,0 +1,549 @@
+/************************************************************************************
+
+Filename    :   Render_BinaryScene.cpp
+Content     :   Binary scene files - implementation
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC. All Rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#include "Render_BinaryScene.h"
+#include <Kernel/OVR_Log.h>
+#include <Kernel/OVR_MappedFile.h>
+#include <Kernel/OVR_Timer.h>
+
+namespace OVR { namespace Render {
+
+//-------------------------------------------------------------------------------------
+// SceneFileHeader, then TextureCount SceneFileTexture, ModelCount SceneFileModel and the
+// SceneFileCollisionModel of the collision models followed by those of the ground
+// collision models. After the tables come the embedded texture files, the vertices and
+// indices of each model and finally all the collision planes, every array starting on a
+// 16 byte boundary.
+
+static const uint32_t SceneFileMagic = 0x4E435342;   // "BSCN"
+
+// Bump whenever the file layout, the Vertex layout or the fix-ups the XML loader makes
+// to the data change.
+static const uint32_t SceneFileVersion = 2;
+
+struct SceneFileHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t VertexSize;
+    uint32_t TextureCount;
+    uint32_t ModelCount;
+    uint32_t CollisionModelCount;
+    uint32_t GroundCollisionModelCount;
+    uint32_t PlaneCount;
+    uint64_t PlaneOffset;
+    uint64_t FileSize;
+};
+
+struct SceneFileTexture
+{
+    char     FileName[248];     // Relative to the scene file
+    uint64_t DataOffset;        // Of the embedded texture file, when DataSize is not 0
+    uint32_t DataSize;
+    uint32_t IsDDS;             // Otherwise TGA
+};
+
+enum SceneFileModelFlags
+{
+    SceneFileModel_Visible   = 0x01,
+    SceneFileModel_Collision = 0x02
+};
+
+struct SceneFileModel
+{
+    uint64_t VertexOffset;
+    uint64_t IndexOffset;
+    uint32_t VertexCount;
+    uint32_t IndexCount;        // uint16_t indices, uint32_t when VertexCount is over 0x10000
+    int32_t  DiffuseTexture;    // -1 for none
+    int32_t  LightmapTexture;
+    uint32_t Flags;             // SceneFileModelFlags
+    uint32_t Reserved;
+};
+
+struct SceneFileCollisionModel
+{
+    uint32_t FirstPlane;
+    uint32_t PlaneCount;
+};
+
+struct SceneFilePlane
+{
+    float N[3];
+    float D;
+};
+
+static inline uint64_t SceneFileAlign(uint64_t offset)
+{
+    return (offset + 15) & ~(uint64_t)15;
+}
+
+static inline bool SceneFileRange(uint64_t fileSize, uint64_t offset, uint64_t bytes)
+{
+    return offset <= fileSize && bytes <= fileSize - offset;
+}
+
+// Indices are stored as the index buffer takes them, like Model::CreateIndexBuffer does
+static inline uint32_t SceneFileIndexSize(uint32_t vertexCount)
+{
+    return (vertexCount > 0x10000) ? sizeof(uint32_t) : sizeof(uint16_t);
+}
+
+template<class T>
+static uint32_t SceneFileMaxIndex(const uint8_t* pData, uint32_t count)
+{
+    const T* indices  = (const T*)pData;
+    T        maxIndex = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        maxIndex = Alg::Max(maxIndex, indices[i]);
+    }
+    return (uint32_t)maxIndex;
+}
+
+// Returns the header of a mapped scene file once every table entry and every array has
+// been checked against the file, or NULL if it is not a file this version can read.
+static const SceneFileHeader* ValidateSceneFile(const MappedFile& file)
+{
+    const uint64_t size = file.GetSize();
+    if (size < sizeof(SceneFileHeader))
+    {
+        return NULL;
+    }
+
+    const SceneFileHeader* header = (const SceneFileHeader*)file.GetData();
+    if (header->Magic != SceneFileMagic ||
+        header->Version != SceneFileVersion ||
+        header->VertexSize != sizeof(Vertex) ||
+        header->FileSize != size ||
+        header->TextureCount > 0x10000 || header->ModelCount > 0x1000000 ||
+        header->CollisionModelCount > 0x1000000 || header->GroundCollisionModelCount > 0x1000000)
+    {
+        return NULL;
+    }
+
+    const uint64_t collisionCount = (uint64_t)header->CollisionModelCount + header->GroundCollisionModelCount;
+    const uint64_t tableBytes     = sizeof(SceneFileHeader) +
+                                    header->TextureCount * sizeof(SceneFileTexture) +
+                                    header->ModelCount * sizeof(SceneFileModel) +
+                                    collisionCount * sizeof(SceneFileCollisionModel);
+    if (tableBytes > size ||
+        !SceneFileRange(size, header->PlaneOffset, (uint64_t)header->PlaneCount * sizeof(SceneFilePlane)))
+    {
+        return NULL;
+    }
+
+    const SceneFileTexture* textures = (const SceneFileTexture*)(header + 1);
+    for (uint32_t i = 0; i < header->TextureCount; i++)
+    {
+        const SceneFileTexture& texture = textures[i];
+        if (!memchr(texture.FileName, 0, sizeof(texture.FileName)) ||
+            !SceneFileRange(size, texture.DataOffset, texture.DataSize) ||
+            texture.DataSize > 0x7FFFFFFF)
+        {
+            return NULL;
+        }
+    }
+
+    // Indices past the model's vertices are caught here, as nothing checks them later
+    const SceneFileModel* models = (const SceneFileModel*)(textures + header->TextureCount);
+    for (uint32_t i = 0; i < header->ModelCount; i++)
+    {
+        const SceneFileModel& model = models[i];
+        const uint32_t        indexSize = SceneFileIndexSize(model.VertexCount);
+        if (!SceneFileRange(size, model.VertexOffset, (uint64_t)model.VertexCount * sizeof(Vertex)) ||
+            !SceneFileRange(size, model.IndexOffset, (uint64_t)model.IndexCount * indexSize) ||
+            model.DiffuseTexture < -1 || model.DiffuseTexture >= (int32_t)header->TextureCount ||
+            model.LightmapTexture < -1 || model.LightmapTexture >= (int32_t)header->TextureCount)
+        {
+            return NULL;
+        }
+
+        const uint8_t* indices  = file.GetData() + model.IndexOffset;
+        uint32_t       maxIndex = (indexSize == sizeof(uint32_t)) ? SceneFileMaxIndex<uint32_t>(indices, model.IndexCount)
+                                                                  : SceneFileMaxIndex<uint16_t>(indices, model.IndexCount);
+        if (model.IndexCount && maxIndex >= model.VertexCount)
+        {
+            return NULL;
+        }
+    }
+
+    const SceneFileCollisionModel* collisions = (const SceneFileCollisionModel*)(models + header->ModelCount);
+    for (uint64_t i = 0; i < collisionCount; i++)
+    {
+        if ((uint64_t)collisions[i].FirstPlane + collisions[i].PlaneCount > header->PlaneCount)
+        {
+            return NULL;
+        }
+    }
+
+    return header;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Writing
+
+// Writes zeros up to the next 16 byte boundary of the file
+static bool WriteSceneFilePadding(File* f, uint64_t* pOffset)
+{
+    static const uint8_t zeros[16] = { 0 };
+    int bytes = (int)(SceneFileAlign(*pOffset) - *pOffset);
+    *pOffset += bytes;
+    return f->Write(zeros, bytes) == bytes;
+}
+
+static bool WriteSceneFileData(File* f, uint64_t* pOffset, const void* data, uint64_t bytes)
+{
+    const uint8_t* p = (const uint8_t*)data;
+    for (uint64_t done = 0; done < bytes; )
+    {
+        int chunk = (int)Alg::Min<uint64_t>(bytes - done, 0x40000000);
+        if (f->Write(p + done, chunk) != chunk)
+        {
+            return false;
+        }
+        done += chunk;
+    }
+    *pOffset += bytes;
+    return WriteSceneFilePadding(f, pOffset);
+}
+
+bool BinarySceneHandler::WriteFile(const char* fileName, const XmlHandler& scene, bool embedTextures)
+{
+    const uint32_t textureCount              = (uint32_t)scene.GetTextureCount();
+    const uint32_t modelCount                = (uint32_t)scene.GetModelCount();
+    const Array<Ptr<CollisionModel> >& collisions       = scene.GetCollisionModels();
+    const Array<Ptr<CollisionModel> >& groundCollisions = scene.GetGroundCollisionModels();
+    const uint32_t collisionCount            = (uint32_t)(collisions.GetSize() + groundCollisions.GetSize());
+
+    // The tables, then the offsets of everything that comes after them
+    uint64_t tableBytes = sizeof(SceneFileHeader) + textureCount * sizeof(SceneFileTexture) +
+                          modelCount * sizeof(SceneFileModel) + collisionCount * sizeof(SceneFileCollisionModel);
+    ArrayPOD<uint8_t> tables;
+    tables.Resize((size_t)tableBytes);
+    memset(&tables[0], 0, tables.GetSize());
+
+    SceneFileHeader*         header         = (SceneFileHeader*)&tables[0];
+    SceneFileTexture*        textureEntries = (SceneFileTexture*)(header + 1);
+    SceneFileModel*          modelEntries   = (SceneFileModel*)(textureEntries + textureCount);
+    SceneFileCollisionModel* collisionEntries = (SceneFileCollisionModel*)(modelEntries + modelCount);
+    uint64_t                 offset         = SceneFileAlign(tableBytes);
+
+    // The texture files to embed are read in full up front, as their sizes go in the table
+    Array<ArrayPOD<uint8_t> > textureData;
+    textureData.Resize(textureCount);
+    const char* scenePath = scene.GetScenePath();
+    size_t      scenePathLength = strlen(scenePath);
+    for (uint32_t i = 0; i < textureCount; i++)
+    {
+        const char*       path  = scene.GetTextureFileName((int)i);
+        SceneFileTexture& entry = textureEntries[i];
+        const char*       name  = strncmp(path, scenePath, scenePathLength) ? path : path + scenePathLength;
+        size_t            dot   = strcspn(name, ".");
+        if (strlen(name) >= sizeof(entry.FileName))
+        {
+            OVR_DEBUG_LOG(("Texture file name too long for a binary scene: %s", name));
+            return false;
+        }
+        OVR_strcpy(entry.FileName, sizeof(entry.FileName), name);
+        entry.IsDDS = (name[dot] && (name[dot + 1] == 'd' || name[dot + 1] == 'D'));
+
+        if (embedTextures)
+        {
+            SysFile f(path);
+            int     length = f.IsValid() ? f.GetLength() : 0;
+            if (length > 0)
+            {
+                textureData[i].Resize(length);
+                if (f.Read(&textureData[i][0], length) != length)
+                {
+                    textureData[i].Clear();
+                }
+            }
+            if (textureData[i].GetSize() == 0)
+            {
+                // Left as a reference, to load or fail the same way the XML scene does
+                OVR_DEBUG_LOG(("Could not embed texture %s.", path));
+            }
+            else
+            {
+                entry.DataOffset = offset;
+                entry.DataSize   = (uint32_t)textureData[i].GetSize();
+                offset           = SceneFileAlign(offset + entry.DataSize);
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < modelCount; i++)
+    {
+        Model*          model = scene.GetModel((int)i);
+        SceneFileModel& entry = modelEntries[i];
+        entry.VertexCount     = (uint32_t)model->Vertices.GetSize();
+        entry.IndexCount      = (uint32_t)model->Indices.GetSize();
+        entry.DiffuseTexture  = scene.GetDiffuseTextureIndex((int)i);
+        entry.LightmapTexture = scene.GetLightmapTextureIndex((int)i);
+        entry.Flags           = (model->Visible ? SceneFileModel_Visible : 0) |
+                                (model->IsCollisionModel ? SceneFileModel_Collision : 0);
+        entry.VertexOffset    = offset;
+        offset                = SceneFileAlign(offset + entry.VertexCount * sizeof(Vertex));
+        entry.IndexOffset     = offset;
+        offset                = SceneFileAlign(offset + (uint64_t)entry.IndexCount * SceneFileIndexSize(entry.VertexCount));
+    }
+
+    uint32_t planeCount = 0;
+    for (uint32_t i = 0; i < collisionCount; i++)
+    {
+        const CollisionModel* cm = (i < collisions.GetSize()) ? collisions[i] : groundCollisions[i - collisions.GetSize()];
+        collisionEntries[i].FirstPlane = planeCount;
+        collisionEntries[i].PlaneCount = (uint32_t)cm->Planes.GetSize();
+        planeCount += collisionEntries[i].PlaneCount;
+    }
+
+    header->Magic                     = SceneFileMagic;
+    header->Version                   = SceneFileVersion;
+    header->VertexSize                = sizeof(Vertex);
+    header->TextureCount              = textureCount;
+    header->ModelCount                = modelCount;
+    header->CollisionModelCount       = (uint32_t)collisions.GetSize();
+    header->GroundCollisionModelCount = (uint32_t)groundCollisions.GetSize();
+    header->PlaneCount                = planeCount;
+    header->PlaneOffset               = offset;
+    header->FileSize                  = SceneFileAlign(offset + planeCount * sizeof(SceneFilePlane));
+
+    // Then everything in the order of the offsets
+    SysFile f(fileName, File::Open_Write | File::Open_Truncate | File::Open_Create);
+    if (!f.IsValid())
+    {
+        return false;
+    }
+
+    uint64_t written = 0;
+    bool     ok      = WriteSceneFileData(&f, &written, &tables[0], tables.GetSize());
+    for (uint32_t i = 0; ok && i < textureCount; i++)
+    {
+        if (textureEntries[i].DataSize)
+        {
+            ok = WriteSceneFileData(&f, &written, &textureData[i][0], textureData[i].GetSize());
+        }
+    }
+    ArrayPOD<uint16_t> indices16;
+    for (uint32_t i = 0; ok && i < modelCount; i++)
+    {
+        Model* model = scene.GetModel((int)i);
+        ok = WriteSceneFileData(&f, &written, model->Vertices.GetSize() ? &model->Vertices[0] : NULL,
+                                model->Vertices.GetSize() * sizeof(Vertex));
+        const void* indexData  = model->Indices.GetSize() ? &model->Indices[0] : NULL;
+        uint64_t    indexBytes = model->Indices.GetSize() * sizeof(uint32_t);
+        if (indexData && !model->UsesIndex32())
+        {
+            indices16.Resize(model->Indices.GetSize());
+            for (size_t j = 0; j < model->Indices.GetSize(); j++)
+            {
+                indices16[j] = (uint16_t)model->Indices[j];
+            }
+            indexData  = &indices16[0];
+            indexBytes = indices16.GetSize() * sizeof(uint16_t);
+        }
+        ok = ok && WriteSceneFileData(&f, &written, indexData, indexBytes);
+    }
+    for (uint32_t i = 0; ok && i < collisionCount; i++)
+    {
+        const CollisionModel* cm = (i < collisions.GetSize()) ? collisions[i] : groundCollisions[i - collisions.GetSize()];
+        for (size_t j = 0; ok && j < cm->Planes.GetSize(); j++)
+        {
+            const Planef&  p = cm->Planes[j];
+            SceneFilePlane plane = { { p.N.x, p.N.y, p.N.z }, p.D };
+            ok = (f.Write((const uint8_t*)&plane, sizeof(plane)) == sizeof(plane));
+            written += sizeof(plane);
+        }
+    }
+    ok = ok && WriteSceneFilePadding(&f, &written);
+    ok = f.Close() && ok;
+
+    OVR_ASSERT(!ok || written == header->FileSize);
+    return ok;
+}
+
+
+//-------------------------------------------------------------------------------------
+// ***** Reading
+
+// As in the XML loader, the textures are decoded on a few threads while the calling
+// thread, the render thread, creates the models' buffers out of the mapped file.
+static void SceneTextureWork(SceneLoaderThreads* threads, void* context)
+{
+    SceneTextureJob* textureJobs = (SceneTextureJob*)context;
+
+    int i;
+    while ((i = threads->NextJob()) >= 0)
+    {
+        DecodeSceneTexture(textureJobs[i]);
+    }
+}
+
+bool BinarySceneHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRender,
+                                  OVR::Render::Scene* pScene,
+                                  OVR::Array<Ptr<CollisionModel> >* pCollisions,
+                                  OVR::Array<Ptr<CollisionModel> >* pGroundCollisions)
+{
+    double startTime = Timer::GetSeconds();
+
+    MappedFile file;
+    if (!file.Open(fileName))
+    {
+        return false;
+    }
+    const SceneFileHeader* header = ValidateSceneFile(file);
+    if (!header)
+    {
+        OVR_DEBUG_LOG(("%s is not a binary scene of version %u.", fileName, SceneFileVersion));
+        return false;
+    }
+    const uint8_t*                 pData      = file.GetData();
+    const SceneFileTexture*        textures   = (const SceneFileTexture*)(header + 1);
+    const SceneFileModel*          models     = (const SceneFileModel*)(textures + header->TextureCount);
+    const SceneFileCollisionModel* collisions = (const SceneFileCollisionModel*)(models + header->ModelCount);
+    const SceneFilePlane*          planes     = (const SceneFilePlane*)(pData + header->PlaneOffset);
+    double validatedTime = Timer::GetSeconds();
+
+    // Texture references are relative to the scene file
+    char     filePath[250];
+    intptr_t pathLength = 0;
+    for (intptr_t i = strlen(fileName); i > 0; i--)
+    {
+        if (fileName[i-1] == '\\' || fileName[i-1] == '/')
+        {
+            pathLength = Alg::Min<intptr_t>(i, sizeof(filePath) - 1);
+            break;
+        }
+    }
+    memcpy(filePath, fileName, pathLength);
+    filePath[pathLength] = 0;
+
+    const int        textureCount = (int)header->TextureCount;
+    SceneTextureJob* textureJobs  = new SceneTextureJob[textureCount > 0 ? textureCount : 1];
+    for (int i = 0; i < textureCount; i++)
+    {
+        SceneTextureJob& job = textureJobs[i];
+        OVR_sprintf(job.FileName, sizeof(job.FileName), "%s%s", filePath, textures[i].FileName);
+        job.pData    = textures[i].DataSize ? pData + textures[i].DataOffset : NULL;
+        job.DataSize = textures[i].DataSize;
+        job.IsDDS    = (textures[i].IsDDS != 0);
+    }
+
+    SceneLoaderThreads threads(SceneTextureWork, textureJobs);
+    threads.Start(textureCount);
+
+    // The models' buffers take their data straight from the mapping. The draw calls
+    // count the Indices, so those are copied; Vertices is left empty.
+    Array<Ptr<Model> > loadedModels;
+    loadedModels.Resize(header->ModelCount);
+    for (uint32_t i = 0; i < header->ModelCount; i++)
+    {
+        const SceneFileModel& entry = models[i];
+        Ptr<Model>            model = *new Model(Prim_Triangles);
+        model->Visible          = (entry.Flags & SceneFileModel_Visible) != 0;
+        model->IsCollisionModel = (entry.Flags & SceneFileModel_Collision) != 0;
+
+        if (entry.VertexCount && entry.IndexCount)
+        {
+            const bool index32 = (SceneFileIndexSize(entry.VertexCount) == sizeof(uint32_t));
+            model->VertexBuffer = *pRender->CreateBuffer();
+            model->VertexBuffer->Data(Buffer_Vertex | Buffer_ReadOnly, pData + entry.VertexOffset, entry.VertexCount * sizeof(Vertex));
+            model->IndexBuffer  = *pRender->CreateBuffer();
+            model->IndexBuffer->Data(Buffer_Index | (index32 ? Buffer_Index32 : 0) | Buffer_ReadOnly, pData + entry.IndexOffset,
+                                     entry.IndexCount * SceneFileIndexSize(entry.VertexCount));
+
+            model->Indices.Resize(entry.IndexCount);
+            if (index32)
+            {
+                memcpy(&model->Indices[0], pData + entry.IndexOffset, entry.IndexCount * sizeof(uint32_t));
+            }
+            else
+            {
+                const uint16_t* indices16 = (const uint16_t*)(pData + entry.IndexOffset);
+                for (uint32_t j = 0; j < entry.IndexCount; j++)
+                {
+                    model->Indices[j] = indices16[j];
+                }
+            }
+        }
+        loadedModels[i] = model;
+    }
+    double buffersTime = Timer::GetSeconds();
+
+    threads.Finish();
+    double decodedTime = Timer::GetSeconds();
+
+    Array<Ptr<Texture> > loadedTextures;
+    loadedTextures.Resize(textureCount);
+    for (int i = 0; i < textureCount; i++)
+    {
+        Texture* created = CreateTextureFromImage(pRender, textureJobs[i].Image);
+        if (created)
+        {
+            loadedTextures[i].SetPtr(*created);
+        }
+    }
+    delete[] textureJobs;
+
+    for (uint32_t i = 0; i < header->ModelCount; i++)
+    {
+        const SceneFileModel& entry = models[i];
+        Model*                model = loadedModels[i];
+        model->Fill = CreateSceneFill(pRender,
+                                      entry.DiffuseTexture > -1 ? loadedTextures[entry.DiffuseTexture] : NULL,
+                                      entry.LightmapTexture > -1 ? loadedTextures[entry.LightmapTexture] : NULL);
+        pScene->World.Add(model);
+        pScene->Models.PushBack(model);
+    }
+
+    const uint32_t collisionCount = header->CollisionModelCount + header->GroundCollisionModelCount;
+    for (uint32_t i = 0; i < collisionCount; i++)
+    {
+        Ptr<CollisionModel> cm = *new CollisionModel();
+        for (uint32_t j = 0; j < collisions[i].PlaneCount; j++)
+        {
+            const SceneFilePlane& p = planes[collisions[i].FirstPlane + j];
+            cm->Add(Planef(p.N[0], p.N[1], p.N[2], p.D));
+        }
+        if (i < header->CollisionModelCount)
+            pCollisions->PushBack(cm);
+        else
+            pGroundCollisions->PushBack(cm);
+    }
+
+	OVR_DEBUG_LOG(("Binary scene %s: %u models, %i textures. Mapped and checked %.0f ms, buffers %.0f ms, "
+                   "textures on %i threads %.0f ms, GPU textures and fills %.0f ms.",
+                   fileName, header->ModelCount, textureCount,
+                   1000.0 * (validatedTime - startTime), 1000.0 * (buffersTime - validatedTime), threads.GetThreadCount(),
+                   1000.0 * (decodedTime - buffersTime), 1000.0 * (Timer::GetSeconds() - decodedTime)));
+    return true;
+}
+
+}} // OVR::Render
+
+#ifdef OVR_DEFINE_NEW
+#define new OVR_DEFINE_NEW
+#endif
@@ -0,0 +1,68 @@
+/************************************************************************************
+
+Filename    :   Render_BinaryScene.h
+Content     :   Binary scene files, converted from the XML scenes and mapped on load
+Created     :   October 16, 2026
+Authors     :   Federico Mammano
+
+Copyright   :   Copyright 2014 Oculus VR, LLC. All Rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#ifndef INC_Render_BinaryScene_h
+#define INC_Render_BinaryScene_h
+
+#include "Render_XmlSceneLoader.h"
+
+namespace OVR { namespace Render {
+
+//-------------------------------------------------------------------------------------
+// ***** Binary scene files
+
+// The same scene an XmlHandler reads, stored the way it ends up in memory: each model's
+// vertices and indices as arrays ready for the vertex and index buffers, the collision
+// planes as they are after the XML fix-ups, and the textures either as references to
+// their files or with the files themselves embedded. Loading maps the file and hands
+// the vertex arrays to the buffers as they are, with nothing to parse.
+//
+// Everything is in the byte order and the Vertex layout of the machine that wrote it;
+// a file of another version, layout or byte order, or one that is truncated, fails to
+// load, and the XML scene can be read instead.
+
+class BinarySceneHandler
+{
+public:
+    // Writes a scene read with XmlHandler::ReadSceneData to fileName. Texture references
+    // are kept relative to the scene file, so the binary file is meant to go next to the
+    // XML one; with embedTextures the texture files are copied into it instead.
+    static bool WriteFile(const char* fileName, const XmlHandler& scene, bool embedTextures);
+
+    // Loads a binary scene the way XmlHandler::ReadFile loads an XML one. The models get
+    // their VertexBuffer, IndexBuffer and Indices, which the renderers draw with; their
+    // Vertices stay empty, as the vertices only ever live in the mapped file and in the
+    // vertex buffers, so ClearRenderer must not be called on them.
+    bool ReadFile(const char* fileName, OVR::Render::RenderDevice* pRender,
+                  OVR::Render::Scene* pScene,
+                  OVR::Array<Ptr<CollisionModel> >* pCollisions,
+                  OVR::Array<Ptr<CollisionModel> >* pGroundCollisions);
+};
+
+}} // OVR::Render
+
+#ifdef OVR_DEFINE_NEW
+#define new OVR_DEFINE_NEW
+#endif
+
+#endif // INC_Render_BinaryScene_h
@@ -2557,12 +2557,10 @@ void RenderDevice::Render(const Matrix4f& matrix, Model* model)
     }
     if (!model->IndexBuffer)
     {
-        Ptr<Buffer> ib = *CreateBuffer();
-        if (!ib->Data(Buffer_Index | Buffer_ReadOnly, &model->Indices[0], model->Indices.GetSize() * 2))
+        if (!model->CreateIndexBuffer(this))
         {
             OVR_ASSERT(false);
         }
-        model->IndexBuffer = ib;
     }
 
     Render(model->Fill ? model->Fill : DefaultFill,
@@ -2605,7 +2603,8 @@ void RenderDevice::Render(const Fill* fill, Render::Buffer* vertices, Render::Bu
 
     if (indices)
     {
-        Context->IASetIndexBuffer(((Buffer*)indices)->GetBuffer(), DXGI_FORMAT_R16_UINT, 0);
+        DXGI_FORMAT indexFormat = (((Buffer*)indices)->Use & Buffer_Index32) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+        Context->IASetIndexBuffer(((Buffer*)indices)->GetBuffer(), indexFormat, 0);
     }
 
     ShaderSet* shaders = ((ShaderFill*)fill)->GetShaders();
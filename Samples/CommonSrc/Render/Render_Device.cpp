@@ -238,7 +238,7 @@ namespace OVR { namespace Render {
 		};
 
 
-		uint16_t startIndex = GetNextVertexIndex();
+		uint32_t startIndex = GetNextVertexIndex();
 
 		enum
 		{
@@ -265,7 +265,7 @@ namespace OVR { namespace Render {
 	{    
 		Vector3f s = size * 0.5f;
 		Vector3f o = origin;
-		uint16_t i = GetNextVertexIndex();
+		uint32_t i = GetNextVertexIndex();
 
 		AddVertex(-s.x + o.x,  s.y + o.y, -s.z + o.z,  c, 0, 1, 0, 0, -1);
 		AddVertex(s.x  + o.x,  s.y + o.y, -s.z + o.z,  c, 1, 1, 0, 0, -1);
@@ -476,6 +476,30 @@ namespace OVR { namespace Render {
 		return grid;
 	}
 
+	bool Model::CreateIndexBuffer(RenderDevice* ren)
+	{
+		if (!Indices.GetSize())
+			return false;
+
+		Ptr<Buffer> ib = *ren->CreateBuffer();
+		bool        ok;
+		if (UsesIndex32())
+		{
+			ok = ib->Data(Buffer_Index | Buffer_Index32 | Buffer_ReadOnly, &Indices[0], Indices.GetSize() * sizeof(uint32_t));
+		}
+		else
+		{
+			ArrayPOD<uint16_t> indices16;
+			indices16.Resize(Indices.GetSize());
+			for (size_t i = 0; i < Indices.GetSize(); i++)
+				indices16[i] = (uint16_t)Indices[i];
+			ok = ib->Data(Buffer_Index | Buffer_ReadOnly, &indices16[0], indices16.GetSize() * sizeof(uint16_t));
+		}
+		if (ok)
+			IndexBuffer = ib;
+		return ok;
+	}
+
 
 	//-------------------------------------------------------------------------------------
 
@@ -126,6 +126,7 @@ enum BufferUsage
     Buffer_Compute  = 16,
     Buffer_TypeMask = 0xff,
     Buffer_ReadOnly = 0x100, // Buffer must be created with Data().
+    Buffer_Index32  = 0x200, // With Buffer_Index: 32 bit indices instead of 16.
 };
 
 enum TextureFormat
@@ -523,7 +524,7 @@ class Model : public Node
 {
 public:
     Array<Vertex>     Vertices;
-    Array<uint16_t>     Indices;
+    Array<uint32_t>   Indices;          // Uploaded as 16 bit indices when the vertices allow it
     PrimitiveType     Type;
     Ptr<class Fill>   Fill;
     bool              Visible;
@@ -553,42 +554,40 @@ public:
     }
 
     // Returns the index next added vertex will have.
-    uint16_t GetNextVertexIndex() const
+    uint32_t GetNextVertexIndex() const
     {
-        return (uint16_t)Vertices.GetSize();
+        return (uint32_t)Vertices.GetSize();
     }
 
-    uint16_t AddVertex(const Vertex& v)
+    uint32_t AddVertex(const Vertex& v)
     {
 		OVR_ASSERT(!VertexBuffer && !IndexBuffer);
-		size_t size = Vertices.GetSize();
-		OVR_ASSERT(size <= USHRT_MAX);      // We only use a short to store vert indices.
-		uint16_t index = (uint16_t) size;
+		uint32_t index = (uint32_t) Vertices.GetSize();
 		Vertices.PushBack(v);
 		return index;
     }
-    uint16_t AddVertex(const Vector3f& v, const Color& c, float u_ = 0, float v_ = 0)
+    uint32_t AddVertex(const Vector3f& v, const Color& c, float u_ = 0, float v_ = 0)
     {
         return AddVertex(Vertex(v,c,u_,v_));
     }
-    uint16_t AddVertex(float x, float y, float z, const Color& c, float u, float v)
+    uint32_t AddVertex(float x, float y, float z, const Color& c, float u, float v)
     {
         return AddVertex(Vertex(Vector3f(x,y,z),c, u,v));
     }
 
-    void AddLine(uint16_t a, uint16_t b)
+    void AddLine(uint32_t a, uint32_t b)
     {
         Indices.PushBack(a);
         Indices.PushBack(b);
     }
 
-    uint16_t AddVertex(float x, float y, float z, const Color& c,
+    uint32_t AddVertex(float x, float y, float z, const Color& c,
                      float u, float v, float nx, float ny, float nz)
     {
         return AddVertex(Vertex(Vector3f(x,y,z),c, u,v, Vector3f(nx,ny,nz)));
     }
 
-	uint16_t AddVertex(float x, float y, float z, const Color& c,
+	uint32_t AddVertex(float x, float y, float z, const Color& c,
                      float u1, float v1, float u2, float v2, float nx, float ny, float nz)
     {
         return AddVertex(Vertex(Vector3f(x,y,z), c, u1, v1, u2, v2, Vector3f(nx,ny,nz)));
@@ -599,13 +598,19 @@ public:
         AddLine(AddVertex(a), AddVertex(b));
     }
 
-    void AddTriangle(uint16_t a, uint16_t b, uint16_t c)
+    void AddTriangle(uint32_t a, uint32_t b, uint32_t c)
     {
         Indices.PushBack(a);
         Indices.PushBack(b);
         Indices.PushBack(c);
     }
 
+    // True when a vertex index does not fit in 16 bits.
+    bool UsesIndex32() const { return Vertices.GetSize() > 0x10000; }
+
+    // Creates IndexBuffer from Indices, with 16 bit indices unless UsesIndex32().
+    bool CreateIndexBuffer(RenderDevice* ren);
+
 
     // Uses texture coordinates for uniform world scaling (must use a repeat sampler).
     void  AddSolidColorBox(float x1, float y1, float z1,
@@ -1095,6 +1100,25 @@ int GetTextureSize(int format, int w, int h);
 // Image size must be a power of 2.
 void FilterRgba2x2(const uint8_t* src, int w, int h, uint8_t* dest);
 
+// A texture file read and decoded into memory, ready for CreateTexture. Decoding does not
+// use the RenderDevice, so it can be done on any thread; CreateTextureFromImage then has to
+// be called on the render thread.
+struct TextureImage
+{
+    int            Format;
+    int            Width, Height;
+    int            MipCount;
+    unsigned char* pData;
+    bool           Clamp;       // The file name has "_c." in it
+
+    TextureImage() : Format(0), Width(0), Height(0), MipCount(1), pData(NULL), Clamp(false) { }
+    ~TextureImage() { OVR_FREE(pData); }
+};
+
+bool     DecodeTextureTga(File* f, TextureImage* image, unsigned char alpha = 255);
+bool     DecodeTextureDDS(File* f, TextureImage* image);
+Texture* CreateTextureFromImage(RenderDevice* ren, const TextureImage& image);
+
 Texture* LoadTextureTga(RenderDevice* ren, File* f, unsigned char alpha = 255);
 Texture* LoadTextureDDS(RenderDevice* ren, File* f);
 
@@ -892,9 +892,7 @@ void RenderDevice::Render(const Matrix4f& matrix, Model* model)
 
     if (!model->IndexBuffer)
     {
-        Ptr<Render::Buffer> ib = *CreateBuffer();
-        ib->Data(Buffer_Index | Buffer_ReadOnly, &model->Indices[0], model->Indices.GetSize() * 2);
-        model->IndexBuffer = ib;
+        model->CreateIndexBuffer(this);
     }
 
     Render(model->Fill ? (const Fill*)model->Fill : (const Fill*)DefaultFill,
@@ -966,7 +964,7 @@ void RenderDevice::Render(const Fill* fill, Render::Buffer* vertices, Render::Bu
     if (indices)
     {
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ((Buffer*)indices)->GLBuffer);
-        glDrawElements(prim, count, GL_UNSIGNED_SHORT, NULL);
+        glDrawElements(prim, count, ((Buffer*)indices)->Index32 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, NULL);
     }
     else
     {
@@ -1011,6 +1009,7 @@ bool Buffer::Data(int use, const void* buffer, size_t size)
     case Buffer_Index:     Use = GL_ELEMENT_ARRAY_BUFFER; break;
     default:               Use = GL_ARRAY_BUFFER; break;
     }
+    Index32 = (use & Buffer_Index32) != 0;
 
     if (!GLBuffer)
         glGenBuffers(1, &GLBuffer);
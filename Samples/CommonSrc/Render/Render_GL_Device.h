@@ -223,10 +223,11 @@ public:
     RenderDevice* Ren;
     size_t        Size;
     GLenum        Use;
+    bool          Index32;
     GLuint        GLBuffer;
 
 public:
-    Buffer(RenderDevice* r) : Ren(r), Size(0), Use(0), GLBuffer(0) {}
+    Buffer(RenderDevice* r) : Ren(r), Size(0), Use(0), Index32(false), GLBuffer(0) {}
     ~Buffer();
 
     GLuint         GetBuffer() { return GLBuffer; }
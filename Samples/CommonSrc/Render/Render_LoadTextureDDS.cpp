@@ -75,7 +75,7 @@ static inline int InterpretPixelFormatFourCC(uint32_t fourCC) {
 	return -1;
 }
 
-Texture* LoadTextureDDS(RenderDevice* ren, File* f)
+bool DecodeTextureDDS(File* f, TextureImage* image)
 {
     OVR_DDS_HEADER header;
     unsigned char filecode[4];
@@ -83,7 +83,7 @@ Texture* LoadTextureDDS(RenderDevice* ren, File* f)
     f->Read(filecode, 4);
     if (strncmp((const char*)filecode, "DDS ", 4) != 0)
     {
-        return NULL;
+        return false;
     }
 
     f->Read((unsigned char*)(&header), sizeof(header));
@@ -102,24 +102,32 @@ Texture* LoadTextureDDS(RenderDevice* ren, File* f)
     {
 		format = InterpretPixelFormatFourCC(header.PixelFormat.FourCC);
 		if (format == -1) {
-			return NULL;
+			return false;
 		}
     }
 
     int            byteLen = f->BytesAvailable();
-    unsigned char* bytes   = new unsigned char[byteLen];
+    unsigned char* bytes   = (unsigned char*) OVR_ALLOC(byteLen);
     f->Read(bytes, byteLen);
-    Texture* out = ren->CreateTexture(format, (int)width, (int)height, bytes, mipCount);
-	if (!out) {
-		return NULL;
-	}
 
-    if(strstr(f->GetFilePath(), "_c."))
+    OVR_FREE(image->pData);
+    image->Format   = format;
+    image->Width    = width;
+    image->Height   = height;
+    image->MipCount = (int)mipCount;
+    image->pData    = bytes;
+    image->Clamp    = (strstr(f->GetFilePath(), "_c.") != NULL);
+    return true;
+}
+
+Texture* LoadTextureDDS(RenderDevice* ren, File* f)
+{
+    TextureImage image;
+    if (!DecodeTextureDDS(f, &image))
     {
-        out->SetSampleMode(Sample_Clamp);
+        return NULL;
     }
-    OVR_FREE(bytes);
-    return out;
+    return CreateTextureFromImage(ren, image);
 }
 
 
@@ -26,7 +26,7 @@ limitations under the License.
 
 namespace OVR { namespace Render {
 
-Texture* LoadTextureTga(RenderDevice* ren, File* f, unsigned char alpha)
+bool DecodeTextureTga(File* f, TextureImage* image, unsigned char alpha)
 {
     f->SeekToBegin();
     
@@ -43,65 +43,68 @@ Texture* LoadTextureTga(RenderDevice* ren, File* f, unsigned char alpha)
     int height = f->ReadUInt16();
     int bpp = f->ReadUByte();
     f->ReadUByte();
-    int imgsize = width * height * 4;
-    unsigned char* imgdata = (unsigned char*) OVR_ALLOC(imgsize);
-    unsigned char buf[16];
-    f->Read(imgdata, desclen);
-    f->Read(imgdata, palCount * (palSize + 7) >> 3);
-    int bpl = width * 4;
 
-    switch (imgtype)
+    if (imgtype != 2 || (bpp != 24 && bpp != 32))
     {
-    case 2:
-        switch (bpp)
-        {
-        case 24:
-            for (int y = 0; y < height; y++)
-                for (int x = 0; x < width; x++)
-                {
-                    f->Read(buf, 3);
-                    imgdata[y*bpl+x*4+0] = buf[2];
-                    imgdata[y*bpl+x*4+1] = buf[1];
-                    imgdata[y*bpl+x*4+2] = buf[0];
-                    imgdata[y*bpl+x*4+3] = alpha;
-                }
-            break;
-        case 32:
-            for (int y = 0; y < height; y++)
-                for (int x = 0; x < width; x++)
-                {
-                    f->Read(buf, 4);
-                    imgdata[y*bpl+x*4+0] = buf[2];
-                    imgdata[y*bpl+x*4+1] = buf[1];
-                    imgdata[y*bpl+x*4+2] = buf[0];
-                    if (buf[3] == 255)
-                        imgdata[y*bpl+x*4+3] = alpha;
-                    else
-                    imgdata[y*bpl+x*4+3] = buf[3];
-                }
-            break;
-
-        default:
-            OVR_FREE(imgdata);
-            return NULL;
-        }
-        break;
-
-    default:
-        OVR_FREE(imgdata);
-        return NULL;
+        return false;
     }
 
-	Texture* out = ren->CreateTexture(Texture_RGBA|Texture_GenMipmaps, width, height, imgdata);
+    // The pixels are read in one go rather than one File::Read each
+    int srcbpp  = bpp / 8;
+    int skip    = desclen + ((palCount * (palSize + 7)) >> 3);
+    int srcsize = width * height * srcbpp;
+    int imgsize = width * height * 4;
+    unsigned char* src     = (unsigned char*) OVR_ALLOC(skip + srcsize);
+    if (f->Read(src, skip + srcsize) != skip + srcsize)
+    {
+        OVR_FREE(src);      // Truncated file
+        return false;
+    }
+    unsigned char* imgdata = (unsigned char*) OVR_ALLOC(imgsize);
 
-	// check for clamp based on texture name
-	if(strstr(f->GetFilePath(), "_c."))
-	{
-		out->SetSampleMode(Sample_Clamp);
-	}
+    const unsigned char* buf = src + skip;
+    for (int i = 0; i < width * height; i++, buf += srcbpp)
+    {
+        imgdata[i*4+0] = buf[2];
+        imgdata[i*4+1] = buf[1];
+        imgdata[i*4+2] = buf[0];
+        imgdata[i*4+3] = (bpp == 24 || buf[3] == 255) ? alpha : buf[3];
+    }
+    OVR_FREE(src);
+
+    OVR_FREE(image->pData);
+    image->Format   = Texture_RGBA|Texture_GenMipmaps;
+    image->Width    = width;
+    image->Height   = height;
+    image->MipCount = 1;
+    image->pData    = imgdata;
+    // check for clamp based on texture name
+    image->Clamp    = (strstr(f->GetFilePath(), "_c.") != NULL);
+    return true;
+}
 
-    OVR_FREE(imgdata);
+Texture* CreateTextureFromImage(RenderDevice* ren, const TextureImage& image)
+{
+    if (!image.pData)
+    {
+        return NULL;
+    }
+    Texture* out = ren->CreateTexture(image.Format, image.Width, image.Height, image.pData, image.MipCount);
+    if (out && image.Clamp)
+    {
+        out->SetSampleMode(Sample_Clamp);
+    }
     return out;
 }
 
+Texture* LoadTextureTga(RenderDevice* ren, File* f, unsigned char alpha)
+{
+    TextureImage image;
+    if (!DecodeTextureTga(f, &image, alpha))
+    {
+        return NULL;
+    }
+    return CreateTextureFromImage(ren, image);
+}
+
 }}
@@ -23,12 +23,334 @@ limitations under the License.
 
 #include "Render_XmlSceneLoader.h"
 #include <Kernel/OVR_Log.h>
+#include <Kernel/OVR_Threads.h>
+#include <Kernel/OVR_Timer.h>
 
 namespace OVR { namespace Render {
 
+//-------------------------------------------------------------------------------------
+// The scene text is parsed by tinyxml2 as before, but everything after it is split in
+// jobs run on a few threads: reading and decoding each texture file, and turning each
+// model's vertex and index text into its Vertices and Indices. Textures come first in
+// the job list, as their files take the longest, so they load while the models are
+// parsed. Whatever uses the RenderDevice (textures, shaders, buffers) is done afterwards
+// on the calling thread, which is the render thread.
+
+static inline bool IsNumberSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',';
+}
+
+// Reads the next number of str, skipping separators first. Returns where the scan
+// stopped, or NULL when there are no more numbers. Gives the float atof would, unless
+// the number has more than 19 significant digits, which are truncated.
+static const char* ScanFloat(const char* str, float* value)
+{
+    static const double pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                    1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                    1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    const char* p = str;
+    while (IsNumberSeparator(*p))
+        p++;
+    if (!*p)
+        return NULL;
+
+    bool negative = (*p == '-');
+    if (*p == '-' || *p == '+')
+        p++;
+
+    uint64_t mantissa = 0;
+    int      digits   = 0;
+    int      exponent = 0;
+    bool     anyDigit = false;
+    for (; *p >= '0' && *p <= '9'; p++, anyDigit = true)
+    {
+        if (digits < 19)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            digits  += (mantissa != 0);
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (*p == '.')
+    {
+        for (p++; *p >= '0' && *p <= '9'; p++, anyDigit = true)
+        {
+            if (digits < 19)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                digits  += (mantissa != 0);
+                exponent--;
+            }
+        }
+    }
+    if (anyDigit && (*p == 'e' || *p == 'E'))
+    {
+        const char* e = p + 1;
+        bool negativeExp = (*e == '-');
+        if (*e == '-' || *e == '+')
+            e++;
+        if (*e >= '0' && *e <= '9')
+        {
+            int exp = 0;
+            for (; *e >= '0' && *e <= '9'; e++)
+                exp = (exp < 10000) ? exp * 10 + (*e - '0') : exp;
+            exponent += negativeExp ? -exp : exp;
+            p = e;
+        }
+    }
+
+    if (!anyDigit)
+    {
+        // Not a number: atof would give 0, skip the token
+        *value = 0.0f;
+        while (*p && !IsNumberSeparator(*p))
+            p++;
+        return p;
+    }
+
+    // Exact powers of ten keep this correctly rounded for up to 15 digits
+    double d = (double)mantissa;
+    if (exponent < 0)
+        d = (exponent >= -22) ? d / pow10[-exponent] : d * pow(10.0, exponent);
+    else if (exponent > 0)
+        d = (exponent <= 22) ? d * pow10[exponent] : d * pow(10.0, exponent);
+    *value = (float)(negative ? -d : d);
+
+    while (*p && !IsNumberSeparator(*p))
+        p++;
+    return p;
+}
+
+static const char* ScanUInt(const char* str, unsigned* value)
+{
+    const char* p = str;
+    while (IsNumberSeparator(*p))
+        p++;
+    if (!*p)
+        return NULL;
+
+    unsigned v = 0;
+    for (; *p >= '0' && *p <= '9'; p++)
+        v = v * 10 + (*p - '0');
+    *value = v;
+
+    while (*p && !IsNumberSeparator(*p))
+        p++;
+    return p;
+}
+
+// Only keeps whole groups of stride numbers, as ParseVectorString did
+static void ScanFloats(const char* str, ArrayPOD<float>& values, size_t stride)
+{
+    values.Clear();
+    if (!str)
+        return;
+    float v;
+    while ((str = ScanFloat(str, &v)) != NULL)
+        values.PushBack(v);
+    values.Resize(values.GetSize() / stride * stride);
+}
+
+static const char* GetElementText(XMLElement* element)
+{
+    XMLNode* child = element ? element->FirstChild() : NULL;
+    XMLText* text  = child ? child->ToText() : NULL;
+    return text ? text->Value() : NULL;
+}
+
+struct XmlModelJob
+{
+    Model*      pModel;
+    const char* pVertices;
+    const char* pNormals;
+    const char* pDiffuseUVs;            // NULL without a diffuse texture
+    const char* pLightmapUVs;           // NULL without a lightmap
+    const char* pIndices;
+    bool        MoveCloser;
+};
+
+struct XmlLoadJobs
+{
+    SceneTextureJob* pTextures;
+    int              TextureCount;
+    XmlModelJob*     pModels;
+    int              ModelCount;
+};
+
+// Scratch arrays are the calling thread's own, reused from one model to the next
+static void ParseXmlModel(XmlModelJob& job, ArrayPOD<float>& positions, ArrayPOD<float>& normals,
+                          ArrayPOD<float>& diffuseUVs, ArrayPOD<float>& lightmapUVs)
+{
+    Model* model = job.pModel;
+
+    ScanFloats(job.pVertices, positions, 3);
+    ScanFloats(job.pNormals, normals, 3);
+    ScanFloats(job.pDiffuseUVs, diffuseUVs, 2);
+    ScanFloats(job.pLightmapUVs, lightmapUVs, 2);
+
+    const size_t numVerts = positions.GetSize() / 3;
+    model->Vertices.Reserve(numVerts);
+    for (size_t v = 0; v < numVerts; ++v)
+    {
+        Vector3f pos(-positions[3*v], positions[3*v+1], positions[3*v+2]);
+        if (job.MoveCloser)
+        {   // Move the terrace tree closer to the house
+            pos.z += 0.5f;
+        }
+        Vector3f norm;
+        if (3*v + 2 < normals.GetSize())
+            norm = Vector3f(normals[3*v], normals[3*v+1], -normals[3*v+2]);
+
+        float u1 = 0, v1 = 0, u2 = 0, v2 = 0;
+        if (2*v + 1 < diffuseUVs.GetSize())
+        {
+            u1 = diffuseUVs[2*v];
+            v1 = diffuseUVs[2*v+1];
+        }
+        if (2*v + 1 < lightmapUVs.GetSize())
+        {
+            u2 = lightmapUVs[2*v];
+            v2 = lightmapUVs[2*v+1];
+        }
+        Color c = job.pDiffuseUVs ? Color(255, 255, 255) : Color(255, 0, 0, 128);
+        model->Vertices.PushBack(Vertex(Vector3f(pos.z, pos.y, pos.x), c, u1, v1, u2, v2, norm));
+    }
+
+    // Read the vertex indices for the triangles, reversing their order to match the original
+    // expected orientation
+    const char* indexStr = job.pIndices;
+    unsigned    index;
+    while (indexStr && (indexStr = ScanUInt(indexStr, &index)) != NULL)
+        model->Indices.PushBack(index);
+
+    Array<uint32_t>& indices    = model->Indices;
+    size_t           indexCount = indices.GetSize();
+    for (size_t revIndex = 0; revIndex < indexCount/2; revIndex++)
+    {
+        uint32_t itemp                     = indices[revIndex];
+        indices[revIndex]                  = indices[indexCount - revIndex - 1];
+        indices[indexCount - revIndex - 1] = itemp;
+    }
+}
+
+static void XmlLoadWork(SceneLoaderThreads* threads, void* context)
+{
+    XmlLoadJobs& jobs = *(XmlLoadJobs*)context;
+
+    ArrayPOD<float> positions, normals, diffuseUVs, lightmapUVs;
+    int job;
+    while ((job = threads->NextJob()) >= 0)
+    {
+        if (job < jobs.TextureCount)
+            DecodeSceneTexture(jobs.pTextures[job]);
+        else
+            ParseXmlModel(jobs.pModels[job - jobs.TextureCount], positions, normals, diffuseUVs, lightmapUVs);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+void DecodeSceneTexture(SceneTextureJob& job)
+{
+    Ptr<File> pFile;
+    if (job.pData)
+        pFile = *new MemoryFile(job.FileName, job.pData, (int)job.DataSize);
+    else
+        pFile = *new SysFile(job.FileName);
+
+    if (job.IsDDS)
+        DecodeTextureDDS(pFile, &job.Image);
+    else
+        DecodeTextureTga(pFile, &job.Image);
+    pFile->Close();
+}
+
+SceneLoaderThreads::SceneLoaderThreads(WorkFn workFn, void* context) :
+    pWorkFn(workFn),
+    pContext(context),
+    JobCount(0),
+    ThreadCount(0)
+{
+}
+
+void SceneLoaderThreads::Start(int jobCount)
+{
+    JobCount    = jobCount;
+    Next        = 0;
+    ThreadCount = Alg::Max(1, Alg::Min(Alg::Min(Thread::GetCPUCount(), jobCount), (int)MaxThreads + 1));
+    for (int i = 0; i < ThreadCount - 1; i++)
+    {
+        Threads[i] = *new Thread(ThreadFn, this);
+        if (!Threads[i]->Start())
+        {
+            Threads[i].Clear();
+        }
+    }
+}
+
+void SceneLoaderThreads::Finish()
+{
+    pWorkFn(this, pContext);
+    for (int i = 0; i < ThreadCount - 1; i++)
+    {
+        if (Threads[i])
+        {
+            Threads[i]->Join();
+            Threads[i].Clear();
+        }
+    }
+}
+
+int SceneLoaderThreads::NextJob()
+{
+    int job = Next.ExchangeAdd_NoSync(1);
+    return (job < JobCount) ? job : -1;
+}
+
+int SceneLoaderThreads::ThreadFn(Thread* pthread, void* h)
+{
+    OVR_UNUSED(pthread);
+    SceneLoaderThreads* threads = (SceneLoaderThreads*)h;
+    threads->pWorkFn(threads, threads->pContext);
+    return 0;
+}
+
+
+//-------------------------------------------------------------------------------------
+Ptr<ShaderFill> CreateSceneFill(RenderDevice* pRender, Texture* diffuse, Texture* lightmap)
+{
+    Ptr<ShaderFill> shader = *new ShaderFill(*pRender->CreateShaderSet());
+    shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Vertex, VShader_MVP));
+    if(diffuse)
+    {
+        shader->SetTexture(0, diffuse);
+        if(lightmap)
+        {
+            shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Fragment, FShader_MultiTexture));
+            shader->SetTexture(1, lightmap);
+        }
+        else
+        {
+            shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Fragment, FShader_Texture));
+        }
+    }
+    else
+    {
+        shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Fragment, FShader_LitGouraud));
+    }
+    return shader;
+}
+
+
+//-------------------------------------------------------------------------------------
 XmlHandler::XmlHandler() :
     pXmlDocument(NULL),
     textureCount(0),
+    pTextureJobs(NULL),
     modelCount(0),
     collisionModelCount(0),
     groundCollisionModelCount(0)
@@ -38,22 +360,39 @@ XmlHandler::XmlHandler() :
 
 XmlHandler::~XmlHandler()
 {
+    delete[] pTextureJobs;
     delete pXmlDocument;
 }
 
-bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRender,
-	                      OVR::Render::Scene* pScene,
-                          OVR::Array<Ptr<CollisionModel> >* pCollisions,
-	                      OVR::Array<Ptr<CollisionModel> >* pGroundCollisions)
+const char* XmlHandler::GetTextureFileName(int texture) const
+{
+    return pTextureJobs[texture].FileName;
+}
+
+bool XmlHandler::ReadSceneData(const char* fileName, bool decodeTextures)
 {
+    Textures.Clear();
+    Models.Clear();
+    DiffuseTextureIndices.Clear();
+    LightmapTextureIndices.Clear();
+    CollisionModels.Clear();
+    GroundCollisionModels.Clear();
+    delete[] pTextureJobs;
+    pTextureJobs              = NULL;
+    textureCount              = 0;
+    modelCount                = 0;
+    collisionModelCount       = 0;
+    groundCollisionModelCount = 0;
+
+    double startTime = Timer::GetSeconds();
     if(pXmlDocument->LoadFile(fileName) != 0)
     {
         return false;
     }
+    double parsedTime = Timer::GetSeconds();
 
     // Extract the relative path to our working directory for loading textures
     filePath[0] = 0;
-    intptr_t pos = 0;
 	intptr_t len = strlen(fileName);
     for(intptr_t i = len; i > 0; i--)
     {
@@ -65,8 +404,7 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
         }        
     }    
 
-    // Load the textures
-	OVR_DEBUG_LOG_TEXT(("Loading textures..."));
+    // List the textures
     XMLElement* pXmlTexture = pXmlDocument->FirstChildElement("scene")->FirstChildElement("textures");
     OVR_ASSERT(pXmlTexture);
     if (pXmlTexture)
@@ -75,53 +413,28 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
         pXmlTexture = pXmlTexture->FirstChildElement("texture");
     }
 
+    pTextureJobs = new SceneTextureJob[textureCount > 0 ? textureCount : 1];
     for(int i = 0; i < textureCount; ++i)
     {
         const char* textureName = pXmlTexture->Attribute("fileName");
 		intptr_t    dotpos = strcspn(textureName, ".");
-        char        fname[300];
-
-		if (pos == len)
-		{            
-			OVR_sprintf(fname, 300, "%s", textureName);
-		}
-		else
-		{
-			OVR_sprintf(fname, 300, "%s%s", filePath, textureName);
-		}
-
-        SysFile* pFile = new SysFile(fname);
-		Ptr<Texture> texture;
-		if (textureName[dotpos + 1] == 'd' || textureName[dotpos + 1] == 'D')
-		{
-			// DDS file
-			texture.SetPtr(*LoadTextureDDS(pRender, pFile));
-		}
-		else
-		{
-			texture.SetPtr(*LoadTextureTga(pRender, pFile));
-		}
 
-        Textures.PushBack(texture);
-		pFile->Close();
-		pFile->Release();
+		OVR_sprintf(pTextureJobs[i].FileName, sizeof(pTextureJobs[i].FileName), "%s%s", filePath, textureName);
+        pTextureJobs[i].IsDDS = (textureName[dotpos + 1] == 'd' || textureName[dotpos + 1] == 'D');
         pXmlTexture = pXmlTexture->NextSiblingElement("texture");
     }
-	OVR_DEBUG_LOG_TEXT(("Done.\n"));
 
-    // Load the models
+    // List the models, with the text of their vertices and indices
 	pXmlDocument->FirstChildElement("scene")->FirstChildElement("models")->
 		          QueryIntAttribute("count", &modelCount);
 	
-		OVR_DEBUG_LOG(("Loading models... %i models to load...", modelCount));
-    XMLElement* pXmlModel = pXmlDocument->FirstChildElement("scene")->
-		                                  FirstChildElement("models")->FirstChildElement("model");
+    XmlModelJob* modelJobs = new XmlModelJob[modelCount > 0 ? modelCount : 1];
+    DiffuseTextureIndices.Resize(modelCount);
+    LightmapTextureIndices.Resize(modelCount);
+    XMLElement*  pXmlModel = pXmlDocument->FirstChildElement("scene")->
+		                                   FirstChildElement("models")->FirstChildElement("model");
     for(int i = 0; i < modelCount; ++i)
     {
-		if (i % 15 == 0)
-		{
-			OVR_DEBUG_LOG_TEXT(("%i models remaining...", modelCount - i));
-		}
 		Models.PushBack(*new Model(Prim_Triangles));
         const char* name = pXmlModel->Attribute("name");
         bool isCollisionModel = false;
@@ -132,38 +445,20 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
 			Models[i]->Visible = false;
 		}
 
-        bool tree_c = (strcmp(name, "tree_C") == 0) || (strcmp(name, "Object03") == 0);
-
-        //read the vertices
-        OVR::Array<Vector3f> *vertices = new OVR::Array<Vector3f>();
-        ParseVectorString(pXmlModel->FirstChildElement("vertices")->FirstChild()->
-			              ToText()->Value(), vertices);
-
-		for (unsigned int vertexIndex = 0; vertexIndex < vertices->GetSize(); ++vertexIndex)
-		{
-			vertices->At(vertexIndex).x *= -1.0f;
-
-            if (tree_c)
-            {   // Move the terrace tree closer to the house
-                vertices->At(vertexIndex).z += 0.5;
-            }
-		}
-
-        //read the normals
-        OVR::Array<Vector3f> *normals = new OVR::Array<Vector3f>();
-        ParseVectorString(pXmlModel->FirstChildElement("normals")->FirstChild()->
-			              ToText()->Value(), normals);
-
-		for (unsigned int normalIndex = 0; normalIndex < normals->GetSize(); ++normalIndex)
-		{
-			normals->At(normalIndex).z *= -1.0f;
-		}
+        XmlModelJob& job = modelJobs[i];
+        job.pModel       = Models[i];
+        job.pVertices    = GetElementText(pXmlModel->FirstChildElement("vertices"));
+        job.pNormals     = GetElementText(pXmlModel->FirstChildElement("normals"));
+        job.pDiffuseUVs  = NULL;
+        job.pLightmapUVs = NULL;
+        job.pIndices     = GetElementText(pXmlModel->FirstChildElement("indices"));
+        job.MoveCloser   = (strcmp(name, "tree_C") == 0) || (strcmp(name, "Object03") == 0);
 
         //read the textures
-        OVR::Array<Vector3f> *diffuseUVs = new OVR::Array<Vector3f>();
-        OVR::Array<Vector3f> *lightmapUVs = new OVR::Array<Vector3f>();
-        int         diffuseTextureIndex = -1;
-        int         lightmapTextureIndex = -1;
+        int&        diffuseTextureIndex  = DiffuseTextureIndices[i];
+        int&        lightmapTextureIndex = LightmapTextureIndices[i];
+        diffuseTextureIndex  = -1;
+        lightmapTextureIndex = -1;
         XMLElement* pXmlCurMaterial = pXmlModel->FirstChildElement("material");
 
         while(pXmlCurMaterial != NULL)
@@ -174,8 +469,7 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
 					             QueryIntAttribute("index", &diffuseTextureIndex);
                 if(diffuseTextureIndex > -1)
                 {
-                    ParseVectorString(pXmlCurMaterial->FirstChildElement("texture")->
-						              FirstChild()->ToText()->Value(), diffuseUVs, true);
+                    job.pDiffuseUVs = GetElementText(pXmlCurMaterial->FirstChildElement("texture"));
                 }
             }
             else if(pXmlCurMaterial->Attribute("name", "lightmap"))
@@ -184,112 +478,37 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
 					                               QueryIntAttribute("index", &lightmapTextureIndex);
                 if(lightmapTextureIndex > -1)
                 {
-                    XMLElement* firstChildElement = pXmlCurMaterial->FirstChildElement("texture");
-                    XMLNode* firstChild = firstChildElement->FirstChild();
-                    XMLText* text = firstChild->ToText();
-                    const char* value = text->Value();
-                    ParseVectorString(value, lightmapUVs, true);
+                    job.pLightmapUVs = GetElementText(pXmlCurMaterial->FirstChildElement("texture"));
                 }
             }
 
             pXmlCurMaterial = pXmlCurMaterial->NextSiblingElement("material");
         }
-
-        //set up the shader
-        Ptr<ShaderFill> shader = *new ShaderFill(*pRender->CreateShaderSet());
-        shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Vertex, VShader_MVP));
-        if(diffuseTextureIndex > -1)
-        {
-            shader->SetTexture(0, Textures[diffuseTextureIndex]);
-            if(lightmapTextureIndex > -1)
-            {
-                shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Fragment, FShader_MultiTexture));
-                shader->SetTexture(1, Textures[lightmapTextureIndex]);
-            }
-            else
-            {
-                shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Fragment, FShader_Texture));
-            }
-        }
-        else
-        {
-            shader->GetShaders()->SetShader(pRender->LoadBuiltinShader(Shader_Fragment, FShader_LitGouraud));
-        }
-        Models[i]->Fill = shader;
-
-        //add all the vertices to the model
-        const size_t numVerts = vertices->GetSize();
-        for(size_t v = 0; v < numVerts; ++v)
-        {
-            if(diffuseTextureIndex > -1)
-            {
-                if(lightmapTextureIndex > -1)
-                {
-                    Models[i]->AddVertex(vertices->At(v).z, vertices->At(v).y, vertices->At(v).x, Color(255, 255, 255),
-                                          diffuseUVs->At(v).x, diffuseUVs->At(v).y, lightmapUVs->At(v).x, lightmapUVs->At(v).y,
-                                          normals->At(v).x, normals->At(v).y, normals->At(v).z);
-                }
-                else
-                {
-                    Models[i]->AddVertex(vertices->At(v).z, vertices->At(v).y, vertices->At(v).x, Color(255, 255, 255),
-                                          diffuseUVs->At(v).x, diffuseUVs->At(v).y, 0, 0,
-                                          normals->At(v).x, normals->At(v).y, normals->At(v).z);
-                }
-            }
-            else
-            {
-                Models[i]->AddVertex(vertices->At(v).z, vertices->At(v).y, vertices->At(v).x, Color(255, 0, 0, 128),
-                                      0, 0, 0, 0,
-                                      normals->At(v).x, normals->At(v).y, normals->At(v).z);
-            }
-        }
-
-        // Read the vertex indices for the triangles
-        const char* indexStr = pXmlModel->FirstChildElement("indices")->
-                                          FirstChild()->ToText()->Value();
-        
-        size_t stringLength = strlen(indexStr);
-
-        for(size_t j = 0; j < stringLength; )
+        if (diffuseTextureIndex < 0)
         {
-            size_t k = j + 1;
-            for(; k < stringLength; ++k)
-            {
-                if (indexStr[k] == ' ')
-                    break;                
-            }
-            char text[20];
-            for(size_t l = 0; l < k - j; ++l)
-            {
-                text[l] = indexStr[j + l];
-            }
-            text[k - j] = '\0';
-
-            Models[i]->Indices.PushBack((unsigned short)atoi(text));
-            j = k + 1;
+            // Lightmap UVs were only used along with a diffuse texture
+            job.pLightmapUVs = NULL;
         }
 
-        // Reverse index order to match original expected orientation
-        Array<uint16_t>& indices    = Models[i]->Indices;
-        size_t         indexCount = indices.GetSize();         
+        pXmlModel = pXmlModel->NextSiblingElement("model");
+    }
 
-        for (size_t revIndex = 0; revIndex < indexCount/2; revIndex++)
-        {
-            unsigned short itemp               = indices[revIndex];
-            indices[revIndex]                  = indices[indexCount - revIndex - 1];
-            indices[indexCount - revIndex - 1] = itemp;            
-        }
+    // Decode the textures and parse the models, on this thread and on the workers
+	OVR_DEBUG_LOG(("Loading %i textures and %i models...", decodeTextures ? textureCount : 0, modelCount));
+    XmlLoadJobs jobs;
+    jobs.pTextures    = pTextureJobs;
+    jobs.TextureCount = decodeTextures ? textureCount : 0;
+    jobs.pModels      = modelJobs;
+    jobs.ModelCount   = modelCount;
 
-        delete vertices;
-        delete normals;
-        delete diffuseUVs;
-        delete lightmapUVs;
+    SceneLoaderThreads threads(XmlLoadWork, &jobs);
+    threads.Start(jobs.TextureCount + modelCount);
+    threads.Finish();
+    double decodedTime = Timer::GetSeconds();
 
-        pScene->World.Add(Models[i]);
-        pScene->Models.PushBack(Models[i]);
-        pXmlModel = pXmlModel->NextSiblingElement("model");
-    }
-	OVR_DEBUG_LOG(("Done."));
+    delete[] modelJobs;
+	OVR_DEBUG_LOG(("Done: XML %.0f ms, textures and models on %i threads %.0f ms.",
+                   1000.0 * (parsedTime - startTime), threads.GetThreadCount(), 1000.0 * (decodedTime - parsedTime)));
 
     //load the collision models
 	OVR_DEBUG_LOG(("Loading collision models... "));
@@ -328,7 +547,7 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
                 pXmlPlane = pXmlPlane->NextSiblingElement("plane");
             }
 
-            pCollisions->PushBack(cm);
+            CollisionModels.PushBack(cm);
             pXmlCollisionModel = pXmlCollisionModel->NextSiblingElement("collisionModel");
         }
     }
@@ -364,7 +583,7 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
                 pXmlPlane = pXmlPlane->NextSiblingElement("plane");
             }
 
-            pGroundCollisions->PushBack(cm);
+            GroundCollisionModels.PushBack(cm);
             pXmlCollisionModel = pXmlCollisionModel->NextSiblingElement("collisionModel");
         }
     }
@@ -372,44 +591,71 @@ bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRend
 	return true;
 }
 
-void XmlHandler::ParseVectorString(const char* str, OVR::Array<OVR::Vector3f> *array,
-	                               bool is2element)
+bool XmlHandler::ReadFile(const char* fileName, OVR::Render::RenderDevice* pRender,
+	                      OVR::Render::Scene* pScene,
+                          OVR::Array<Ptr<CollisionModel> >* pCollisions,
+	                      OVR::Array<Ptr<CollisionModel> >* pGroundCollisions)
 {
-    size_t stride = is2element ? 2 : 3;
-    size_t stringLength = strlen(str);
-    size_t element = 0;
-    float v[3];
+    if (!ReadSceneData(fileName, true))
+    {
+        return false;
+    }
+    double decodedTime = Timer::GetSeconds();
 
-    for(size_t j = 0; j < stringLength;)
+    // Everything that goes through the RenderDevice, in one pass on this thread
+    for(int i = 0; i < textureCount; ++i)
     {
-        size_t k = j + 1;
-        for(; k < stringLength; ++k)
-        {
-            if(str[k] == ' ')
-            {
-                break;
-            }
-        }
-        char text[20];
-        for(size_t l = 0; l < k - j; ++l)
+		Ptr<Texture> texture;
+        Texture*     created = CreateTextureFromImage(pRender, pTextureJobs[i].Image);
+        if (created)
         {
-            text[l] = str[j + l];
+            texture.SetPtr(*created);
         }
-        text[k - j] = '\0';
-        v[element] = (float)atof(text);
+        Textures.PushBack(texture);
+    }
 
-        if(element == (stride - 1))
+    for(int i = 0; i < modelCount; ++i)
+    {
+        Models[i]->Fill = CreateSceneFill(pRender,
+                                          DiffuseTextureIndices[i] > -1 ? Textures[DiffuseTextureIndices[i]] : NULL,
+                                          LightmapTextureIndices[i] > -1 ? Textures[LightmapTextureIndices[i]] : NULL);
+
+        // The buffers the renderers would otherwise create on the first frame
+        Model* model = Models[i];
+        if (model->Vertices.GetSize() && model->Indices.GetSize())
         {
-            //we've got all the elements of our vertex, so store them
-            OVR::Vector3f vect;
-            vect.x = v[0];
-            vect.y = v[1];
-            vect.z = is2element ? 0.0f : v[2];
-            array->PushBack(vect);
+            model->VertexBuffer = *pRender->CreateBuffer();
+            model->VertexBuffer->Data(Buffer_Vertex | Buffer_ReadOnly, &model->Vertices[0], model->Vertices.GetSize() * sizeof(Vertex));
+            model->CreateIndexBuffer(pRender);
         }
 
-        j = k + 1;
-        element = (element + 1) % stride;
+        pScene->World.Add(Models[i]);
+        pScene->Models.PushBack(Models[i]);
+    }
+
+    // The images are on the GPU now
+    for(int i = 0; i < textureCount; ++i)
+    {
+        OVR_FREE(pTextureJobs[i].Image.pData);
+        pTextureJobs[i].Image.pData = NULL;
+    }
+
+    pCollisions->Append(CollisionModels);
+    pGroundCollisions->Append(GroundCollisionModels);
+	OVR_DEBUG_LOG(("GPU uploads %.0f ms.", 1000.0 * (Timer::GetSeconds() - decodedTime)));
+	return true;
+}
+
+void XmlHandler::ParseVectorString(const char* str, OVR::Array<OVR::Vector3f> *array,
+	                               bool is2element)
+{
+    ArrayPOD<float> values;
+    size_t          stride = is2element ? 2 : 3;
+    ScanFloats(str, values, stride);
+
+    for (size_t i = 0; i < values.GetSize(); i += stride)
+    {
+        array->PushBack(OVR::Vector3f(values[i], values[i + 1], is2element ? 0.0f : values[i + 2]));
     }
 }
 
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "Render_Device.h"
 #include <Kernel/OVR_SysFile.h>
+#include <Kernel/OVR_Threads.h>
 using namespace OVR;
 using namespace OVR::Render;
 
@@ -35,6 +36,55 @@ namespace OVR { namespace Render {
 
 using namespace tinyxml2;
 
+// A scene texture to decode off the render thread: the pData file when it is set, as
+// when embedded in a binary scene, otherwise the FileName file.
+struct SceneTextureJob
+{
+    char           FileName[300];
+    const uint8_t* pData;
+    uint32_t       DataSize;
+    bool           IsDDS;
+    TextureImage   Image;
+
+    SceneTextureJob() : pData(NULL), DataSize(0), IsDDS(false) { FileName[0] = 0; }
+};
+
+void DecodeSceneTexture(SceneTextureJob& job);
+
+// The threads the scene loaders share their jobs out on: the calling thread and up to
+// MaxThreads workers, no more than there are CPUs or jobs. Start runs workFn on the
+// workers, so the calling thread can do what only it can meanwhile, then Finish runs
+// workFn on the calling thread too and waits for the workers. workFn takes the jobs
+// with NextJob until there are none left.
+class SceneLoaderThreads
+{
+public:
+    enum { MaxThreads = 7 };    // Besides the calling thread
+
+    typedef void (*WorkFn)(SceneLoaderThreads* threads, void* context);
+
+    SceneLoaderThreads(WorkFn workFn, void* context);
+
+    void Start(int jobCount);
+    void Finish();
+    int  NextJob();             // -1 when all the jobs are taken
+    int  GetThreadCount() const { return ThreadCount; }
+
+private:
+    static int ThreadFn(Thread* pthread, void* h);
+
+    WorkFn         pWorkFn;
+    void*          pContext;
+    int            JobCount;
+    AtomicInt<int> Next;
+    int            ThreadCount;
+    Ptr<Thread>    Threads[MaxThreads];
+};
+
+// The fill the scene loaders give a model: lit Gouraud without a diffuse texture, the
+// diffuse texture alone without a lightmap, otherwise both.
+Ptr<ShaderFill> CreateSceneFill(RenderDevice* pRender, Texture* diffuse, Texture* lightmap);
+
 class XmlHandler
 {
 public:
@@ -46,6 +96,22 @@ public:
 		          OVR::Array<Ptr<CollisionModel> >* pColisions,
                   OVR::Array<Ptr<CollisionModel> >* pGroundCollisions);
 
+    // Reads the scene without a RenderDevice: the models get their Vertices and Indices,
+    // and the collision models their planes, but nothing is created on the GPU. The
+    // texture files are only decoded with decodeTextures. This is what ReadFile starts
+    // with, and what the binary scene converter reads from.
+    bool ReadSceneData(const char* fileName, bool decodeTextures);
+
+    const char* GetScenePath() const                    { return filePath; }  // The scene file's directory
+    int         GetTextureCount() const                 { return textureCount; }
+    const char* GetTextureFileName(int texture) const;  // Including the scene file's path
+    int         GetModelCount() const                   { return modelCount; }
+    Model*      GetModel(int model) const               { return Models[model]; }
+    int         GetDiffuseTextureIndex(int model) const { return DiffuseTextureIndices[model]; }  // -1 for none
+    int         GetLightmapTextureIndex(int model) const{ return LightmapTextureIndices[model]; }
+    const OVR::Array<Ptr<CollisionModel> >& GetCollisionModels() const       { return CollisionModels; }
+    const OVR::Array<Ptr<CollisionModel> >& GetGroundCollisionModels() const { return GroundCollisionModels; }
+
 protected:
     void ParseVectorString(const char* str, OVR::Array<OVR::Vector3f> *array,
 		                   bool is2element = false);
@@ -54,9 +120,14 @@ private:
     tinyxml2::XMLDocument* pXmlDocument;
     char                   filePath[250];
     int                    textureCount;
+    SceneTextureJob*       pTextureJobs;
     OVR::Array<Ptr<Texture> > Textures;
     int                    modelCount;
     OVR::Array<Ptr<Model> > Models;
+    OVR::ArrayPOD<int>     DiffuseTextureIndices;
+    OVR::ArrayPOD<int>     LightmapTextureIndices;
+    OVR::Array<Ptr<CollisionModel> > CollisionModels;
+    OVR::Array<Ptr<CollisionModel> > GroundCollisionModels;
     int                    collisionModelCount;
     int                    groundCollisionModelCount;
 };
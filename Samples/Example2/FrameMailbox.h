@@ -0,0 +1,86 @@
+/************************************************************************************
+Filename    :   FrameMailbox.h
+Content     :   Lock-less triple buffer to hand the latest webcam frame to the render thread
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+#ifndef FRAMEMAILBOX_H_
+#define FRAMEMAILBOX_H_
+
+#include "Kernel/OVR_Atomic.h"
+
+#define FRAMEMAILBOX_SLOTS				3			// Back (owned by the producer), Middle (shared), Front (owned by the consumer)
+#define FRAMEMAILBOX_FRESH				0x4			// Set in the Middle index when it holds a frame the consumer has not taken yet
+
+
+// ==================================================================================//
+//  FrameMailbox Class
+// ==================================================================================//
+// Same idea as OVR::LocklessUpdater (single producer, only the most recent update matters), but the slots
+// are preallocated by the caller and are never copied: the producer fills its Back slot in place and
+// publishes it with one atomic exchange, the consumer takes the newest one with another exchange.
+// Neither side ever waits for the other, and a slot is never written while the other side owns it.
+template<class SlotType>
+class FrameMailbox
+{
+public:
+
+	SlotType					Slots[FRAMEMAILBOX_SLOTS];
+
+private:
+
+	int							iBack;																					// Producer thread only
+	int							iFront;																					// Consumer thread only
+	OVR::AtomicInt<int>			Middle;
+	OVR::AtomicInt<int>			PublishedCount;
+	OVR::AtomicInt<int>			DroppedCount;																			// Frames overwritten before the consumer took them
+	OVR::AtomicInt<int>			DuplicatedCount;																		// Consumer polls that found no new frame (the previous one is shown again)
+
+public:
+
+	// Constructor
+	FrameMailbox() : iBack(0), iFront(1), Middle(2), PublishedCount(0), DroppedCount(0), DuplicatedCount(0) {}
+
+	// Producer side: the slot to fill, valid until the next call to Publish()
+	SlotType &GetBackSlot()					{ return Slots[iBack]; }
+	int GetBackIndex() const				{ return iBack; }
+
+	void Publish()
+	{
+		int iOldMiddle = Middle.Exchange_Sync(iBack | FRAMEMAILBOX_FRESH);
+		if (iOldMiddle & FRAMEMAILBOX_FRESH) { DroppedCount.Increment_Sync(); }
+		iBack = iOldMiddle & ~FRAMEMAILBOX_FRESH;
+		PublishedCount.Increment_Sync();
+	}
+
+	// Consumer side: swaps in the newest frame if there is one. The front slot stays untouched until the next Acquire().
+	bool Acquire()
+	{
+		if (!(Middle.Load_Acquire() & FRAMEMAILBOX_FRESH)) { DuplicatedCount.Increment_Sync(); return false; }
+		int iOldMiddle = Middle.Exchange_Sync(iFront);
+		iFront = iOldMiddle & ~FRAMEMAILBOX_FRESH;
+		return true;
+	}
+
+	SlotType &GetFrontSlot()				{ return Slots[iFront]; }
+	int GetFrontIndex() const				{ return iFront; }
+
+	int GetPublishedCount() const			{ return PublishedCount.Load_Acquire(); }
+	int GetDroppedCount() const				{ return DroppedCount.Load_Acquire(); }
+	int GetDuplicatedCount() const			{ return DuplicatedCount.Load_Acquire(); }
+};
+
+#endif // FRAMEMAILBOX_H_
@@ -20,8 +20,14 @@ limitations under the License.
 #ifndef HAND_H_
 #define HAND_H_
 
+#include "SkinMask.h"
+
 #define HAND_HISTORY_SIZE				10			// Number of chronological hand positions stored in memory. Useful for gesture detection, stabilization, etc ...
 #define HAND_MIN_FINGER_DEPTH			10.0f		// Finger depth threshold value. Used in the finger detection algorithm.
+#define HAND_DETECTION_SCALE			2			// Detection runs on a 1/HAND_DETECTION_SCALE image (1, 2 or 4). Results are given in full resolution coordinates.
+#define HAND_TRACKING_ROI_SCALE			1.5f		// Half size of the tracking region around the last palm center, in units of the hand mean size
+#define HAND_EVENT_MAX_CONTOUR_POINTS	64			// Hand geometry sent with each HandEvent (contour simplified with approxPolyDP)
+#define HAND_EVENT_MAX_FINGER_TIPS		10
 #define HAND_GESTURE_NONE				0x00000000
 #define HAND_GESTURE_SWIPE_RIGHT		0x00000001
 #define HAND_GESTURE_SWIPE_LEFT			0x00000002
@@ -33,7 +39,27 @@ cv::Scalar MaxYCrCb = cv::Scalar(255, 190, 100);	// Maximum YCrCb threshold valu
 													// NOTE: As far as hand is not detected through a depth map but through a color map, light condition could dramatically change 
 													// these values. Consider to develop an algorithm to identify these thresholds automatically (e.g.: through a ROI Histogram).
 
-cv::vector<cv::Point> PalmCenters;					// Array of hand center positions. Useful for gesture detection, stabilization, etc ...
+// ==================================================================================//
+//  HandEvent Struct
+// ==================================================================================//
+// Result of the analysis of one frame: gestures and the geometry needed to draw the hand overlay. Plain data, so that
+// it can go through a LocklessQueue from the gesture worker to the render thread. Coordinates are frame pixels.
+struct HandEvent
+{
+	double						dCaptureTime;																			// When the analyzed frame was captured
+	bool						bIsHandFound;
+	DWORD						dwGesture;																				// HAND_GESTURE_* flags
+	cv::Point					PalmCenter;
+	float						fMeanSize;
+	int							iNbContourPoints;
+	cv::Point					ContourPoints[HAND_EVENT_MAX_CONTOUR_POINTS];
+	int							iNbFingerTips;
+	cv::Point					FingerTips[HAND_EVENT_MAX_FINGER_TIPS];
+	int							iNbPalmHistory;
+	cv::Point					PalmHistory[HAND_HISTORY_SIZE];
+
+	HandEvent() : dCaptureTime(0.0), bIsHandFound(false), dwGesture(HAND_GESTURE_NONE), fMeanSize(1.0f), iNbContourPoints(0), iNbFingerTips(0), iNbPalmHistory(0) {}
+};
 
 
 // ==================================================================================//
@@ -47,6 +73,7 @@ public:
 	cv::Point					RoughPalmCenter;
 	float						fMeanSize;
 	cv::vector<cv::Point>		FingerTips;
+	cv::vector<cv::Point>	   *pPalmCenters;																			// Palm center history this hand is appended to (owned by the HandTracker of its webcam), NULL for none
 
 private:
 
@@ -56,16 +83,18 @@ private:
 public:
 
 	// Constructor
-	Hand() : fMeanSize(1.0f) {}
+	Hand(cv::vector<cv::Point> *pHistory=NULL) : fMeanSize(1.0f), pPalmCenters(pHistory) {}
 
 	// Destructor
 	~Hand() {}
 
-	int ExtractContourAndHull(cv::Mat &SkinMask)
+	int ExtractContourAndHull(cv::Mat &SkinMask, int iScale=1, cv::Point Offset=cv::Point(0, 0))						// SkinMask may be downscaled by iScale and cropped at Offset: the hand is returned in full resolution coordinates
 	{
 		static int iThresh = 100;
 		static double dMinArea = 5000;																					// Ignore all small insignificant areas
 		static unsigned int uiMinContourSize = 300;
+		double dScaledMinArea = dMinArea / (iScale*iScale);																// Thresholds are in full resolution pixels
+		unsigned int uiScaledMinContourSize = uiMinContourSize / iScale;
 		
 		cv::RNG rng;
 		cv::Mat OutThreshold;
@@ -83,7 +112,7 @@ public:
 		cv::vector<cv::vector<cv::Vec4i>> Defects(Contours.size());
 		for (unsigned int i = 0; i < Contours.size(); i++)
 		{
-			if (cv::contourArea(Contours[i]) < dMinArea) { continue; }
+			if (cv::contourArea(Contours[i]) < dScaledMinArea) { continue; }
 
 			cv::convexHull(cv::Mat(Contours[i]), Hulls[i], false);
 			if (Hulls[i].size() > 3) { cv::convexityDefects(Contours[i], Hulls[i], Defects[i]); }
@@ -92,14 +121,29 @@ public:
 		// Find the biggest contour
 		int iBiggestContourID = FindBiggestContour(Contours);
 		if (iBiggestContourID == -1) return 0;
-		if (Contours[iBiggestContourID].size() < uiMinContourSize ||
+		if (Contours[iBiggestContourID].size() < uiScaledMinContourSize ||
 			Defects[iBiggestContourID].size() < 3) return 0;
 
 		Contour = Contours[iBiggestContourID];
 		Defect = Defects[iBiggestContourID];
+		if (iScale != 1 || Offset != cv::Point(0, 0))
+		{
+			for (unsigned int i = 0; i < Contour.size(); i++) { Contour[i] = Contour[i]*iScale + Offset; }
+			for (unsigned int j = 0; j < Defect.size(); j++) { Defect[j][3] *= iScale; }								// Defect depths are 8.8 fixed point distances
+		}
 		return 1;
 	}
 
+	int Detect(cv::Mat &BGRFrame, cv::Rect ROI, int iScale)															// Skin mask and contour on the ROI of the frame, downscaled by iScale
+	{
+		cv::Mat SmallFrame, SkinMask;
+		if (iScale > 1) { cv::resize(BGRFrame(ROI), SmallFrame, cv::Size(ROI.width / iScale, ROI.height / iScale), 0, 0, cv::INTER_AREA); }
+		else { SmallFrame = BGRFrame(ROI); }
+		if (SmallFrame.empty()) { return 0; }
+		BGR2SkinMask(SmallFrame, SkinMask, iScale);
+		return ExtractContourAndHull(SkinMask, iScale, ROI.tl());
+	}
+
 	int IdentifyProperties()																							// Identify Hand: bounding rect, palm center and fingers.
 	{
 		BoundingRect = cv::minAreaRect(cv::Mat(Contour));
@@ -143,40 +187,24 @@ public:
 
 		//if (FingerTips.size() > 5) return 0;																			// Add your own finger tips robust control algorithm
 
-		PalmCenters.push_back(RoughPalmCenter);																			// Add this center position to the history
-		if (PalmCenters.size() > HAND_HISTORY_SIZE) { PalmCenters.erase(PalmCenters.begin()); }
+		if (pPalmCenters)
+		{
+			pPalmCenters->push_back(RoughPalmCenter);																	// Add this center position to the history
+			if (pPalmCenters->size() > HAND_HISTORY_SIZE) { pPalmCenters->erase(pPalmCenters->begin()); }
+		}
 
 		return 1;
 	}
 
-	void BGR2SkinMask(cv::Mat &BGRFrame, cv::Mat &SkinMask)																// Convert the video frame into a YCrCb color space and obtain a Black & White mask to extract the skin
+	void BGR2SkinMask(cv::Mat &BGRFrame, cv::Mat &SkinMask, int iScale=1)												// Threshold the video frame in the YCrCb color space and obtain a Black & White mask to extract the skin
 	{
-		cv::Mat FrameYCrCb;
-		cv::cvtColor(BGRFrame, FrameYCrCb, CV_BGR2YCrCb);
-
-		int y, cr, cb;
-		int rows = BGRFrame.rows;
-		int cols = BGRFrame.cols;
-		int channels = FrameYCrCb.channels();
-		unsigned char *pYCrCbData = FrameYCrCb.data;
-		unsigned char *pGrayMaskData = SkinMask.data;
-		for (int i = 0; i < rows; i++)
-		{
-			for (int j = 0; j < cols; j++)
-			{
-				y = pYCrCbData[(i*cols + j)*channels + 0];
-				cr = pYCrCbData[(i*cols + j)*channels + 1];
-				cb = pYCrCbData[(i*cols + j)*channels + 2];
+		SkinMaskRange Range((int)ceil(MinYCrCb[0]), (int)floor(MaxYCrCb[0]),											// Integer bounds give the same result as the old double comparisons
+							(int)ceil(MinYCrCb[1]), (int)floor(MaxYCrCb[1]),
+							(int)ceil(MinYCrCb[2]), (int)floor(MaxYCrCb[2]));
+		SkinMask.create(BGRFrame.rows, BGRFrame.cols, CV_8UC1);
+		BGR2SkinMaskFused(BGRFrame.data, BGRFrame.step, SkinMask.data, SkinMask.step, BGRFrame.cols, BGRFrame.rows, Range);	// Fused BGR->YCrCb->threshold, see SkinMask.h
 
-				y = (y >= MinYCrCb[0] && y <= MaxYCrCb[0]) ? (unsigned char)255 : (unsigned char)0;
-				cr = (cr >= MinYCrCb[1] && cr <= MaxYCrCb[1]) ? (unsigned char)255 : (unsigned char)0;
-				cb = (cb >= MinYCrCb[2] && cb <= MaxYCrCb[2]) ? (unsigned char)255 : (unsigned char)0;
-
-				pGrayMaskData[i*cols + j] = ((y + cr + cb) > 255 ? (unsigned char)255 : (unsigned char)0);
-			}
-		}
-
-		int size = 3;
+		int size = std::max(1, cvRound(3.0 / iScale));																	// Same physical size at any detection scale
 		cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2 * size, 2 * size), cv::Point(size, size));
 		cv::erode(SkinMask, SkinMask, element);
 		cv::dilate(SkinMask, SkinMask, element);
@@ -185,8 +213,10 @@ public:
 	DWORD GestureDetection()																							// Analyze the parameters and identify gestures
 	{
 		DWORD dwGesture = HAND_GESTURE_NONE;
-		int deltaX = PalmCenters[PalmCenters.size()-1].x - PalmCenters[0].x;
-		int deltaY = PalmCenters[PalmCenters.size()-1].y - PalmCenters[0].y;
+		if (!pPalmCenters || pPalmCenters->empty()) { return dwGesture; }
+		const cv::vector<cv::Point> &History = *pPalmCenters;
+		int deltaX = History[History.size()-1].x - History[0].x;
+		int deltaY = History[History.size()-1].y - History[0].y;
 
 		if (deltaX > (int)fMeanSize)		{ dwGesture |= HAND_GESTURE_SWIPE_RIGHT; }
 		else if (deltaX < -(int)fMeanSize)	{ dwGesture |= HAND_GESTURE_SWIPE_LEFT; }
@@ -200,11 +230,13 @@ public:
 	void Draw(cv::Mat &Frame)
 	{
 		// Draw the palm center position history
-		for (unsigned int i = 0; i<PalmCenters.size(); i++)
+		static const cv::vector<cv::Point> NoHistory;
+		const cv::vector<cv::Point> &History = (pPalmCenters ? *pPalmCenters : NoHistory);
+		for (unsigned int i = 0; i<History.size(); i++)
 		{
-			if (PalmCenters.size() >= 2 && i < PalmCenters.size() - 2)
+			if (History.size() >= 2 && i < History.size() - 2)
 			{
-				cv::line(Frame, PalmCenters[i], PalmCenters[i + 1], cv::Scalar(128, 100, 0), 2);
+				cv::line(Frame, History[i], History[i + 1], cv::Scalar(128, 100, 0), 2);
 			}
 		}
 
@@ -224,6 +256,24 @@ public:
 		}
 	}
 
+	void FillEvent(HandEvent &Event, DWORD dwGesture)																	// Same geometry as Draw(), to be drawn by the renderer instead of into the frame
+	{
+		cv::vector<cv::Point> ContourPoly;
+		approxPolyDP(cv::Mat(Contour), ContourPoly, 3, true);
+		for (double dEpsilon = 6; ContourPoly.size() > HAND_EVENT_MAX_CONTOUR_POINTS; dEpsilon *= 2) { approxPolyDP(cv::Mat(Contour), ContourPoly, dEpsilon, true); }
+
+		Event.bIsHandFound		= true;
+		Event.dwGesture			= dwGesture;
+		Event.PalmCenter		= RoughPalmCenter;
+		Event.fMeanSize			= fMeanSize;
+		Event.iNbContourPoints	= (int)ContourPoly.size();
+		for (int i = 0; i < Event.iNbContourPoints; i++) { Event.ContourPoints[i] = ContourPoly[i]; }
+		Event.iNbFingerTips		= std::min((int)FingerTips.size(), HAND_EVENT_MAX_FINGER_TIPS);
+		for (int i = 0; i < Event.iNbFingerTips; i++) { Event.FingerTips[i] = FingerTips[i]; }
+		Event.iNbPalmHistory	= (pPalmCenters ? std::min((int)pPalmCenters->size(), HAND_HISTORY_SIZE) : 0);
+		for (int i = 0; i < Event.iNbPalmHistory; i++) { Event.PalmHistory[i] = (*pPalmCenters)[i]; }
+	}
+
 	int FindBiggestContour(cv::vector<cv::vector<cv::Point>> Contours)
 	{
 		int iBiggestContourID = -1;
@@ -247,4 +297,41 @@ public:
 	}
 };
 
+
+
+// ==================================================================================//
+//  HandTracker Class
+// ==================================================================================//
+// Keeps the detection cheap: it runs on a downscaled image and, once the hand is found, only inside a region around
+// its last palm center. The whole frame is searched again only when the hand is lost. One tracker per webcam.
+class HandTracker
+{
+public:
+
+	int							iScale;
+	bool						bIsTracking;
+	cv::Rect					TrackingROI;
+	cv::vector<cv::Point>		PalmHistory;																			// Per webcam, used by the hands given to Process()
+
+public:
+
+	// Constructor
+	HandTracker(int iDetectionScale=HAND_DETECTION_SCALE) : iScale(iDetectionScale), bIsTracking(false) {}
+
+	int Process(cv::Mat &BGRFrame, Hand &hand)
+	{
+		hand.pPalmCenters = &PalmHistory;
+		cv::Rect FullFrame(0, 0, BGRFrame.cols, BGRFrame.rows);
+		int iFound = hand.Detect(BGRFrame, (bIsTracking ? TrackingROI : FullFrame), iScale);
+		if (!iFound && bIsTracking) { iFound = hand.Detect(BGRFrame, FullFrame, iScale); }								// Tracking lost: search the whole frame right away
+		bIsTracking = false;
+		if (!iFound || !hand.IdentifyProperties()) { return 0; }
+
+		int iHalfSize = (int)(HAND_TRACKING_ROI_SCALE*hand.fMeanSize);
+		TrackingROI = cv::Rect(hand.RoughPalmCenter.x - iHalfSize, hand.RoughPalmCenter.y - iHalfSize, 2*iHalfSize, 2*iHalfSize) & FullFrame;
+		bIsTracking = (TrackingROI.width >= 2*iScale && TrackingROI.height >= 2*iScale);
+		return 1;
+	}
+};
+
 #endif // HAND_H_
\ No newline at end of file
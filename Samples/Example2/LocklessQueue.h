@@ -0,0 +1,71 @@
+/************************************************************************************
+Filename    :   LocklessQueue.h
+Content     :   Bounded single producer / single consumer queue without locks
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+#ifndef LOCKLESSQUEUE_H_
+#define LOCKLESSQUEUE_H_
+
+#include "Kernel/OVR_Atomic.h"
+
+
+// ==================================================================================//
+//  LocklessQueue Class
+// ==================================================================================//
+// Unlike FrameMailbox every item matters here (e.g.: gesture events), so nothing is overwritten: when the
+// consumer falls behind, Push() fails and the item is counted as lost instead of blocking the producer.
+// One slot is always left empty to tell a full queue from an empty one, so it holds up to Capacity-1 items.
+template<class ItemType, int Capacity>
+class LocklessQueue
+{
+private:
+
+	ItemType					Items[Capacity];
+	OVR::AtomicInt<int>			Head;																					// Next slot to write, advanced by the producer only
+	OVR::AtomicInt<int>			Tail;																					// Next slot to read, advanced by the consumer only
+	OVR::AtomicInt<int>			LostCount;
+
+public:
+
+	// Constructor
+	LocklessQueue() : Head(0), Tail(0), LostCount(0) {}
+
+	// Producer side
+	bool Push(const ItemType &Item)
+	{
+		int iHead = Head.Load_Acquire();
+		int iNext = (iHead + 1) % Capacity;
+		if (iNext == Tail.Load_Acquire()) { LostCount.Increment_Sync(); return false; }
+		Items[iHead] = Item;
+		Head.Store_Release(iNext);																						// Publishes the item written above
+		return true;
+	}
+
+	// Consumer side
+	bool Pop(ItemType &Item)
+	{
+		int iTail = Tail.Load_Acquire();
+		if (iTail == Head.Load_Acquire()) { return false; }
+		Item = Items[iTail];
+		Tail.Store_Release((iTail + 1) % Capacity);																		// Hands the slot back to the producer
+		return true;
+	}
+
+	int GetLostCount() const	{ return LostCount.Load_Acquire(); }
+};
+
+#endif // LOCKLESSQUEUE_H_
@@ -0,0 +1,355 @@
+/************************************************************************************
+Filename    :   SkinMask.h
+Content     :   Fused BGR -> YCrCb -> threshold skin mask kernel (Scalar, SSSE3, AVX2, NEON)
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// The kernel converts each BGR pixel to YCrCb with the same 14-bit fixed point arithmetic used by
+// cv::cvtColor(..., CV_BGR2YCrCb) on 8-bit images, so the output is bit-exact with the old
+// cvtColor + per-pixel threshold code, but no intermediate YCrCb frame is ever allocated.
+// A pixel is marked as skin (255) when at least 2 of its 3 YCrCb channels are inside their range.
+
+#ifndef SKINMASK_H_
+#define SKINMASK_H_
+
+#include <stddef.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SKINMASK_X86					1
+#include <emmintrin.h>
+#include <tmmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM) || defined(_M_ARM64)
+#define SKINMASK_NEON					1
+#include <arm_neon.h>
+#endif
+
+#if defined(SKINMASK_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SKINMASK_TARGET(isa)			__attribute__((target(isa)))									// GCC/Clang need the ISA enabled per function, MSVC always accepts the intrinsics
+#else
+#define SKINMASK_TARGET(isa)
+#endif
+
+#define SKINMASK_PATH_AUTO				-1
+#define SKINMASK_PATH_SCALAR			0
+#define SKINMASK_PATH_SSSE3				1			// 16 pixels per iteration
+#define SKINMASK_PATH_AVX2				2			// 32 pixels per iteration
+#define SKINMASK_PATH_NEON				3			// 16 pixels per iteration
+
+#define SKINMASK_YUV_SHIFT				14			// Same fixed point coefficients as OpenCV RGB2YCrCb_i
+#define SKINMASK_Y_B					1868
+#define SKINMASK_Y_G					9617
+#define SKINMASK_Y_R					4899
+#define SKINMASK_CR_R					11682
+#define SKINMASK_CB_B					9241
+#define SKINMASK_ROUND					(1 << (SKINMASK_YUV_SHIFT - 1))
+#define SKINMASK_DELTA					(128 << SKINMASK_YUV_SHIFT)
+
+
+// ==================================================================================//
+//  SkinMaskRange Struct
+// ==================================================================================//
+struct SkinMaskRange																									// Inclusive integer [Min, Max] thresholds for each YCrCb channel
+{
+	int MinY, MaxY, MinCr, MaxCr, MinCb, MaxCb;
+
+	SkinMaskRange(int minY = 0, int maxY = 255, int minCr = 0, int maxCr = 255, int minCb = 0, int maxCb = 255)
+		: MinY(minY), MaxY(maxY), MinCr(minCr), MaxCr(maxCr), MinCb(minCb), MaxCb(maxCb) {}
+
+	static unsigned char Clamp(int v)				{ return (unsigned char)(v < 0 ? 0 : (v > 255 ? 255 : v)); }
+	static bool IsEmpty(int iMin, int iMax)		{ return iMin > iMax || iMin > 255 || iMax < 0; }				// Clamped bounds alone would still let 0 or 255 through
+};
+
+
+// ==================================================================================//
+//  Scalar reference
+// ==================================================================================//
+inline void SkinMaskRow_Scalar(const unsigned char *pBGR, unsigned char *pMask, int iCount, const SkinMaskRange &Range)
+{
+	for (int j = 0; j < iCount; j++, pBGR += 3)
+	{
+		int b = pBGR[0], g = pBGR[1], r = pBGR[2];
+		int y  = (b*SKINMASK_Y_B + g*SKINMASK_Y_G + r*SKINMASK_Y_R + SKINMASK_ROUND) >> SKINMASK_YUV_SHIFT;
+		int cr = ((r - y)*SKINMASK_CR_R + SKINMASK_DELTA + SKINMASK_ROUND) >> SKINMASK_YUV_SHIFT;
+		int cb = ((b - y)*SKINMASK_CB_B + SKINMASK_DELTA + SKINMASK_ROUND) >> SKINMASK_YUV_SHIFT;
+		cr = (cr < 0 ? 0 : (cr > 255 ? 255 : cr));																	// saturate_cast<uchar>, as cvtColor does
+		cb = (cb < 0 ? 0 : (cb > 255 ? 255 : cb));
+
+		int iInside = (y  >= Range.MinY  && y  <= Range.MaxY) +
+					  (cr >= Range.MinCr && cr <= Range.MaxCr) +
+					  (cb >= Range.MinCb && cb <= Range.MaxCb);
+		pMask[j] = (iInside >= 2 ? (unsigned char)255 : (unsigned char)0);
+	}
+}
+
+
+#if SKINMASK_X86
+// ==================================================================================//
+//  SSSE3 / AVX2 kernels
+// ==================================================================================//
+// Each 128 bit lane converts a group of 4 pixels (12 bytes): pshufb spreads B,G and R into 16/32 bit lanes,
+// pmaddwd evaluates the dot products in 32 bit, and the results of 4 groups are packed back to 16 bytes
+// with signed/unsigned saturation, which matches saturate_cast<uchar>. Loads read 4 bytes past the last
+// group, so callers must leave at least 2 more pixels on the row.
+
+inline SKINMASK_TARGET("ssse3") __m128i SkinMaskInRange_SSE(__m128i v, __m128i lo, __m128i hi)
+{
+	return _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(v, lo), v), _mm_cmpeq_epi8(_mm_min_epu8(v, hi), v));
+}
+
+inline SKINMASK_TARGET("ssse3") void SkinMaskGroup_SSSE3(__m128i v, __m128i &y, __m128i &cr, __m128i &cb)
+{
+	const __m128i ShufBG	= _mm_setr_epi8(0,-1, 1,-1, 3,-1, 4,-1, 6,-1, 7,-1, 9,-1, 10,-1);
+	const __m128i ShufR		= _mm_setr_epi8(2,-1,-1,-1, 5,-1,-1,-1, 8,-1,-1,-1, 11,-1,-1,-1);
+	const __m128i ShufB		= _mm_setr_epi8(0,-1,-1,-1, 3,-1,-1,-1, 6,-1,-1,-1, 9,-1,-1,-1);
+	const __m128i CoefBG	= _mm_setr_epi16(SKINMASK_Y_B, SKINMASK_Y_G, SKINMASK_Y_B, SKINMASK_Y_G, SKINMASK_Y_B, SKINMASK_Y_G, SKINMASK_Y_B, SKINMASK_Y_G);
+	const __m128i CoefR		= _mm_set1_epi32(SKINMASK_Y_R);															// High 16 bits are 0: pmaddwd only uses the low half of each lane
+	const __m128i CoefCr	= _mm_set1_epi32(SKINMASK_CR_R);
+	const __m128i CoefCb	= _mm_set1_epi32(SKINMASK_CB_B);
+	const __m128i Round		= _mm_set1_epi32(SKINMASK_ROUND);
+	const __m128i Delta		= _mm_set1_epi32(SKINMASK_DELTA + SKINMASK_ROUND);
+
+	__m128i r = _mm_shuffle_epi8(v, ShufR);
+	__m128i b = _mm_shuffle_epi8(v, ShufB);
+	y  = _mm_add_epi32(_mm_madd_epi16(_mm_shuffle_epi8(v, ShufBG), CoefBG), _mm_madd_epi16(r, CoefR));
+	y  = _mm_srai_epi32(_mm_add_epi32(y, Round), SKINMASK_YUV_SHIFT);
+	cr = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_sub_epi32(r, y), CoefCr), Delta), SKINMASK_YUV_SHIFT);		// (r - y) fits in the low 16 bits as a signed value
+	cb = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_sub_epi32(b, y), CoefCb), Delta), SKINMASK_YUV_SHIFT);
+}
+
+inline SKINMASK_TARGET("ssse3") int SkinMaskRow_SSSE3(const unsigned char *pBGR, unsigned char *pMask, int iCount, const SkinMaskRange &Range)
+{
+	const __m128i LoY  = _mm_set1_epi8((char)SkinMaskRange::Clamp(Range.MinY)),  HiY  = _mm_set1_epi8((char)SkinMaskRange::Clamp(Range.MaxY));
+	const __m128i LoCr = _mm_set1_epi8((char)SkinMaskRange::Clamp(Range.MinCr)), HiCr = _mm_set1_epi8((char)SkinMaskRange::Clamp(Range.MaxCr));
+	const __m128i LoCb = _mm_set1_epi8((char)SkinMaskRange::Clamp(Range.MinCb)), HiCb = _mm_set1_epi8((char)SkinMaskRange::Clamp(Range.MaxCb));
+	const __m128i EmptyY  = _mm_set1_epi8(SkinMaskRange::IsEmpty(Range.MinY,  Range.MaxY)  ? 0 : -1);
+	const __m128i EmptyCr = _mm_set1_epi8(SkinMaskRange::IsEmpty(Range.MinCr, Range.MaxCr) ? 0 : -1);
+	const __m128i EmptyCb = _mm_set1_epi8(SkinMaskRange::IsEmpty(Range.MinCb, Range.MaxCb) ? 0 : -1);
+
+	int j = 0;
+	for (; j + 16 + 2 <= iCount; j += 16, pBGR += 48)
+	{
+		__m128i y[4], cr[4], cb[4];
+		for (int k = 0; k < 4; k++) { SkinMaskGroup_SSSE3(_mm_loadu_si128((const __m128i*)(pBGR + 12*k)), y[k], cr[k], cb[k]); }
+
+		__m128i Y  = _mm_packus_epi16(_mm_packs_epi32(y[0],  y[1]),  _mm_packs_epi32(y[2],  y[3]));
+		__m128i Cr = _mm_packus_epi16(_mm_packs_epi32(cr[0], cr[1]), _mm_packs_epi32(cr[2], cr[3]));
+		__m128i Cb = _mm_packus_epi16(_mm_packs_epi32(cb[0], cb[1]), _mm_packs_epi32(cb[2], cb[3]));
+
+		__m128i InY  = _mm_and_si128(SkinMaskInRange_SSE(Y,  LoY,  HiY),  EmptyY);
+		__m128i InCr = _mm_and_si128(SkinMaskInRange_SSE(Cr, LoCr, HiCr), EmptyCr);
+		__m128i InCb = _mm_and_si128(SkinMaskInRange_SSE(Cb, LoCb, HiCb), EmptyCb);
+		__m128i Mask = _mm_or_si128(_mm_and_si128(InY, _mm_or_si128(InCr, InCb)), _mm_and_si128(InCr, InCb));		// At least 2 of 3
+		_mm_storeu_si128((__m128i*)(pMask + j), Mask);
+	}
+	return j;
+}
+
+inline SKINMASK_TARGET("avx2") __m256i SkinMaskInRange_AVX2(__m256i v, __m256i lo, __m256i hi)
+{
+	return _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(v, lo), v), _mm256_cmpeq_epi8(_mm256_min_epu8(v, hi), v));
+}
+
+inline SKINMASK_TARGET("avx2") void SkinMaskGroup_AVX2(const unsigned char *pLo, const unsigned char *pHi, __m256i &y, __m256i &cr, __m256i &cb)
+{
+	const __m256i ShufBG	= _mm256_broadcastsi128_si256(_mm_setr_epi8(0,-1, 1,-1, 3,-1, 4,-1, 6,-1, 7,-1, 9,-1, 10,-1));
+	const __m256i ShufR		= _mm256_broadcastsi128_si256(_mm_setr_epi8(2,-1,-1,-1, 5,-1,-1,-1, 8,-1,-1,-1, 11,-1,-1,-1));
+	const __m256i ShufB		= _mm256_broadcastsi128_si256(_mm_setr_epi8(0,-1,-1,-1, 3,-1,-1,-1, 6,-1,-1,-1, 9,-1,-1,-1));
+	const __m256i CoefBG	= _mm256_set1_epi32((SKINMASK_Y_G << 16) | SKINMASK_Y_B);
+	const __m256i CoefR		= _mm256_set1_epi32(SKINMASK_Y_R);
+	const __m256i CoefCr	= _mm256_set1_epi32(SKINMASK_CR_R);
+	const __m256i CoefCb	= _mm256_set1_epi32(SKINMASK_CB_B);
+	const __m256i Round		= _mm256_set1_epi32(SKINMASK_ROUND);
+	const __m256i Delta		= _mm256_set1_epi32(SKINMASK_DELTA + SKINMASK_ROUND);
+
+	__m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)pLo)), _mm_loadu_si128((const __m128i*)pHi), 1);
+	__m256i r = _mm256_shuffle_epi8(v, ShufR);
+	__m256i b = _mm256_shuffle_epi8(v, ShufB);
+	y  = _mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(v, ShufBG), CoefBG), _mm256_madd_epi16(r, CoefR));
+	y  = _mm256_srai_epi32(_mm256_add_epi32(y, Round), SKINMASK_YUV_SHIFT);
+	cr = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_sub_epi32(r, y), CoefCr), Delta), SKINMASK_YUV_SHIFT);
+	cb = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_sub_epi32(b, y), CoefCb), Delta), SKINMASK_YUV_SHIFT);
+}
+
+inline SKINMASK_TARGET("avx2") int SkinMaskRow_AVX2(const unsigned char *pBGR, unsigned char *pMask, int iCount, const SkinMaskRange &Range)
+{
+	const __m256i LoY  = _mm256_set1_epi8((char)SkinMaskRange::Clamp(Range.MinY)),  HiY  = _mm256_set1_epi8((char)SkinMaskRange::Clamp(Range.MaxY));
+	const __m256i LoCr = _mm256_set1_epi8((char)SkinMaskRange::Clamp(Range.MinCr)), HiCr = _mm256_set1_epi8((char)SkinMaskRange::Clamp(Range.MaxCr));
+	const __m256i LoCb = _mm256_set1_epi8((char)SkinMaskRange::Clamp(Range.MinCb)), HiCb = _mm256_set1_epi8((char)SkinMaskRange::Clamp(Range.MaxCb));
+	const __m256i EmptyY  = _mm256_set1_epi8(SkinMaskRange::IsEmpty(Range.MinY,  Range.MaxY)  ? 0 : -1);
+	const __m256i EmptyCr = _mm256_set1_epi8(SkinMaskRange::IsEmpty(Range.MinCr, Range.MaxCr) ? 0 : -1);
+	const __m256i EmptyCb = _mm256_set1_epi8(SkinMaskRange::IsEmpty(Range.MinCb, Range.MaxCb) ? 0 : -1);
+
+	int j = 0;
+	for (; j + 32 + 2 <= iCount; j += 32, pBGR += 96)
+	{
+		// Lane 0 holds groups 0..3 (pixels 0..15) and lane 1 groups 4..7 (pixels 16..31), so the in-lane packs
+		// below already produce the 32 results in memory order.
+		__m256i y[4], cr[4], cb[4];
+		for (int k = 0; k < 4; k++) { SkinMaskGroup_AVX2(pBGR + 12*k, pBGR + 48 + 12*k, y[k], cr[k], cb[k]); }
+
+		__m256i Y  = _mm256_packus_epi16(_mm256_packs_epi32(y[0],  y[1]),  _mm256_packs_epi32(y[2],  y[3]));
+		__m256i Cr = _mm256_packus_epi16(_mm256_packs_epi32(cr[0], cr[1]), _mm256_packs_epi32(cr[2], cr[3]));
+		__m256i Cb = _mm256_packus_epi16(_mm256_packs_epi32(cb[0], cb[1]), _mm256_packs_epi32(cb[2], cb[3]));
+
+		__m256i InY  = _mm256_and_si256(SkinMaskInRange_AVX2(Y,  LoY,  HiY),  EmptyY);
+		__m256i InCr = _mm256_and_si256(SkinMaskInRange_AVX2(Cr, LoCr, HiCr), EmptyCr);
+		__m256i InCb = _mm256_and_si256(SkinMaskInRange_AVX2(Cb, LoCb, HiCb), EmptyCb);
+		__m256i Mask = _mm256_or_si256(_mm256_and_si256(InY, _mm256_or_si256(InCr, InCb)), _mm256_and_si256(InCr, InCb));
+		_mm256_storeu_si256((__m256i*)(pMask + j), Mask);
+	}
+	return j;
+}
+
+inline int SkinMaskDetectPath()
+{
+	int iInfo[4] = { 0, 0, 0, 0 };
+	bool bSSSE3 = false, bAVX2 = false;
+#if defined(_MSC_VER)
+	__cpuid(iInfo, 0);
+	int iMaxLeaf = iInfo[0];
+	__cpuid(iInfo, 1);
+	bSSSE3 = (iInfo[2] & (1 << 9)) != 0;
+	bool bOSXSAVE = (iInfo[2] & (1 << 27)) != 0;
+	if (iMaxLeaf >= 7 && bOSXSAVE && (_xgetbv(0) & 6) == 6)															// The OS must save the YMM registers
+	{
+		__cpuidex(iInfo, 7, 0);
+		bAVX2 = (iInfo[1] & (1 << 5)) != 0;
+	}
+#else
+	unsigned int a, b, c, d;
+	if (__get_cpuid(1, &a, &b, &c, &d))
+	{
+		bSSSE3 = (c & (1 << 9)) != 0;
+		bool bOSXSAVE = (c & (1 << 27)) != 0;
+		if (bOSXSAVE && __get_cpuid_max(0, NULL) >= 7)
+		{
+			unsigned int uiXCR0Lo, uiXCR0Hi;
+			__asm__ ("xgetbv" : "=a"(uiXCR0Lo), "=d"(uiXCR0Hi) : "c"(0));
+			__cpuid_count(7, 0, a, b, c, d);
+			bAVX2 = ((uiXCR0Lo & 6) == 6) && (b & (1 << 5)) != 0;
+		}
+	}
+	(void)iInfo;
+#endif
+	return (bAVX2 ? SKINMASK_PATH_AVX2 : (bSSSE3 ? SKINMASK_PATH_SSSE3 : SKINMASK_PATH_SCALAR));
+}
+#endif // SKINMASK_X86
+
+
+#if SKINMASK_NEON
+// ==================================================================================//
+//  NEON kernel
+// ==================================================================================//
+inline uint8x8_t SkinMaskHalf_NEON(uint16x8_t b, uint16x8_t g, uint16x8_t r, uint8x8_t &cr, uint8x8_t &cb)
+{
+	uint32x4_t yLo = vmlal_n_u16(vmlal_n_u16(vmull_n_u16(vget_low_u16(b), SKINMASK_Y_B), vget_low_u16(g), SKINMASK_Y_G), vget_low_u16(r), SKINMASK_Y_R);
+	uint32x4_t yHi = vmlal_n_u16(vmlal_n_u16(vmull_n_u16(vget_high_u16(b), SKINMASK_Y_B), vget_high_u16(g), SKINMASK_Y_G), vget_high_u16(r), SKINMASK_Y_R);
+	uint16x8_t y   = vcombine_u16(vrshrn_n_u32(yLo, SKINMASK_YUV_SHIFT), vrshrn_n_u32(yHi, SKINMASK_YUV_SHIFT));		// vrshrn adds the rounding term itself
+
+	const int32x4_t Delta = vdupq_n_s32(SKINMASK_DELTA);
+	int16x8_t dr = vsubq_s16(vreinterpretq_s16_u16(r), vreinterpretq_s16_u16(y));
+	int16x8_t db = vsubq_s16(vreinterpretq_s16_u16(b), vreinterpretq_s16_u16(y));
+	int16x8_t crW = vcombine_s16(vrshrn_n_s32(vmlal_n_s16(Delta, vget_low_s16(dr), SKINMASK_CR_R), SKINMASK_YUV_SHIFT),
+								 vrshrn_n_s32(vmlal_n_s16(Delta, vget_high_s16(dr), SKINMASK_CR_R), SKINMASK_YUV_SHIFT));
+	int16x8_t cbW = vcombine_s16(vrshrn_n_s32(vmlal_n_s16(Delta, vget_low_s16(db), SKINMASK_CB_B), SKINMASK_YUV_SHIFT),
+								 vrshrn_n_s32(vmlal_n_s16(Delta, vget_high_s16(db), SKINMASK_CB_B), SKINMASK_YUV_SHIFT));
+	cr = vqmovun_s16(crW);
+	cb = vqmovun_s16(cbW);
+	return vmovn_u16(y);
+}
+
+inline int SkinMaskRow_NEON(const unsigned char *pBGR, unsigned char *pMask, int iCount, const SkinMaskRange &Range)
+{
+	const uint8x16_t LoY  = vdupq_n_u8(SkinMaskRange::Clamp(Range.MinY)),  HiY  = vdupq_n_u8(SkinMaskRange::Clamp(Range.MaxY));
+	const uint8x16_t LoCr = vdupq_n_u8(SkinMaskRange::Clamp(Range.MinCr)), HiCr = vdupq_n_u8(SkinMaskRange::Clamp(Range.MaxCr));
+	const uint8x16_t LoCb = vdupq_n_u8(SkinMaskRange::Clamp(Range.MinCb)), HiCb = vdupq_n_u8(SkinMaskRange::Clamp(Range.MaxCb));
+	const uint8x16_t EmptyY  = vdupq_n_u8(SkinMaskRange::IsEmpty(Range.MinY,  Range.MaxY)  ? 0 : 0xFF);
+	const uint8x16_t EmptyCr = vdupq_n_u8(SkinMaskRange::IsEmpty(Range.MinCr, Range.MaxCr) ? 0 : 0xFF);
+	const uint8x16_t EmptyCb = vdupq_n_u8(SkinMaskRange::IsEmpty(Range.MinCb, Range.MaxCb) ? 0 : 0xFF);
+
+	int j = 0;
+	for (; j + 16 <= iCount; j += 16, pBGR += 48)
+	{
+		uint8x16x3_t bgr = vld3q_u8(pBGR);																			// De-interleaves B, G and R, no over-read
+		uint8x8_t crLo, cbLo, crHi, cbHi;
+		uint8x8_t yLo = SkinMaskHalf_NEON(vmovl_u8(vget_low_u8(bgr.val[0])),  vmovl_u8(vget_low_u8(bgr.val[1])),  vmovl_u8(vget_low_u8(bgr.val[2])),  crLo, cbLo);
+		uint8x8_t yHi = SkinMaskHalf_NEON(vmovl_u8(vget_high_u8(bgr.val[0])), vmovl_u8(vget_high_u8(bgr.val[1])), vmovl_u8(vget_high_u8(bgr.val[2])), crHi, cbHi);
+		uint8x16_t Y = vcombine_u8(yLo, yHi), Cr = vcombine_u8(crLo, crHi), Cb = vcombine_u8(cbLo, cbHi);
+
+		uint8x16_t InY  = vandq_u8(vandq_u8(vcgeq_u8(Y,  LoY),  vcleq_u8(Y,  HiY)),  EmptyY);
+		uint8x16_t InCr = vandq_u8(vandq_u8(vcgeq_u8(Cr, LoCr), vcleq_u8(Cr, HiCr)), EmptyCr);
+		uint8x16_t InCb = vandq_u8(vandq_u8(vcgeq_u8(Cb, LoCb), vcleq_u8(Cb, HiCb)), EmptyCb);
+		vst1q_u8(pMask + j, vorrq_u8(vandq_u8(InY, vorrq_u8(InCr, InCb)), vandq_u8(InCr, InCb)));
+	}
+	return j;
+}
+#endif // SKINMASK_NEON
+
+
+// ==================================================================================//
+//  Dispatch
+// ==================================================================================//
+inline int SkinMaskGetBestPath()
+{
+#if SKINMASK_X86
+	static int iPath = SkinMaskDetectPath();																		// CPUID is queried only once
+	return iPath;
+#elif SKINMASK_NEON
+	return SKINMASK_PATH_NEON;
+#else
+	return SKINMASK_PATH_SCALAR;
+#endif
+}
+
+inline bool SkinMaskIsPathSupported(int iPath)
+{
+	if (iPath == SKINMASK_PATH_SCALAR) { return true; }
+#if SKINMASK_X86
+	if (iPath == SKINMASK_PATH_SSSE3)  { return SkinMaskGetBestPath() >= SKINMASK_PATH_SSSE3; }
+	if (iPath == SKINMASK_PATH_AVX2)   { return SkinMaskGetBestPath() >= SKINMASK_PATH_AVX2; }
+#elif SKINMASK_NEON
+	if (iPath == SKINMASK_PATH_NEON)   { return true; }
+#endif
+	return false;
+}
+
+// Writes a 1 byte per pixel mask (0 or 255) from a packed 8 bit BGR image. Strides are in bytes.
+// iPath forces a given kernel (used by the SkinMaskTool self-check/benchmark), unsupported ones fall back to scalar.
+inline void BGR2SkinMaskFused(const unsigned char *pBGR, size_t BGRStride, unsigned char *pMask, size_t MaskStride,
+							  int iWidth, int iHeight, const SkinMaskRange &Range, int iPath = SKINMASK_PATH_AUTO)
+{
+	if (iPath == SKINMASK_PATH_AUTO || !SkinMaskIsPathSupported(iPath)) { iPath = (iPath == SKINMASK_PATH_AUTO ? SkinMaskGetBestPath() : SKINMASK_PATH_SCALAR); }
+
+	for (int i = 0; i < iHeight; i++, pBGR += BGRStride, pMask += MaskStride)
+	{
+		int j = 0;
+	#if SKINMASK_X86
+		if (iPath == SKINMASK_PATH_AVX2)		{ j = SkinMaskRow_AVX2(pBGR, pMask, iWidth, Range); }
+		if (iPath >= SKINMASK_PATH_SSSE3)		{ j += SkinMaskRow_SSSE3(pBGR + 3*j, pMask + j, iWidth - j, Range); }		// Remaining 16 pixel blocks of the AVX2 tail
+	#elif SKINMASK_NEON
+		if (iPath == SKINMASK_PATH_NEON)		{ j = SkinMaskRow_NEON(pBGR, pMask, iWidth, Range); }
+	#endif
+		SkinMaskRow_Scalar(pBGR + 3*j, pMask + j, iWidth - j, Range);
+	}
+}
+
+#endif // SKINMASK_H_
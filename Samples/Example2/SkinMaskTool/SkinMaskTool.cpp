@@ -2,6 +2,10 @@
 #include "opencv2/imgproc/imgproc.hpp"
 #include "opencv2/highgui/highgui.hpp"
 #include <iostream>
+#include <windows.h>
+#include "../SkinMask.h"
+#include "../Hand.h"
+#include "../WebCamCalibration.h"
 
 using namespace cv;
 using namespace std;
@@ -13,7 +17,7 @@ int iMaxCr = 190;
 int iMinCb = 70;
 int iMaxCb = 100;
 
-void Skin2GrayMask(Mat &BGRFrame, Mat &SkinMask)
+void Skin2GrayMaskReference(Mat &BGRFrame, Mat &SkinMask)								// Original cvtColor + per-pixel threshold, kept to validate the fused kernel
 {
 	Mat FrameYCrCb;
 	cvtColor(BGRFrame, FrameYCrCb, CV_BGR2YCrCb);
@@ -39,6 +43,12 @@ void Skin2GrayMask(Mat &BGRFrame, Mat &SkinMask)
 			pGrayMaskData[i*cols + j] = ((y + cr + cb) > 255 ? (unsigned char)255 : (unsigned char)0);
 		}
 	}
+}
+
+void Skin2GrayMask(Mat &BGRFrame, Mat &SkinMask)
+{
+	SkinMaskRange Range(iMinY, iMaxY, iMinCr, iMaxCr, iMinCb, iMaxCb);
+	BGR2SkinMaskFused(BGRFrame.data, BGRFrame.step, SkinMask.data, SkinMask.step, BGRFrame.cols, BGRFrame.rows, Range);
 
 	int size = 3;
 	Mat element = getStructuringElement(MORPH_RECT, Size(2 * size, 2 * size), Point(size, size));
@@ -46,8 +56,152 @@ void Skin2GrayMask(Mat &BGRFrame, Mat &SkinMask)
 	dilate(SkinMask, SkinMask, element);
 }
 
+int RunBenchmark()																						// SkinMaskTool.exe -bench : bit-exact check and timings of every kernel
+{
+	const char *PathNames[] = { "Scalar", "SSSE3", "AVX2", "NEON" };
+	const Size Sizes[] = { Size(640, 480), Size(1280, 720), Size(1920, 1080) };
+	const int iIterations = 100;
+	int iErrors = 0;
+
+	RNG rng(0x5EED);
+	for (int s = 0; s < 3; s++)
+	{
+		Mat Frame(Sizes[s], CV_8UC3);
+		rng.fill(Frame, RNG::UNIFORM, 0, 256);
+		Mat Reference(Sizes[s], CV_8UC1), Mask(Sizes[s], CV_8UC1);
+
+		double dTicks = (double)getTickCount();
+		for (int i = 0; i < iIterations; i++) { Skin2GrayMaskReference(Frame, Reference); }
+		dTicks = ((double)getTickCount() - dTicks) * 1000.0 / (getTickFrequency() * iIterations);
+		cout << Sizes[s].width << "x" << Sizes[s].height << "\tcvtColor + loop\t" << dTicks << " ms" << endl;
+
+		for (int p = SKINMASK_PATH_SCALAR; p <= SKINMASK_PATH_NEON; p++)
+		{
+			if (!SkinMaskIsPathSupported(p)) { continue; }
+
+			SkinMaskRange Range(iMinY, iMaxY, iMinCr, iMaxCr, iMinCb, iMaxCb);
+			dTicks = (double)getTickCount();
+			for (int i = 0; i < iIterations; i++) { BGR2SkinMaskFused(Frame.data, Frame.step, Mask.data, Mask.step, Frame.cols, Frame.rows, Range, p); }
+			dTicks = ((double)getTickCount() - dTicks) * 1000.0 / (getTickFrequency() * iIterations);
+
+			bool bExact = (countNonZero(Mask != Reference) == 0);
+			if (!bExact) { iErrors++; }
+			cout << Sizes[s].width << "x" << Sizes[s].height << "\t" << PathNames[p] << "\t\t" << dTicks << " ms\t" << (bExact ? "bit-exact" : "MISMATCH") << endl;
+		}
+	}
+	return (iErrors ? -1 : 0);
+}
+
+int RunHandBenchmark(const char *pClip, int iScale)													// SkinMaskTool.exe -handbench clip.avi [scale] : downscaled/tracked detection against the full resolution one
+{
+	VideoCapture Clip(pClip);
+	if (!Clip.isOpened())
+	{
+		cout << "Cannot open the clip " << pClip << endl;
+		return -1;
+	}
+
+	HandTracker Tracker(iScale);
+	Mat Frame;
+	int iFrames = 0, iAgreements = 0, iBothFound = 0, iFullFound = 0, iTrackedFrames = 0;
+	double dFullTime = 0.0, dTrackerTime = 0.0, dCenterError = 0.0;
+	cv::vector<Point> FullPalmHistory;																	// The full resolution pipeline keeps its own history, like a second webcam
+	while (Clip.read(Frame))
+	{
+		Hand FullHand(&FullPalmHistory), TrackedHand;
+		bool bWasTracking = Tracker.bIsTracking;
+
+		double dTicks = (double)getTickCount();
+		bool bFullFound = (FullHand.Detect(Frame, Rect(0, 0, Frame.cols, Frame.rows), 1) && FullHand.IdentifyProperties());	// Same work as the original pipeline
+		dFullTime += (double)getTickCount() - dTicks;
+
+		dTicks = (double)getTickCount();
+		bool bTrackedFound = (Tracker.Process(Frame, TrackedHand) != 0);
+		dTrackerTime += (double)getTickCount() - dTicks;
+
+		iFrames++;
+		if (bWasTracking) { iTrackedFrames++; }
+		if (bFullFound) { iFullFound++; }
+		if (bFullFound == bTrackedFound) { iAgreements++; }
+		if (bFullFound && bTrackedFound)
+		{
+			iBothFound++;
+			dCenterError += norm(FullHand.RoughPalmCenter - TrackedHand.RoughPalmCenter) / FullHand.fMeanSize;
+		}
+	}
+	if (!iFrames)
+	{
+		cout << "No frames in " << pClip << endl;
+		return -1;
+	}
+
+	double dMsPerTick = 1000.0 / getTickFrequency();
+	cout << pClip << ": " << iFrames << " frames " << Frame.cols << "x" << Frame.rows << ", hand found in " << iFullFound << endl;
+	cout << "Full resolution		" << dFullTime * dMsPerTick / iFrames << " ms/frame" << endl;
+	cout << "1/" << iScale << " scale + ROI	" << dTrackerTime * dMsPerTick / iFrames << " ms/frame	(" << 100.0 * iTrackedFrames / iFrames << "% of frames inside the ROI)" << endl;
+	cout << "Detection agreement	" << 100.0 * iAgreements / iFrames << "%" << endl;
+	if (iBothFound) { cout << "Palm center error	" << 100.0 * dCenterError / iBothFound << "% of the hand size" << endl; }
+	return 0;
+}
+
+int RunRectifyBenchmark(const char *pCalibrationFile, int iWidth, int iHeight)						// SkinMaskTool.exe -rectbench calib.yml [width height] : rectification mesh density against the exact per-pixel map
+{
+	Size FrameSize(iWidth, iHeight);
+	WebCamCalibration Calibration;
+	if (!Calibration.Load(pCalibrationFile, FrameSize))
+	{
+		cout << "Cannot load the calibration " << pCalibrationFile << endl;
+		return -1;
+	}
+
+	Mat MapX, MapY;
+	double dTicks = (double)getTickCount();
+	initUndistortRectifyMap(Calibration.CameraMatrix, Calibration.DistCoeffs, Calibration.Rectification, Calibration.NewCameraMatrix, FrameSize, CV_32FC1, MapX, MapY);
+	double dMapTime = ((double)getTickCount() - dTicks) * 1000.0 / getTickFrequency();
+
+	Mat Frame(FrameSize, CV_8UC3), Rectified;
+	randu(Frame, Scalar::all(0), Scalar::all(256));
+	const int iIterations = 20;
+	dTicks = (double)getTickCount();
+	for (int i = 0; i < iIterations; i++) { remap(Frame, Rectified, MapX, MapY, INTER_LINEAR); }
+	double dRemapTime = ((double)getTickCount() - dTicks) * 1000.0 / (getTickFrequency() * iIterations);
+	cout << iWidth << "x" << iHeight << ": per-pixel map " << dMapTime << " ms, CPU remap " << dRemapTime << " ms/frame (the mesh costs no CPU per frame)" << endl;
+	cout << "Grid\tVertices\tTriangles\tMean error\tMax error (source pixels)" << endl;
+
+	const int Grids[] = { 2, 4, 8, 12, 16, 18, 24, 32, 64 };
+	for (int g = 0; g < sizeof(Grids)/sizeof(Grids[0]); g++)
+	{
+		WebCamRectifyMesh Mesh;
+		Mesh.Build(&Calibration, FrameSize, Grids[g]);
+
+		double dError = 0.0, dMaxError = 0.0;
+		int iNbPixels = 0;
+		for (int y = 0; y < iHeight; y++)
+		{
+			for (int x = 0; x < iWidth; x++)
+			{
+				Point2f Exact(MapX.at<float>(y, x), MapY.at<float>(y, x));
+				if (Exact.x < 0 || Exact.y < 0 || Exact.x > iWidth - 1 || Exact.y > iHeight - 1) { continue; }	// Faded out anyway
+				Point2f UV = Mesh.Interpolate(Point2f(2.0f * (x + 0.5f) / iWidth - 1.0f, 2.0f * (y + 0.5f) / iHeight - 1.0f));
+				Point2f Interpolated(UV.x * iWidth - 0.5f, UV.y * iHeight - 0.5f);
+				double dPixelError = norm(Interpolated - Exact);
+				dError += dPixelError;
+				dMaxError = max(dMaxError, dPixelError);
+				iNbPixels++;
+			}
+		}
+		cout << Grids[g] << "x" << Grids[g] << "\t" << Mesh.Positions.size() << "\t\t" << 2 * Mesh.GetNbCells() << "\t\t" 
+			 << (iNbPixels ? dError / iNbPixels : 0.0) << "\t\t" << dMaxError << (Grids[g] == WEBCAM_RECTIFY_GRID ? "\t<- WEBCAM_RECTIFY_GRID" : "") << endl;
+	}
+	return 0;
+}
+
 int main(int argc, char* argv[])
 {
+	if (argc > 1 && !strcmp(argv[1], "-bench")) { return RunBenchmark(); }
+	if (argc > 2 && !strcmp(argv[1], "-rectbench")) { return RunRectifyBenchmark(argv[2], (argc > 4 ? atoi(argv[3]) : 640), (argc > 4 ? atoi(argv[4]) : 480)); }
+	if (argc > 2 && !strcmp(argv[1], "-handbench")) { return RunHandBenchmark(argv[2], (argc > 3 ? atoi(argv[3]) : HAND_DETECTION_SCALE)); }
+
 	VideoCapture cap(0);																				// Open the video camera number 0
 	if (!cap.isOpened())
 	{
@@ -0,0 +1,200 @@
+/************************************************************************************
+Filename    :   UploadRingTest.cpp
+Content     :   Headless test of the OpenGL UploadRing: slot wrap-around and fences
+Created     :   October 17th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// Drives Win32_UploadRing.h and FrameMailbox.h the way WebCamDevice does, on an offscreen Mesa context (EGL surfaceless,
+// GL_ARB_buffer_storage), and reads every uploaded texture back, for each frame layout the webcams upload (BGR, RGBA,
+// YUYV as RGBA texels at half width, NV12 as luminance texels with the UV rows under the Y rows):
+//  - Wrap:   one frame at a time, every slot of the ring is reused many times and each upload must give back its frame.
+//  - Fences: a producer thread writes frames into the mapped slots as fast as it can while this thread uploads them.
+//            A torn texture (rows of two frames) means a slot was handed back before the GPU finished copying from it.
+// Returns 0 when both pass. Build on Linux with OpenCV and Mesa:
+//   g++ -std=c++11 -DRENDER_OPENGL=1 -I../../../LibOVR/Src -I../../../LibOVR/Include UploadRingTest.cpp -o UploadRingTest -lEGL -lGL -lopencv_core -lpthread
+
+#define GL_GLEXT_PROTOTYPES
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/gl.h>
+#include <GL/glext.h>
+#include "opencv2/core/core.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#define wglGetProcAddress(Name)	eglGetProcAddress(Name)													// The ring fetches its GL 4.4 entry points by name
+struct ImageBuffer { GLuint TexId; };																	// The part of Win32_OGLAppUtil.h's ImageBuffer used by the ring
+
+#include "../FrameMailbox.h"
+#include "../Win32_UploadRing.h"
+
+const int iWidth = 320, iHeight = 240;
+
+bool CreateHeadlessContext()
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC pGetPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (!pGetPlatformDisplay) { return false; }
+	EGLDisplay Display = pGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+	EGLint iMajor, iMinor;
+	if (!eglInitialize(Display, &iMajor, &iMinor) || !eglBindAPI(EGL_OPENGL_API)) { return false; }
+	EGLContext Context = eglCreateContext(Display, (EGLConfig)0, EGL_NO_CONTEXT, NULL);						// EGL_KHR_no_config_context
+	return (Context != EGL_NO_CONTEXT && eglMakeCurrent(Display, EGL_NO_SURFACE, EGL_NO_SURFACE, Context));
+}
+
+unsigned char FrameByte(unsigned int uiFrame, int y, int x)											// Different for every frame, row and column
+{
+	return (unsigned char)(uiFrame*131 + y*7 + x);
+}
+
+void WriteFrame(cv::Mat &Slot, unsigned int uiFrame, std::vector<unsigned char> &Row)					// Like the capture thread: the frame is built on the heap and only copied into the mapped slot
+{
+	int iRowSize = Slot.cols*(int)Slot.elemSize();
+	for (int y = 0; y < Slot.rows; y++)
+	{
+		for (int x = 0; x < iRowSize; x++) { Row[x] = FrameByte(uiFrame, y, x); }
+		memcpy(Slot.ptr(y), &Row[0], iRowSize);
+	}
+}
+
+bool ReadFrameId(const ImageBuffer &Image, int iType, int iRows, unsigned int uiFirstFrame, unsigned int uiLastFrame, unsigned int &uiFrame)	// Which frame the texture holds, false if torn or unknown
+{
+	int iRowSize = iWidth*CV_ELEM_SIZE(iType);
+	std::vector<unsigned char> Pixels(iRowSize*iRows);
+	glBindTexture(GL_TEXTURE_2D, Image.TexId);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glGetTexImage(GL_TEXTURE_2D, 0, UploadRing::GetTexelFormat(iType), GL_UNSIGNED_BYTE, &Pixels[0]);
+	for (uiFrame = uiFirstFrame; uiFrame <= uiLastFrame; uiFrame++)
+	{
+		if (Pixels[0] == FrameByte(uiFrame, 0, 0) && Pixels[1] == FrameByte(uiFrame, 0, 1)) { break; }
+	}
+	if (uiFrame > uiLastFrame) { return false; }
+	for (int y = 0; y < iRows; y++)
+	{
+		for (int x = 0; x < iRowSize; x++) { if (Pixels[y*iRowSize + x] != FrameByte(uiFrame, y, x)) { return false; } }
+	}
+	return true;
+}
+
+void CreateTexture(ImageBuffer &Image, int iType, int iRows)
+{
+	glGenTextures(1, &Image.TexId);
+	glBindTexture(GL_TEXTURE_2D, Image.TexId);
+	glTexImage2D(GL_TEXTURE_2D, 0, UploadRing::GetTexelInternalFormat(iType), UploadRing::GetTexelWidth(iWidth, iType), iRows, 0,
+				 UploadRing::GetTexelFormat(iType), GL_UNSIGNED_BYTE, NULL);
+}
+
+int TestWrap(int iType, int iRows, const char *pName)
+{
+	FrameMailbox<cv::Mat> Frames;
+	UploadRing Ring;
+	if (!Ring.Initialize(iWidth, iRows, iType, Frames.Slots)) { printf("%s wrap:\tGL_ARB_buffer_storage not supported\n", pName); return 1; }
+	ImageBuffer Image;
+	CreateTexture(Image, iType, iRows);
+
+	std::vector<unsigned char> Row(iWidth*CV_ELEM_SIZE(iType));
+	const unsigned int uiNbFrames = 10*UPLOADRING_SLOTS;
+	int iErrors = 0, iSlotUses[UPLOADRING_SLOTS] = { 0 };
+	for (unsigned int uiFrame = 1; uiFrame <= uiNbFrames; uiFrame++)
+	{
+		WriteFrame(Frames.GetBackSlot(), uiFrame, Row);
+		Frames.Publish();
+
+		glFinish();																						// The previous copy is done: its slot must come back
+		if (!Ring.Reclaim(Frames.GetFrontIndex(), Frames.GetFrontSlot())) { iErrors++; continue; }
+		if (!Frames.Acquire()) { iErrors++; continue; }
+		Ring.Upload(Frames.GetFrontIndex(), &Image);
+		iSlotUses[Frames.GetFrontIndex()]++;
+
+		unsigned int uiShown;
+		if (!ReadFrameId(Image, iType, iRows, uiFrame, uiFrame, uiShown)) { iErrors++; }
+	}
+	for (int i = 0; i < UPLOADRING_SLOTS; i++) { if (iSlotUses[i] < 2) { iErrors++; } }					// Every slot went around more than once
+	printf("%s wrap:\t%u frames, slot uses %d/%d/%d, %d errors\n", pName, uiNbFrames, iSlotUses[0], iSlotUses[1], iSlotUses[2], iErrors);
+	Ring.Release();
+	glDeleteTextures(1, &Image.TexId);
+	return (iErrors ? 1 : 0);
+}
+
+int TestFences(int iType, int iRows, const char *pName)
+{
+	FrameMailbox<cv::Mat> Frames;
+	UploadRing Ring;
+	if (!Ring.Initialize(iWidth, iRows, iType, Frames.Slots)) { printf("%s fences:\tGL_ARB_buffer_storage not supported\n", pName); return 1; }
+	ImageBuffer Image;
+	CreateTexture(Image, iType, iRows);
+
+	std::atomic<bool> bRunning(true);
+	std::atomic<unsigned int> uiPublished(0);
+	std::thread Producer([&]()
+	{
+		std::vector<unsigned char> Row(iWidth*CV_ELEM_SIZE(iType));
+		for (unsigned int uiFrame = 1; bRunning; uiFrame++)
+		{
+			WriteFrame(Frames.GetBackSlot(), uiFrame, Row);
+			uiPublished = uiFrame;																		// Before Publish, so an acquired frame is never newer
+			Frames.Publish();
+		}
+	});
+
+	const int iNbUploads = 500;
+	int iUploads = 0, iTorn = 0, iBackwards = 0, iNotReclaimed = 0;
+	unsigned int uiLastShown = 0;
+	while (iUploads < iNbUploads)
+	{
+		if (!Ring.Reclaim(Frames.GetFrontIndex(), Frames.GetFrontSlot())) { iNotReclaimed++; continue; }	// Same order as WebCamDevice::UpdateFrame
+		if (!Frames.Acquire()) { continue; }
+		Ring.Upload(Frames.GetFrontIndex(), &Image);
+		iUploads++;
+
+		unsigned int uiShown;
+		if (!ReadFrameId(Image, iType, iRows, uiLastShown, uiPublished, uiShown)) { iTorn++; continue; }
+		if (uiShown < uiLastShown) { iBackwards++; }
+		uiLastShown = uiShown;
+	}
+	bRunning = false;
+	Producer.join();
+
+	printf("%s fences:\t%d uploads of %u frames, %d dropped, %d polls on a busy slot, %d torn, %d out of order\n", pName, iUploads, (unsigned int)uiPublished,
+		   Frames.GetDroppedCount(), iNotReclaimed, iTorn, iBackwards);
+	Ring.Release();
+	glDeleteTextures(1, &Image.TexId);
+	return ((iTorn || iBackwards) ? 1 : 0);
+}
+
+int main()
+{
+	if (!CreateHeadlessContext())
+	{
+		printf("Cannot create an offscreen OpenGL context\n");
+		return 1;
+	}
+	printf("%s, OpenGL %s\n", (const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION));
+
+	int iFailures = 0;
+	iFailures += TestWrap(CV_8UC3, iHeight, "BGR");
+	iFailures += TestWrap(CV_8UC4, iHeight, "RGBA");
+	iFailures += TestWrap(CV_8UC2, iHeight, "YUYV");
+	iFailures += TestWrap(CV_8UC1, iHeight*3/2, "NV12");
+	iFailures += TestFences(CV_8UC3, iHeight, "BGR");
+	iFailures += TestFences(CV_8UC4, iHeight, "RGBA");
+	iFailures += TestFences(CV_8UC2, iHeight, "YUYV");
+	iFailures += TestFences(CV_8UC1, iHeight*3/2, "NV12");
+	printf("%s\n", (iFailures ? "FAILED" : "PASSED"));
+	return (iFailures ? 1 : 0);
+}
@@ -0,0 +1,193 @@
+/************************************************************************************
+Filename    :   WebCamCalibration.h
+Content     :   Lens undistortion and stereo rectification of the webcams as a warped mesh
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// Same idea as DistortionMeshCreate for the Rift lenses: the warp is evaluated once per vertex of a grid, and the GPU
+// interpolates it across the triangles, so undistorting/rectifying a frame costs one draw and no CPU work per frame.
+// The grid covers the [-1,1] space of the webcam quad (the output, rectified image) and each vertex gets the texture
+// coordinates of the source pixel seen through it.
+//
+// Calibration files are cv::FileStorage YAML/XML files, one per camera, with the names used by the OpenCV calibration
+// tools: camera_matrix and distortion_coefficients (intrinsics), and optionally rectification_matrix and
+// projection_matrix (R1/P1 or R2/P2 given by cv::stereoRectify from the stereo extrinsics). Without them the frame is
+// only undistorted. image_width and image_height, when present, let a calibration made at another resolution be used.
+
+#ifndef WEBCAMCALIBRATION_H_
+#define WEBCAMCALIBRATION_H_
+
+#include "opencv2/calib3d/calib3d.hpp"
+#include "opencv2/imgproc/imgproc.hpp"
+
+#define WEBCAM_RECTIFY_GRID				16			// Cells per side of the rectification mesh
+
+
+// ==================================================================================//
+//  WebCamCalibration Class
+// ==================================================================================//
+class WebCamCalibration
+{
+public:
+
+	cv::Mat						CameraMatrix;																			// 3x3 intrinsics of the camera, CV_64F
+	cv::Mat						DistCoeffs;																				// k1, k2, p1, p2[, k3...]
+	cv::Mat						Rectification;																			// 3x3 rotation from the camera to the rectified camera
+	cv::Mat						NewCameraMatrix;																		// 3x3 intrinsics of the rectified camera
+
+public:
+
+	bool Load(const char *pFileName, cv::Size FrameSize)
+	{
+		cv::FileStorage File(pFileName, cv::FileStorage::READ);
+		if(!File.isOpened()) { return false; }
+
+		int iCalibWidth = 0, iCalibHeight = 0;
+		File["camera_matrix"]			>> CameraMatrix;
+		File["distortion_coefficients"]	>> DistCoeffs;
+		File["rectification_matrix"]	>> Rectification;
+		File["projection_matrix"]		>> NewCameraMatrix;
+		File["image_width"]				>> iCalibWidth;
+		File["image_height"]			>> iCalibHeight;
+		if(CameraMatrix.rows != 3 || CameraMatrix.cols != 3) { return false; }
+
+		CameraMatrix.convertTo(CameraMatrix, CV_64F);
+		if(DistCoeffs.empty()) { DistCoeffs = cv::Mat::zeros(1, 5, CV_64F); }
+		else { DistCoeffs.convertTo(DistCoeffs, CV_64F); }
+		if(Rectification.empty()) { Rectification = cv::Mat::eye(3, 3, CV_64F); }
+		else { Rectification.convertTo(Rectification, CV_64F); }
+		if(NewCameraMatrix.rows != 3 || NewCameraMatrix.cols < 3) { NewCameraMatrix = CameraMatrix.clone(); }
+		else { NewCameraMatrix(cv::Rect(0, 0, 3, 3)).convertTo(NewCameraMatrix, CV_64F); }						// The 4th column of P2 is the baseline, not needed here
+
+		if(iCalibWidth > 0 && iCalibHeight > 0 && (iCalibWidth != FrameSize.width || iCalibHeight != FrameSize.height))	// Intrinsics scale with the image
+		{
+			double dScaleX = (double)FrameSize.width/iCalibWidth, dScaleY = (double)FrameSize.height/iCalibHeight;
+			CameraMatrix.row(0) *= dScaleX;		CameraMatrix.row(1) *= dScaleY;
+			NewCameraMatrix.row(0) *= dScaleX;	NewCameraMatrix.row(1) *= dScaleY;
+		}
+		return true;
+	}
+
+	// Source pixels seen through the rectified pixels, same model as cv::initUndistortRectifyMap
+	void GetSourcePoints(const cv::vector<cv::Point2f> &Rectified, cv::vector<cv::Point2f> &Source) const
+	{
+		cv::Mat InvNewKR = (NewCameraMatrix*Rectification).inv();
+		cv::vector<cv::Point3f> Rays(Rectified.size());
+		for(size_t i=0; i<Rectified.size(); i++)
+		{
+			cv::Mat Ray = InvNewKR*(cv::Mat_<double>(3, 1) << Rectified[i].x, Rectified[i].y, 1.0);
+			double dZ = Ray.at<double>(2);
+			Rays[i] = cv::Point3f((float)(Ray.at<double>(0)/dZ), (float)(Ray.at<double>(1)/dZ), 1.0f);
+		}
+		cv::Mat NoRotation = cv::Mat::zeros(3, 1, CV_64F), NoTranslation = cv::Mat::zeros(3, 1, CV_64F);
+		cv::projectPoints(Rays, NoRotation, NoTranslation, CameraMatrix, DistCoeffs, Source);
+	}
+
+	// The other way round, for the hand overlay: where source pixels end up in the rectified frame
+	void GetRectifiedPoints(const cv::vector<cv::Point2f> &Source, cv::vector<cv::Point2f> &Rectified) const
+	{
+		if(Source.empty()) { Rectified.clear(); return; }
+		cv::undistortPoints(Source, Rectified, CameraMatrix, DistCoeffs, Rectification, NewCameraMatrix);
+	}
+};
+
+
+// ==================================================================================//
+//  WebCamRectifyMesh Struct
+// ==================================================================================//
+// (iNbColumns x iNbRows) vertices, row by row. Positions are in the [-1,1] space of the webcam quad, TexCoords in
+// the source frame: outside [0,1] when the vertex sees no pixel of the sensor.
+struct WebCamRectifyMesh
+{
+	int							iNbColumns, iNbRows;
+	cv::vector<cv::Point2f>		Positions;
+	cv::vector<cv::Point2f>		TexCoords;
+	cv::vector<float>			Alphas;																					// Fading edges, 0 to 1
+
+	WebCamRectifyMesh() : iNbColumns(0), iNbRows(0) {}
+
+	// pCalibration NULL gives the plain quad. A band > 0 adds the grid lines of the fading edge, at the same place as FadingEdgeQuadVertices.
+	void Build(const WebCamCalibration *pCalibration, cv::Size FrameSize, int iNbCells, float fBandWidth=0.0f, float fBandHeight=0.0f)
+	{
+		cv::vector<float> Xs, Ys;
+		GetGridLines(iNbCells, fBandWidth, Xs);
+		GetGridLines(iNbCells, fBandHeight, Ys);
+		iNbColumns	= (int)Xs.size();
+		iNbRows		= (int)Ys.size();
+
+		Positions.resize(iNbColumns*iNbRows);
+		Alphas.resize(iNbColumns*iNbRows);
+		cv::vector<cv::Point2f> Rectified(Positions.size());
+		for(int r=0; r<iNbRows; r++)
+		{
+			for(int c=0; c<iNbColumns; c++)
+			{
+				int i = r*iNbColumns + c;
+				Positions[i] = cv::Point2f(Xs[c], Ys[r]);
+				Rectified[i] = cv::Point2f(0.5f*(Xs[c] + 1.0f)*FrameSize.width - 0.5f, 0.5f*(Ys[r] + 1.0f)*FrameSize.height - 0.5f);	// Pixel centers
+				float fAlphaX = (fBandWidth > 0.0f ? std::min(1.0f - fabs(Xs[c]), fBandWidth)/fBandWidth : 1.0f);
+				float fAlphaY = (fBandHeight > 0.0f ? std::min(1.0f - fabs(Ys[r]), fBandHeight)/fBandHeight : 1.0f);
+				Alphas[i] = std::min(fAlphaX, fAlphaY);
+			}
+		}
+
+		if(pCalibration) { pCalibration->GetSourcePoints(Rectified, TexCoords); }
+		else { TexCoords = Rectified; }
+		for(size_t i=0; i<TexCoords.size(); i++)
+		{
+			TexCoords[i] = cv::Point2f((TexCoords[i].x + 0.5f)/FrameSize.width, (TexCoords[i].y + 0.5f)/FrameSize.height);
+			if(TexCoords[i].x < 0.0f || TexCoords[i].x > 1.0f || TexCoords[i].y < 0.0f || TexCoords[i].y > 1.0f) { Alphas[i] = 0.0f; }	// Fades out instead of smearing the border pixels
+		}
+	}
+
+	// Two triangles per cell, split along the same diagonal and with the same winding as SimpleQuadIndices
+	int GetIndex(int iCell, int iCorner) const
+	{
+		static const int CornerColumns[6] = { 0, 1, 1, 1, 0, 0 }, CornerRows[6] = { 0, 0, 1, 1, 1, 0 };
+		int iCellColumn = iCell % (iNbColumns - 1), iCellRow = iCell / (iNbColumns - 1);
+		return (iCellRow + CornerRows[iCorner])*iNbColumns + iCellColumn + CornerColumns[iCorner];
+	}
+	int GetNbCells() const { return (iNbColumns - 1)*(iNbRows - 1); }
+
+	// Texture coordinates the GPU interpolates at Position, inside the cell's triangles
+	cv::Point2f Interpolate(cv::Point2f Position) const
+	{
+		int c = 0, r = 0;
+		while(c < iNbColumns - 2 && Position.x > Positions[c + 1].x) { c++; }
+		while(r < iNbRows - 2 && Position.y > Positions[(r + 1)*iNbColumns].y) { r++; }
+		const cv::Point2f &A = TexCoords[r*iNbColumns + c], &B = TexCoords[r*iNbColumns + c + 1];
+		const cv::Point2f &C = TexCoords[(r + 1)*iNbColumns + c + 1], &D = TexCoords[(r + 1)*iNbColumns + c];
+		float s = (Position.x - Positions[c].x)/(Positions[c + 1].x - Positions[c].x);
+		float t = (Position.y - Positions[r*iNbColumns].y)/(Positions[(r + 1)*iNbColumns].y - Positions[r*iNbColumns].y);
+		if(s >= t) { return A + s*(B - A) + t*(C - B); }																// Triangle A B C
+		return A + t*(D - A) + s*(C - D);																				// Triangle C D A
+	}
+
+	static void GetGridLines(int iNbCells, float fBand, cv::vector<float> &Lines)
+	{
+		Lines.clear();
+		if(fBand > 0.0f && iNbCells >= 3)																				// Band lines first, the inner cells share the rest
+		{
+			Lines.push_back(-1.0f);
+			for(int i=0; i<=iNbCells-2; i++) { Lines.push_back(-1.0f + fBand + (2.0f - 2.0f*fBand)*i/(iNbCells - 2)); }
+			Lines.push_back(1.0f);
+			return;
+		}
+		for(int i=0; i<=iNbCells; i++) { Lines.push_back(-1.0f + 2.0f*i/iNbCells); }
+	}
+};
+
+#endif // WEBCAMCALIBRATION_H_
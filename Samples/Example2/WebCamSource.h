@@ -0,0 +1,472 @@
+/************************************************************************************
+Filename    :   WebCamSource.h
+Content     :   Pluggable webcam capture backends delivering the camera's native pixel format
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// A WebCamSource negotiates a capture mode (size, frame rate, pixel format) and then fills frames in that format, in
+// place and without any colour conversion: the renderer unpacks BGR, YUYV or NV12 in the pixel shader.
+//  - MediaFoundationWebCamSource: Win32 capture in the camera's native YUYV or NV12. When only MJPEG reaches the
+//                         requested mode (most webcams above 640x480 at 30 fps), Media Foundation's MJPEG decoder is
+//                         inserted and decodes straight to YUV planes, on the GPU when the driver provides one.
+//  - OpenCVWebCamSource:  cv::VideoCapture, which always converts to BGR. Fallback when Media Foundation cannot open
+//                         the camera in the requested size.
+//  - RawFileWebCamSource: replays frames recorded by RawFileWebCamWriter at their original frame rate and in their
+//                         original format, so the whole pipeline can be run and profiled without cameras.
+
+#ifndef WEBCAMSOURCE_H_
+#define WEBCAMSOURCE_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "opencv2/highgui/highgui.hpp"
+#include "Kernel/OVR_Alg.h"
+#include "Kernel/OVR_Timer.h"
+#include "Kernel/OVR_Threads.h"
+#include "Kernel/OVR_RefCount.h"
+#if defined(OVR_OS_WIN32)
+#include <mfapi.h>
+#include <mfidl.h>
+#include <mfreadwrite.h>
+#pragma comment(lib, "mfplat.lib")
+#pragma comment(lib, "mf.lib")
+#pragma comment(lib, "mfreadwrite.lib")
+#pragma comment(lib, "mfuuid.lib")
+#endif
+
+#define WEBCAM_FORMAT_BGR				0			// 3 bytes per pixel, B G R. The only format delivered by cv::VideoCapture
+#define WEBCAM_FORMAT_YUYV				1			// 4:2:2, 4 bytes per 2 pixels, Y0 U Y1 V (BT.601, limited range)
+#define WEBCAM_FORMAT_NV12				2			// 4:2:0, the Y plane then the interleaved U V plane at half height (BT.601, limited range)
+#define WEBCAM_FORMAT_COUNT				3
+
+#define WEBCAM_RAWFILE_MAGIC			0x46524357	// "WCRF"
+
+
+// ==================================================================================//
+//  WebCamMode Struct
+// ==================================================================================//
+struct WebCamMode
+{
+	int							iWidth, iHeight;																		// 0 = camera default
+	float						fFPS;																					// 0 = camera default
+	int							iFormat;																				// WEBCAM_FORMAT_*
+
+	WebCamMode(int iW=0, int iH=0, float fRate=0.0f, int iFmt=WEBCAM_FORMAT_BGR) : iWidth(iW), iHeight(iH), fFPS(fRate), iFormat(iFmt) {}
+
+	// A frame is a single cv::Mat: NV12 keeps its UV plane right under the Y plane, the layout cv::cvtColor expects
+	int GetCvType() const			{ return (iFormat == WEBCAM_FORMAT_YUYV ? CV_8UC2 : (iFormat == WEBCAM_FORMAT_NV12 ? CV_8UC1 : CV_8UC3)); }
+	int GetFrameRows() const		{ return (iFormat == WEBCAM_FORMAT_NV12 ? iHeight*3/2 : iHeight); }
+	const char *GetFormatName() const
+	{
+		static const char *Names[WEBCAM_FORMAT_COUNT] = { "BGR", "YUYV", "NV12" };
+		return (iFormat >= 0 && iFormat < WEBCAM_FORMAT_COUNT ? Names[iFormat] : "unknown");
+	}
+	bool IsValid() const																								// The YUV formats share their chroma between 2 columns, and 2 rows for NV12
+	{
+		return (iWidth > 0 && iHeight > 0 && iFormat >= 0 && iFormat < WEBCAM_FORMAT_COUNT &&
+				(iFormat == WEBCAM_FORMAT_BGR || (iWidth % 2 == 0 && (iFormat != WEBCAM_FORMAT_NV12 || iHeight % 2 == 0))));
+	}
+};
+
+
+// ==================================================================================//
+//  WebCamSource Class
+// ==================================================================================//
+class WebCamSource
+{
+public:
+
+	virtual ~WebCamSource() {}
+
+	// Mode holds the requested mode on input and the negotiated one on output
+	virtual bool Open(int iDeviceNum, WebCamMode &Mode) = 0;
+	virtual void Close() = 0;
+
+	// Fills Frame (already allocated with the negotiated size and type, possibly with padded rows) in place. Called by the capture thread only.
+	// dCaptureTime is when the frame was captured, on the ovr_GetTimeInSeconds() clock: from the driver when it provides it, otherwise when it was received.
+	virtual bool Read(cv::Mat &Frame, double &dCaptureTime) = 0;
+};
+
+
+#if defined(OVR_OS_WIN32)
+// ==================================================================================//
+//  MediaFoundationWebCamSource Class
+// ==================================================================================//
+class MediaFoundationWebCamSource : public WebCamSource
+{
+private:
+
+	OVR::Ptr<IMFMediaSource>	MediaSource;
+	OVR::Ptr<IMFSourceReader>	Reader;
+	WebCamMode					ReaderMode;																				// What ReadSample() delivers
+	int							iBufferHeight;																			// Rows of the Y plane in the sample buffers: decoders may pad the frame to a multiple of 16
+	LONG						lDefaultStride;																			// Row pitch of the buffers that cannot be locked as 2D
+	bool						bPreferMJPEG;
+	bool						bIsCOMInitialized, bIsMFStarted;
+	bool						bHasClockOffset;
+	double						dClockOffset;																			// Timer::GetSeconds() minus the sample time: the smallest seen so far, i.e. the shortest delivery delay
+
+public:
+
+	// Constructor
+	MediaFoundationWebCamSource(bool bMJPEG=false) : iBufferHeight(0), lDefaultStride(0), bPreferMJPEG(bMJPEG), bIsCOMInitialized(false), bIsMFStarted(false),
+													 bHasClockOffset(false), dClockOffset(0.0) {}
+
+	// Destructor
+	virtual ~MediaFoundationWebCamSource() { Close(); }
+
+	virtual bool Open(int iDeviceNum, WebCamMode &Mode)
+	{
+		bIsCOMInitialized	= SUCCEEDED(CoInitializeEx(NULL, COINIT_MULTITHREADED));									// RPC_E_CHANGED_MODE if the thread is already an STA, which Media Foundation accepts too
+		bIsMFStarted		= SUCCEEDED(MFStartup(MF_VERSION, MFSTARTUP_LITE));
+		if(!bIsMFStarted || !CreateReader(iDeviceNum) || !SelectMediaType(Mode) || !GetReaderMode())
+		{
+			Close();
+			return false;
+		}
+		bHasClockOffset	= false;
+		Mode			= ReaderMode;
+		return true;
+	}
+
+	virtual void Close()																								// Same thread as Open()
+	{
+		Reader.Clear();
+		if(MediaSource) { MediaSource->Shutdown(); MediaSource.Clear(); }
+		if(bIsMFStarted) { MFShutdown(); bIsMFStarted = false; }
+		if(bIsCOMInitialized) { CoUninitialize(); bIsCOMInitialized = false; }
+	}
+
+	virtual bool Read(cv::Mat &Frame, double &dCaptureTime)
+	{
+		if(!Reader) { return false; }
+		OVR::Ptr<IMFSample> Sample;
+		LONGLONG llSampleTime = 0;
+		while(!Sample)																									// No sample on stream ticks, the gaps of a live source
+		{
+			DWORD dwFlags = 0;
+			if(FAILED(Reader->ReadSample((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, 0, NULL, &dwFlags, &llSampleTime, &Sample.GetRawRef())) ||
+			   (dwFlags & (MF_SOURCE_READERF_ERROR | MF_SOURCE_READERF_ENDOFSTREAM))) { return false; }
+			if((dwFlags & MF_SOURCE_READERF_CURRENTMEDIATYPECHANGED) && !GetReaderMode()) { return false; }				// The frame size may change: Frame is reallocated below
+		}
+		double dArrivalTime	= OVR::Timer::GetSeconds();
+		double dSampleTime	= llSampleTime*1e-7;																		// 100 ns units, on the system clock but from an arbitrary origin
+		if(!bHasClockOffset || dArrivalTime - dSampleTime < dClockOffset)
+		{
+			dClockOffset	= dArrivalTime - dSampleTime;
+			bHasClockOffset	= true;
+		}
+		dCaptureTime = dSampleTime + dClockOffset;																		// Free of the delivery jitter, unlike the arrival time
+
+		OVR::Ptr<IMFMediaBuffer> Buffer;
+		if(FAILED(Sample->ConvertToContiguousBuffer(&Buffer.GetRawRef()))) { return false; }							// No copy when the sample holds a single buffer, the usual case
+		return CopyFrame(Buffer, Frame);
+	}
+
+private:
+
+	bool CreateReader(int iDeviceNum)																					// Video capture devices are numbered like the DirectShow ones cv::VideoCapture opens
+	{
+		OVR::Ptr<IMFAttributes> Attributes;
+		IMFActivate **ppDevices = NULL;
+		UINT32 uiNbDevices = 0;
+		if(FAILED(MFCreateAttributes(&Attributes.GetRawRef(), 1)) ||
+		   FAILED(Attributes->SetGUID(MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE, MF_DEVSOURCE_ATTRIBUTE_SOURCE_TYPE_VIDCAP_GUID)) ||
+		   FAILED(MFEnumDeviceSources(Attributes, &ppDevices, &uiNbDevices))) { return false; }
+		if(iDeviceNum >= 0 && (UINT32)iDeviceNum < uiNbDevices) { ppDevices[iDeviceNum]->ActivateObject(IID_PPV_ARGS(&MediaSource.GetRawRef())); }
+		for(UINT32 i=0; i<uiNbDevices; i++) { ppDevices[i]->Release(); }
+		CoTaskMemFree(ppDevices);
+		if(!MediaSource) { return false; }
+
+		OVR::Ptr<IMFAttributes> ReaderAttributes;
+		return (SUCCEEDED(MFCreateAttributes(&ReaderAttributes.GetRawRef(), 1)) &&
+				SUCCEEDED(ReaderAttributes->SetUINT32(MF_READWRITE_ENABLE_HARDWARE_TRANSFORMS, TRUE)) &&				// Lets the reader pick a hardware MJPEG decoder
+				SUCCEEDED(MFCreateSourceReaderFromMediaSource(MediaSource, ReaderAttributes, &Reader.GetRawRef())));
+	}
+
+	bool SelectMediaType(const WebCamMode &Requested)																	// The native type closest to the request, then the decoded type for MJPEG
+	{
+		OVR::Ptr<IMFMediaType> Current;
+		UINT32 uiWidth = 0, uiHeight = 0, uiNum = 0, uiDen = 0;
+		if(FAILED(Reader->GetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, &Current.GetRawRef()))) { return false; }
+		MFGetAttributeSize(Current, MF_MT_FRAME_SIZE, &uiWidth, &uiHeight);
+		MFGetAttributeRatio(Current, MF_MT_FRAME_RATE, &uiNum, &uiDen);
+		WebCamMode Target((Requested.iWidth > 0 ? Requested.iWidth : (int)uiWidth), (Requested.iHeight > 0 ? Requested.iHeight : (int)uiHeight),
+						  (Requested.fFPS > 0.0f ? Requested.fFPS : (uiDen ? (float)uiNum/uiDen : 0.0f)));				// 0 = what the camera is currently set to
+
+		OVR::Ptr<IMFMediaType> Best;
+		int iBestScore = -1;
+		float fBestRateGap = 0.0f;
+		for(DWORD i=0; ; i++)
+		{
+			OVR::Ptr<IMFMediaType> Type;
+			GUID Subtype;
+			if(FAILED(Reader->GetNativeMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, i, &Type.GetRawRef()))) { break; }	// MF_E_NO_MORE_TYPES
+			if(FAILED(Type->GetGUID(MF_MT_SUBTYPE, &Subtype)) || FAILED(MFGetAttributeSize(Type, MF_MT_FRAME_SIZE, &uiWidth, &uiHeight)) ||
+			   FAILED(MFGetAttributeRatio(Type, MF_MT_FRAME_RATE, &uiNum, &uiDen)) || !uiDen) { continue; }
+			bool bIsMJPEG = (Subtype == MFVideoFormat_MJPG);
+			if((int)uiWidth != Target.iWidth || (int)uiHeight != Target.iHeight || (!bIsMJPEG && GetFormat(Subtype) < 0)) { continue; }
+
+			float fRate = (float)uiNum/uiDen;
+			int iScore = (fRate >= Target.fFPS - 0.5f ? 4 : 0) + (bIsMJPEG == bPreferMJPEG ? 2 : 0) + (Subtype == MFVideoFormat_NV12 ? 1 : 0);	// The frame rate first, then the requested transport, then the smaller NV12
+			float fRateGap = fabs(fRate - Target.fFPS);
+			if(iScore > iBestScore || (iScore == iBestScore && fRateGap < fBestRateGap))
+			{
+				Best			= Type;
+				iBestScore		= iScore;
+				fBestRateGap	= fRateGap;
+			}
+		}
+		GUID BestSubtype;
+		if(!Best || FAILED(Best->GetGUID(MF_MT_SUBTYPE, &BestSubtype)) ||
+		   FAILED(Reader->SetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, NULL, Best))) { return false; }
+		if(BestSubtype != MFVideoFormat_MJPG) { return true; }
+
+		// Asking for YUV output makes the reader insert the MJPEG decoder, which writes the JPEG's own YUV samples without any RGB step
+		const GUID *pOutputSubtypes[] = { &MFVideoFormat_NV12, &MFVideoFormat_YUY2 };
+		for(int i=0; i<2; i++)
+		{
+			OVR::Ptr<IMFMediaType> Output;
+			if(FAILED(MFCreateMediaType(&Output.GetRawRef()))) { return false; }
+			Output->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video);
+			Output->SetGUID(MF_MT_SUBTYPE, *pOutputSubtypes[i]);
+			if(SUCCEEDED(Reader->SetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, NULL, Output))) { return true; }
+		}
+		return false;
+	}
+
+	bool GetReaderMode()																								// From the current output type of the reader
+	{
+		OVR::Ptr<IMFMediaType> Type;
+		GUID Subtype;
+		UINT32 uiWidth = 0, uiHeight = 0, uiNum = 0, uiDen = 0;
+		if(FAILED(Reader->GetCurrentMediaType((DWORD)MF_SOURCE_READER_FIRST_VIDEO_STREAM, &Type.GetRawRef())) || FAILED(Type->GetGUID(MF_MT_SUBTYPE, &Subtype)) ||
+		   FAILED(MFGetAttributeSize(Type, MF_MT_FRAME_SIZE, &uiWidth, &uiHeight))) { return false; }
+		MFGetAttributeRatio(Type, MF_MT_FRAME_RATE, &uiNum, &uiDen);
+		ReaderMode		= WebCamMode((int)uiWidth, (int)uiHeight, (uiDen ? (float)uiNum/uiDen : 0.0f), GetFormat(Subtype));
+		iBufferHeight	= (int)uiHeight;
+		MFVideoArea Aperture;
+		if(SUCCEEDED(Type->GetBlob(MF_MT_MINIMUM_DISPLAY_APERTURE, (UINT8*)&Aperture, sizeof(Aperture), NULL)))			// The part of a padded frame to show
+		{
+			ReaderMode.iWidth	= Aperture.Area.cx;
+			ReaderMode.iHeight	= Aperture.Area.cy;
+		}
+		lDefaultStride	= (LONG)MFGetAttributeUINT32(Type, MF_MT_DEFAULT_STRIDE, uiWidth*(ReaderMode.iFormat == WEBCAM_FORMAT_YUYV ? 2 : 1));
+		return ReaderMode.IsValid();
+	}
+
+	bool CopyFrame(IMFMediaBuffer *pBuffer, cv::Mat &Frame) const														// Into Frame, allocated beforehand, without the row padding of the buffer
+	{
+		OVR::Ptr<IMF2DBuffer> Buffer2D;
+		BYTE *pScan0 = NULL;
+		LONG lPitch = 0;
+		if(FAILED(pBuffer->QueryInterface(IID_PPV_ARGS(&Buffer2D.GetRawRef()))) || FAILED(Buffer2D->Lock2D(&pScan0, &lPitch)))
+		{
+			Buffer2D.Clear();
+			DWORD dwLength = 0;
+			lPitch = lDefaultStride;
+			if(FAILED(pBuffer->Lock(&pScan0, NULL, &dwLength))) { return false; }
+			if(lPitch <= 0 || dwLength < (DWORD)lPitch*(ReaderMode.iFormat == WEBCAM_FORMAT_NV12 ? iBufferHeight*3/2 : iBufferHeight)) { pBuffer->Unlock(); return false; }
+		}
+
+		Frame.create(ReaderMode.GetFrameRows(), ReaderMode.iWidth, ReaderMode.GetCvType());								// No-op unless the camera changed its frame size
+		size_t RowSize = (size_t)ReaderMode.iWidth*Frame.elemSize();
+		for(int y=0; y<ReaderMode.iHeight; y++) { memcpy(Frame.ptr(y), pScan0 + y*lPitch, RowSize); }
+		if(ReaderMode.iFormat == WEBCAM_FORMAT_NV12)																	// The UV plane starts right after the iBufferHeight rows of the Y plane
+		{
+			const BYTE *pUV = pScan0 + iBufferHeight*lPitch;
+			for(int y=0; y<ReaderMode.iHeight/2; y++) { memcpy(Frame.ptr(ReaderMode.iHeight + y), pUV + y*lPitch, RowSize); }
+		}
+
+		if(Buffer2D) { Buffer2D->Unlock2D(); }
+		else { pBuffer->Unlock(); }
+		return true;
+	}
+
+	static int GetFormat(const GUID &Subtype)																			// The WEBCAM_FORMAT_* delivered as is, -1 for any other subtype
+	{
+		if(Subtype == MFVideoFormat_YUY2) { return WEBCAM_FORMAT_YUYV; }
+		if(Subtype == MFVideoFormat_NV12) { return WEBCAM_FORMAT_NV12; }
+		return -1;
+	}
+};
+#endif // OVR_OS_WIN32
+
+
+// ==================================================================================//
+//  OpenCVWebCamSource Class
+// ==================================================================================//
+class OpenCVWebCamSource : public WebCamSource
+{
+private:
+
+	cv::VideoCapture			Video;
+	bool						bRequestMJPEG;
+
+public:
+
+	// Constructor
+	OpenCVWebCamSource(bool bMJPEG=false) : bRequestMJPEG(bMJPEG) {}
+
+	virtual bool Open(int iDeviceNum, WebCamMode &Mode)
+	{
+		if(!Video.open(iDeviceNum)) { return false; }
+		if(bRequestMJPEG) { Video.set(CV_CAP_PROP_FOURCC, CV_FOURCC('M','J','P','G')); }								// Must come first: the available sizes and rates depend on it
+		if(Mode.iWidth > 0 && Mode.iHeight > 0)
+		{
+			Video.set(CV_CAP_PROP_FRAME_WIDTH, Mode.iWidth);
+			Video.set(CV_CAP_PROP_FRAME_HEIGHT, Mode.iHeight);
+		}
+		if(Mode.fFPS > 0.0f) { Video.set(CV_CAP_PROP_FPS, Mode.fFPS); }
+
+		Mode.iWidth		= (int)Video.get(CV_CAP_PROP_FRAME_WIDTH);														// What the driver actually agreed to
+		Mode.iHeight	= (int)Video.get(CV_CAP_PROP_FRAME_HEIGHT);
+		Mode.fFPS		= (float)Video.get(CV_CAP_PROP_FPS);
+		Mode.iFormat	= WEBCAM_FORMAT_BGR;																			// OpenCV always hands out BGR
+		return true;
+	}
+
+	virtual void Close() { Video.release(); }
+
+	virtual bool Read(cv::Mat &Frame, double &dCaptureTime)
+	{
+		if(!Video.grab()) { return false; }
+		dCaptureTime = OVR::Timer::GetSeconds();																		// cv::VideoCapture has no capture timestamp on this clock: take the arrival time, before the MJPEG decode
+		return Video.retrieve(Frame);
+	}
+};
+
+
+// ==================================================================================//
+//  RawFileWebCamSource Class
+// ==================================================================================//
+// File layout: magic, width, height, format (int32 each), frame rate (float32), then the frames back to back with unpadded rows
+// (NV12: the Y rows then the UV rows of each frame)
+class RawFileWebCamSource : public WebCamSource
+{
+private:
+
+	char						FileName[260];
+	FILE					   *pFile;
+	WebCamMode					FileMode;
+	long						lFirstFramePos;
+	double						dNextFrameTime;
+
+public:
+
+	// Constructor
+	RawFileWebCamSource(const char *pName) : pFile(NULL), lFirstFramePos(0), dNextFrameTime(0.0) { strcpy_s(FileName, sizeof(FileName), pName); }
+
+	// Destructor
+	virtual ~RawFileWebCamSource() { Close(); }
+
+	virtual bool Open(int iDeviceNum, WebCamMode &Mode)
+	{
+		OVR_UNUSED(iDeviceNum);
+		if(fopen_s(&pFile, FileName, "rb") != 0) { pFile = NULL; return false; }
+		int Header[4];
+		if(fread(Header, sizeof(int), 4, pFile) != 4 || Header[0] != WEBCAM_RAWFILE_MAGIC ||
+		   fread(&FileMode.fFPS, sizeof(float), 1, pFile) != 1)
+		{
+			Close();
+			return false;
+		}
+		FileMode.iWidth		= Header[1];
+		FileMode.iHeight	= Header[2];
+		FileMode.iFormat	= Header[3];
+		if(!FileMode.IsValid())
+		{
+			Close();
+			return false;
+		}
+		if(FileMode.fFPS <= 0.0f) { FileMode.fFPS = 30.0f; }
+		lFirstFramePos		= ftell(pFile);
+		dNextFrameTime		= OVR::Timer::GetSeconds();
+		Mode				= FileMode;																					// The recording dictates the mode
+		return true;
+	}
+
+	virtual void Close()
+	{
+		if(pFile) { fclose(pFile); pFile = NULL; }
+	}
+
+	virtual bool Read(cv::Mat &Frame, double &dCaptureTime)
+	{
+		if(!pFile) { return false; }
+		double dWait = dNextFrameTime - OVR::Timer::GetSeconds();													// Pace the replay like a real camera would
+		if(dWait > 0.0) { OVR::Thread::MSleep((unsigned)(dWait*1000.0)); }
+		dCaptureTime = dNextFrameTime;																					// When the camera would have delivered it: regular intervals, whatever the sleep accuracy
+		dNextFrameTime = OVR::Max(dNextFrameTime + 1.0/FileMode.fFPS, OVR::Timer::GetSeconds() - 1.0/FileMode.fFPS);
+
+		Frame.create(FileMode.GetFrameRows(), FileMode.iWidth, FileMode.GetCvType());
+		size_t RowSize = (size_t)FileMode.iWidth*Frame.elemSize();
+		for(int y=0; y<FileMode.GetFrameRows(); y++)
+		{
+			if(fread(Frame.ptr(y), 1, RowSize, pFile) == RowSize) { continue; }
+			if(y != 0) { return false; }																				// Truncated recording
+			fseek(pFile, lFirstFramePos, SEEK_SET);																		// End of the recording: loop
+			if(fread(Frame.ptr(y), 1, RowSize, pFile) != RowSize) { return false; }
+		}
+		return true;
+	}
+};
+
+
+// ==================================================================================//
+//  RawFileWebCamWriter Class
+// ==================================================================================//
+class RawFileWebCamWriter
+{
+private:
+
+	FILE					   *pFile;
+	WebCamMode					FileMode;
+
+public:
+
+	// Constructor
+	RawFileWebCamWriter() : pFile(NULL) {}
+
+	// Destructor
+	~RawFileWebCamWriter() { Close(); }
+
+	bool Open(const char *pFileName, const WebCamMode &Mode)
+	{
+		Close();
+		if(fopen_s(&pFile, pFileName, "wb") != 0) { pFile = NULL; return false; }
+		FileMode = Mode;
+		int Header[4] = { WEBCAM_RAWFILE_MAGIC, Mode.iWidth, Mode.iHeight, Mode.iFormat };
+		fwrite(Header, sizeof(int), 4, pFile);
+		fwrite(&Mode.fFPS, sizeof(float), 1, pFile);
+		return true;
+	}
+
+	void Close()
+	{
+		if(pFile) { fclose(pFile); pFile = NULL; }
+	}
+
+	void Write(const cv::Mat &Frame)
+	{
+		if(!pFile || Frame.cols != FileMode.iWidth || Frame.rows != FileMode.GetFrameRows() || Frame.type() != FileMode.GetCvType()) { return; }
+		size_t RowSize = (size_t)FileMode.iWidth*Frame.elemSize();
+		for(int y=0; y<FileMode.GetFrameRows(); y++) { fwrite(Frame.ptr(y), 1, RowSize, pFile); }
+	}
+};
+
+#endif // WEBCAMSOURCE_H_
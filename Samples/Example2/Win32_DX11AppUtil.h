@@ -18,10 +18,18 @@ limitations under the License.
 *************************************************************************************/
  
 #include "Kernel/OVR_Math.h"
+#include "Kernel/OVR_Array.h"
+#if _MSC_VER >= 1700                    // The D3D 11.1 headers come with the Windows 8 SDK, not with the DirectX SDK used by VS2010
+#define DX11_CONSTANT_RING 1
+#include <d3d11_1.h>
+#else
 #include <d3d11.h>
+#endif
 #include <d3dcompiler.h>
 using namespace OVR;
 
+#define DX11_CONSTANT_RING_SIZE (4*1024*1024)
+
 //---------------------------------------------------------------------
 struct DirectX11
 {
@@ -31,14 +39,19 @@ struct DirectX11
     struct ImageBuffer     * MainDepthBuffer;
     ID3D11Device           * Device;
     ID3D11DeviceContext    * Context;
+#if DX11_CONSTANT_RING
+    ID3D11DeviceContext1   * Context1;
+#endif
     IDXGISwapChain         * SwapChain;
     ID3D11Texture2D        * BackBuffer;
     ID3D11RenderTargetView * BackBufferRT;
     struct DataBuffer      * UniformBufferGen;
+    struct ConstantRing    * UniformRing;   // NULL unless the device binds constant buffers at offsets (D3D 11.1)
 
     bool InitWindowAndDevice(HINSTANCE hinst, Recti vp,  bool windowed);
     void ClearAndSetRenderTarget(ID3D11RenderTargetView * rendertarget, ImageBuffer * depthbuffer, Recti vp);
-    void Render(struct ShaderFill* fill, DataBuffer* vertices, DataBuffer* indices,UINT stride, int count);
+    void Render(struct ShaderFill* fill, DataBuffer* vertices, DataBuffer* indices,UINT stride, int count,
+                int firstIndex = 0, int baseVertex = 0, int indexSize = 2);
 
     bool IsAnyKeyPressed() const
     {
@@ -132,16 +145,11 @@ struct Shader
         UniformData  = (unsigned char*)OVR_ALLOC(bufd.Size);
     }
 
-    void SetUniform(const char* name, int n, const float* v)
+    int FindUniformOffset(const char* name) const
     {
         for (int i=0;i<numUniformInfo;i++)
-        {
-            if (!strcmp(UniformInfo[i].Name,name))
-            {
-                memcpy(UniformData + UniformInfo[i].Offset, v, n * sizeof(float));
-                return;
-            }
-        }
+            if (!strcmp(UniformInfo[i].Name,name)) return UniformInfo[i].Offset;
+        return -1;
     }
 };
 //------------------------------------------------------------
@@ -202,10 +210,29 @@ struct ImageBuffer
 //-----------------------------------------------------
 struct ShaderFill
 {
+    // The uniforms the sample shaders use, looked up once when the fill is created
+    enum UniformId { Uniform_View, Uniform_Proj, Uniform_NewCol, Uniform_TexSize,
+                     Uniform_EyeToSourceUVScale, Uniform_EyeToSourceUVOffset,
+                     Uniform_EyeRotationStart, Uniform_EyeRotationEnd, Uniform_Count };
+
     Shader             * VShader, *PShader;
     ImageBuffer        * OneTexture;
     ID3D11InputLayout  * InputLayout;
     ID3D11SamplerState * SamplerState;
+    int                  UniformOffsets[Uniform_Count]; // In the vertex shader constants, -1 when not used
+
+    static const char * GetUniformName(UniformId id)
+    {
+        static const char * names[Uniform_Count] = { "View", "Proj", "NewCol", "TexSize",
+                                                     "EyeToSourceUVScale", "EyeToSourceUVOffset",
+                                                     "EyeRotationStart", "EyeRotationEnd" };
+        return names[id];
+    }
+
+    void SetUniform(UniformId id, int n, const float* v)
+    {
+        if (UniformOffsets[id] >= 0) memcpy(VShader->UniformData + UniformOffsets[id], v, n * sizeof(float));
+    }
 
     ShaderFill::ShaderFill(D3D11_INPUT_ELEMENT_DESC * VertexDesc, int numVertexDesc,
                            char* vertexShader, char* pixelShader, ImageBuffer * t, bool wrap=1)
@@ -218,6 +245,8 @@ struct ShaderFill
                                        blobData->GetBufferPointer(), blobData->GetBufferSize(), &InputLayout);
         D3DCompile(pixelShader, strlen(pixelShader), NULL, NULL, NULL, "main", "ps_4_0", 0, 0, &blobData, NULL);
         PShader  = new Shader(blobData,1);
+        for (int i = 0; i < Uniform_Count; i++)
+            UniformOffsets[i] = VShader->FindUniformOffset(GetUniformName((UniformId)i));
 
         D3D11_SAMPLER_DESC ss; memset(&ss, 0, sizeof(ss));
         ss.AddressU = ss.AddressV = ss.AddressW = wrap ? D3D11_TEXTURE_ADDRESS_WRAP : D3D11_TEXTURE_ADDRESS_BORDER;
@@ -234,11 +263,12 @@ struct DataBuffer
     ID3D11Buffer * D3DBuffer;
     size_t         Size;
 
-    DataBuffer(D3D11_BIND_FLAG use, const void* buffer, size_t size) : Size(size)
+    // Static buffers are only written by Update and CopyFrom, and are never mapped
+    DataBuffer(D3D11_BIND_FLAG use, const void* buffer, size_t size, bool dynamic = true) : D3DBuffer(NULL), Size(size)
     {
         D3D11_BUFFER_DESC desc;   memset(&desc, 0, sizeof(desc));
-        desc.Usage = D3D11_USAGE_DYNAMIC;
-        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.Usage = dynamic ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT;
+        desc.CPUAccessFlags = dynamic ? D3D11_CPU_ACCESS_WRITE : 0;
         desc.BindFlags = use;
         desc.ByteWidth = (unsigned)size;
         D3D11_SUBRESOURCE_DATA sr;
@@ -246,6 +276,8 @@ struct DataBuffer
         sr.SysMemPitch = sr.SysMemSlicePitch = 0;
         DX11.Device->CreateBuffer(&desc, buffer ? &sr : NULL, &D3DBuffer);
     }
+    ~DataBuffer() { if (D3DBuffer) D3DBuffer->Release(); }
+
     void Refresh(const void* buffer, size_t size)
     {
         D3D11_MAPPED_SUBRESOURCE map;
@@ -253,6 +285,98 @@ struct DataBuffer
         memcpy((void *)map.pData, buffer, size);
         DX11.Context->Unmap(D3DBuffer, 0);
     }
+    void Update(size_t offset, const void* buffer, size_t size)
+    {
+        D3D11_BOX box = { (UINT)offset, 0, 0, (UINT)(offset + size), 1, 1 };
+        DX11.Context->UpdateSubresource(D3DBuffer, 0, &box, buffer, 0, 0);
+    }
+    void CopyFrom(DataBuffer* source, size_t size)
+    {
+        D3D11_BOX box = { 0, 0, 0, (UINT)size, 1, 1 };
+        DX11.Context->CopySubresourceRegion(D3DBuffer, 0, 0, 0, 0, source->D3DBuffer, 0, &box);
+    }
+};
+
+//----------------------------------------------------------------
+// A static buffer the models' vertices or indices are appended to. Each range is written once,
+// when its model is added; when the buffer is full it is replaced by one twice as large, and the
+// ranges already in use are copied over on the GPU. Models keep the ArenaBuffer, not the
+// DataBuffer, which may change while a scene is being built.
+#define ARENABUFFER_INITIAL_SIZE    (64*1024)
+
+struct ArenaBuffer
+{
+    DataBuffer     * Buffer;      // NULL until the first Append
+    D3D11_BIND_FLAG  Use;
+    size_t           ElementSize, numElements;
+
+    ArenaBuffer(D3D11_BIND_FLAG use, size_t elementSize) : Buffer(NULL), Use(use), ElementSize(elementSize), numElements(0) {}
+
+    // Returns the index of the first element appended
+    int Append(const void* elements, size_t count)
+    {
+        size_t used = numElements * ElementSize, needed = used + count * ElementSize;
+        if (!Buffer || needed > Buffer->Size)
+        {
+            size_t capacity = Buffer ? 2 * Buffer->Size : ARENABUFFER_INITIAL_SIZE;
+            while (capacity < needed) capacity *= 2;
+            DataBuffer * grown = new DataBuffer(Use, NULL, capacity, false);
+            if (Buffer) { grown->CopyFrom(Buffer, used); delete Buffer; }
+            Buffer = grown;
+        }
+        Buffer->Update(used, elements, count * ElementSize);
+        numElements += count;
+        return (int)(numElements - count);
+    }
+};
+
+//----------------------------------------------------------------
+// One large dynamic constant buffer the draws take their constants from, bound at an offset with
+// VSSetConstantBuffers1. It is mapped with NO_OVERWRITE while there is room and with DISCARD
+// when it wraps, so the data of draws still in flight is never overwritten.
+struct ConstantRing
+{
+    ID3D11Buffer * D3DBuffer;
+    size_t         Size, Offset;
+
+    ConstantRing(size_t size) : D3DBuffer(NULL), Size(size), Offset(size) // The first Map discards
+    {
+        D3D11_BUFFER_DESC desc;   memset(&desc, 0, sizeof(desc));
+        desc.Usage = D3D11_USAGE_DYNAMIC;
+        desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+        desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        desc.ByteWidth = (unsigned)size;
+        DX11.Device->CreateBuffer(&desc, NULL, &D3DBuffer);
+    }
+
+    // VSSetConstantBuffers1 takes offsets and sizes in multiples of 16 constants, i.e. 256 bytes
+    static size_t BlockSize(size_t size)  { return (size + 255) & ~(size_t)255; }
+
+    // Room for size bytes, starting at constant *firstConstant. Unmap before drawing.
+    unsigned char * Map(size_t size, UINT * firstConstant)
+    {
+        size = BlockSize(size);
+        OVR_ASSERT(size <= Size);
+        D3D11_MAP mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+        if (Offset + size > Size) { mapType = D3D11_MAP_WRITE_DISCARD; Offset = 0; }
+        D3D11_MAPPED_SUBRESOURCE map;
+        if (FAILED(DX11.Context->Map(D3DBuffer, 0, mapType, 0, &map))) return NULL;
+        *firstConstant = (UINT)(Offset / 16);
+        unsigned char * data = (unsigned char *)map.pData + Offset;
+        Offset += size;
+        return data;
+    }
+    void Unmap() { DX11.Context->Unmap(D3DBuffer, 0); }
+
+    void Bind(UINT firstConstant, size_t size)
+    {
+    #if DX11_CONSTANT_RING
+        UINT numConstants = (UINT)(BlockSize(size) / 16);
+        DX11.Context1->VSSetConstantBuffers1(0, 1, &D3DBuffer, &firstConstant, &numConstants);
+    #else
+        OVR_UNUSED2(firstConstant, size);
+    #endif
+    }
 };
 
 //---------------------------------------------------------------------------
@@ -277,21 +401,20 @@ struct Model
     Quatf        Rot;
     Matrix4f     Mat;
     int          numVertices, numIndices;
-    Vertex       Vertices[2000]; //Note fixed maximum
-    uint16_t     Indices[2000];
+    ArrayPOD<Vertex>   Vertices;  // Only until AllocateBuffers has put them in the arenas
+    ArrayPOD<uint32_t> Indices;   // Relative to the model's first vertex
     ShaderFill * Fill;
-    DataBuffer * VertexBuffer, * IndexBuffer;  
+    ArenaBuffer * VertexArena, * IndexArena;
+    int          BaseVertex, FirstIndex;
    
-    Model(Vector3f arg_pos, ShaderFill * arg_Fill ) { numVertices=0;numIndices=0;Pos = arg_pos; Fill = arg_Fill; }
+    Model(Vector3f arg_pos, ShaderFill * arg_Fill ) : VertexArena(NULL), IndexArena(NULL), BaseVertex(0), FirstIndex(0)
+                                                    { numVertices=0;numIndices=0;Pos = arg_pos; Fill = arg_Fill; }
     Matrix4f& GetMatrix()                           { Mat = Matrix4f(Rot); Mat = Matrix4f::Translation(Pos) * Mat; return Mat;   }
-    void AddVertex(const Vertex& v)                 { Vertices[numVertices++] = v; OVR_ASSERT(numVertices<2000); }
-    void AddIndex(uint16_t a)                       { Indices[numIndices++] = a;   OVR_ASSERT(numIndices<2000);  }
+    void AddVertex(const Vertex& v)                 { Vertices.PushBack(v); numVertices++; }
+    void AddIndex(uint32_t a)                       { Indices.PushBack(a);  numIndices++;  }
 
-    void AllocateBuffers()
-    {
-        VertexBuffer = new DataBuffer(D3D11_BIND_VERTEX_BUFFER, &Vertices[0], numVertices * sizeof(Vertex));
-        IndexBuffer  = new DataBuffer(D3D11_BIND_INDEX_BUFFER, &Indices[0], numIndices * 2);
-    }
+    void AllocateBuffers();
+    void Render();
 
     void Model::AddSolidColorBox(float x1, float y1, float z1, float x2, float y2, float z2, Color c)
     {
@@ -314,7 +437,7 @@ struct Model
                                   16, 17, 19,  19, 17, 18,  21, 20, 22,  22, 20, 23 };
         
         for(int i = 0; i < 36; i++)
-            AddIndex(CubeIndices[i] + (uint16_t) numVertices);
+            AddIndex(CubeIndices[i] + (uint32_t) numVertices);
 
         for(int v = 0; v < 24; v++)
         {
@@ -333,6 +456,47 @@ struct Model
         }
     }
 };
+
+//-------------------------------------------------------------------------
+// Shared by all the models: models up to 65536 vertices use 16 bit indices
+struct ModelArenas
+{
+    ArenaBuffer Vertices, Indices16, Indices32;
+
+    ModelArenas() : Vertices(D3D11_BIND_VERTEX_BUFFER, sizeof(Model::Vertex)),
+                    Indices16(D3D11_BIND_INDEX_BUFFER, sizeof(uint16_t)),
+                    Indices32(D3D11_BIND_INDEX_BUFFER, sizeof(uint32_t)) {}
+} ModelArena;
+
+void Model::AllocateBuffers()
+{
+    if (!numIndices) return;
+    VertexArena = &ModelArena.Vertices;
+    BaseVertex  = VertexArena->Append(&Vertices[0], numVertices);
+    if (numVertices <= 65536)
+    {
+        ArrayPOD<uint16_t> indices16;
+        indices16.Resize(numIndices);
+        for (int i = 0; i < numIndices; i++) indices16[i] = (uint16_t)Indices[i];
+        IndexArena = &ModelArena.Indices16;
+        FirstIndex = IndexArena->Append(&indices16[0], numIndices);
+    }
+    else
+    {
+        IndexArena = &ModelArena.Indices32;
+        FirstIndex = IndexArena->Append(&Indices[0], numIndices);
+    }
+    Vertices.ClearAndRelease();
+    Indices.ClearAndRelease();
+}
+
+void Model::Render()
+{
+    if (!IndexArena) return;
+    DX11.Render(Fill, VertexArena->Buffer, IndexArena->Buffer, sizeof(Vertex), numIndices,
+                FirstIndex, BaseVertex, (int)IndexArena->ElementSize);
+}
+
 //------------------------------------------------------------------------- 
 struct Scene  
 {
@@ -458,11 +622,10 @@ struct Scene
             Matrix4f modelmat = Models[i]->GetMatrix();
             Matrix4f mat      = (view * modelmat).Transposed();
 
-            Models[i]->Fill->VShader->SetUniform("View",16,(float *) &mat);
-            Models[i]->Fill->VShader->SetUniform("Proj",16,(float *) &proj);
+            Models[i]->Fill->SetUniform(ShaderFill::Uniform_View,16,(float *) &mat);
+            Models[i]->Fill->SetUniform(ShaderFill::Uniform_Proj,16,(float *) &proj);
 
-            DX11.Render(Models[i]->Fill, Models[i]->VertexBuffer,  Models[i]->IndexBuffer,
-                        sizeof(Model::Vertex), Models[i]->numIndices);
+            Models[i]->Render();
         }
     }
 };
@@ -564,6 +727,13 @@ bool DirectX11::InitWindowAndDevice(HINSTANCE hinst, Recti vp, bool windowed)
     Context->OMSetRenderTargets(1, &BackBufferRT, MainDepthBuffer->TexDsv);
     if (!windowed) SwapChain->SetFullscreenState(1, NULL);
     UniformBufferGen = new DataBuffer(D3D11_BIND_CONSTANT_BUFFER, NULL, 2000);// make sure big enough
+#if DX11_CONSTANT_RING
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options;
+    if (SUCCEEDED(Device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) &&
+        options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer &&
+        SUCCEEDED(Context->QueryInterface(__uuidof(ID3D11DeviceContext1), (void**)&Context1)))
+        UniformRing = new ConstantRing(DX11_CONSTANT_RING_SIZE);
+#endif
  
     D3D11_RASTERIZER_DESC rs;
     memset(&rs, 0, sizeof(rs));
@@ -586,22 +756,34 @@ bool DirectX11::InitWindowAndDevice(HINSTANCE hinst, Recti vp, bool windowed)
 }
 
 //---------------------------------------------------------------------------------------------
-void DirectX11::Render(ShaderFill* fill, DataBuffer* vertices, DataBuffer* indices,UINT stride, int count)
+void DirectX11::Render(ShaderFill* fill, DataBuffer* vertices, DataBuffer* indices,UINT stride, int count,
+                       int firstIndex, int baseVertex, int indexSize)
 {
     Context->IASetInputLayout(fill->InputLayout);
-    Context->IASetIndexBuffer(indices->D3DBuffer, DXGI_FORMAT_R16_UINT, 0);
+    Context->IASetIndexBuffer(indices->D3DBuffer, indexSize == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT, 0);
 
     UINT offset = 0;
     Context->IASetVertexBuffers(0, 1, &vertices->D3DBuffer, &stride, &offset);
-    UniformBufferGen->Refresh(fill->VShader->UniformData, fill->VShader->UniformsSize);
-    Context->VSSetConstantBuffers(0, 1, &UniformBufferGen->D3DBuffer);
+    UINT           firstConstant;
+    unsigned char* constants = UniformRing ? UniformRing->Map(fill->VShader->UniformsSize, &firstConstant) : NULL;
+    if (constants)
+    {
+        memcpy(constants, fill->VShader->UniformData, fill->VShader->UniformsSize);
+        UniformRing->Unmap();
+        UniformRing->Bind(firstConstant, fill->VShader->UniformsSize);
+    }
+    else
+    {
+        UniformBufferGen->Refresh(fill->VShader->UniformData, fill->VShader->UniformsSize);
+        Context->VSSetConstantBuffers(0, 1, &UniformBufferGen->D3DBuffer);
+    }
     Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     Context->VSSetShader(fill->VShader->D3DVert, NULL, 0);
     Context->PSSetShader(fill->PShader->D3DPix, NULL, 0);
     Context->PSSetSamplers(0, 1, &fill->SamplerState);
     if (fill->OneTexture)
         Context->PSSetShaderResources(0, 1, &fill->OneTexture->TexSv);
-    Context->DrawIndexed(count, 0, 0);
+    Context->DrawIndexed(count, firstIndex, baseVertex);
 }
 
 //--------------------------------------------------------------------------------
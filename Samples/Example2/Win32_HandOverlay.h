@@ -0,0 +1,189 @@
+/************************************************************************************
+Filename    :   Win32_HandOverlay.h
+Content     :   GPU layer drawing the detected hand over the webcam quad
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// The hand used to be drawn with OpenCV into the captured pixels, by the capture thread. Now the render thread turns
+// the last HandEvent into thick line segments, in the same [-1,1] space as the webcam quad, and draws them right
+// after the quad with the same View/Proj matrices. Each segment is a quad indexed with both windings, so it does
+// not depend on the culling state nor on the mirroring done by the projection. When the webcam is calibrated, the
+// points found in the raw frame are moved to where the rectification mesh shows them.
+
+#ifndef HANDOVERLAY_H_
+#define HANDOVERLAY_H_
+
+#define HANDOVERLAY_MAX_SEGMENTS		512
+#define HANDOVERLAY_CIRCLE_SEGMENTS		12
+#define HANDOVERLAY_LINE_WIDTH			2.0f		// In frame pixels
+
+#include "Hand.h"
+#include "WebCamCalibration.h"
+
+
+// ==================================================================================//
+//  HandOverlay Class
+// ==================================================================================//
+class HandOverlay
+{
+private:
+
+	Model::Vertex				Vertices[4*HANDOVERLAY_MAX_SEGMENTS];
+	uint16_t					Indices[12*HANDOVERLAY_MAX_SEGMENTS];
+	DataBuffer				   *pVertexBuffer;
+	DataBuffer				   *pIndexBuffer;
+	ShaderFill				   *pFill;
+	const WebCamCalibration	   *pCalibration;																		// NULL when the quad shows the raw frame
+	int							iNbSegments;
+	cv::vector<cv::Point2f>		SegmentEnds, RectifiedEnds;																// 2 points per segment, in the raw frame then rectified together
+	float						SegmentWidths[HANDOVERLAY_MAX_SEGMENTS];
+	Model::Color				SegmentColors[HANDOVERLAY_MAX_SEGMENTS];
+	float						fFrameWidth, fFrameHeight;
+#if !RENDER_OPENGL
+	Ptr<ID3D11DepthStencilState> NoDepthState;																			// The overlay lies in the plane of the quad
+#endif
+
+public:
+
+	// Constructor
+	HandOverlay() : pVertexBuffer(NULL), pIndexBuffer(NULL), pFill(NULL), pCalibration(NULL), iNbSegments(0), fFrameWidth(1.0f), fFrameHeight(1.0f) {}
+
+	void Initialize(ShaderFill *pShaderFill, int iFrameWidth, int iFrameHeight, const WebCamCalibration *pFrameCalibration=NULL)
+	{
+		pFill			= pShaderFill;
+		pCalibration	= pFrameCalibration;
+		fFrameWidth		= (float)iFrameWidth;
+		fFrameHeight	= (float)iFrameHeight;
+
+		static const uint16_t QuadIndices[] = { 0, 1, 2, 2, 3, 0,  0, 2, 1, 2, 0, 3 };									// Front and back faces
+		for (int i = 0; i < HANDOVERLAY_MAX_SEGMENTS; i++)
+		{
+			for (int j = 0; j < 12; j++) { Indices[12*i + j] = (uint16_t)(4*i + QuadIndices[j]); }
+		}
+		memset(Vertices, 0, sizeof(Vertices));
+		SegmentEnds.reserve(2*HANDOVERLAY_MAX_SEGMENTS);
+		RectifiedEnds.reserve(2*HANDOVERLAY_MAX_SEGMENTS);
+	#if RENDER_OPENGL
+		pVertexBuffer	= new DataBuffer(GL_ARRAY_BUFFER, Vertices, sizeof(Vertices));									// Refreshed with each new HandEvent
+		pIndexBuffer	= new DataBuffer(GL_ELEMENT_ARRAY_BUFFER, Indices, sizeof(Indices));							// Never changes
+	#else
+		pVertexBuffer	= new DataBuffer(D3D11_BIND_VERTEX_BUFFER, Vertices, sizeof(Vertices));
+		pIndexBuffer	= new DataBuffer(D3D11_BIND_INDEX_BUFFER, Indices, sizeof(Indices));
+
+		D3D11_DEPTH_STENCIL_DESC ds;
+		memset(&ds, 0, sizeof(ds));
+		ds.DepthEnable		= false;
+		ds.DepthWriteMask	= D3D11_DEPTH_WRITE_MASK_ZERO;
+		ds.DepthFunc		= D3D11_COMPARISON_ALWAYS;
+		WND.Device->CreateDepthStencilState(&ds, &NoDepthState.GetRawRef());
+	#endif
+	}
+
+	void Build(const HandEvent &Event)																					// Render thread, once per new event
+	{
+		iNbSegments = 0;
+		SegmentEnds.clear();
+		if (!Event.bIsHandFound) { return; }
+
+		Model::Color HistoryColor(0, 100, 128), ContourColor(128, 128, 128), PalmColor(0, 200, 255);				// Same colors as Hand::Draw()
+		float fRelativeUnity = Event.fMeanSize*0.007f;
+
+		for (int i = 0; i + 2 < Event.iNbPalmHistory; i++) { AddSegment(Event.PalmHistory[i], Event.PalmHistory[i + 1], HANDOVERLAY_LINE_WIDTH, HistoryColor); }
+		for (int i = 0; i < Event.iNbContourPoints; i++)
+		{
+			AddSegment(Event.ContourPoints[i], Event.ContourPoints[(i + 1) % Event.iNbContourPoints], HANDOVERLAY_LINE_WIDTH, ContourColor);
+		}
+		AddCircle(Event.PalmCenter, 12*fRelativeUnity, 6.0f, PalmColor);
+		for (int i = 0; i < Event.iNbFingerTips; i++)
+		{
+			AddCircle(Event.FingerTips[i], 5*fRelativeUnity, std::max(3*fRelativeUnity, 1.0f), PalmColor);
+			AddCircle(Event.FingerTips[i], 10*fRelativeUnity, std::max(fRelativeUnity, 1.0f), PalmColor);
+			AddSegment(Event.FingerTips[i], Event.PalmCenter, HANDOVERLAY_LINE_WIDTH, PalmColor);
+		}
+
+		const cv::vector<cv::Point2f> &Ends = RectifySegmentEnds();
+		for (int i = 0; i < (int)Ends.size()/2; i++) { AddQuad(Ends[2*i], Ends[2*i + 1], SegmentWidths[i], SegmentColors[i]); }
+		if (iNbSegments) { pVertexBuffer->Refresh(Vertices, 4*iNbSegments*sizeof(Model::Vertex)); }
+	}
+
+	void Draw(const Matrix4f &View, const Matrix4f &Proj)																// Same matrices as the webcam quad it lies on
+	{
+		if (!pFill || !iNbSegments) { return; }
+		pFill->SetUniform(ShaderFill::Uniform_View, 16, (float *) &View);
+		pFill->SetUniform(ShaderFill::Uniform_Proj, 16, (float *) &Proj);
+	#if RENDER_OPENGL
+		glDisable(GL_DEPTH_TEST);
+		WND.Render(pFill, pVertexBuffer, pIndexBuffer, sizeof(Model::Vertex), 12*iNbSegments);
+		glEnable(GL_DEPTH_TEST);
+	#else
+		WND.Context->OMSetDepthStencilState(NoDepthState, 0);
+		WND.Render(pFill, pVertexBuffer, pIndexBuffer, sizeof(Model::Vertex), 12*iNbSegments);
+		WND.Context->OMSetDepthStencilState(NULL, 0);
+	#endif
+	}
+
+private:
+
+	Vector3f ToQuadSpace(float fX, float fY) const																		// Frame pixels to the [-1,1] space of the webcam quad (texture coordinates (x+1)/2, (y+1)/2)
+	{
+		return Vector3f(2.0f*fX/fFrameWidth - 1.0f, 2.0f*fY/fFrameHeight - 1.0f, 0.0f);
+	}
+
+	const cv::vector<cv::Point2f> &RectifySegmentEnds()																	// All the points of the event in one cv::undistortPoints call
+	{
+		if (!pCalibration) { return SegmentEnds; }
+		pCalibration->GetRectifiedPoints(SegmentEnds, RectifiedEnds);
+		return RectifiedEnds;
+	}
+
+	void AddSegment(const cv::Point2f &SourceA, const cv::Point2f &SourceB, float fWidth, const Model::Color &Color)	// Queued until RectifySegmentEnds()
+	{
+		int iSegment = (int)SegmentEnds.size()/2;
+		if (iSegment >= HANDOVERLAY_MAX_SEGMENTS) { return; }
+		SegmentEnds.push_back(SourceA);
+		SegmentEnds.push_back(SourceB);
+		SegmentWidths[iSegment] = fWidth;
+		SegmentColors[iSegment] = Color;
+	}
+
+	void AddQuad(const cv::Point2f &A, const cv::Point2f &B, float fWidth, const Model::Color &Color)
+	{
+		cv::Point2f Dir = B - A;
+		float fLength = sqrt(Dir.x*Dir.x + Dir.y*Dir.y);
+		if (fLength < 1e-3f) { return; }
+		cv::Point2f Normal(-Dir.y*0.5f*fWidth/fLength, Dir.x*0.5f*fWidth/fLength);
+
+		Model::Vertex *pV = &Vertices[4*iNbSegments++];
+		cv::Point2f Corners[4] = { A + Normal, B + Normal, B - Normal, A - Normal };
+		for (int i = 0; i < 4; i++)
+		{
+			pV[i].Pos	= ToQuadSpace(Corners[i].x, Corners[i].y);
+			pV[i].C		= Color;
+			pV[i].U		= pV[i].V = 0.0f;
+		}
+	}
+
+	void AddCircle(const cv::Point2f &Center, float fRadius, float fWidth, const Model::Color &Color)
+	{
+		for (int i = 0; i < HANDOVERLAY_CIRCLE_SEGMENTS; i++)
+		{
+			float fA0 = 2.0f*MATH_FLOAT_PI*i/HANDOVERLAY_CIRCLE_SEGMENTS, fA1 = 2.0f*MATH_FLOAT_PI*(i + 1)/HANDOVERLAY_CIRCLE_SEGMENTS;
+			AddSegment(Center + fRadius*cv::Point2f(cos(fA0), sin(fA0)), Center + fRadius*cv::Point2f(cos(fA1), sin(fA1)), fWidth, Color);
+		}
+	}
+};
+
+#endif // HANDOVERLAY_H_
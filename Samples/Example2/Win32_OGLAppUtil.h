@@ -18,6 +18,7 @@ limitations under the License.
 *************************************************************************************/
  
 #include "Kernel/OVR_Math.h"
+#include "Kernel/OVR_Array.h"
 #include <CAPI/GL/CAPI_GLE.h>
 #include <CAPI/GL/CAPI_GL_Util.h>
 #include <dwmapi.h>
@@ -34,7 +35,8 @@ struct OpenGL
 
     bool InitWindowAndDevice(HINSTANCE hinst, Recti vp,  bool windowed);
 	void ClearAndSetRenderTarget(struct ImageBuffer * imagebuffer, Recti vp);
-    void Render(struct ShaderFill* fill, struct DataBuffer* vertices, DataBuffer* indices,UINT stride, int count);
+    void Render(struct ShaderFill* fill, struct DataBuffer* vertices, DataBuffer* indices,UINT stride, int count,
+                int firstIndex = 0, int baseVertex = 0, int indexSize = 2);
 
     bool IsAnyKeyPressed() const
     {
@@ -191,9 +193,34 @@ struct ImageBuffer
 //-----------------------------------------------------
 struct ShaderFill
 {
+    // The uniforms the sample shaders use, looked up once when the program is linked
+    enum UniformId { Uniform_View, Uniform_Proj, Uniform_NewCol, Uniform_TexSize,
+                     Uniform_EyeToSourceUVScale, Uniform_EyeToSourceUVOffset,
+                     Uniform_EyeRotationStart, Uniform_EyeRotationEnd, Uniform_Count };
+
     GLuint				Prog;
 	Shader            * VShader, *PShader;
     ImageBuffer       * OneTexture;
+	GLint				UniformLocations[Uniform_Count];	// -1 when not used
+	float				UniformValues[Uniform_Count][16];	// Kept by SetUniform until BeginRender sends them
+	int					UniformSizes[Uniform_Count];
+	unsigned			DirtyUniforms;
+
+    static const char * GetUniformName(UniformId id)
+    {
+        static const char * names[Uniform_Count] = { "View", "Proj", "NewCol", "TexSize",
+                                                     "EyeToSourceUVScale", "EyeToSourceUVOffset",
+                                                     "EyeRotationStart", "EyeRotationEnd" };
+        return names[id];
+    }
+
+	void SetUniform(UniformId id, int n, const float* v)
+	{
+		if (UniformLocations[id] < 0) return;
+		memcpy(UniformValues[id], v, n * sizeof(float));
+		UniformSizes[id] = n;
+		DirtyUniforms   |= 1u << id;
+	}
 
 	struct VertexAttribDesc
 	{
@@ -209,8 +236,9 @@ struct ShaderFill
 
     ShaderFill::ShaderFill(const VertexAttribDesc * VertexDesc, int numVertexDesc,
                            char* vertexShader, char* pixelShader, ImageBuffer * t, bool wrap=1)
-        : numVertexDescInfo(numVertexDesc), OneTexture(t)
+        : numVertexDescInfo(numVertexDesc), OneTexture(t), DirtyUniforms(0)
     {
+		for (int i = 0; i < Uniform_Count; i++) UniformLocations[i] = -1;
 		Prog = glCreateProgram();
 		VShader = new Shader(vertexShader,0);
 		glAttachShader(Prog, VShader->GLShader);
@@ -231,6 +259,10 @@ struct ShaderFill
 			if (!r) return;
 		}
 		glUseProgram(Prog);
+		for (int i = 0; i < Uniform_Count; i++)
+			UniformLocations[i] = glGetUniformLocation(Prog, GetUniformName((UniformId)i));
+		GLint Texture0 = glGetUniformLocation(Prog, "Texture0");
+		if (Texture0 >= 0) glUniform1i(Texture0, 0);	// Always texture unit 0
 
 		if(t)
 		{
@@ -242,23 +274,31 @@ struct ShaderFill
 		}
     }
 
-	void BeginRender(UINT stride)
+	// vertexOffset is where the vertices start in the bound array buffer, as GL 2.1 has no base vertex
+	void BeginRender(UINT stride, size_t vertexOffset = 0)
 	{
+		glUseProgram(Prog);
+		for (int i = 0; DirtyUniforms; i++)
+		{
+			if (!(DirtyUniforms & (1u << i))) continue;
+			if      (UniformSizes[i] == 16) glUniformMatrix4fv(UniformLocations[i], 1, 0, UniformValues[i]);
+			else if (UniformSizes[i] == 4)  glUniform4fv(UniformLocations[i], 1, UniformValues[i]);
+			else if (UniformSizes[i] == 2)  glUniform2fv(UniformLocations[i], 1, UniformValues[i]);
+			else                            glUniform1fv(UniformLocations[i], 1, UniformValues[i]);
+			DirtyUniforms &= ~(1u << i);
+		}
+
 		if(OneTexture)
 		{
 			glActiveTexture(GL_TEXTURE0);
 			glBindTexture(GL_TEXTURE_2D, OneTexture->TexId);
-			
-			glUseProgram(Prog);
-			GLint Texture0 = glGetUniformLocation(Prog, "Texture0");
-			if (Texture0 >= 0) glUniform1i(Texture0, 0);
 		}	
 		
 		for (size_t i = 0; i < numVertexDescInfo; i++)
 		{
 			VertexAttribDesc vad = VertexDescInfo[i];
 			glEnableVertexAttribArray((GLuint)i);	
-			glVertexAttribPointer((GLuint)i, vad.Size, vad.Type, vad.Normalized, stride, reinterpret_cast<char*>(vad.Offset));
+			glVertexAttribPointer((GLuint)i, vad.Size, vad.Type, vad.Normalized, stride, reinterpret_cast<char*>(vertexOffset + vad.Offset));
 		}
 	}
 	void EndRender() { for (size_t i = 0; i < numVertexDescInfo; i++) glDisableVertexAttribArray((GLuint)i); }
@@ -271,12 +311,15 @@ struct DataBuffer
 	size_t				Size;
 	GLenum				Use;
 
-    DataBuffer(GLenum use, const void* buffer, size_t size) : Size(size), Use(use)
+	// Static buffers are only written by Update and CopyFrom, and are never mapped
+    DataBuffer(GLenum use, const void* buffer, size_t size, bool dynamic = true) : Size(size), Use(use)
     {
 		glGenBuffers(1, &GLBuffer);
 		glBindBuffer(use, GLBuffer);
-		glBufferData(use, size, buffer, GL_DYNAMIC_DRAW);
+		glBufferData(use, size, buffer, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
     }
+	~DataBuffer() { glDeleteBuffers(1, &GLBuffer); }
+
     void Refresh(const void* buffer, size_t size)
     {
 		glBindBuffer(Use, GLBuffer);
@@ -284,6 +327,52 @@ struct DataBuffer
 		memcpy((void *)v, buffer, size);
 		glUnmapBuffer(Use);
     }
+	void Update(size_t offset, const void* buffer, size_t size)
+	{
+		glBindBuffer(Use, GLBuffer);
+		glBufferSubData(Use, offset, size, buffer);
+	}
+	void CopyFrom(DataBuffer* source, size_t size)											// GL 2.1 has no glCopyBufferSubData: read back, then upload
+	{
+		void* data = OVR_ALLOC(size);
+		glBindBuffer(source->Use, source->GLBuffer);
+		glGetBufferSubData(source->Use, 0, size, data);
+		Update(0, data, size);
+		OVR_FREE(data);
+	}
+};
+
+//----------------------------------------------------------------
+// A static buffer the models' vertices or indices are appended to. Each range is written once,
+// when its model is added; when the buffer is full it is replaced by one twice as large, and the
+// ranges already in use are copied over. Models keep the ArenaBuffer, not the DataBuffer, which
+// may change while a scene is being built.
+#define ARENABUFFER_INITIAL_SIZE    (64*1024)
+
+struct ArenaBuffer
+{
+    DataBuffer        * Buffer;		// NULL until the first Append
+	GLenum				Use;
+	size_t				ElementSize, numElements;
+
+    ArenaBuffer(GLenum use, size_t elementSize) : Buffer(NULL), Use(use), ElementSize(elementSize), numElements(0) {}
+
+	// Returns the index of the first element appended
+	int Append(const void* elements, size_t count)
+	{
+		size_t used = numElements * ElementSize, needed = used + count * ElementSize;
+		if (!Buffer || needed > Buffer->Size)
+		{
+			size_t capacity = Buffer ? 2 * Buffer->Size : ARENABUFFER_INITIAL_SIZE;
+			while (capacity < needed) capacity *= 2;
+			DataBuffer * grown = new DataBuffer(Use, NULL, capacity, false);
+			if (Buffer) { grown->CopyFrom(Buffer, used); delete Buffer; }
+			Buffer = grown;
+		}
+		Buffer->Update(used, elements, count * ElementSize);
+		numElements += count;
+		return (int)(numElements - count);
+	}
 };
 
 //---------------------------------------------------------------------------
@@ -308,21 +397,20 @@ struct Model
     Quatf        Rot;
     Matrix4f     Mat;
     int          numVertices, numIndices;
-    Vertex       Vertices[2000]; //Note fixed maximum
-    uint16_t     Indices[2000];
+    ArrayPOD<Vertex>   Vertices;  // Only until AllocateBuffers has put them in the arenas
+    ArrayPOD<uint32_t> Indices;   // Relative to the model's first vertex
     ShaderFill * Fill;
-    DataBuffer * VertexBuffer, * IndexBuffer;  
+    ArenaBuffer * VertexArena, * IndexArena;
+    int          BaseVertex, FirstIndex;
    
-    Model(Vector3f arg_pos, ShaderFill * arg_Fill ) { numVertices=0;numIndices=0;Pos = arg_pos; Fill = arg_Fill; }
+    Model(Vector3f arg_pos, ShaderFill * arg_Fill ) : VertexArena(NULL), IndexArena(NULL), BaseVertex(0), FirstIndex(0)
+                                                    { numVertices=0;numIndices=0;Pos = arg_pos; Fill = arg_Fill; }
     Matrix4f& GetMatrix()                           { Mat = Matrix4f(Rot); Mat = Matrix4f::Translation(Pos) * Mat; return Mat;   }
-    void AddVertex(const Vertex& v)                 { Vertices[numVertices++] = v; OVR_ASSERT(numVertices<2000); }
-    void AddIndex(uint16_t a)                       { Indices[numIndices++] = a;   OVR_ASSERT(numIndices<2000);  }
+    void AddVertex(const Vertex& v)                 { Vertices.PushBack(v); numVertices++; }
+    void AddIndex(uint32_t a)                       { Indices.PushBack(a);  numIndices++;  }
 
-    void AllocateBuffers()
-    {
-		VertexBuffer = new DataBuffer(GL_ARRAY_BUFFER, &Vertices[0], numVertices * sizeof(Vertex));
-        IndexBuffer  = new DataBuffer(GL_ELEMENT_ARRAY_BUFFER, &Indices[0], numIndices * 2);
-    }
+    void AllocateBuffers();
+    void Render();
 
     void Model::AddSolidColorBox(float x1, float y1, float z1, float x2, float y2, float z2, Color c)
     {
@@ -345,7 +433,7 @@ struct Model
                                   16, 17, 19,  19, 17, 18,  21, 20, 22,  22, 20, 23 };
         
         for(int i = 0; i < 36; i++)
-            AddIndex(CubeIndices[i] + (uint16_t) numVertices);
+            AddIndex(CubeIndices[i] + (uint32_t) numVertices);
 
         for(int v = 0; v < 24; v++)
         {
@@ -364,6 +452,47 @@ struct Model
         }
     }
 };
+
+//-------------------------------------------------------------------------
+// Shared by all the models: models up to 65536 vertices use 16 bit indices
+struct ModelArenas
+{
+    ArenaBuffer Vertices, Indices16, Indices32;
+
+    ModelArenas() : Vertices(GL_ARRAY_BUFFER, sizeof(Model::Vertex)),
+                    Indices16(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t)),
+                    Indices32(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t)) {}
+} ModelArena;
+
+void Model::AllocateBuffers()
+{
+    if (!numIndices) return;
+    VertexArena = &ModelArena.Vertices;
+    BaseVertex  = VertexArena->Append(&Vertices[0], numVertices);
+    if (numVertices <= 65536)
+    {
+        ArrayPOD<uint16_t> indices16;
+        indices16.Resize(numIndices);
+        for (int i = 0; i < numIndices; i++) indices16[i] = (uint16_t)Indices[i];
+        IndexArena = &ModelArena.Indices16;
+        FirstIndex = IndexArena->Append(&indices16[0], numIndices);
+    }
+    else
+    {
+        IndexArena = &ModelArena.Indices32;
+        FirstIndex = IndexArena->Append(&Indices[0], numIndices);
+    }
+    Vertices.ClearAndRelease();
+    Indices.ClearAndRelease();
+}
+
+void Model::Render()
+{
+    if (!IndexArena) return;
+    OGL.Render(Fill, VertexArena->Buffer, IndexArena->Buffer, sizeof(Vertex), numIndices,
+               FirstIndex, BaseVertex, (int)IndexArena->ElementSize);
+}
+
 //------------------------------------------------------------------------- 
 struct Scene  
 {
@@ -514,14 +643,10 @@ struct Scene
             Matrix4f modelmat	= Models[i]->GetMatrix();
             Matrix4f mat		= (view * modelmat).Transposed();
 
-			glUseProgram(Models[i]->Fill->Prog);
-			GLint ProjLoc = glGetUniformLocation(Models[i]->Fill->Prog, "Proj");
-			GLint ViewLoc = glGetUniformLocation(Models[i]->Fill->Prog, "View");
-			if (ProjLoc >= 0) glUniformMatrix4fv(ProjLoc, 1, 0, &proj.M[0][0]);
-			if (ViewLoc >= 0) glUniformMatrix4fv(ViewLoc, 1, 0, &mat.M[0][0]);
+			Models[i]->Fill->SetUniform(ShaderFill::Uniform_Proj, 16, &proj.M[0][0]);
+			Models[i]->Fill->SetUniform(ShaderFill::Uniform_View, 16, &mat.M[0][0]);
 
-            OGL.Render(Models[i]->Fill, Models[i]->VertexBuffer,  Models[i]->IndexBuffer,
-                        sizeof(Model::Vertex), Models[i]->numIndices);
+            Models[i]->Render();
         }
     }
 };
@@ -733,12 +858,14 @@ bool OpenGL::InitWindowAndDevice(HINSTANCE hinst, Recti vp, bool windowed)
 }
 
 //---------------------------------------------------------------------------------------------
-void OpenGL::Render(ShaderFill* fill, DataBuffer* vertices, DataBuffer* indices,UINT stride, int count)
+void OpenGL::Render(ShaderFill* fill, DataBuffer* vertices, DataBuffer* indices,UINT stride, int count,
+                    int firstIndex, int baseVertex, int indexSize)
 {
 	glBindBuffer(GL_ARRAY_BUFFER, vertices->GLBuffer);
-	fill->BeginRender(stride);
+	fill->BeginRender(stride, (size_t)baseVertex * stride);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices->GLBuffer);
-    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, NULL);
+    glDrawElements(GL_TRIANGLES, count, indexSize == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT,
+                   reinterpret_cast<char*>((size_t)firstIndex * indexSize));
 	fill->EndRender();
 }
 
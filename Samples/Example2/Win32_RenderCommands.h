@@ -0,0 +1,270 @@
+/************************************************************************************
+Filename    :   Win32_RenderCommands.h
+Content     :   Scene draws recorded once per frame, sorted by state and replayed per eye
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// Scene::Render() goes through every model for each eye and binds the whole pipeline again for each draw. Here the
+// scene is recorded once per frame, timesToRenderScene times over, into a list of draws sorted by ShaderFill and then
+// by model, and that list is replayed for each eye:
+//  - Shaders, input layout or vertex attributes, sampler and texture are bound once per ShaderFill, Proj once per
+//    ShaderFill. All the models share the vertex and index arenas, bound once; on GL, which has no base vertex, the
+//    attribute pointers are moved to each model's first vertex. Each draw only sets View and draws.
+//  - On D3D with a constant ring, the constants of RENDERCOMMANDS_BATCH draws are written with a single Map, and each
+//    draw binds its own range. Otherwise each draw refreshes the shared constant buffer, as DirectX11::Render() does.
+// Both eyes have their own render target and may be skipped or redirected by the example features, so the eyes are
+// replayed one after the other rather than drawn as instances of a single pass.
+
+#ifndef RENDERCOMMANDS_H_
+#define RENDERCOMMANDS_H_
+
+#include "Kernel/OVR_Array.h"
+#include "Kernel/OVR_Alg.h"
+
+#define RENDERCOMMANDS_MAX_FILLS		32
+#define RENDERCOMMANDS_BATCH			1024		// D3D draws whose constants share one Map of the constant ring
+#define RENDERCOMMANDS_STATS_FRAMES		200			// Frames averaged in each draw timing report
+
+
+// ==================================================================================//
+//  RenderCommandList Class
+// ==================================================================================//
+class RenderCommandList
+{
+private:
+
+	struct Command
+	{
+		uint64_t					uiSortKey;																			// Fill, model, copy: draws sharing state end up next to each other
+		Matrix4f					ModelMat;
+		DataBuffer				   *pVertexBuffer;
+		DataBuffer				   *pIndexBuffer;
+		int							iFill;
+		int							iNbIndices;
+		int							iFirstIndex;																		// Range of the model in the arenas
+		int							iBaseVertex;
+		int							iIndexSize;
+	};
+
+	ShaderFill				   *Fills[RENDERCOMMANDS_MAX_FILLS];													// In the order they were first recorded
+	int							iNbFills;
+	ArrayPOD<Command>			Commands;
+
+	// Scene draw CPU time, summed over both eyes
+	double						dDrawTime;
+	int							iNbTimedFrames;
+	bool						bTimingRecorded;
+
+public:
+
+	// Constructor
+	RenderCommandList() : iNbFills(0), dDrawTime(0.0), iNbTimedFrames(0), bTimingRecorded(false) {}
+
+	// Once per frame, after the models have been moved
+	void Record(Scene &scene, int iTimesToRender)
+	{
+		Commands.Clear();
+		for (int i = 0; i < scene.num_models; i++)
+		{
+			Model *pModel	= scene.Models[i];
+			int iFill		= GetFillIndex(pModel->Fill);
+			if (iFill < 0 || !pModel->IndexArena) { continue; }
+
+			Command Cmd;
+			Cmd.ModelMat		= pModel->GetMatrix();
+			Cmd.pVertexBuffer	= pModel->VertexArena->Buffer;
+			Cmd.pIndexBuffer	= pModel->IndexArena->Buffer;
+			Cmd.iFill			= iFill;
+			Cmd.iNbIndices		= pModel->numIndices;
+			Cmd.iFirstIndex		= pModel->FirstIndex;
+			Cmd.iBaseVertex		= pModel->BaseVertex;
+			Cmd.iIndexSize		= (int)pModel->IndexArena->ElementSize;
+			for (int t = 0; t < iTimesToRender; t++)
+			{
+				Cmd.uiSortKey = ((uint64_t)iFill << 48) | ((uint64_t)i << 32) | (uint64_t)t;
+				Commands.PushBack(Cmd);
+			}
+		}
+		Alg::QuickSort(Commands, CommandLess);
+	}
+
+	// Same arguments as Scene::Render(): proj is already transposed
+	void Replay(const Matrix4f &view, const Matrix4f &proj)
+	{
+		int iCurrentFill = -1;
+		DataBuffer *pCurrentVertexBuffer = NULL, *pCurrentIndexBuffer = NULL;
+	#if RENDER_OPENGL
+		size_t uiNbEnabledAttribs = 0;
+		int iCurrentBaseVertex = -1;
+
+		for (size_t i = 0; i < Commands.GetSize(); i++)
+		{
+			const Command &Cmd	= Commands[i];
+			ShaderFill *pFill	= Fills[Cmd.iFill];
+			bool bNewFill		= (Cmd.iFill != iCurrentFill);
+			Matrix4f mat		= (view * Cmd.ModelMat).Transposed();
+			GLint ViewLoc		= pFill->UniformLocations[ShaderFill::Uniform_View];
+			GLint ProjLoc		= pFill->UniformLocations[ShaderFill::Uniform_Proj];
+
+			if (bNewFill)
+			{
+				glUseProgram(pFill->Prog);
+				if (pFill->OneTexture)
+				{
+					glActiveTexture(GL_TEXTURE0);
+					glBindTexture(GL_TEXTURE_2D, pFill->OneTexture->TexId);
+				}
+				if (ProjLoc >= 0) glUniformMatrix4fv(ProjLoc, 1, 0, &proj.M[0][0]);
+			}
+			if (bNewFill || Cmd.pVertexBuffer != pCurrentVertexBuffer || Cmd.iBaseVertex != iCurrentBaseVertex)		// The attribute pointers carry the model's first vertex
+			{
+				size_t uiVertexOffset = (size_t)Cmd.iBaseVertex * sizeof(Model::Vertex);
+				glBindBuffer(GL_ARRAY_BUFFER, Cmd.pVertexBuffer->GLBuffer);
+				for (size_t a = 0; a < pFill->numVertexDescInfo; a++)
+				{
+					const ShaderFill::VertexAttribDesc &vad = pFill->VertexDescInfo[a];
+					glVertexAttribPointer((GLuint)a, vad.Size, vad.Type, vad.Normalized, sizeof(Model::Vertex), reinterpret_cast<char*>(uiVertexOffset + vad.Offset));
+				}
+				for (size_t a = uiNbEnabledAttribs; a < pFill->numVertexDescInfo; a++) glEnableVertexAttribArray((GLuint)a);
+				for (size_t a = pFill->numVertexDescInfo; a < uiNbEnabledAttribs; a++) glDisableVertexAttribArray((GLuint)a);
+				uiNbEnabledAttribs = pFill->numVertexDescInfo;
+			}
+			if (Cmd.pIndexBuffer != pCurrentIndexBuffer) { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Cmd.pIndexBuffer->GLBuffer); }
+			if (ViewLoc >= 0) glUniformMatrix4fv(ViewLoc, 1, 0, &mat.M[0][0]);
+			glDrawElements(GL_TRIANGLES, Cmd.iNbIndices, (Cmd.iIndexSize == 4 ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT),
+						   reinterpret_cast<char*>((size_t)Cmd.iFirstIndex * Cmd.iIndexSize));
+
+			iCurrentFill			= Cmd.iFill;
+			iCurrentBaseVertex		= Cmd.iBaseVertex;
+			pCurrentVertexBuffer	= Cmd.pVertexBuffer;
+			pCurrentIndexBuffer		= Cmd.pIndexBuffer;
+		}
+		for (size_t a = 0; a < uiNbEnabledAttribs; a++) glDisableVertexAttribArray((GLuint)a);								// As OpenGL::Render() leaves them
+	#else
+		WND.Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+		for (size_t uiBatch = 0; uiBatch < Commands.GetSize(); uiBatch += RENDERCOMMANDS_BATCH)
+		{
+			size_t uiBatchEnd = Alg::Min(Commands.GetSize(), uiBatch + RENDERCOMMANDS_BATCH);
+
+			// The constants of the whole batch, through one Map of the ring
+			UINT uiFirstConstant = 0;
+			unsigned char *pConstants = NULL;
+			if (WND.UniformRing)
+			{
+				size_t uiSize = 0;
+				for (size_t i = uiBatch; i < uiBatchEnd; i++) { uiSize += ConstantRing::BlockSize(Fills[Commands[i].iFill]->VShader->UniformsSize); }
+				pConstants = WND.UniformRing->Map(uiSize, &uiFirstConstant);
+			}
+			if (pConstants)
+			{
+				size_t uiOffset = 0;
+				for (size_t i = uiBatch; i < uiBatchEnd; i++)
+				{
+					ShaderFill *pFill = Fills[Commands[i].iFill];
+					SetDrawUniforms(pFill, view, proj, Commands[i].ModelMat);
+					memcpy(pConstants + uiOffset, pFill->VShader->UniformData, pFill->VShader->UniformsSize);
+					uiOffset += ConstantRing::BlockSize(pFill->VShader->UniformsSize);
+				}
+				WND.UniformRing->Unmap();
+			}
+			else
+			{
+				WND.Context->VSSetConstantBuffers(0, 1, &WND.UniformBufferGen->D3DBuffer);
+			}
+
+			size_t uiOffset = 0;
+			for (size_t i = uiBatch; i < uiBatchEnd; i++)
+			{
+				const Command &Cmd	= Commands[i];
+				ShaderFill *pFill	= Fills[Cmd.iFill];
+
+				if (Cmd.iFill != iCurrentFill)
+				{
+					WND.Context->IASetInputLayout(pFill->InputLayout);
+					WND.Context->VSSetShader(pFill->VShader->D3DVert, NULL, 0);
+					WND.Context->PSSetShader(pFill->PShader->D3DPix, NULL, 0);
+					WND.Context->PSSetSamplers(0, 1, &pFill->SamplerState);
+					if (pFill->OneTexture) WND.Context->PSSetShaderResources(0, 1, &pFill->OneTexture->TexSv);
+				}
+				if (Cmd.pVertexBuffer != pCurrentVertexBuffer)
+				{
+					UINT stride = sizeof(Model::Vertex), offset = 0;
+					WND.Context->IASetVertexBuffers(0, 1, &Cmd.pVertexBuffer->D3DBuffer, &stride, &offset);
+				}
+				if (Cmd.pIndexBuffer != pCurrentIndexBuffer)
+				{
+					WND.Context->IASetIndexBuffer(Cmd.pIndexBuffer->D3DBuffer, (Cmd.iIndexSize == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT), 0);
+				}
+				if (pConstants)
+				{
+					WND.UniformRing->Bind(uiFirstConstant + (UINT)(uiOffset/16), pFill->VShader->UniformsSize);
+					uiOffset += ConstantRing::BlockSize(pFill->VShader->UniformsSize);
+				}
+				else
+				{
+					SetDrawUniforms(pFill, view, proj, Cmd.ModelMat);
+					WND.UniformBufferGen->Refresh(pFill->VShader->UniformData, pFill->VShader->UniformsSize);
+				}
+				WND.Context->DrawIndexed(Cmd.iNbIndices, Cmd.iFirstIndex, Cmd.iBaseVertex);
+
+				iCurrentFill			= Cmd.iFill;
+				pCurrentVertexBuffer	= Cmd.pVertexBuffer;
+				pCurrentIndexBuffer		= Cmd.pIndexBuffer;
+			}
+		}
+	#endif
+	}
+
+	// Scene draw CPU time of one frame, both eyes, through Replay() or Scene::Render(). Reported every
+	// RENDERCOMMANDS_STATS_FRAMES frames, the average restarts when switching from one to the other.
+	void AddFrameTime(double dSeconds, bool bRecorded, int iNbDraws)
+	{
+		if (bRecorded != bTimingRecorded) { dDrawTime = 0.0; iNbTimedFrames = 0; bTimingRecorded = bRecorded; }
+		dDrawTime += dSeconds;
+		if (++iNbTimedFrames < RENDERCOMMANDS_STATS_FRAMES) { return; }
+		OVR_DEBUG_LOG(("Scene draws (%s): %d per eye, %.3f ms of CPU per frame", (bRecorded ? "recorded" : "direct"),
+					   iNbDraws, 1000.0*dDrawTime/iNbTimedFrames));
+		dDrawTime		= 0.0;
+		iNbTimedFrames	= 0;
+	}
+
+private:
+
+	static bool CommandLess(const Command &a, const Command &b) { return (a.uiSortKey < b.uiSortKey); }
+
+	int GetFillIndex(ShaderFill *pFill)
+	{
+		for (int i = 0; i < iNbFills; i++)
+		{
+			if (Fills[i] == pFill) { return i; }
+		}
+		if (iNbFills >= RENDERCOMMANDS_MAX_FILLS) { OVR_ASSERT(false); return -1; }
+		Fills[iNbFills] = pFill;
+		return iNbFills++;
+	}
+
+#if !RENDER_OPENGL
+	static void SetDrawUniforms(ShaderFill *pFill, const Matrix4f &view, const Matrix4f &proj, const Matrix4f &modelMat)
+	{
+		Matrix4f mat = (view * modelMat).Transposed();
+		pFill->SetUniform(ShaderFill::Uniform_View, 16, (float *) &mat);
+		pFill->SetUniform(ShaderFill::Uniform_Proj, 16, (float *) &proj);
+	}
+#endif
+};
+
+#endif // RENDERCOMMANDS_H_
@@ -131,7 +131,7 @@ void APP_RENDER_DistortAndPresent()
         ovrFovPort  fov = { 1, 1, 1, 1 };
         Matrix4f    proj = ovrMatrix4f_Projection(fov, 0.15f, 2, true);
 
-        pLatencyTestScene->Models[0]->Fill->VShader->SetUniform("NewCol", 4, col);
+        pLatencyTestScene->Models[0]->Fill->SetUniform(ShaderFill::Uniform_NewCol, 4, col);
         pLatencyTestScene->Render(view, proj.Transposed());
     }
 
@@ -149,8 +149,8 @@ void APP_RENDER_DistortAndPresent()
         ovrVector2f UVScaleOffset[2];
         ovrHmd_GetRenderScaleAndOffset(EyeRenderDesc[eye].Fov,
                                        pEyeRenderTexture[eye]->Size, EyeRenderViewport[eye], UVScaleOffset);
-        useShaderfill->VShader->SetUniform("EyeToSourceUVScale", 2, (float*)&UVScaleOffset[0]);
-        useShaderfill->VShader->SetUniform("EyeToSourceUVOffset", 2, (float *)&UVScaleOffset[1]);
+        useShaderfill->SetUniform(ShaderFill::Uniform_EyeToSourceUVScale, 2, (float*)&UVScaleOffset[0]);
+        useShaderfill->SetUniform(ShaderFill::Uniform_EyeToSourceUVOffset, 2, (float *)&UVScaleOffset[1]);
 
         ovrMatrix4f    timeWarpMatrices[2];
         Quatf extraYawSinceRender = Quatf(Vector3f(0, 1, 0), Yaw - *useYaw);
@@ -162,8 +162,8 @@ void APP_RENDER_DistortAndPresent()
 
         timeWarpMatrices[0] = ((Matrix4f)timeWarpMatrices[0]).Transposed();
         timeWarpMatrices[1] = ((Matrix4f)timeWarpMatrices[1]).Transposed();
-        useShaderfill->VShader->SetUniform("EyeRotationStart", 16, (float *)&timeWarpMatrices[0]);
-        useShaderfill->VShader->SetUniform("EyeRotationEnd",   16, (float *)&timeWarpMatrices[1]);
+        useShaderfill->SetUniform(ShaderFill::Uniform_EyeRotationStart, 16, (float *)&timeWarpMatrices[0]);
+        useShaderfill->SetUniform(ShaderFill::Uniform_EyeRotationEnd,   16, (float *)&timeWarpMatrices[1]);
 
         // Perform distortion
         DX11.Render(useShaderfill, MeshVBs[eye], MeshIBs[eye], sizeof(ovrDistortionVertex), (int)MeshVBs[eye]->Size);
@@ -39,6 +39,7 @@ limitations under the License.
 #endif
 #include "OVR_CAPI.h"                  // Include the OculusVR SDK
 #include "Win32_WebCam.h"			   // Include WebCamDevice class
+#include "Win32_RenderCommands.h"	   // Include RenderCommandList class
 
 ovrHmd           HMD;                  // The handle of the headset
 ovrEyeRenderDesc EyeRenderDesc[2];     // Description of the VR.
@@ -139,6 +140,10 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE, LPSTR, int)
     // Create the room model
     Scene roomScene(false); // Can simplify scene further with parameter if required.
 
+    // Scene draws recorded once per frame and replayed for each eye ('C' toggles back to Scene::Render)
+    RenderCommandList roomCommands;
+    bool              bRecordedDraws = true;
+
     // Initialize Webcams and threads
 	WebCamManager WebCamMngr(HMD);
 
@@ -179,10 +184,23 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE, LPSTR, int)
 
 		// Get both eye poses simultaneously, with IPD offset already included. 
 		ovrPosef temp_EyeRenderPose[2];
-		ovrHmd_GetEyePoses(HMD, 0, useHmdToEyeViewOffset, temp_EyeRenderPose, NULL);
+		ovrTrackingState hmdState;
+		ovrHmd_GetEyePoses(HMD, 0, useHmdToEyeViewOffset, temp_EyeRenderPose, &hmdState);
+
+		// Keyboard input to switch from "look through" to scene mode
+		static bool bOldLookThrough	= false;
+		if (WND.Key['X'] && bOldLookThrough != WND.Key['X']) { bLookThrough = !bLookThrough; }
+		bOldLookThrough = WND.Key['X'];
 
-		// Update textures with WebCams' frames
-		WebCamMngr.Update();	
+		// Update textures with WebCams' frames, and the head poses used to reproject them (hand gestures can switch modes too)
+		WebCamMngr.Update(hmdState);	
+
+        static bool bOldRecordedKey = false;
+        if (WND.Key['C'] && !bOldRecordedKey) { bRecordedDraws = !bRecordedDraws; }
+        bOldRecordedKey = WND.Key['C'];
+        double sceneDrawTime = 0;
+        if (bRecordedDraws && !bLookThrough)
+            roomCommands.Record(roomScene, timesToRenderScene);
 
         // Render the two undistorted eye views into their render buffers.  
         for (int eye = 0; eye < 2; eye++)
@@ -220,23 +238,29 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE, LPSTR, int)
                 Matrix4f view = Matrix4f::LookAtRH(shiftedEyePos, shiftedEyePos + finalForward, finalUp);
                 Matrix4f proj = ovrMatrix4f_Projection(EyeRenderDesc[eye].Fov, 0.2f, 1000.0f, true); 
 
-				// Keyboard input to switch from "look through" to scene mode
-				static bool bOldLookThrough	= false;
-				if (WND.Key['X'] && bOldLookThrough != WND.Key['X']) { bLookThrough = !bLookThrough; }
-				bOldLookThrough = WND.Key['X'];
-
 				if(!bLookThrough)
 				{
 					// Render the scene
-					for (int t=0; t<timesToRenderScene; t++)
-						roomScene.Render(view, proj.Transposed());
+					double sceneDrawStart = ovr_GetTimeInSeconds();
+					if (bRecordedDraws)
+						roomCommands.Replay(view, proj.Transposed());
+					else
+						for (int t=0; t<timesToRenderScene; t++)
+							roomScene.Render(view, proj.Transposed());
+					sceneDrawTime += ovr_GetTimeInSeconds() - sceneDrawStart;
 
 					WebCamMngr.DrawBoard(view, proj.Transposed());
 				}
-				else { WebCamMngr.DrawLookThrough(eye); }
+				else { WebCamMngr.DrawLookThrough(eye, proj, useEyePose->Orientation); }
             }
         }
 
+		if (sceneDrawTime > 0)
+			roomCommands.AddFrameTime(sceneDrawTime, bRecordedDraws, timesToRenderScene*roomScene.num_models);
+
+		// Tell the SDK which WebCam frame this frame shows
+		WebCamMngr.ReportFrameTiming();
+
         // Do distortion rendering, Present and flush/sync
     #if SDK_RENDER
 		#if RENDER_OPENGL
@@ -263,6 +287,9 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE, LPSTR, int)
     #else
         APP_RENDER_DistortAndPresent();
     #endif
+
+		// Latency statistics of the WebCams' frames
+		WebCamMngr.FrameDisplayed();
     }
 
 	WebCamMngr.StopCapture();
@@ -151,9 +151,7 @@ void APP_RENDER_DistortAndPresent()
         ovrFovPort  fov = { 1, 1, 1, 1 };
         Matrix4f    proj = ovrMatrix4f_Projection(fov, 0.15f, 2, true);
 
-		glUseProgram(pLatencyTestScene->Models[0]->Fill->Prog);
-		GLint NewCol = glGetUniformLocation(pLatencyTestScene->Models[0]->Fill->Prog, "NewCol");
-		if (NewCol >= 0) glUniform4fv(NewCol, 1, col);
+		pLatencyTestScene->Models[0]->Fill->SetUniform(ShaderFill::Uniform_NewCol, 4, col);
         pLatencyTestScene->Render(view, proj.Transposed());
     }
 
@@ -172,11 +170,8 @@ void APP_RENDER_DistortAndPresent()
         ovrHmd_GetRenderScaleAndOffset(EyeRenderDesc[eye].Fov,
                                        pEyeRenderTexture[eye]->Size, EyeRenderViewport[eye], UVScaleOffset);
 
-		glUseProgram(useShaderfill->Prog);
-		GLint EyeToSourceUVScale  = glGetUniformLocation(useShaderfill->Prog, "EyeToSourceUVScale");
-		GLint EyeToSourceUVOffset = glGetUniformLocation(useShaderfill->Prog, "EyeToSourceUVOffset");
-		if (EyeToSourceUVScale >= 0)  glUniform2fv(EyeToSourceUVScale, 1, (float*)&UVScaleOffset[0]);
-		if (EyeToSourceUVOffset >= 0) glUniform2fv(EyeToSourceUVOffset, 1, (float*)&UVScaleOffset[1]);
+		useShaderfill->SetUniform(ShaderFill::Uniform_EyeToSourceUVScale, 2, (float*)&UVScaleOffset[0]);
+		useShaderfill->SetUniform(ShaderFill::Uniform_EyeToSourceUVOffset, 2, (float*)&UVScaleOffset[1]);
 
         ovrMatrix4f    timeWarpMatrices[2];
         Quatf extraYawSinceRender = Quatf(Vector3f(0, 1, 0), Yaw - *useYaw);
@@ -188,10 +183,8 @@ void APP_RENDER_DistortAndPresent()
 
         timeWarpMatrices[0] = ((Matrix4f)timeWarpMatrices[0]).Transposed();
         timeWarpMatrices[1] = ((Matrix4f)timeWarpMatrices[1]).Transposed();
-		GLint EyeRotationStart = glGetUniformLocation(useShaderfill->Prog, "EyeRotationStart");
-		GLint EyeRotationEnd   = glGetUniformLocation(useShaderfill->Prog, "EyeRotationEnd");
-		if (EyeRotationStart >= 0) glUniformMatrix4fv(EyeRotationStart, 1, 0, &timeWarpMatrices[0].M[0][0]);
-		if (EyeRotationEnd >= 0)   glUniformMatrix4fv(EyeRotationEnd, 1, 0, &timeWarpMatrices[1].M[0][0]);
+		useShaderfill->SetUniform(ShaderFill::Uniform_EyeRotationStart, 16, &timeWarpMatrices[0].M[0][0]);
+		useShaderfill->SetUniform(ShaderFill::Uniform_EyeRotationEnd, 16, &timeWarpMatrices[1].M[0][0]);
 
         // Perform distortion
         OGL.Render(useShaderfill, MeshVBs[eye], MeshIBs[eye], sizeof(ovrDistortionVertex), (int)(MeshIBs[eye]->Size/sizeof(unsigned short)));
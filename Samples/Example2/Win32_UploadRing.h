@@ -0,0 +1,260 @@
+/************************************************************************************
+Filename    :   Win32_UploadRing.h
+Content     :   Ring of persistently mapped upload buffers for the webcam frames
+Created     :   October 16th, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*************************************************************************************/
+
+// Each FrameMailbox slot gets its own piece of GPU upload memory, and the slot cv::Mat is just a header over it,
+// so the capture thread decodes/converts directly into memory the GPU can read and the render thread only issues
+// the copy to the texture:
+//  - OpenGL: one GL_ARB_buffer_storage PBO, persistently and coherently mapped, split in N slots. A fence is
+//            inserted after each glTexSubImage2D and the slot is handed back to the capture thread only once signaled.
+//  - D3D11:  one staging texture per slot, kept mapped while the capture thread owns it. It is unmapped right before
+//            CopyResource and mapped again (D3D11_MAP_FLAG_DO_NOT_WAIT) once the GPU has finished copying from it.
+// Reclaim() must succeed on the current front slot before FrameMailbox::Acquire() gives it back to the producer.
+// The slots hold the camera's bytes as they are (BGR, YUYV or NV12), and the texel helpers below lay them out in the
+// texture the way the pixel shader unpacks them.
+
+#ifndef UPLOADRING_H_
+#define UPLOADRING_H_
+
+#define UPLOADRING_SLOTS				FRAMEMAILBOX_SLOTS
+#define UPLOADRING_SLOT_ALIGNMENT		256			// Start of each slot in the GL buffer
+
+#if RENDER_OPENGL
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT				0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT			0x0040
+#define GL_MAP_COHERENT_BIT				0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE	0x9117
+#define GL_ALREADY_SIGNALED				0x911A
+#define GL_CONDITION_SATISFIED			0x911C
+#define GL_SYNC_FLUSH_COMMANDS_BIT		0x00000001
+#endif
+
+// GL 4.4 / GL_ARB_buffer_storage and GL 3.2 / GL_ARB_sync entry points are not loaded by CAPI_GLE, so they are fetched here
+typedef void	(GLAPIENTRY *PFNUPLOADRINGBUFFERSTORAGE)	(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+typedef void*	(GLAPIENTRY *PFNUPLOADRINGMAPBUFFERRANGE)	(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+typedef GLsync	(GLAPIENTRY *PFNUPLOADRINGFENCESYNC)		(GLenum condition, GLbitfield flags);
+typedef GLenum	(GLAPIENTRY *PFNUPLOADRINGCLIENTWAITSYNC)	(GLsync sync, GLbitfield flags, GLuint64 timeout);
+typedef void	(GLAPIENTRY *PFNUPLOADRINGDELETESYNC)		(GLsync sync);
+#endif
+
+
+// ==================================================================================//
+//  UploadRing Class
+// ==================================================================================//
+class UploadRing
+{
+private:
+
+	bool						bEnabled;
+	int							iWidth, iRows, iCvType;																	// iRows: rows of a frame as uploaded, 1.5 times the height for NV12
+	unsigned char			   *pSlotData[UPLOADRING_SLOTS];
+	size_t						SlotPitch[UPLOADRING_SLOTS];
+#if RENDER_OPENGL
+	GLuint						uiBufferID;
+	GLsync						Fences[UPLOADRING_SLOTS];
+	int							iSlotSize;
+	PFNUPLOADRINGBUFFERSTORAGE	pglBufferStorage;
+	PFNUPLOADRINGMAPBUFFERRANGE	pglMapBufferRange;
+	PFNUPLOADRINGFENCESYNC		pglFenceSync;
+	PFNUPLOADRINGCLIENTWAITSYNC	pglClientWaitSync;
+	PFNUPLOADRINGDELETESYNC		pglDeleteSync;
+#else
+	ID3D11Texture2D			   *pStagingTex[UPLOADRING_SLOTS];
+	bool						bMapped[UPLOADRING_SLOTS];
+#endif
+
+public:
+
+	// Constructor
+	UploadRing() : bEnabled(false), iWidth(0), iRows(0), iCvType(0)
+	{
+		for(int i=0; i<UPLOADRING_SLOTS; i++)
+		{
+			pSlotData[i]	= NULL;
+			SlotPitch[i]	= 0;
+		#if RENDER_OPENGL
+			Fences[i]		= 0;
+		#else
+			pStagingTex[i]	= NULL;
+			bMapped[i]		= false;
+		#endif
+		}
+	#if RENDER_OPENGL
+		uiBufferID = 0;
+	#endif
+	}
+
+	// Destructor
+	~UploadRing() { Release(); }
+
+	bool IsEnabled() const { return bEnabled; }
+
+#if RENDER_OPENGL
+	// 3 channel frames are BGR, 4 channel frames RGBA. The YUV ones are unpacked by the pixel shader: 2 channel frames are YUYV pairs
+	// uploaded as one RGBA texel per 2 pixels, 1 channel frames are NV12 planes uploaded as luminance texels, the UV rows under the Y rows
+	static GLint GetTexelInternalFormat(int iType)		{ return (CV_MAT_CN(iType) == 3 ? GL_RGB : (CV_MAT_CN(iType) == 1 ? GL_LUMINANCE8 : GL_RGBA8)); }
+	static GLenum GetTexelFormat(int iType)				{ return (CV_MAT_CN(iType) == 3 ? GL_BGR : (CV_MAT_CN(iType) == 1 ? GL_LUMINANCE : GL_RGBA)); }
+	static int GetTexelWidth(int iW, int iType)			{ return (CV_MAT_CN(iType) == 2 ? iW/2 : iW); }
+#else
+	// 4 channel frames map to RGBA texels, anything else is uploaded as raw bytes in an R8 texture unpacked by the pixel shader
+	static DXGI_FORMAT GetTexelFormat(int iType)		{ return (CV_MAT_CN(iType) == 4 ? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_R8_UNORM); }
+	static UINT GetTexelWidth(int iW, int iType)		{ return (CV_MAT_CN(iType) == 4 ? iW : iW*CV_ELEM_SIZE(iType)); }
+#endif
+
+	// Allocates the upload memory and points the Slots headers to it. Returns false (and leaves Slots untouched) if not supported.
+	// The slots are sized for frames of iFrameRows rows of iW pixels of type iType: WebCamMode::GetFrameRows() and GetCvType() for the camera's format.
+	bool Initialize(int iW, int iFrameRows, int iType, cv::Mat *Slots)
+	{
+		iWidth	= iW;
+		iRows	= iFrameRows;
+		iCvType	= iType;
+		size_t Pitch = (size_t)(iWidth*CV_ELEM_SIZE(iCvType));
+
+	#if RENDER_OPENGL
+		pglBufferStorage	= (PFNUPLOADRINGBUFFERSTORAGE)wglGetProcAddress("glBufferStorage");
+		pglMapBufferRange	= (PFNUPLOADRINGMAPBUFFERRANGE)wglGetProcAddress("glMapBufferRange");
+		pglFenceSync		= (PFNUPLOADRINGFENCESYNC)wglGetProcAddress("glFenceSync");
+		pglClientWaitSync	= (PFNUPLOADRINGCLIENTWAITSYNC)wglGetProcAddress("glClientWaitSync");
+		pglDeleteSync		= (PFNUPLOADRINGDELETESYNC)wglGetProcAddress("glDeleteSync");
+		if(!pglBufferStorage || !pglMapBufferRange || !pglFenceSync || !pglClientWaitSync || !pglDeleteSync) { return false; }
+
+		iSlotSize = (((int)Pitch*iRows + UPLOADRING_SLOT_ALIGNMENT - 1) / UPLOADRING_SLOT_ALIGNMENT) * UPLOADRING_SLOT_ALIGNMENT;
+		GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;							// Coherent: CPU writes are visible to the GPU without explicit flushes
+		glGenBuffers(1, &uiBufferID);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uiBufferID);
+		pglBufferStorage(GL_PIXEL_UNPACK_BUFFER, iSlotSize*UPLOADRING_SLOTS, NULL, Flags);
+		unsigned char *pMapped = (unsigned char*)pglMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, iSlotSize*UPLOADRING_SLOTS, Flags);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if(!pMapped)
+		{
+			glDeleteBuffers(1, &uiBufferID);
+			uiBufferID = 0;
+			return false;
+		}
+		for(int i=0; i<UPLOADRING_SLOTS; i++) { pSlotData[i] = pMapped + i*iSlotSize; SlotPitch[i] = Pitch; }
+	#else
+		D3D11_TEXTURE2D_DESC dsDesc;
+		dsDesc.Width				= GetTexelWidth(iWidth, iCvType);
+		dsDesc.Height				= iRows;
+		dsDesc.MipLevels			= 1;
+		dsDesc.ArraySize			= 1;
+		dsDesc.Format				= GetTexelFormat(iCvType);
+		dsDesc.SampleDesc.Count		= 1;
+		dsDesc.SampleDesc.Quality	= 0;
+		dsDesc.Usage				= D3D11_USAGE_STAGING;
+		dsDesc.CPUAccessFlags		= D3D11_CPU_ACCESS_WRITE;
+		dsDesc.MiscFlags			= 0;
+		dsDesc.BindFlags			= 0;
+		for(int i=0; i<UPLOADRING_SLOTS; i++)
+		{
+			D3D11_MAPPED_SUBRESOURCE map;
+			if(FAILED(WND.Device->CreateTexture2D(&dsDesc, NULL, &pStagingTex[i])) ||
+			   FAILED(WND.Context->Map(pStagingTex[i], 0, D3D11_MAP_WRITE, 0, &map)))
+			{
+				Release();
+				return false;
+			}
+			bMapped[i]		= true;
+			pSlotData[i]	= (unsigned char*)map.pData;
+			SlotPitch[i]	= map.RowPitch;																				// The driver may pad the rows
+		}
+	#endif
+		for(int i=0; i<UPLOADRING_SLOTS; i++) { RestoreSlot(i, Slots[i]); }
+		bEnabled = true;
+		return true;
+	}
+
+	void Release()
+	{
+	#if RENDER_OPENGL
+		for(int i=0; i<UPLOADRING_SLOTS; i++) { if(Fences[i]) { pglDeleteSync(Fences[i]); Fences[i] = 0; } }
+		if(uiBufferID)
+		{
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uiBufferID);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			glDeleteBuffers(1, &uiBufferID);
+			uiBufferID = 0;
+		}
+	#else
+		for(int i=0; i<UPLOADRING_SLOTS; i++)
+		{
+			if(!pStagingTex[i]) { continue; }
+			if(bMapped[i]) { WND.Context->Unmap(pStagingTex[i], 0); bMapped[i] = false; }
+			pStagingTex[i]->Release();
+			pStagingTex[i] = NULL;
+		}
+	#endif
+		for(int i=0; i<UPLOADRING_SLOTS; i++) { pSlotData[i] = NULL; }
+		bEnabled = false;
+	}
+
+	// True when the frame still lives in the upload memory of its slot (cv::Mat reallocates if the camera changes its frame size)
+	bool IsSlotIntact(int iSlot, const cv::Mat &Slot) const { return !bEnabled || Slot.data == pSlotData[iSlot]; }
+
+	void RestoreSlot(int iSlot, cv::Mat &Slot) const { Slot = cv::Mat(iRows, iWidth, iCvType, pSlotData[iSlot], SlotPitch[iSlot]); }
+
+	// Render thread: true when the GPU is done with the slot, which can then be written by the capture thread again
+	bool Reclaim(int iSlot, cv::Mat &Slot)
+	{
+		if(!bEnabled) { return true; }
+	#if RENDER_OPENGL
+		OVR_UNUSED(Slot);
+		if(!Fences[iSlot]) { return true; }
+		GLenum Status = pglClientWaitSync(Fences[iSlot], GL_SYNC_FLUSH_COMMANDS_BIT, 0);								// Poll only, never wait
+		if(Status != GL_ALREADY_SIGNALED && Status != GL_CONDITION_SATISFIED) { return false; }
+		pglDeleteSync(Fences[iSlot]);
+		Fences[iSlot] = 0;
+		return true;
+	#else
+		if(bMapped[iSlot]) { return true; }
+		D3D11_MAPPED_SUBRESOURCE map;
+		if(WND.Context->Map(pStagingTex[iSlot], 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &map) != S_OK) { return false; }	// DXGI_ERROR_WAS_STILL_DRAWING while CopyResource is pending
+		bMapped[iSlot]		= true;
+		pSlotData[iSlot]	= (unsigned char*)map.pData;																	// The address may change from one Map to the next
+		SlotPitch[iSlot]	= map.RowPitch;
+		RestoreSlot(iSlot, Slot);
+		return true;
+	#endif
+	}
+
+	// Render thread: issues the copy from the slot to the texture, no CPU copy involved
+	void Upload(int iSlot, ImageBuffer *pImageBuffer)
+	{
+	#if RENDER_OPENGL
+		glBindTexture(GL_TEXTURE_2D, pImageBuffer->TexId);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uiBufferID);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);																			// The rows are packed in the slots, whatever the width and the format
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, GetTexelWidth(iWidth, iCvType), iRows, GetTexelFormat(iCvType), GL_UNSIGNED_BYTE, (GLvoid*)(size_t)(iSlot*iSlotSize));
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		Fences[iSlot] = pglFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	#else
+		WND.Context->Unmap(pStagingTex[iSlot], 0);
+		bMapped[iSlot] = false;
+		WND.Context->CopyResource(pImageBuffer->Tex, pStagingTex[iSlot]);
+	#endif
+	}
+};
+
+#endif // UPLOADRING_H_
@@ -27,12 +27,34 @@ limitations under the License.
 #define WEBCAM_1_DEVICE_NUMBER			1		// The device number for webcam 1 (eg.: Right Eye) among connected ones. If you have 2 webcams and they are inverted, swith the number with WEBCAM_0_DEVICE_NUMBER!
 #define WEBCAM_1_VERT_ORIENTATION		true	// Is webcam 1 (eg.: Right Eye) vertically positioned?
 #define WEBCAM_1_HMD_FOV_RATIO			1.0f	// The ratio: (Web Cam Diagonal Field of View) / (Oculus Rift Eye Field of View) for webcam 1 (eg.: Right Eye)
+#define WEBCAM_0_CALIBRATION_FILE		NULL	// eg. "WebCam0.yml": intrinsics, distortion and stereo rectification of webcam 0 (see WebCamCalibration.h). NULL = raw frames
+#define WEBCAM_1_CALIBRATION_FILE		NULL	// eg. "WebCam1.yml": same for webcam 1
+#define WEBCAM_PACKED_UPLOAD			1		// D3D only: upload the camera's bytes (BGR, YUYV or NV12) as they are and unpack them in the pixel shader, instead of converting them to RGBA on the CPU
+#define WEBCAM_REQUESTED_WIDTH			0		// Capture mode requested to the webcams (0 = camera default). The negotiated one is logged at startup
+#define WEBCAM_REQUESTED_HEIGHT			0
+#define WEBCAM_REQUESTED_FPS			0.0f
+#define WEBCAM_NATIVE_FORMAT			1		// Capture through Media Foundation in the camera's native YUYV or NV12, converted to RGB by the pixel shader (0 = cv::VideoCapture, BGR)
+#define WEBCAM_REQUEST_MJPEG			false	// Prefer MJPEG on the USB link even when raw YUV reaches the requested mode. Media Foundation picks MJPEG anyway when only it does (most webcams at 720p/1080p and high frame rates) and decodes it to YUV
+#define WEBCAM_REPLAY_FILE				NULL	// eg. "WebCam%d.raw": replay recorded frames instead of opening the webcams (%d = device number)
+#define WEBCAM_RECORD_FILE				NULL	// eg. "WebCam%d.raw": record the captured frames for later replay
+#define WEBCAM_HAND_WORKER				1		// Analyze the hand on its own thread, off the capture-to-display path (0 = in the capture thread, before the frame is published)
+#define WEBCAM_HAND_EVENT_QUEUE			8		// HandEvents waiting for the render thread
+#define WEBCAM_POSE_COMPENSATION		1		// Look through mode: rotate each frame by the head rotation since its capture, like timewarp does for the rendered eyes
+#define WEBCAM_POSE_HISTORY_SIZE		64		// Head orientations kept for the capture threads, one per rendered frame (about 0.85 s at 75 Hz)
+#define WEBCAM_PERF_LOG_FILE			NULL	// eg. "WebCamLatency.csv": log the latency histograms of webcam 0 with ovrHmd_StartPerfLog (in the OVR base path)
 
 #include "opencv2/highgui/highgui.hpp"	// Include OpenCV
 #include <opencv2/imgproc/imgproc.hpp>
 #include "Kernel/OVR_Log.h"
 #include "Kernel/OVR_Threads.h"
+#include "Kernel/OVR_Lockless.h"
+#include "FrameMailbox.h"
+#include "LocklessQueue.h"
+#include "WebCamSource.h"
+#include "Win32_UploadRing.h"
 #include "Hand.h"
+#include "Win32_HandOverlay.h"
+#include "WebCamCalibration.h"
 
 #if RENDER_OPENGL																							// Buffer Object
 bool bIsBOSupported						= false;
@@ -124,6 +146,40 @@ char* PixelShaderSrc					= "#version 110\n"
 										  "varying vec4 oColor;\n"
 										  "varying vec2 oTexCoord;\n"
 										  "void main() { gl_FragColor = oColor * texture2D(Texture0, oTexCoord); }\n";
+char* PixelShaderOverlaySrc				= "#version 110\n"
+										  "varying vec4 oColor;\n"
+										  "varying vec2 oTexCoord;\n"
+										  "void main() { gl_FragColor = oColor; }\n";
+#define YUV_TO_RGB																																				\
+										  "vec3 YUVToRGB(float Y, float U, float V) { Y = 1.164*(Y - 0.0625); U -= 0.5; V -= 0.5;\n"							\
+										  "  return clamp(vec3(Y + 1.596*V, Y - 0.392*U - 0.813*V, Y + 2.017*U), 0.0, 1.0); }\n"								// BT.601, limited range
+#define PACKED_PIXEL_SHADER_MAIN																																\
+										  "void main() {\n"																										\
+										  "  vec2 p = clamp(oTexCoord, 0.0, 1.0)*TexSize - 0.5; vec2 f = p - floor(p);\n"										\
+										  "  vec2 i0 = clamp(floor(p), vec2(0.0), TexSize - 1.0); vec2 i1 = min(i0 + 1.0, TexSize - 1.0);\n"					\
+										  "  vec3 c = mix(mix(LoadRGB(i0), LoadRGB(vec2(i1.x, i0.y)), f.x), mix(LoadRGB(vec2(i0.x, i1.y)), LoadRGB(i1), f.x), f.y);\n"	\
+										  "  gl_FragColor = oColor * vec4(c, 1.0); }\n"																			// Bilinear filtering done by hand: the sampler would blend the chroma of different pixels
+char* PixelShaderYUYVSrc				= "#version 110\n"
+										  "uniform sampler2D Texture0;\n"																	// One RGBA texel (Y0 U Y1 V) per 2 pixels, nearest filtering
+										  "uniform vec2 TexSize;\n"																			// Frame size in pixels
+										  "varying vec4 oColor;\n"
+										  "varying vec2 oTexCoord;\n"
+										  YUV_TO_RGB
+										  "vec3 LoadRGB(vec2 p) {\n"
+										  "  vec4 t = texture2D(Texture0, vec2((floor(p.x*0.5)+0.5)/(TexSize.x*0.5), (p.y+0.5)/TexSize.y));\n"
+										  "  return YUVToRGB((mod(p.x, 2.0) < 0.5 ? t.r : t.b), t.g, t.a); }\n"
+										  PACKED_PIXEL_SHADER_MAIN;
+char* PixelShaderNV12Src				= "#version 110\n"
+										  "uniform sampler2D Texture0;\n"																	// Luminance texture 1.5 times taller than the frame: the Y rows, then the U V rows. Nearest filtering
+										  "uniform vec2 TexSize;\n"																			// Frame size in pixels
+										  "varying vec4 oColor;\n"
+										  "varying vec2 oTexCoord;\n"
+										  YUV_TO_RGB
+										  "float LoadByte(float x, float y) { return texture2D(Texture0, vec2((x+0.5)/TexSize.x, (y+0.5)/(1.5*TexSize.y))).r; }\n"
+										  "vec3 LoadRGB(vec2 p) {\n"
+										  "  vec2 c = vec2(2.0*floor(p.x*0.5), TexSize.y + floor(p.y*0.5));\n"										// U V pair shared by 2x2 pixels
+										  "  return YUVToRGB(LoadByte(p.x, p.y), LoadByte(c.x, c.y), LoadByte(c.x + 1.0, c.y)); }\n"
+										  PACKED_PIXEL_SHADER_MAIN;
 #else
 D3D11_INPUT_ELEMENT_DESC QuadVertDesc[]	= {	{"Position", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, offsetof(Model::Vertex, Pos),   D3D11_INPUT_PER_VERTEX_DATA, 0},
 											{"Color",    0, DXGI_FORMAT_R8G8B8A8_UNORM,  0, offsetof(Model::Vertex, C),     D3D11_INPUT_PER_VERTEX_DATA, 0},
@@ -132,12 +188,97 @@ char* VertexShaderSrc					= "float4x4 Proj, View;"
 										  "void main(in  float4 Position  : POSITION,    in  float4 Color : COLOR0, in  float2 TexCoord  : TEXCOORD0,"
 										  "          out float4 oPosition : SV_Position, out float4 oColor: COLOR0, out float2 oTexCoord : TEXCOORD0)"
 										  "{ oPosition = mul(Proj, mul(View, Position)); oTexCoord = TexCoord; oColor = Color; }";
+#if WEBCAM_PACKED_UPLOAD
+#define PACKED_PIXEL_SHADER_MAIN(Width, Height)																					\
+										  "float4 main(in float4 Position : SV_Position, in float4 Color: COLOR0, in float2 TexCoord : TEXCOORD0) : SV_Target"	\
+										  "{ uint w, h; Texture.GetDimensions(w, h); int2 Size = int2(" #Width ", " #Height ");"								\
+										  "  float2 p = saturate(TexCoord)*Size - 0.5; float2 f = p - floor(p);"												\
+										  "  int2 i0 = clamp(int2(floor(p)), 0, Size-1); int2 i1 = min(i0+1, Size-1);"										\
+										  "  float3 c = lerp(lerp(LoadRGB(i0), LoadRGB(int2(i1.x,i0.y)), f.x), lerp(LoadRGB(int2(i0.x,i1.y)), LoadRGB(i1), f.x), f.y);"	\
+										  "  return Color * float4(c, 1); }"																// Bilinear filtering done by hand: the sampler would blend bytes of different channels
+#define YUV_TO_RGB																																				\
+										  "float3 YUVToRGB(float Y, float U, float V) { Y = 1.164*(Y - 0.0625); U -= 0.5; V -= 0.5;"							\
+										  "  return saturate(float3(Y + 1.596*V, Y - 0.392*U - 0.813*V, Y + 2.017*U)); }"										// BT.601, limited range
+char* PixelShaderSrc					= "Texture2D<float> Texture : register(t0);"														// R8 texture 3 times wider than the frame: B, G, R bytes of each pixel side by side
+										  "float3 LoadRGB(int2 p) { int x = 3*p.x; return float3(Texture.Load(int3(x+2,p.y,0)), Texture.Load(int3(x+1,p.y,0)), Texture.Load(int3(x,p.y,0))); }"
+										  PACKED_PIXEL_SHADER_MAIN(w/3, h);
+char* PixelShaderYUYVSrc				= "Texture2D<float> Texture : register(t0);"														// R8 texture 2 times wider than the frame: Y0 U Y1 V bytes of each pixel pair
+										  YUV_TO_RGB
+										  "float3 LoadRGB(int2 p) { int x = 4*(p.x/2);"
+										  "  return YUVToRGB(Texture.Load(int3(2*p.x,p.y,0)), Texture.Load(int3(x+1,p.y,0)), Texture.Load(int3(x+3,p.y,0))); }"
+										  PACKED_PIXEL_SHADER_MAIN(w/2, h);
+char* PixelShaderNV12Src				= "Texture2D<float> Texture : register(t0);"														// R8 texture 1.5 times taller than the frame: the Y rows, then the U V rows
+										  YUV_TO_RGB
+										  "float3 LoadRGB(int2 p) { uint w, h; Texture.GetDimensions(w, h); int2 c = int2(p.x & ~1, (int)(h*2/3) + p.y/2);"	// U V pair shared by 2x2 pixels
+										  "  return YUVToRGB(Texture.Load(int3(p,0)), Texture.Load(int3(c,0)), Texture.Load(int3(c.x+1,c.y,0))); }"
+										  PACKED_PIXEL_SHADER_MAIN(w, h*2/3);
+#else
 char* PixelShaderSrc					= "Texture2D Texture   : register(t0); SamplerState Linear : register(s0);"
 										  "float4 main(in float4 Position : SV_Position, in float4 Color: COLOR0, in float2 TexCoord : TEXCOORD0) : SV_Target"
 										  "{ return Color * Texture.Sample(Linear, TexCoord); }";
+#endif
+char* PixelShaderOverlaySrc				= "float4 main(in float4 Position : SV_Position, in float4 Color: COLOR0, in float2 TexCoord : TEXCOORD0) : SV_Target"
+										  "{ return Color; }";
 #endif 
 
 
+// ==================================================================================//
+//  WebCamHandFrame Struct
+// ==================================================================================//
+// Copy of a captured frame for the hand analysis worker, in the camera's format
+struct WebCamHandFrame
+{
+	cv::Mat						Frame;
+	double						dCaptureTime;
+
+	WebCamHandFrame() : dCaptureTime(0.0) {}
+};
+
+
+// ==================================================================================//
+//  HeadPoseHistory Struct
+// ==================================================================================//
+// Head orientations of the last rendered frames, at the times they were predicted for. Only the render thread
+// calls into the SDK: the capture threads read a copy through a LocklessUpdater and interpolate in it.
+struct HeadPoseHistory
+{
+	double						dTimes[WEBCAM_POSE_HISTORY_SIZE];
+	Quatf						Orientations[WEBCAM_POSE_HISTORY_SIZE];
+	int							iNbSamples;
+	int							iNewest;
+
+	HeadPoseHistory() : iNbSamples(0), iNewest(WEBCAM_POSE_HISTORY_SIZE-1) {}
+
+	void Add(double dTime, const Quatf &Orientation)																	// Times must increase
+	{
+		if(iNbSamples && dTime <= dTimes[iNewest]) { return; }
+		iNewest					= (iNewest + 1) % WEBCAM_POSE_HISTORY_SIZE;
+		dTimes[iNewest]			= dTime;
+		Orientations[iNewest]	= Orientation;
+		iNbSamples				= std::min(iNbSamples + 1, WEBCAM_POSE_HISTORY_SIZE);
+	}
+
+	Quatf GetOrientation(double dTime) const																			// Interpolated between the samples around dTime, clamped to the oldest and newest ones
+	{
+		if(!iNbSamples) { return Quatf(); }
+		int iNewer = iNewest;
+		for(int i=1; i<iNbSamples; i++)
+		{
+			int iOlder = (iNewer + WEBCAM_POSE_HISTORY_SIZE - 1) % WEBCAM_POSE_HISTORY_SIZE;
+			if(dTimes[iOlder] <= dTime)
+			{
+				if(dTime >= dTimes[iNewer]) { return Orientations[iNewer]; }
+				float fNewerWeight = (float)((dTime - dTimes[iOlder]) / (dTimes[iNewer] - dTimes[iOlder]));
+				return Quatf(Orientations[iNewer]).Nlerp(Orientations[iOlder], fNewerWeight);
+			}
+			iNewer = iOlder;
+		}
+		return Orientations[iNewer];																					// Older than the whole history
+	}
+};
+typedef OVR::LocklessUpdater<HeadPoseHistory, HeadPoseHistory> HeadPoseUpdater;
+
+
 // ==================================================================================//
 //  WebCamDevice Class
 // ==================================================================================//
@@ -145,15 +286,38 @@ class WebCamDevice
 {
 private:
 
-	cv::Mat						Frame;
-    cv::VideoCapture			Video;  
+	FrameMailbox<cv::Mat>		Frames;																					// Preallocated frames shared lock-less between the capture and the render threads
+	UploadRing					Ring;																					// When enabled, the Frames slots live in GPU upload memory
+	WebCamSource			   *pSource;
+	WebCamMode					Mode;																					// Negotiated capture mode
+	RawFileWebCamWriter			Recorder;
+	const HeadPoseUpdater	   *pPoseHistory;																			// Filled by the render thread, read by the capture thread
+	ovrVideoFrameTiming			FrameTimings[FRAMEMAILBOX_SLOTS];														// Per Frames slot, written before Publish() and read after Acquire()
+	Quatf						FrameOrientations[FRAMEMAILBOX_SLOTS];													// Head orientation when each slot's frame was captured
+	unsigned int				uiCaptureSequence;																		// Capture thread only: frames read from the source so far
+	FrameMailbox<WebCamHandFrame> HandFrames;																			// Capture thread to hand worker: only the newest frame is analyzed
+	LocklessQueue<HandEvent, WEBCAM_HAND_EVENT_QUEUE> HandEvents;														// Hand worker to render thread
+	HandTracker					Tracker;																				// Hand analysis thread only
+	cv::Mat						HandBGRFrame;																			// Hand analysis thread only: YUV frames converted for the tracker
+	HandEvent					LastHandEvent;																			// Render thread only
+	HandOverlay					Overlay;
+	WebCamCalibration			Calibration;
+	bool						bIsCalibrated;																			// The quads are rectification meshes instead of plain quads
 	OVR::Thread					CaptureFrameThread;
-	OVR::Mutex				   *pMutex;
+	OVR::Thread					HandThread;
 	int							iStatus;
-	bool						bHasCapturedFrame;
 	bool						bIsVertOriented;
+	double						dConvertTime;																			// Capture thread CPU time spent adapting the frames to the texture format
+	double						dHandTime;																				// CPU time spent analyzing the hand
+	int							iNbHandFrames;
+	double						dPublishLatency, dUploadLatency, dDisplayLatency, dHandLatency;							// Sums of the delays from the capture of each frame
+	int							iNbUploads, iNbDisplays, iNbHandEvents;
+	ovrVideoFrameTiming			UploadedFrameTiming;																	// Render thread only: the frame in the texture (SequenceNumber 0 until the first upload)
+	bool						bIsUploadedFrameDisplayed;
+	Quatf						UploadedFrameOrientation;																// Render thread only
 	ImageBuffer				   *pImageBuffer;
 	ShaderFill				   *pShaderFill;
+	ShaderFill				   *pOverlayFill;
 	Model					   *pQuadModel;
 	Model					   *pFadingEdgeQuadModel;
 #if RENDER_OPENGL
@@ -161,12 +325,12 @@ private:
 	GLuint						uiBOIDs[2];
 #else
 	Ptr<ID3D11BlendState>		BlendState;
-	unsigned char			   *pucRGBAData;																			// Buffer to convert BGR WebCam Frame to RGBA format
 #endif
 
 public:
 
 	int							iWidth, iHeight, iBufferSize, iColorChannels;
+	int							iFrameRows;																				// Rows of the uploaded frames: NV12 adds its UV rows under the Y rows
 	float						fAspectRatio;
 	float						fWebCamHMD_DiagonalFOVRatio;															// The ratio: (Web Cam Diagonal Field of View) / (Oculus Rift Eye Field of View)
 																														// For a fullscreen feeling take this parameter to 1.0f 
@@ -174,15 +338,15 @@ public:
 public:
 
 	// Constructor
-	WebCamDevice() : iStatus(OVR::Thread::NotRunning), pMutex(NULL), bHasCapturedFrame(false), 
-					 pImageBuffer(NULL), pShaderFill(NULL), pQuadModel(NULL), pFadingEdgeQuadModel(NULL)
+	WebCamDevice() : pSource(NULL), pPoseHistory(NULL), uiCaptureSequence(0), bIsCalibrated(false), iStatus(OVR::Thread::NotRunning),
+					 dConvertTime(0.0), dHandTime(0.0), iNbHandFrames(0), dPublishLatency(0.0), dUploadLatency(0.0), dDisplayLatency(0.0), dHandLatency(0.0),
+					 iNbUploads(0), iNbDisplays(0), iNbHandEvents(0), bIsUploadedFrameDisplayed(true),
+					 pImageBuffer(NULL), pShaderFill(NULL), pOverlayFill(NULL), pQuadModel(NULL), pFadingEdgeQuadModel(NULL)
 	{
+		memset(FrameTimings, 0, sizeof(FrameTimings));
+		memset(&UploadedFrameTiming, 0, sizeof(UploadedFrameTiming));
 	#if RENDER_OPENGL
-		iColorChannels	= 3;																							// 3 for BGR format
 		iCurrentBOIndex	= 0; 
-	#else
-		iColorChannels	= 4;																							// 4 for RGBA format (R8G8B8A8)
-		pucRGBAData		= NULL;
 	#endif
 	}
 
@@ -190,30 +354,75 @@ public:
     ~WebCamDevice()
 	{
 	#if RENDER_OPENGL
-		if(bIsBOSupported) { glDeleteBuffers(2, uiBOIDs); }
+		if(bIsBOSupported && !Ring.IsEnabled()) { glDeleteBuffers(2, uiBOIDs); }
 	#endif
+		Ring.Release();
+		delete pSource;
 	}
 
-	int Initialize(int iDeviceNum, bool bVOriented=false, float fDiagonalFOVRatio=1.0f) 
+	int Initialize(const HeadPoseUpdater *pHistory, int iDeviceNum, bool bVOriented=false, float fDiagonalFOVRatio=1.0f, const char *pCalibrationFile=NULL) 
 	{
-		Video.open(iDeviceNum);																							// Open the WebCam number iDevice
-		if(!Video.isOpened()) 
+		pPoseHistory = pHistory;
+		char FileName[260];
+		const char *pReplayFile = WEBCAM_REPLAY_FILE, *pRecordFile = WEBCAM_RECORD_FILE;
+		if(pReplayFile)
+		{
+			sprintf_s(FileName, sizeof(FileName), pReplayFile, iDeviceNum);
+			pSource = new RawFileWebCamSource(FileName);
+		}
+	#if WEBCAM_NATIVE_FORMAT
+		else { pSource = new MediaFoundationWebCamSource(WEBCAM_REQUEST_MJPEG); }
+	#else
+		else { pSource = new OpenCVWebCamSource(WEBCAM_REQUEST_MJPEG); }
+	#endif
+
+		Mode = WebCamMode(WEBCAM_REQUESTED_WIDTH, WEBCAM_REQUESTED_HEIGHT, WEBCAM_REQUESTED_FPS);
+		bool bIsOpen = pSource->Open(iDeviceNum, Mode);																	// Open the WebCam number iDevice and negotiate its capture mode
+		if(!bIsOpen && !pReplayFile && WEBCAM_NATIVE_FORMAT)															// Not available through Media Foundation in this size: let cv::VideoCapture try, in BGR
+		{
+			delete pSource;
+			pSource	= new OpenCVWebCamSource(WEBCAM_REQUEST_MJPEG);
+			Mode	= WebCamMode(WEBCAM_REQUESTED_WIDTH, WEBCAM_REQUESTED_HEIGHT, WEBCAM_REQUESTED_FPS);
+			bIsOpen	= pSource->Open(iDeviceNum, Mode);
+		}
+		if(!bIsOpen)
 		{ 
 			char msg[100];
 			sprintf_s(msg, 100, "Cannot open the video of WebCam number %d", iDeviceNum);
 			MessageBoxA(NULL,msg,"", MB_OK); 
 			return(0); 
 		}
-		iWidth			= (int)Video.get(CV_CAP_PROP_FRAME_WIDTH);														// Get the Width of frames of the WebCam Video
-		iHeight			= (int)Video.get(CV_CAP_PROP_FRAME_HEIGHT);														// Get the Height of frames of the WebCam Video
-		iBufferSize		= iWidth*iHeight*iColorChannels;
+		OVR_DEBUG_LOG(("WebCam %d: %dx%d at %.1f fps, %s", iDeviceNum, Mode.iWidth, Mode.iHeight, Mode.fFPS, Mode.GetFormatName()));
+		if(pRecordFile)
+		{
+			sprintf_s(FileName, sizeof(FileName), pRecordFile, iDeviceNum);
+			Recorder.Open(FileName, Mode);
+		}
+
+		iWidth			= Mode.iWidth;																					// Width of frames of the WebCam Video
+		iHeight			= Mode.iHeight;																					// Height of frames of the WebCam Video
+	#if RENDER_OPENGL || WEBCAM_PACKED_UPLOAD
+		iColorChannels	= CV_MAT_CN(Mode.GetCvType());																	// Camera's bytes as they are: 3 for BGR, 2 for YUYV, 1 for NV12
+		iFrameRows		= Mode.GetFrameRows();
+	#else
+		iColorChannels	= 4;																							// 4 for RGBA format (R8G8B8A8)
+		iFrameRows		= iHeight;
+	#endif
+		iBufferSize		= iWidth*iFrameRows*iColorChannels;
 		fAspectRatio	= (float)iHeight/(float)iWidth;
 		bIsVertOriented	= bVOriented;																					// Change landscape webcam frame to portrait in order to better exploit the resolutions
 		fWebCamHMD_DiagonalFOVRatio = fDiagonalFOVRatio; 
+		for(int i=0; i<FRAMEMAILBOX_SLOTS; i++) { Frames.Slots[i].create(iFrameRows, iWidth, CV_8UC(iColorChannels)); }	// Allocated once: the capture thread writes in place from now on
+		for(int i=0; i<FRAMEMAILBOX_SLOTS; i++) { HandFrames.Slots[i].Frame.create(Mode.GetFrameRows(), iWidth, Mode.GetCvType()); }
+
+		if(bIsBOSupported && !Ring.Initialize(iWidth, iFrameRows, CV_8UC(iColorChannels), Frames.Slots))				// Frames.Slots now point to mapped memory, otherwise they stay on the heap
+		{
+			OVR_DEBUG_LOG(("Persistently mapped upload ring not supported, falling back to per-frame copies."));
+		}
 
 		pImageBuffer = new ImageBuffer(false, false, Sizei(iWidth, iHeight));
 	#if RENDER_OPENGL
-		if(bIsBOSupported)																								// Use 2 Pixel Buffer Objects to optimize uploading pipeline: 1 from WebCam to PBO, and 1 from PBO to Texture Object.
+		if(bIsBOSupported && !Ring.IsEnabled())																								// Use 2 Pixel Buffer Objects to optimize uploading pipeline: 1 from WebCam to PBO, and 1 from PBO to Texture Object.
 		{																												
 			glGenBuffers(2, uiBOIDs);
 			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uiBOIDs[0]);
@@ -223,19 +432,25 @@ public:
 			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 		}
 		glBindTexture(GL_TEXTURE_2D, pImageBuffer->TexId);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, iWidth, iHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, NULL);
-		glGenerateMipmap(GL_TEXTURE_2D);
+		glTexImage2D(GL_TEXTURE_2D, 0, UploadRing::GetTexelInternalFormat(CV_8UC(iColorChannels)), UploadRing::GetTexelWidth(iWidth, CV_8UC(iColorChannels)), iFrameRows, 0, 
+					 UploadRing::GetTexelFormat(CV_8UC(iColorChannels)), GL_UNSIGNED_BYTE, NULL);
+		if(Mode.iFormat != WEBCAM_FORMAT_BGR)																			// Texels are unpacked and filtered by the pixel shader
+		{
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		}
+		else { glGenerateMipmap(GL_TEXTURE_2D); }
 	#else
 		D3D11_TEXTURE2D_DESC dsDesc;
-		dsDesc.Width				= iWidth;
-		dsDesc.Height				= iHeight;
+		dsDesc.Width				= UploadRing::GetTexelWidth(iWidth, CV_8UC(iColorChannels));
+		dsDesc.Height				= iFrameRows;
 		dsDesc.MipLevels			= 1;
 		dsDesc.ArraySize			= 1;
-		dsDesc.Format				= DXGI_FORMAT_R8G8B8A8_UNORM;
+		dsDesc.Format				= UploadRing::GetTexelFormat(CV_8UC(iColorChannels));
 		dsDesc.SampleDesc.Count		= 1;
 		dsDesc.SampleDesc.Quality	= 0;
-		dsDesc.Usage				= (bIsBOSupported ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT);
-		dsDesc.CPUAccessFlags		= (bIsBOSupported ? D3D11_CPU_ACCESS_WRITE : 0);
+		dsDesc.Usage				= ((bIsBOSupported && !Ring.IsEnabled()) ? D3D11_USAGE_DYNAMIC : D3D11_USAGE_DEFAULT);		// The ring copies from its staging textures, no CPU access needed
+		dsDesc.CPUAccessFlags		= ((bIsBOSupported && !Ring.IsEnabled()) ? D3D11_CPU_ACCESS_WRITE : 0);
 		dsDesc.MiscFlags			= 0;
 		dsDesc.BindFlags			= D3D11_BIND_SHADER_RESOURCE;
 		WND.Device->CreateTexture2D(&dsDesc, NULL, &pImageBuffer->Tex);
@@ -251,38 +466,68 @@ public:
 		WND.Device->CreateBlendState(&bm, &BlendState.GetRawRef());
 	#endif
 
-		pShaderFill = new ShaderFill(QuadVertDesc, 3, VertexShaderSrc, PixelShaderSrc, pImageBuffer);
+	#if RENDER_OPENGL || WEBCAM_PACKED_UPLOAD
+		char *pPixelShaderSrc = (Mode.iFormat == WEBCAM_FORMAT_YUYV ? PixelShaderYUYVSrc : (Mode.iFormat == WEBCAM_FORMAT_NV12 ? PixelShaderNV12Src : PixelShaderSrc));
+	#else
+		char *pPixelShaderSrc = PixelShaderSrc;																			// Frames converted to RGBA by the capture thread
+	#endif
+		pShaderFill = new ShaderFill(QuadVertDesc, 3, VertexShaderSrc, pPixelShaderSrc, pImageBuffer);
 
 
-		// Simple Quad Model
-        pQuadModel = new Model(Vector3f(0,0,0), pShaderFill);
+		// Calibrated webcam: both quads become meshes that undistort and rectify the frame while texturing it
+		if(pCalibrationFile)
+		{
+			bIsCalibrated = Calibration.Load(pCalibrationFile, cv::Size(iWidth, iHeight));
+			if(!bIsCalibrated) { OVR_DEBUG_LOG(("WebCam %d: cannot load the calibration file %s, showing raw frames.", iDeviceNum, pCalibrationFile)); }
+		}
+		if(bIsCalibrated)
+		{
+			WebCamRectifyMesh Mesh;
+			Mesh.Build(&Calibration, cv::Size(iWidth, iHeight), WEBCAM_RECTIFY_GRID);
+			pQuadModel = CreateMeshModel(Mesh, 200);
+			Mesh.Build(&Calibration, cv::Size(iWidth, iHeight), WEBCAM_RECTIFY_GRID, fBandWidth, fBandHeight);
+			pFadingEdgeQuadModel = CreateMeshModel(Mesh, 255);
+		}
+		else
+		{
+			// Simple Quad Model
+			pQuadModel = new Model(Vector3f(0,0,0), pShaderFill);
 		
-		int iNbVertices = sizeof(SimpleQuadVertices)/sizeof(SimpleQuadVertices[0]);
-		for(int i=0; i<iNbVertices; i++) { pQuadModel->AddVertex(SimpleQuadVertices[i]); }
+			int iNbVertices = sizeof(SimpleQuadVertices)/sizeof(SimpleQuadVertices[0]);
+			for(int i=0; i<iNbVertices; i++) { pQuadModel->AddVertex(SimpleQuadVertices[i]); }
 		
-		int iNbIndices = sizeof(SimpleQuadIndices)/sizeof(SimpleQuadIndices[0]);
-		for(int i=0; i<iNbIndices; i++) { pQuadModel->AddIndex(SimpleQuadIndices[i]); }
+			int iNbIndices = sizeof(SimpleQuadIndices)/sizeof(SimpleQuadIndices[0]);
+			for(int i=0; i<iNbIndices; i++) { pQuadModel->AddIndex(SimpleQuadIndices[i]); }
         
-		pQuadModel->AllocateBuffers();
+			pQuadModel->AllocateBuffers();
 		
 
-		// Fading Edge Quad Model
-		pFadingEdgeQuadModel = new Model(Vector3f(0,0,0), pShaderFill);
+			// Fading Edge Quad Model
+			pFadingEdgeQuadModel = new Model(Vector3f(0,0,0), pShaderFill);
 		
-		iNbVertices = sizeof(FadingEdgeQuadVertices)/sizeof(FadingEdgeQuadVertices[0]);
-		for(int i=0; i<iNbVertices; i++) { pFadingEdgeQuadModel->AddVertex(FadingEdgeQuadVertices[i]); }
+			iNbVertices = sizeof(FadingEdgeQuadVertices)/sizeof(FadingEdgeQuadVertices[0]);
+			for(int i=0; i<iNbVertices; i++) { pFadingEdgeQuadModel->AddVertex(FadingEdgeQuadVertices[i]); }
 
-		iNbIndices = sizeof(FadingEdgeQuadIndices)/sizeof(FadingEdgeQuadIndices[0]);
-		for(int i=0; i<iNbIndices; i++) { pFadingEdgeQuadModel->AddIndex(FadingEdgeQuadIndices[i]); }
+			iNbIndices = sizeof(FadingEdgeQuadIndices)/sizeof(FadingEdgeQuadIndices[0]);
+			for(int i=0; i<iNbIndices; i++) { pFadingEdgeQuadModel->AddIndex(FadingEdgeQuadIndices[i]); }
 		
-		pFadingEdgeQuadModel->AllocateBuffers();
+			pFadingEdgeQuadModel->AllocateBuffers();
+		}
 
 
-		// Create a new thread to capture the webcam frames
+		// Hand Overlay, drawn on top of both quads
+		pOverlayFill = new ShaderFill(QuadVertDesc, 3, VertexShaderSrc, PixelShaderOverlaySrc, NULL);
+		Overlay.Initialize(pOverlayFill, iWidth, iHeight, (bIsCalibrated ? &Calibration : NULL));
+
+
+		// Create a new thread to capture the webcam frames, and one to analyze them
 		CaptureFrameThread = OVR::Thread((OVR::Thread::ThreadFn)&WebCamDevice::CaptureFrameThreadFn, this);
 		iStatus			   = OVR::Thread::Running;
 		CaptureFrameThread.Start(OVR::Thread::Running);
-		pMutex = new OVR::Mutex();
+	#if WEBCAM_HAND_WORKER
+		HandThread = OVR::Thread((OVR::Thread::ThreadFn)&WebCamDevice::HandThreadFn, this);
+		HandThread.Start(OVR::Thread::Running);
+	#endif
 
 		return(1);
 	}
@@ -293,58 +538,119 @@ public:
 
 		iStatus = OVR::Thread::NotRunning;
 		CaptureFrameThread.Join();
-		Video.release();
-	#if !RENDER_OPENGL
-		if (pucRGBAData) { OVR_FREE(pucRGBAData); pucRGBAData = NULL; }
+	#if WEBCAM_HAND_WORKER
+		HandThread.Join();
 	#endif
-		if(pMutex) { delete pMutex; }
+		pSource->Close();
+		Recorder.Close();
+		OVR_DEBUG_LOG(("WebCam frames: %d published, %d dropped, %d duplicated", 
+					   GetPublishedFrameCount(), GetDroppedFrameCount(), GetDuplicatedFrameCount()));
+		OVR_DEBUG_LOG(("WebCam upload: %d bytes per frame (%s%s), %.3f ms per frame of CPU colour conversion", 
+					   iBufferSize, (iColorChannels == 4 ? "RGBA" : Mode.GetFormatName()), (Ring.IsEnabled() ? ", upload ring" : ""), (GetPublishedFrameCount() ? 1000.0*dConvertTime/GetPublishedFrameCount() : 0.0)));
+		OVR_DEBUG_LOG(("WebCam latency from capture (%s): publish %.2f ms, upload %.2f ms, display %.2f ms", (WEBCAM_HAND_WORKER ? "hand worker" : "inline hand"),
+					   (GetPublishedFrameCount() ? 1000.0*dPublishLatency/GetPublishedFrameCount() : 0.0),
+					   (iNbUploads ? 1000.0*dUploadLatency/iNbUploads : 0.0), (iNbDisplays ? 1000.0*dDisplayLatency/iNbDisplays : 0.0)));
+		OVR_DEBUG_LOG(("WebCam hand: %d frames analyzed (%.2f ms each), %d skipped as stale, %d events lost, %.2f ms from capture to event", 
+					   iNbHandFrames, (iNbHandFrames ? 1000.0*dHandTime/iNbHandFrames : 0.0), (WEBCAM_HAND_WORKER ? HandFrames.GetDroppedCount() : 0),
+					   HandEvents.GetLostCount(), (iNbHandEvents ? 1000.0*dHandLatency/iNbHandEvents : 0.0)));
 	}
 
-	void ProcessHand(cv::Mat &InFrame) 
+	int GetPublishedFrameCount() const	{ return Frames.GetPublishedCount(); }											// Frames delivered by the capture thread
+	int GetDroppedFrameCount() const	{ return Frames.GetDroppedCount(); }											// Captured frames replaced by a newer one before being displayed
+	int GetDuplicatedFrameCount() const	{ return Frames.GetDuplicatedCount(); }											// Render updates with no new frame (the previous one is displayed again)
+
+	bool GetUploadedFrameTiming(ovrVideoFrameTiming &Timing) const														// Render thread: the frame displayed by the next present, false before the first upload
 	{
+		Timing = UploadedFrameTiming;
+		return (Timing.SequenceNumber != 0);
+	}
+
+	void FrameDisplayed()																								// Render thread, right after the frame is presented
+	{
+		if (bIsUploadedFrameDisplayed) { return; }
+		dDisplayLatency += ovr_GetTimeInSeconds() - UploadedFrameTiming.CaptureSeconds;
+		iNbDisplays++;
+		bIsUploadedFrameDisplayed = true;
+	}
+
+	void AnalyzeHand(cv::Mat &InFrame, double dCaptureTime)															// Hand worker (or capture thread when !WEBCAM_HAND_WORKER): never writes into the frame
+	{
+		double dStartTime = ovr_GetTimeInSeconds();
+		cv::Mat *pBGRFrame = &InFrame;
+		if (Mode.iFormat != WEBCAM_FORMAT_BGR)																			// Hand detection works on BGR
+		{
+			cv::cvtColor(InFrame, HandBGRFrame, (Mode.iFormat == WEBCAM_FORMAT_YUYV ? CV_YUV2BGR_YUYV : CV_YUV2BGR_NV12));
+			pBGRFrame = &HandBGRFrame;
+		}
+
 		Hand hand;
-		cv::Mat SkinMask(iHeight, iWidth, CV_8UC1);
-		hand.BGR2SkinMask(InFrame, SkinMask);
-		if (hand.ExtractContourAndHull(SkinMask))
+		HandEvent Event;
+		Event.dCaptureTime = dCaptureTime;
+		if (Tracker.Process(*pBGRFrame, hand)) { hand.FillEvent(Event, hand.GestureDetection()); }					// Downscaled detection, restricted to the tracked region when possible
+		HandEvents.Push(Event);																							// Also when not found, so that the overlay is cleared
+		dHandTime += ovr_GetTimeInSeconds() - dStartTime;
+		iNbHandFrames++;
+	}
+
+	void ApplyGesture(DWORD dwGesture)																					// Render thread: bLookThrough is also toggled by the keyboard
+	{
+		if(WEBCAM_0_VERT_ORIENTATION)
 		{
-			hand.IdentifyProperties();
-			hand.Draw(InFrame);
-			DWORD dwGesture = hand.GestureDetection();
-			if(WEBCAM_0_VERT_ORIENTATION)
-			{
-				if(dwGesture & HAND_GESTURE_SWIPE_LEFT) { bLookThrough = true; }										// Switching from VR world to LookingThrough mode
-				else if(dwGesture & HAND_GESTURE_SWIPE_RIGHT) { bLookThrough = false; }									// Switching from LookingThrough mode to the VR world
-			}
-			else
-			{
-				if(dwGesture & HAND_GESTURE_SWIPE_DOWN) { bLookThrough = true; }										// Switching from VR world to LookingThrough mode
-				else if(dwGesture & HAND_GESTURE_SWIPE_UP) { bLookThrough = false; }									// Switching from LookingThrough mode to the VR world
-			}
+			if(dwGesture & HAND_GESTURE_SWIPE_LEFT) { bLookThrough = true; }											// Switching from VR world to LookingThrough mode
+			else if(dwGesture & HAND_GESTURE_SWIPE_RIGHT) { bLookThrough = false; }										// Switching from LookingThrough mode to the VR world
+		}
+		else
+		{
+			if(dwGesture & HAND_GESTURE_SWIPE_DOWN) { bLookThrough = true; }											// Switching from VR world to LookingThrough mode
+			else if(dwGesture & HAND_GESTURE_SWIPE_UP) { bLookThrough = false; }										// Switching from LookingThrough mode to the VR world
 		}
 	}
 
-	void SetFrame(const cv::Mat &InFrame) 
+	void Update()
 	{
-		OVR::Mutex::Locker Locker(pMutex);
-		Frame = InFrame;
-		bHasCapturedFrame = true;
+		if (!pImageBuffer) { return; }
+		UpdateHand();
+		if (!UpdateFrame()) { return; }
+		UploadedFrameTiming					= FrameTimings[Frames.GetFrontIndex()];
+		UploadedFrameTiming.UploadSeconds	= ovr_GetTimeInSeconds();
+		UploadedFrameOrientation			= FrameOrientations[Frames.GetFrontIndex()];
+		bIsUploadedFrameDisplayed			= false;
+		dUploadLatency += UploadedFrameTiming.UploadSeconds - UploadedFrameTiming.CaptureSeconds;
+		iNbUploads++;
 	}
 
-	bool GetFrame(cv::Mat &OutFrame)
+	void UpdateHand()																									// Takes the events published by the hand analysis since the last update
 	{
-		if (!bHasCapturedFrame) { return false; }
-		OVR::Mutex::Locker Locker(pMutex);
-		OutFrame = Frame;
-		bHasCapturedFrame = false;
-		return true;
+		HandEvent Event;
+		bool bIsNewEvent = false;
+		while (HandEvents.Pop(Event))
+		{
+			ApplyGesture(Event.dwGesture);
+			dHandLatency += ovr_GetTimeInSeconds() - Event.dCaptureTime;
+			iNbHandEvents++;
+			LastHandEvent = Event;
+			bIsNewEvent = true;
+		}
+		if (bIsNewEvent) { Overlay.Build(LastHandEvent); }
 	}
 
-	void Update()
+	bool UpdateFrame()																									// True when a new frame was uploaded to the texture
 	{
-		if (!bHasCapturedFrame || !pImageBuffer) { return; }
-		OVR::Mutex::Locker Locker(pMutex);
+		if (Ring.IsEnabled())
+		{
+			if (!Ring.Reclaim(Frames.GetFrontIndex(), Frames.GetFrontSlot())) { return false; }							// GPU still copying from the front slot: keep displaying it, never wait
+			if (!Frames.Acquire()) { return false; }
+			Ring.Upload(Frames.GetFrontIndex(), pImageBuffer);															// Zero-copy: the frame is already in upload memory
+			return true;
+		}
+
+		if (!Frames.Acquire()) { return false; }																		// Never blocks: the front frame is owned by this thread until the next Acquire()
+		const cv::Mat &Frame = Frames.GetFrontSlot();
+		if ((int)(Frame.total()*Frame.elemSize()) != iBufferSize || !Frame.isContinuous()) { return false; }
 
 	#if RENDER_OPENGL
+		int iTexWidth		= UploadRing::GetTexelWidth(iWidth, Frame.type());
+		GLenum TexFormat	= UploadRing::GetTexelFormat(Frame.type());
 		if(bIsBOSupported)
 		{
 			iCurrentBOIndex		= (iCurrentBOIndex + 1) % 2;															// iCurrentBOIndex is used to copy pixels from a Pixel Buffer Object to a Texture Object. Increment current index first then get the next index
@@ -353,7 +659,7 @@ public:
 			// Read from the PBO (current)
 			glBindTexture(GL_TEXTURE_2D, pImageBuffer->TexId);
 			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uiBOIDs[iCurrentBOIndex]);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, iWidth, iHeight, GL_BGR, GL_UNSIGNED_BYTE, 0);						// Copy pixels from Pixel Buffer Object to Texture Object. Use offset instead of pointer.
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, iTexWidth, iFrameRows, TexFormat, GL_UNSIGNED_BYTE, 0);						// Copy pixels from Pixel Buffer Object to Texture Object. Use offset instead of pointer.
 
 			// Write into the PBO (next)
 			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uiBOIDs[iNextBOIndex]);			
@@ -369,18 +675,22 @@ public:
 		else
 		{
 			glBindTexture(GL_TEXTURE_2D, pImageBuffer->TexId);
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, iWidth, iHeight, GL_BGR, GL_UNSIGNED_BYTE, (GLvoid*)Frame.data);
+			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, iTexWidth, iFrameRows, TexFormat, GL_UNSIGNED_BYTE, (GLvoid*)Frame.data);
 		}
 	#else
 		if(bIsBOSupported)
 		{
 			D3D11_MAPPED_SUBRESOURCE map;
-			WND.Context->Map(pImageBuffer->Tex, 0, D3D11_MAP_WRITE_DISCARD, 0, &map);   
-			memcpy((void *)map.pData, (const void*)Frame.data, iBufferSize);
-			WND.Context->Unmap(pImageBuffer->Tex, 0);
+			if(SUCCEEDED(WND.Context->Map(pImageBuffer->Tex, 0, D3D11_MAP_WRITE_DISCARD, 0, &map)))
+			{
+				int iRowSize = iWidth*iColorChannels;
+				for(int y=0; y<iFrameRows; y++) { memcpy((unsigned char*)map.pData + y*map.RowPitch, Frame.ptr(y), iRowSize); }	// The driver may pad the rows of the texture
+				WND.Context->Unmap(pImageBuffer->Tex, 0);
+			}
 		}
-		else { WND.Context->UpdateSubresource(pImageBuffer->Tex, 0, NULL, (const void*)Frame.data, iWidth*iColorChannels, iHeight*iColorChannels); }
+		else { WND.Context->UpdateSubresource(pImageBuffer->Tex, 0, NULL, (const void*)Frame.data, iWidth*iColorChannels, iFrameRows*iColorChannels); }
 	#endif
+		return true;
 	}
 
 	void DrawBoard(Matrix4f view, Matrix4f proj, float fXBoardGap=0)
@@ -392,23 +702,32 @@ public:
 							Matrix4f::RotationZ(bIsVertOriented ? MATH_FLOAT_PIOVER2 : MATH_FLOAT_PI);
 		Matrix4f mat = (view * modelmat).Transposed();
 
+		pQuadModel->Fill->SetUniform(ShaderFill::Uniform_View, 16, (float *) &mat);
+		pQuadModel->Fill->SetUniform(ShaderFill::Uniform_Proj, 16, (float *) &proj);
 	#if RENDER_OPENGL
-		glUseProgram(pQuadModel->Fill->Prog);
-		GLint ViewLoc = glGetUniformLocation(pQuadModel->Fill->Prog, "View");
-		GLint ProjLoc = glGetUniformLocation(pQuadModel->Fill->Prog, "Proj");
-		if (ViewLoc >= 0) glUniformMatrix4fv(ViewLoc, 1, 0, &mat.M[0][0]);
-		if (ProjLoc >= 0) glUniformMatrix4fv(ProjLoc, 1, 0, &proj.M[0][0]);
-		WND.Render(pQuadModel->Fill, pQuadModel->VertexBuffer, pQuadModel->IndexBuffer, sizeof(Model::Vertex), pQuadModel->numIndices);
+		float TexSize[2] = { (float)iWidth, (float)iHeight };
+		pQuadModel->Fill->SetUniform(ShaderFill::Uniform_TexSize, 2, TexSize);
+		pQuadModel->Render();
 	#else
-		pQuadModel->Fill->VShader->SetUniform("View",16,(float *) &mat);
-		pQuadModel->Fill->VShader->SetUniform("Proj",16,(float *) &proj);
 		WND.Context->OMSetBlendState(BlendState, NULL, 0xffffffff);
-		WND.Render(pQuadModel->Fill, pQuadModel->VertexBuffer, pQuadModel->IndexBuffer, sizeof(Model::Vertex), pQuadModel->numIndices);
+		pQuadModel->Render();
 		WND.Context->OMSetBlendState(NULL, NULL, 0xffffffff);
 	#endif
+		Overlay.Draw(mat, proj);
+	}
+
+	Quatf GetHeadOrientation(double dTime) const																		// Capture thread: never calls the SDK, which is not thread safe and instruments the render thread's poses
+	{
+	#if WEBCAM_POSE_COMPENSATION
+		if(pPoseHistory) { return pPoseHistory->GetState().GetOrientation(dTime); }
+	#else
+		OVR_UNUSED(dTime);
+	#endif
+		return Quatf();
 	}
 
-	void DrawLookThrough()
+	// EyeProj is the untransposed eye projection, EyeOrientation the render pose of this eye
+	void DrawLookThrough(const Matrix4f &EyeProj, const Quatf &EyeOrientation)
 	{
 		if(!pFadingEdgeQuadModel) { return; }
 
@@ -417,49 +736,122 @@ public:
 		proj.M[0][0]  = fWebCamHMD_DiagonalFOVRatio;
 		proj.M[1][1]  = -fWebCamHMD_DiagonalFOVRatio*(bIsVertOriented ? 1.0f/fAspectRatio : fAspectRatio)*fHMDEyeAspectRatio;
 		if(bIsVertOriented) { proj *= Matrix4f::RotationZ(-MATH_FLOAT_PIOVER2); }
+	#if WEBCAM_POSE_COMPENSATION
+		// The quad covers the same tan-angles the camera saw at capture. Each vertex is lifted to the view ray through it, 1 m away
+		// (Unproject), rotated by the head rotation since the capture, and projected again with the eye projection.
+		// With no rotation this gives back the same vertex positions.
+		Matrix4f Unproject;
+		Unproject.M[0][0] = 1.0f/EyeProj.M[0][0];	Unproject.M[0][3] = EyeProj.M[0][2]/EyeProj.M[0][0];
+		Unproject.M[1][1] = 1.0f/EyeProj.M[1][1];	Unproject.M[1][3] = EyeProj.M[1][2]/EyeProj.M[1][1];
+		Unproject.M[2][2] = 0.0f;					Unproject.M[2][3] = -1.0f;
+		Matrix4f Delta(EyeOrientation.Inverted()*UploadedFrameOrientation);												// Capture view space to current view space
+		proj = (EyeProj * Delta * Unproject * proj.Transposed()).Transposed();											// The shaders see the transpose of what is uploaded
+	#else
+		OVR_UNUSED2(EyeProj, EyeOrientation);
+	#endif
+		pFadingEdgeQuadModel->Fill->SetUniform(ShaderFill::Uniform_View, 16, (float *) &mat);
+		pFadingEdgeQuadModel->Fill->SetUniform(ShaderFill::Uniform_Proj, 16, (float *) &proj);
 	#if RENDER_OPENGL
-		glUseProgram(pFadingEdgeQuadModel->Fill->Prog);
-		GLint ViewLoc = glGetUniformLocation(pFadingEdgeQuadModel->Fill->Prog, "View");
-		GLint ProjLoc = glGetUniformLocation(pFadingEdgeQuadModel->Fill->Prog, "Proj");
-		if (ViewLoc >= 0) glUniformMatrix4fv(ViewLoc, 1, 0, &mat.M[0][0]);
-		if (ProjLoc >= 0) glUniformMatrix4fv(ProjLoc, 1, 0, &proj.M[0][0]);
-		WND.Render(pFadingEdgeQuadModel->Fill, pFadingEdgeQuadModel->VertexBuffer, pFadingEdgeQuadModel->IndexBuffer, 
-				   sizeof(Model::Vertex), pFadingEdgeQuadModel->numIndices);
+		float TexSize[2] = { (float)iWidth, (float)iHeight };
+		pFadingEdgeQuadModel->Fill->SetUniform(ShaderFill::Uniform_TexSize, 2, TexSize);
+		pFadingEdgeQuadModel->Render();
 	#else
-		pFadingEdgeQuadModel->Fill->VShader->SetUniform("View",16,(float *) &mat);
-		pFadingEdgeQuadModel->Fill->VShader->SetUniform("Proj",16,(float *) &proj);
 		WND.Context->OMSetBlendState(BlendState, NULL, 0xffffffff);
-		WND.Render(pFadingEdgeQuadModel->Fill, pFadingEdgeQuadModel->VertexBuffer, pFadingEdgeQuadModel->IndexBuffer, 
-				   sizeof(Model::Vertex), pFadingEdgeQuadModel->numIndices);
+		pFadingEdgeQuadModel->Render();
 		WND.Context->OMSetBlendState(NULL, NULL, 0xffffffff);
 	#endif
+		Overlay.Draw(mat, proj);
+	}
+
+	Model *CreateMeshModel(const WebCamRectifyMesh &Mesh, unsigned char ucAlpha)											// Rectification mesh as a Model, alpha scaled by the mesh's fading
+	{
+		Model *pModel = new Model(Vector3f(0,0,0), pShaderFill);
+		for(size_t i=0; i<Mesh.Positions.size(); i++)
+		{
+			Model::Vertex Vertex = { Vector3f(Mesh.Positions[i].x, Mesh.Positions[i].y, 0.0f), Model::Color(255, 255, 255, (unsigned char)(ucAlpha*Mesh.Alphas[i])), 
+									 Mesh.TexCoords[i].x, Mesh.TexCoords[i].y };
+			pModel->AddVertex(Vertex);
+		}
+		for(int i=0; i<Mesh.GetNbCells(); i++)
+		{
+			for(int j=0; j<6; j++) { pModel->AddIndex((uint32_t)Mesh.GetIndex(i, j)); }
+		}
+		pModel->AllocateBuffers();
+		return pModel;
 	}
 
 	static int CaptureFrameThreadFn(Thread *pthread, void* h)
 	{
 		OVR_UNUSED(pthread);
 		WebCamDevice *pDevice = (WebCamDevice *)h;
-		cv::Mat TmpBGRFrame;
+		cv::Mat TmpFrame;
+	#if RENDER_OPENGL || WEBCAM_PACKED_UPLOAD
+		bool bIsSlotWriteOnly = pDevice->Ring.IsEnabled();																// Mapped upload memory: reading it back is very slow, or not allowed at all
+	#else
+		bool bIsSlotWriteOnly = false;
+		int iRGBAConversion = (pDevice->Mode.iFormat == WEBCAM_FORMAT_YUYV ? CV_YUV2RGBA_YUYV : (pDevice->Mode.iFormat == WEBCAM_FORMAT_NV12 ? CV_YUV2RGBA_NV12 : CV_BGR2RGBA));
+	#endif
 
 		while (pDevice->iStatus == OVR::Thread::Running)
 		{
-			bool bSuccess = pDevice->Video.read(TmpBGRFrame);															// Capture a new frame from WebCam's video
-			if (bSuccess) 
+			cv::Mat &BackFrame = pDevice->Frames.GetBackSlot();														// Free slot, no other thread touches it until Publish()
+		#if RENDER_OPENGL || WEBCAM_PACKED_UPLOAD
+			cv::Mat &SourceFrame = BackFrame;																			// Capture a new frame from WebCam's video straight into the slot
+		#else
+			cv::Mat &SourceFrame = TmpFrame;
+		#endif
+			WebCamHandFrame &HandBack = pDevice->HandFrames.GetBackSlot();
+			cv::Mat &CapturedFrame = (bIsSlotWriteOnly ? HandBack.Frame : SourceFrame);									// The hand analysis needs to read the frame: capture it on the heap first
+			double dCaptureTime = 0.0;
+			if (pDevice->pSource->Read(CapturedFrame, dCaptureTime)) 
 			{
-				pDevice->ProcessHand(TmpBGRFrame);																		// Analyze the new frame, detect hand and gestures
-			#if RENDER_OPENGL
-				pDevice->SetFrame(TmpBGRFrame);
-			#else
-				if(pDevice->pucRGBAData == NULL) { pDevice->pucRGBAData = (unsigned char*)OVR_ALLOC(pDevice->iBufferSize); }
-				cv::Mat TmpRGBAFrame(TmpBGRFrame.size(), CV_8UC4, pDevice->pucRGBAData);
-				cv::cvtColor(TmpBGRFrame, TmpRGBAFrame, CV_BGR2RGBA, pDevice->iColorChannels);
-				pDevice->SetFrame(TmpRGBAFrame);
+				unsigned int uiSequence = ++pDevice->uiCaptureSequence;													// Also counts the frames dropped below, so they show up as gaps
+				pDevice->Recorder.Write(CapturedFrame);
+				if (&CapturedFrame != &SourceFrame) { CapturedFrame.copyTo(SourceFrame); }								// Same size and type: copied into the slot, not reallocated
+			#if !RENDER_OPENGL && !WEBCAM_PACKED_UPLOAD
+				double dStartTime = ovr_GetTimeInSeconds();
+				cv::cvtColor(SourceFrame, BackFrame, iRGBAConversion, pDevice->iColorChannels);							// Converted in place into the preallocated RGBA slot
+				pDevice->dConvertTime += ovr_GetTimeInSeconds() - dStartTime;
+			#endif
+			#if !WEBCAM_HAND_WORKER
+				pDevice->AnalyzeHand(CapturedFrame, dCaptureTime);														// The frame waits for the analysis before being displayed
+			#endif
+				int iBackIndex = pDevice->Frames.GetBackIndex();
+				if (!pDevice->Ring.IsSlotIntact(iBackIndex, BackFrame))													// The camera changed its frame size and the slot was reallocated on the heap
+				{
+					OVR_DEBUG_LOG(("WebCam frame size changed, frame dropped."));
+					pDevice->Ring.RestoreSlot(iBackIndex, BackFrame);
+					continue;
+				}
+				pDevice->FrameTimings[iBackIndex].SequenceNumber	= uiSequence;
+				pDevice->FrameTimings[iBackIndex].CaptureSeconds	= dCaptureTime;
+				pDevice->FrameOrientations[iBackIndex]				= pDevice->GetHeadOrientation(dCaptureTime);
+				pDevice->Frames.Publish();
+				pDevice->dPublishLatency += ovr_GetTimeInSeconds() - dCaptureTime;
+			#if WEBCAM_HAND_WORKER
+				if (&CapturedFrame != &HandBack.Frame) { CapturedFrame.copyTo(HandBack.Frame); }						// After Publish(): this copy is not on the display path. The published slot is only read by the render thread
+				HandBack.dCaptureTime = dCaptureTime;
+				pDevice->HandFrames.Publish();																			// Overwrites the previous one if the worker has not taken it yet
 			#endif
 			}
 			else { OVR_DEBUG_LOG(("Cannot read a frame from video file.")); }
 		}
 		return(1);
 	}
+
+	static int HandThreadFn(Thread *pthread, void* h)
+	{
+		OVR_UNUSED(pthread);
+		WebCamDevice *pDevice = (WebCamDevice *)h;
+
+		while (pDevice->iStatus == OVR::Thread::Running)
+		{
+			if (!pDevice->HandFrames.Acquire()) { OVR::Thread::MSleep(1); continue; }									// No new frame yet
+			WebCamHandFrame &FrontFrame = pDevice->HandFrames.GetFrontSlot();											// Newest frame, the older ones were skipped
+			pDevice->AnalyzeHand(FrontFrame.Frame, FrontFrame.dCaptureTime);
+		}
+		return(1);
+	}
 };
 
 // ==================================================================================//
@@ -471,10 +863,16 @@ public:
 
 	WebCamDevice WebCams[WEBCAM_NB];
 
+private:
+
+	ovrHmd		 HMD;
+	HeadPoseHistory PoseHistory;																					// Render thread only
+	HeadPoseUpdater SharedPoseHistory;																				// Copy of PoseHistory for the capture threads
+
 public:
 
 	// Constructors
-	WebCamManager(ovrHmd HMD)
+	WebCamManager(ovrHmd Hmd) : HMD(Hmd)
 	{ 
 		fHMDEyeAspectRatio	= 0.5f*(float)HMD->Resolution.w/(float)HMD->Resolution.h;
 	#if RENDER_OPENGL
@@ -482,15 +880,31 @@ public:
 						  glMapBuffer && glUnmapBuffer && glDeleteBuffers && glGetBufferParameteriv);
 	#endif
 	#if WEBCAM_NB		
-		WebCams[0].Initialize(WEBCAM_0_DEVICE_NUMBER, WEBCAM_0_VERT_ORIENTATION, WEBCAM_0_HMD_FOV_RATIO);
+		WebCams[0].Initialize(&SharedPoseHistory, WEBCAM_0_DEVICE_NUMBER, WEBCAM_0_VERT_ORIENTATION, WEBCAM_0_HMD_FOV_RATIO, WEBCAM_0_CALIBRATION_FILE);
 	#endif
 	#if WEBCAM_NB == 2
-		WebCams[1].Initialize(WEBCAM_1_DEVICE_NUMBER, WEBCAM_1_VERT_ORIENTATION, WEBCAM_1_HMD_FOV_RATIO);
+		WebCams[1].Initialize(&SharedPoseHistory, WEBCAM_1_DEVICE_NUMBER, WEBCAM_1_VERT_ORIENTATION, WEBCAM_1_HMD_FOV_RATIO, WEBCAM_1_CALIBRATION_FILE);
 	#endif
+		const char *pPerfLogFile = WEBCAM_PERF_LOG_FILE;
+		if (pPerfLogFile) { ovrHmd_StartPerfLog(HMD, pPerfLogFile, (WEBCAM_REPLAY_FILE ? "WebCamReplay" : "WebCam")); }
 	}
 
-	void Update()
+	void ReportFrameTiming()																							// Before ovrHmd_EndFrame: adds webcam 0's frame to the latency statistics
 	{
+	#if WEBCAM_NB
+		ovrVideoFrameTiming Timing;
+		if (WebCams[0].GetUploadedFrameTiming(Timing)) { ovrHmd_SetVideoFrameTiming(HMD, &Timing); }
+	#endif
+	}
+
+	void Update(const ovrTrackingState &HmdState)																	// HmdState: what the render thread got with its eye poses for this frame
+	{
+	#if WEBCAM_POSE_COMPENSATION
+		PoseHistory.Add(HmdState.HeadPose.TimeInSeconds, Quatf(HmdState.HeadPose.ThePose.Orientation));
+		SharedPoseHistory.SetState(PoseHistory);
+	#else
+		OVR_UNUSED(HmdState);
+	#endif
 	#if WEBCAM_NB
 		WebCams[0].Update();
 	#endif
@@ -510,12 +924,22 @@ public:
 	#endif
 	}
 
-	void DrawLookThrough (int eye) 
+	void FrameDisplayed()
+	{
+	#if WEBCAM_NB
+		WebCams[0].FrameDisplayed();
+	#endif
+	#if WEBCAM_NB == 2
+		WebCams[1].FrameDisplayed();
+	#endif
+	}
+
+	void DrawLookThrough (int eye, const Matrix4f &EyeProj, const Quatf &EyeOrientation) 
 	{
 	#if WEBCAM_NB == 1
 		eye = 0;
 	#endif
-		WebCams[eye].DrawLookThrough(); 
+		WebCams[eye].DrawLookThrough(EyeProj, EyeOrientation); 
 	}
 
 	void StopCapture() 
@@ -526,6 +950,8 @@ public:
 	#if WEBCAM_NB == 2
 		WebCams[1].StopCapture();
 	#endif
+		const char *pPerfLogFile = WEBCAM_PERF_LOG_FILE;
+		if (pPerfLogFile) { ovrHmd_StopPerfLog(HMD); }
 	}
 };
 
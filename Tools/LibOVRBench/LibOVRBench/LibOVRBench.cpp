@@ -0,0 +1,114 @@
+/************************************************************************************
+
+Filename    :   LibOVRBench.cpp
+Content     :   Command line runner for the LibOVR benchmarks and self-checks
+Created     :   October 17, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+// Build LibOVR first (LibOVR/Projects/Win32/VS2013), then LibOVRBench_VS2013.sln.
+// Each switch runs one benchmark, logs its results and returns 0, or 1 if it failed:
+//   LibOVRBench.exe -rpc [calls] [window]   RPC1 sequential, pipelined and batched calls over localhost
+//   LibOVRBench.exe -session [calls]        Session polling 1, 16 and 256 localhost connections
+//   LibOVRBench.exe -netclient              NetClient property cache against a stand-in service (stop OVRService first)
+//   LibOVRBench.exe -lens [samples]         Inverse lens distortion tables of DK1 and DK2 against the exact inverse
+//   LibOVRBench.exe -swdistortion [frames]  Software distortion golden frames, then DK2 frames on 1 to 8 threads
+
+#include "Kernel/OVR_System.h"
+#include "Kernel/OVR_Log.h"
+#include "Net/OVR_RPC1_Benchmark.h"
+#include "Util/Util_Render_Stereo_Benchmark.h"
+#include "OVR_Profile.h"
+#include "NetClientTest.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace OVR;
+
+static const uint16_t BenchmarkPort = 30320;   // Loopback port of the benchmark sessions, away from OVRService's
+
+static int RunRPC1Benchmark(int callCount, int window)
+{
+    Net::Plugins::RPC1BenchmarkResult results[Net::Plugins::RPC1Benchmark_Count];
+    return Net::Plugins::RunRPC1LoopbackBenchmark(callCount, window, BenchmarkPort, results) ? 0 : 1;
+}
+
+static int RunSessionBenchmark(int callsPerConnection)
+{
+    Net::Plugins::RPC1BenchmarkResult results[Net::Plugins::SessionBenchmark_Count];
+    return Net::Plugins::RunSessionLoopbackBenchmark(callsPerConnection, BenchmarkPort, results) ? 0 : 1;
+}
+
+// The DK2 CatmullRom10 table is the loosest, at about 4e-5 of tan-angle
+static int RunLensDistortionAccuracyCheck(int sampleCount)
+{
+    Util::Render::LensDistortionAccuracyResult results[Util::Render::LensDistortionAccuracy_Count];
+    return Util::Render::RunLensDistortionTableAccuracyCheck(sampleCount, 1e-4f, results) ? 0 : 1;
+}
+
+static int RunSoftwareDistortionBenchmark(int iterations)
+{
+    Ptr<Profile>  profile       = *ProfileManager::GetInstance()->GetDefaultProfile(HmdType_DK2);
+    HmdRenderInfo hmdRenderInfo = GenerateHmdRenderInfoFromHmdInfo(CreateDebugHMDInfo(HmdType_DK2), profile);
+
+    Util::Render::SoftwareDistortionBenchmarkResult results[Util::Render::SoftwareDistortionBenchmark_ThreadCounts];
+    return Util::Render::RunSoftwareDistortionBenchmark(hmdRenderInfo, iterations, results) ? 0 : 1;
+}
+
+static void PrintUsage()
+{
+    printf("Usage:\n"
+           "  LibOVRBench -rpc [calls] [window]\n"
+           "  LibOVRBench -session [calls]\n"
+           "  LibOVRBench -netclient\n"
+           "  LibOVRBench -lens [samples]\n"
+           "  LibOVRBench -swdistortion [frames]\n");
+}
+
+int main(int argc, char* argv[])
+{
+    System::Init(Log::ConfigureDefaultLog(LogMask_All));
+
+    int result = 1;
+    if (argc > 1 && !strcmp(argv[1], "-rpc"))
+    {
+        result = RunRPC1Benchmark((argc > 2 ? atoi(argv[2]) : 10000), (argc > 3 ? atoi(argv[3]) : 16));
+    }
+    else if (argc > 1 && !strcmp(argv[1], "-session"))
+    {
+        result = RunSessionBenchmark(argc > 2 ? atoi(argv[2]) : 100);
+    }
+    else if (argc > 1 && !strcmp(argv[1], "-netclient"))
+    {
+        result = RunNetClientPropertyCacheTest() ? 0 : 1;
+    }
+    else if (argc > 1 && !strcmp(argv[1], "-lens"))
+    {
+        result = RunLensDistortionAccuracyCheck(argc > 2 ? atoi(argv[2]) : 4096);
+    }
+    else if (argc > 1 && !strcmp(argv[1], "-swdistortion"))
+    {
+        result = RunSoftwareDistortionBenchmark(argc > 2 ? atoi(argv[2]) : 10);
+    }
+    else
+    {
+        PrintUsage();
+    }
+
+    System::Destroy();
+    return result;
+}
@@ -0,0 +1,270 @@
+/************************************************************************************
+
+Filename    :   NetClientTest.cpp
+Content     :   NetClient property cache test against a stand-in service
+Created     :   October 17, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#include "NetClientTest.h"
+#include "Net/OVR_RPC1_Benchmark.h"
+#include "Service/Service_NetClient.h"
+#include "Kernel/OVR_Timer.h"
+#include "Kernel/OVR_Log.h"
+
+using namespace OVR;
+using namespace OVR::Net;
+using namespace OVR::Net::Plugins;
+using namespace OVR::Service;
+
+static const char* const   TestKey = "CenterPupilDepth";   // A number property handled by the service
+static const VirtualHmdId  TestHmd = 0;
+
+
+//-----------------------------------------------------------------------------
+// StandInService
+
+// Answers GetNumberValue_1 and SetNumberValue_1 for TestKey like OVRService, counting the gets.
+// With RPCCapability_PropertyChanged it pushes PropertyChanged_1 whenever the value changes.
+class StandInService : public LoopbackEndpoint
+{
+public:
+    StandInService(bool pushesChanges) :
+        LoopbackEndpoint(true),
+        PushesChanges(pushesChanges),
+        Value(1.),
+        ChangeDuringNextGet(false),
+        NextValue(0.),
+        GetCalls(0)
+    {
+        TheSession.SetLocalCapabilities(RPCCapabilities_Local | (pushesChanges ? RPCCapability_PropertyChanged : 0));
+        Rpc.RegisterBlockingFunction("GetNumberValue_1", RPCDelegate::FromMember<StandInService, &StandInService::GetNumberValue_1>(this));
+        SetNumberValueScope.SetHandler(RPCSlot::FromMember<StandInService, &StandInService::SetNumberValue_1>(this));
+        Rpc.RegisterSlot("SetNumberValue_1", SetNumberValueScope);
+    }
+
+    bool Listen()
+    {
+        BerkleyBindParameters bbp;
+        bbp.Address = "::1";
+        bbp.Port = VRServicePort;
+        if (TheSession.ListenPTCP(&bbp) != SessionResult_OK)
+        {
+            return false;
+        }
+        StartPolling();
+        return true;
+    }
+
+    // Changes the value as OVRService would when another application sets it
+    void SetValue(double value)
+    {
+        {
+            Lock::Locker locker(&ValueLock);
+            Value = value;
+        }
+        if (PushesChanges)
+        {
+            BitStream bsOut;
+            bsOut.Write(TestHmd);
+            bsOut.Write(TestKey);
+            Rpc.BroadcastSignal("PropertyChanged_1", &bsOut);
+        }
+    }
+
+    // The next get replies with the current value, but only after the change to nextValue was pushed
+    void ChangeDuringGet(double nextValue)
+    {
+        Lock::Locker locker(&ValueLock);
+        ChangeDuringNextGet = true;
+        NextValue = nextValue;
+    }
+
+    int GetCallCount() const { return GetCalls.Load_Acquire(); }
+
+protected:
+    void GetNumberValue_1(BitStream* userData, BitStream* returnData, ReceivePayload* pPayload)
+    {
+        OVR_UNUSED(pPayload);
+        GetCalls.Increment_NoSync();
+
+        VirtualHmdId hmd = InvalidVirtualHmdId;
+        String key;
+        double value = 0.;
+        userData->Read(hmd);
+        userData->Read(key);
+        userData->Read(value);  // Default
+        if (key != TestKey)
+        {
+            returnData->Write(value);
+            return;
+        }
+
+        bool changeNow;
+        double nextValue;
+        {
+            Lock::Locker locker(&ValueLock);
+            value = Value;
+            changeNow = ChangeDuringNextGet;
+            nextValue = NextValue;
+            ChangeDuringNextGet = false;
+        }
+        if (changeNow)
+        {
+            SetValue(nextValue);
+        }
+        returnData->Write(value);
+    }
+
+    void SetNumberValue_1(BitStream* userData, ReceivePayload* pPayload)
+    {
+        OVR_UNUSED(pPayload);
+
+        VirtualHmdId hmd = InvalidVirtualHmdId;
+        String key;
+        double value = 0.;
+        userData->Read(hmd);
+        userData->Read(key);
+        if (userData->Read(value) && key == TestKey)
+        {
+            SetValue(value);
+        }
+    }
+
+    bool                         PushesChanges;
+    Lock                         ValueLock;
+    double                       Value;
+    bool                         ChangeDuringNextGet;
+    double                       NextValue;
+    AtomicInt<int>               GetCalls;
+    ObserverScope<RPCSlot>       SetNumberValueScope;
+};
+
+
+//-----------------------------------------------------------------------------
+// Test
+
+static int Failures;
+
+static void check(bool condition, const char* what)
+{
+    if (!condition)
+    {
+        LogError("[NetClientTest] FAILED: %s", what);
+        ++Failures;
+    }
+}
+
+static double getValue()
+{
+    return NetClient::GetInstance()->GetCachedNumberValue(TestHmd, TestKey, -1.);
+}
+
+// Pushed notifications arrive on the NetClient thread: reads until value comes back, or a second went by
+static bool waitForValue(double value)
+{
+    double timeout = Timer::GetSeconds() + 1.;
+    while (getValue() != value)
+    {
+        if (Timer::GetSeconds() > timeout)
+        {
+            return false;
+        }
+        Thread::MSleep(1);
+    }
+    return true;
+}
+
+static bool waitForConnection(bool connected)
+{
+    double timeout = Timer::GetSeconds() + 5.;
+    while (NetClient::GetInstance()->IsConnected(false, false) != connected)
+    {
+        if (Timer::GetSeconds() > timeout)
+        {
+            return false;
+        }
+        Thread::MSleep(1);
+    }
+    return true;
+}
+
+bool RunNetClientPropertyCacheTest()
+{
+    Failures = 0;
+    NetClient* client = NetClient::GetInstance();
+    client->Disconnect();
+
+    // A service that pushes its changes: values are cached
+    {
+        StandInService service(true);
+        if (!service.Listen())
+        {
+            LogError("[NetClientTest] Cannot listen on port %d, is OVRService running?", VRServicePort);
+            return false;
+        }
+        check(client->Connect(true) && waitForConnection(true), "connects to the stand-in service");
+
+        client->PrefetchNumberValues(TestHmd);
+        int calls = service.GetCallCount();
+        check(calls > 0, "prefetch calls the service");
+        check(getValue() == 1. && getValue() == 1., "reads the prefetched value");
+        check(service.GetCallCount() == calls, "cache hits make no call");
+
+        service.SetValue(2.);
+        check(waitForValue(2.), "PropertyChanged_1 drops the cached value");
+        calls = service.GetCallCount();
+        check(getValue() == 2. && service.GetCallCount() == calls, "the new value is cached");
+
+        // The reply carries 2 but was sent after the change to 3 was pushed: it must not be kept
+        client->InvalidatePropertyCache();
+        service.ChangeDuringGet(3.);
+        check(getValue() == 2., "a miss returns the value of the reply");
+        check(getValue() == 3., "a reply overtaken by a change is not cached");
+
+        client->SetNumberValue(TestHmd, TestKey, 4.);
+        check(getValue() == 4., "SetNumberValue drops the cached value");
+
+        client->Disconnect();
+        check(waitForConnection(false), "disconnects");
+    }
+
+    // Disconnected, with a service to reconnect to: a miss must not reconnect
+    {
+        StandInService service(false);
+        check(service.Listen(), "listens again");
+
+        for (int i = 0; i < 100; ++i)
+        {
+            check(getValue() == -1., "a miss while disconnected returns the default");
+        }
+        check(!client->IsConnected(false, false) && service.GetCallCount() == 0, "a miss while disconnected does not reconnect");
+
+        // A service that does not push its changes: nothing is cached
+        check(client->Connect(true) && waitForConnection(true), "reconnects");
+        client->PrefetchNumberValues(TestHmd);
+        check(service.GetCallCount() == 0, "no prefetch without PropertyChanged_1");
+        check(getValue() == 1. && getValue() == 1. && service.GetCallCount() == 2, "every read calls a service that does not push changes");
+        service.SetValue(5.);
+        check(getValue() == 5., "reads the changed value at once");
+
+        client->Disconnect();
+        waitForConnection(false);
+    }
+
+    LogText("[NetClientTest] %s, %d failed checks\n", Failures ? "FAILED" : "PASSED", Failures);
+    return Failures == 0;
+}
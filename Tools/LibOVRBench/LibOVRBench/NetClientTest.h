@@ -0,0 +1,34 @@
+/************************************************************************************
+
+Filename    :   NetClientTest.h
+Content     :   NetClient property cache test against a stand-in service
+Created     :   October 17, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+#ifndef LibOVRBench_NetClientTest_h
+#define LibOVRBench_NetClientTest_h
+
+// Runs the NetClient singleton against a stand-in service listening on VRServicePort (OVRService
+// must not be running) and checks GetCachedNumberValue():
+//  - with RPCCapability_PropertyChanged: hits make no call, PropertyChanged_1 and SetNumberValue()
+//    drop the value, and a reply overtaken by a change is not cached;
+//  - while disconnected: a miss returns the default without reconnecting;
+//  - without the capability: nothing is cached.
+// Logs each failed check. Returns true if all passed.
+bool RunNetClientPropertyCacheTest();
+
+#endif // LibOVRBench_NetClientTest_h
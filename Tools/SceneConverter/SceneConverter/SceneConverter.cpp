@@ -0,0 +1,69 @@
+/************************************************************************************
+
+Filename    :   SceneConverter.cpp
+Content     :   Converts an XML scene to the binary scene format
+Created     :   October 17, 2026
+Authors     :   Federico Mammano
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+************************************************************************************/
+
+// Build LibOVR first (LibOVR/Projects/Win32/VS2013), then SceneConverter_VS2013.sln.
+// Reads a scene with XmlHandler and writes it with BinarySceneHandler, for loaders that
+// map the binary file instead of parsing the XML. Returns 0, or 1 if it failed:
+//   SceneConverter.exe [-embed] scene.xml scene.bscn
+// Without -embed the binary scene refers to the texture files of the XML scene, so it has
+// to go in the same directory; with it, the texture files are copied into it.
+
+#include "Kernel/OVR_System.h"
+#include "Kernel/OVR_Log.h"
+#include "Render/Render_BinaryScene.h"
+
+using namespace OVR;
+using namespace OVR::Render;
+
+int main(int argc, char* argv[])
+{
+    System::Init(Log::ConfigureDefaultLog(LogMask_All));
+
+    bool embedTextures = (argc > 1 && !strcmp(argv[1], "-embed"));
+    int  firstFile     = embedTextures ? 2 : 1;
+    int  result        = 1;
+    if (argc != firstFile + 2)
+    {
+        LogText("Usage: SceneConverter [-embed] scene.xml scene.bscn\n");
+    }
+    else
+    {
+        // The textures are only read when they are embedded
+        XmlHandler scene;
+        if (!scene.ReadSceneData(argv[firstFile], false))
+        {
+            LogError("[SceneConverter] Cannot read %s", argv[firstFile]);
+        }
+        else if (!BinarySceneHandler::WriteFile(argv[firstFile + 1], scene, embedTextures))
+        {
+            LogError("[SceneConverter] Cannot write %s", argv[firstFile + 1]);
+        }
+        else
+        {
+            LogText("[SceneConverter] %s: %d models, %d textures%s\n", argv[firstFile + 1], scene.GetModelCount(),
+                    scene.GetTextureCount(), embedTextures ? " embedded" : "");
+            result = 0;
+        }
+    }
+
+    System::Destroy();
+    return result;
+}